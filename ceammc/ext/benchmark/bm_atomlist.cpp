@@ -11,7 +11,9 @@
  * contact the author of this file, or the owner of the project in which
  * this file belongs to.
  *****************************************************************************/
+#include "ceammc_arena.h"
 #include "ceammc_atomlist.h"
+#include "ceammc_containers.h"
 
 #include <nonius/nonius.h++>
 #include <random>
@@ -41,3 +43,29 @@ NONIUS_BENCHMARK("AtomList::product", [] {
 NONIUS_BENCHMARK("AtomList::reduce *", [] {
     return randomList(100).view().reduceFloat(1, [](t_float f0, t_float f1) { return f0 * f1; });
 })
+
+// message temporaries: 8 atoms inplace, 40 atoms overflow
+template <typename List>
+static size_t fillList()
+{
+    List l;
+    for (int i = 0; i < 40; i++)
+        l.push_back(Atom(i));
+
+    return l.size();
+}
+
+NONIUS_BENCHMARK("temp list: AtomList", [] {
+    return fillList<AtomList>();
+})
+
+NONIUS_BENCHMARK("temp list: heap small_vector", [] {
+    return fillList<HeapAtomListN<8>>();
+})
+
+NONIUS_BENCHMARK("temp list: arena small_vector", [](nonius::chronometer meter) {
+    AtomArena arena;
+    AtomArena::bind(&arena);
+    meter.measure([] { return fillList<SmallAtomList>(); });
+    AtomArena::bind(nullptr);
+})
@@ -14,9 +14,15 @@
 #include "ceammc_abstractdata.h"
 #include "ceammc_data.h"
 #include "ceammc_datastorage.h"
+#include "datatype_dict.h"
 
+#include <algorithm>
+#include <map>
 #include <nonius/nonius.h++>
 #include <random>
+#include <string>
+
+extern "C" void pd_init();
 
 using namespace ceammc;
 
@@ -90,3 +96,96 @@ NONIUS_BENCHMARK("DataPtr::sort", [] {
     std::sort(vec2000.begin(), vec2000.end());
     return 0;
 })
+
+/*
+ * Dict storage: the DataTypeDict map vs std::map that was used before, with
+ * 10k and 100k keys. Lookups and updates go in random key order.
+ */
+
+using FlatDict = DataTypeDict::DictMap;
+using StdDict = std::map<t_symbol*, AtomList>;
+
+constexpr size_t MAX_KEYS = 100000;
+
+static std::vector<t_symbol*> dict_keys;
+static FlatDict flat10k, flat100k;
+static StdDict std10k, std100k;
+
+template <typename Dict>
+static void fill_dict(Dict& d, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        d[dict_keys[i]] = AtomList(Atom(i));
+}
+
+static bool init_dict()
+{
+    pd_init();
+
+    dict_keys.reserve(MAX_KEYS);
+    for (size_t i = 0; i < MAX_KEYS; i++)
+        dict_keys.push_back(gensym(("key" + std::to_string(i)).c_str()));
+
+    std::shuffle(dict_keys.begin(), dict_keys.end(), std::default_random_engine());
+
+    fill_dict(flat10k, 10000);
+    fill_dict(flat100k, MAX_KEYS);
+    fill_dict(std10k, 10000);
+    fill_dict(std100k, MAX_KEYS);
+    return true;
+}
+
+static const bool dict_init_ = init_dict();
+
+template <typename Dict>
+static size_t dict_get(Dict& d)
+{
+    size_t res = 0;
+    for (size_t i = d.size(); i > 0; i--)
+        res += d.find(dict_keys[i - 1])->second.size();
+
+    return res;
+}
+
+template <typename Dict>
+static size_t dict_set(Dict& d)
+{
+    for (size_t i = d.size(); i > 0; i--)
+        d[dict_keys[i - 1]] = Atom(i);
+
+    return d.size();
+}
+
+template <typename Dict>
+static size_t dict_iterate(Dict& d)
+{
+    size_t res = 0;
+    for (auto& kv : d)
+        res += kv.second.size();
+
+    return res;
+}
+
+template <typename Dict>
+static size_t dict_copy(Dict& d)
+{
+    Dict c(d);
+    return c.size();
+}
+
+#define BM_DICT(title, fn, n)                                                                  \
+    NONIUS_BENCHMARK("Dict::" title " " #n "k", [](nonius::chronometer meter) {                \
+        meter.measure([] { return fn(flat##n##k); });                                          \
+    })                                                                                         \
+    NONIUS_BENCHMARK("Dict::" title " " #n "k (std::map)", [](nonius::chronometer meter) {     \
+        meter.measure([] { return fn(std##n##k); });                                           \
+    })
+
+BM_DICT("get", dict_get, 10)
+BM_DICT("get", dict_get, 100)
+BM_DICT("set", dict_set, 10)
+BM_DICT("set", dict_set, 100)
+BM_DICT("iterate", dict_iterate, 10)
+BM_DICT("iterate", dict_iterate, 100)
+BM_DICT("copy", dict_copy, 10)
+BM_DICT("copy", dict_copy, 100)
@@ -0,0 +1,139 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include <nonius/nonius.h++>
+
+#include <cstring>
+
+#ifndef PD
+#define PD
+#endif
+
+extern "C" {
+#include "x_vexp.h"
+
+void pd_init();
+struct ex_ex* ex_eval(struct expr* expr, struct ex_ex* eptr, struct ex_ex* optr, int idx);
+}
+
+/*
+ * Tree walker (ex_eval) vs compiled program (ex_run) for a single DSP block
+ * of 64 samples. expr~ evaluates once per block, fexpr~ once per sample.
+ */
+
+constexpr int BS = 64;
+
+static t_float in[3][BS];
+static t_float out[BS];
+
+static t_expr* make_expr(const char* name, const char* args)
+{
+    auto bb = binbuf_new();
+    binbuf_text(bb, args, strlen(args));
+    pd_typedmess(&pd_objectmaker, gensym(name), binbuf_getnatom(bb), binbuf_getvec(bb));
+    binbuf_free(bb);
+
+    auto x = reinterpret_cast<t_expr*>(pd_newest());
+    for (int i = 0; i < MAX_VARS; i++) {
+        auto& v = x->exp_var[i];
+        if (i == 0 || v.ex_type == ET_VI || v.ex_type == ET_XI)
+            v.ex_vec = in[i % 3];
+    }
+
+    return x;
+}
+
+static t_expr *e0, *e1, *f0, *f1;
+
+static bool init_data()
+{
+    pd_init();
+
+    for (int i = 0; i < BS; i++) {
+        in[0][i] = i * 0.01;
+        in[1][i] = 1 - i * 0.02;
+        in[2][i] = (i % 8) - 4;
+    }
+
+    e0 = make_expr("expr~", "$v1 * 0.5 + $v2 * $v3 - $v1 / ($v2 + 2)");
+    e1 = make_expr("expr~", "if($v1 > 0.3 \\, $v2 \\, $v3 * 2) + min($v1 \\, $v2)");
+    f0 = make_expr("fexpr~", "$x1 * 0.1 + $y1 * 0.9");
+    f1 = make_expr("fexpr~", "$x1 * 0.2 + $x1[-1] * 0.3 + $y1[-1] * 0.5 - $y1[-2] * 0.1");
+    return true;
+}
+
+const static bool init = init_data();
+
+static void eval_block(t_expr* x, bool compiled)
+{
+    struct ex_ex res;
+
+    if (IS_EXPR_TILDE(x)) {
+        res.ex_type = ET_VEC;
+        res.ex_vec = out;
+        if (compiled)
+            ex_run(x, x->exp_prog[0], &res, 0);
+        else
+            ex_eval(x, x->exp_stack[0], &res, 0);
+    } else {
+        for (int i = 0; i < BS; i++) {
+            res.ex_type = 0;
+            if (compiled)
+                ex_run(x, x->exp_prog[0], &res, i);
+            else
+                ex_eval(x, x->exp_stack[0], &res, i);
+
+            out[i] = (res.ex_type == ET_INT) ? res.ex_int : res.ex_flt;
+        }
+    }
+}
+
+NONIUS_BENCHMARK("expr~ arithmetic: tree", [] {
+    eval_block(e0, false);
+    return out[0];
+})
+
+NONIUS_BENCHMARK("expr~ arithmetic: bytecode", [] {
+    eval_block(e0, true);
+    return out[0];
+})
+
+NONIUS_BENCHMARK("expr~ if/min: tree", [] {
+    eval_block(e1, false);
+    return out[0];
+})
+
+NONIUS_BENCHMARK("expr~ if/min: bytecode", [] {
+    eval_block(e1, true);
+    return out[0];
+})
+
+NONIUS_BENCHMARK("fexpr~ one pole: tree", [] {
+    eval_block(f0, false);
+    return out[0];
+})
+
+NONIUS_BENCHMARK("fexpr~ one pole: bytecode", [] {
+    eval_block(f0, true);
+    return out[0];
+})
+
+NONIUS_BENCHMARK("fexpr~ biquad like: tree", [] {
+    eval_block(f1, false);
+    return out[0];
+})
+
+NONIUS_BENCHMARK("fexpr~ biquad like: bytecode", [] {
+    eval_block(f1, true);
+    return out[0];
+})
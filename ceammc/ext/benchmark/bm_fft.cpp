@@ -0,0 +1,86 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "d_fftplan.h"
+#include "m_pd.h"
+
+#include <algorithm>
+#include <nonius/nonius.h++>
+#include <random>
+#include <vector>
+
+extern "C" void pd_init();
+
+/*
+ * The FFT library Pd was built with (Ooura or FFTW) vs the vectorized one,
+ * as used by rfft~ (mayer_realfft) and fft~ (mayer_fft). The input is copied
+ * in before every transform, which costs the same for both. Without SIMD
+ * both variants run the library.
+ */
+
+constexpr int MAX_N = 65536;
+
+static std::vector<t_sample> src_re(MAX_N), src_im(MAX_N), re(MAX_N), im(MAX_N);
+
+static bool init()
+{
+    pd_init();
+
+    std::default_random_engine gen;
+    std::uniform_real_distribution<float> dist(-1, 1);
+    for (int i = 0; i < MAX_N; i++) {
+        src_re[i] = dist(gen);
+        src_im[i] = dist(gen);
+    }
+
+    return true;
+}
+
+static const bool init_ = init();
+
+static void run_rfft(int n)
+{
+    std::copy(src_re.begin(), src_re.begin() + n, re.begin());
+    mayer_realfft(n, re.data());
+}
+
+static void run_fft(int n)
+{
+    std::copy(src_re.begin(), src_re.begin() + n, re.begin());
+    std::copy(src_im.begin(), src_im.begin() + n, im.begin());
+    mayer_fft(n, re.data(), im.data());
+}
+
+#define BM_FFT(title, runner, n)                                                      \
+    NONIUS_BENCHMARK(title " " #n " (library)", [](nonius::chronometer meter) {       \
+        fft_setbackend(FFT_BACKEND_LIBRARY);                                          \
+        meter.measure([] { runner(n); });                                             \
+    })                                                                                \
+    NONIUS_BENCHMARK(title " " #n " (simd)", [](nonius::chronometer meter) {          \
+        fft_setbackend(FFT_BACKEND_SIMD);                                             \
+        meter.measure([] { runner(n); });                                             \
+    })
+
+BM_FFT("rfft", run_rfft, 64)
+BM_FFT("rfft", run_rfft, 256)
+BM_FFT("rfft", run_rfft, 1024)
+BM_FFT("rfft", run_rfft, 4096)
+BM_FFT("rfft", run_rfft, 16384)
+BM_FFT("rfft", run_rfft, 65536)
+
+BM_FFT("fft", run_fft, 64)
+BM_FFT("fft", run_fft, 256)
+BM_FFT("fft", run_fft, 1024)
+BM_FFT("fft", run_fft, 4096)
+BM_FFT("fft", run_fft, 16384)
+BM_FFT("fft", run_fft, 65536)
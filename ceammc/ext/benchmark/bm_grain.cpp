@@ -0,0 +1,116 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_canvas.h"
+#include "ceammc_pd.h"
+#include "grain_cloud.h"
+
+#include <nonius/nonius.h++>
+#include <random>
+
+using namespace ceammc;
+using namespace ceammc::pd;
+
+extern "C" void pd_init();
+
+/*
+ * GrainCloud rendering: one 64 samples block with 100, 1000 and 5000 simultaneous grains.
+ * At 48kHz block should be rendered in less than 1.3ms.
+ */
+
+constexpr uint32_t BS = 64;
+constexpr uint32_t SR = 48000;
+constexpr size_t ARRAY_SIZE = 10 * SR;
+
+static CanvasPtr canvas;
+static ArrayPtr array;
+static t_sample buf0[BS], buf1[BS];
+static t_sample* buf[] = { buf0, buf1 };
+
+enum GrainKind {
+    KIND_RECT, // no interpolation, no window
+    KIND_HANN, // linear interpolation, hann window
+    KIND_MIXED, // all interpolation and window types
+    KIND_MOD, // with amp modulation: per-sample processing
+};
+
+static void fill_cloud(GrainCloud& cloud, size_t n, GrainKind kind)
+{
+    std::default_random_engine gen;
+    std::uniform_int_distribution<size_t> pos(0, ARRAY_SIZE - SR);
+    std::uniform_int_distribution<size_t> len(SR / 10, SR / 2);
+    std::uniform_real_distribution<float> speed(0.5, 1.5);
+
+    cloud.clear();
+    cloud.setArrayData(array->begin(), array->size());
+
+    for (size_t i = 0; i < n; i++) {
+        auto g = cloud.appendGrain(pos(gen), len(gen));
+        g->setSpeed(speed(gen));
+        g->setAmplitude(1.0 / n);
+
+        switch (kind) {
+        case KIND_RECT:
+            break;
+        case KIND_HANN:
+            g->setPlayInterpolation(GRAIN_INTERP_LINEAR);
+            g->setWinType(GRAIN_WIN_HANN);
+            break;
+        case KIND_MIXED:
+            g->setPlayInterpolation(GrainInterp(i % 3));
+            g->setWinType(GrainWindowType(i % 6));
+            break;
+        case KIND_MOD:
+            g->setPlayInterpolation(GRAIN_INTERP_LINEAR);
+            g->setWinType(GRAIN_WIN_HANN);
+            g->setModulation(GRAIN_PROP_AMP, GrainPropModulator(GRAIN_MOD_SIN, 4, 0, 1.0 / n));
+            break;
+        }
+    }
+}
+
+static bool init()
+{
+    pd_init();
+    canvas = PureData::instance().createTopCanvas("test_canvas");
+    array = canvas->createArray("grain_array", ARRAY_SIZE);
+
+    array->fillWith([](size_t) -> t_float {
+        static std::default_random_engine gen;
+        static std::uniform_real_distribution<t_float> dist(-1, 1);
+        return dist(gen);
+    });
+
+    return true;
+}
+
+static const bool init_ = init();
+
+static void bench(nonius::chronometer& meter, size_t n, GrainKind kind)
+{
+    GrainCloud cloud(n);
+    fill_cloud(cloud, n, kind);
+
+    meter.measure([&cloud] { return cloud.playBuffer(buf, BS, SR); });
+}
+
+NONIUS_BENCHMARK("GrainCloud 100 rect", [](nonius::chronometer meter) { bench(meter, 100, KIND_RECT); })
+NONIUS_BENCHMARK("GrainCloud 1000 rect", [](nonius::chronometer meter) { bench(meter, 1000, KIND_RECT); })
+NONIUS_BENCHMARK("GrainCloud 5000 rect", [](nonius::chronometer meter) { bench(meter, 5000, KIND_RECT); })
+
+NONIUS_BENCHMARK("GrainCloud 100 hann", [](nonius::chronometer meter) { bench(meter, 100, KIND_HANN); })
+NONIUS_BENCHMARK("GrainCloud 1000 hann", [](nonius::chronometer meter) { bench(meter, 1000, KIND_HANN); })
+NONIUS_BENCHMARK("GrainCloud 5000 hann", [](nonius::chronometer meter) { bench(meter, 5000, KIND_HANN); })
+
+NONIUS_BENCHMARK("GrainCloud 5000 mixed", [](nonius::chronometer meter) { bench(meter, 5000, KIND_MIXED); })
+NONIUS_BENCHMARK("GrainCloud 5000 modulated", [](nonius::chronometer meter) { bench(meter, 5000, KIND_MOD); })
@@ -0,0 +1,155 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_json.h"
+#include "datatype_json.h"
+#include "m_pd.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <nonius/nonius.h++>
+#include <random>
+#include <string>
+
+extern "C" void pd_init();
+
+using namespace ceammc;
+
+/*
+ * JSON to atoms: nlohmann::json document converted with from_json() (as it was
+ * done by net.http.client, net.ws.* and Dict fromJSON) vs the streaming parser
+ * in ceammc_json.h. Number of allocations for each payload is printed on start.
+ */
+
+static std::atomic<size_t> alloc_count { 0 };
+
+void* operator new(std::size_t n)
+{
+    alloc_count++;
+    if (auto p = std::malloc(n ? n : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// 100k numbers
+static std::string json_numbers;
+// 10k records with nested arrays and objects
+static std::string json_records;
+// object with 10k keys
+static std::string json_dict;
+
+static size_t parse_dom(const std::string& str)
+{
+    auto j = nlohmann::json::parse(str);
+    if (j.is_array()) {
+        AtomList lst;
+        from_json(j, lst);
+        return lst.size();
+    } else {
+        Atom a;
+        from_json(j, a);
+        return a.isNone() ? 0 : 1;
+    }
+}
+
+static size_t parse_stream(const std::string& str)
+{
+    AtomList lst;
+    bool is_array = false;
+    std::string err;
+    json::from_json_string(str.data(), str.size(), lst, is_array, err);
+    return lst.size();
+}
+
+static size_t parse_each(const std::string& str)
+{
+    size_t n = 0;
+    std::string err;
+    json::from_json_stream(str.data(), str.size(), [&n](const Atom&) { n++; }, err);
+    return n;
+}
+
+template <typename Fn>
+static size_t count_allocs(Fn fn, const std::string& str)
+{
+    const size_t n = alloc_count;
+    fn(str);
+    return alloc_count - n;
+}
+
+static bool init()
+{
+    pd_init();
+
+    std::default_random_engine gen;
+    std::uniform_real_distribution<float> dist(-1000, 1000);
+
+    json_numbers = "[";
+    for (int i = 0; i < 100000; i++) {
+        if (i)
+            json_numbers += ',';
+        json_numbers += std::to_string(dist(gen));
+    }
+    json_numbers += "]";
+
+    json_records = "[";
+    for (int i = 0; i < 10000; i++) {
+        if (i)
+            json_records += ',';
+        json_records += "{\"id\":" + std::to_string(i)
+            + ",\"name\":\"item" + std::to_string(i % 100)
+            + "\",\"pos\":[" + std::to_string(dist(gen)) + "," + std::to_string(dist(gen))
+            + "],\"tags\":[\"a\",\"b\",\"c\"],\"on\":true}";
+    }
+    json_records += "]";
+
+    json_dict = "{";
+    for (int i = 0; i < 10000; i++) {
+        if (i)
+            json_dict += ',';
+        json_dict += "\"key" + std::to_string(i) + "\":[" + std::to_string(dist(gen)) + ",\"v\"]";
+    }
+    json_dict += "}";
+
+    for (auto p : { &json_numbers, &json_records, &json_dict }) {
+        std::cerr << "JSON " << p->size() / 1024 << "Kb, allocations:"
+                  << " dom: " << count_allocs(parse_dom, *p)
+                  << ", stream: " << count_allocs(parse_stream, *p)
+                  << ", each: " << count_allocs(parse_each, *p) << "\n";
+    }
+
+    return true;
+}
+
+static const bool init_ = init();
+
+#define BM_JSON(title, str)                                                     \
+    NONIUS_BENCHMARK("JSON " title " (dom)", [](nonius::chronometer meter) {    \
+        meter.measure([] { return parse_dom(str); });                           \
+    })                                                                          \
+    NONIUS_BENCHMARK("JSON " title " (stream)", [](nonius::chronometer meter) { \
+        meter.measure([] { return parse_stream(str); });                        \
+    })                                                                          \
+    NONIUS_BENCHMARK("JSON " title " (each)", [](nonius::chronometer meter) {   \
+        meter.measure([] { return parse_each(str); });                          \
+    })
+
+BM_JSON("numbers", json_numbers)
+BM_JSON("records", json_records)
+BM_JSON("dict", json_dict)
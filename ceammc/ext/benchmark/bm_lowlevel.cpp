@@ -14,6 +14,7 @@
 
 #include "fmt/include/fmt/core.h"
 #include "ceammc_datatypes.h"
+#include "m_pd.h"
 
 #include <boost/unordered_map.hpp>
 #include <boost/container/static_vector.hpp>
@@ -23,6 +24,7 @@
 #include <nonius/nonius.h++>
 #include <random>
 #include <sstream>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
@@ -72,6 +74,92 @@ bool init_data()
 
 const static bool init = init_data();
 
+extern "C" void pd_init();
+
+constexpr int NSYM = 1024;
+constexpr int NSYM_MANY = 1000000;
+constexpr int NTHREADS = 4;
+static std::vector<std::string> sym_names;
+
+static bool init_gensym()
+{
+    pd_init();
+
+    for (int i = 0; i < NSYM; i++) {
+        sym_names.push_back(fmt::format("bm_symbol_{}", i));
+        gensym(sym_names.back().c_str());
+    }
+
+    return true;
+}
+
+const static bool init_sym = init_gensym();
+
+static void gensym_lookup(int n, int offset)
+{
+    for (int i = 0; i < n; i++)
+        gensym(sym_names[(i + offset) % NSYM].c_str());
+}
+
+NONIUS_BENCHMARK("gensym: existing", [] {
+    return gensym(sym_names[irand2(gen)].c_str());
+})
+
+NONIUS_BENCHMARK("gensym: new", [](nonius::chronometer meter) {
+    static int n = 0;
+    std::vector<std::string> names;
+    for (int i = 0; i < meter.runs(); i++)
+        names.push_back(fmt::format("bm_new_{}", n++));
+
+    meter.measure([&names](int i) { return gensym(names[i].c_str()); });
+})
+
+NONIUS_BENCHMARK("gensym: existing x1024, 1 thread", [] {
+    gensym_lookup(NSYM, 0);
+})
+
+NONIUS_BENCHMARK("gensym: existing x1024, 4 threads", [] {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NTHREADS; i++)
+        threads.emplace_back(gensym_lookup, NSYM / NTHREADS, i * NSYM / NTHREADS);
+
+    for (auto& t : threads)
+        t.join();
+})
+
+NONIUS_BENCHMARK("gensym: new x1024, 4 threads", [](nonius::chronometer meter) {
+    static int n = 0;
+    std::vector<std::string> names;
+    for (int i = 0; i < meter.runs() * NSYM; i++)
+        names.push_back(fmt::format("bm_new_mt_{}", n++));
+
+    meter.measure([&names](int run) {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < NTHREADS; i++) {
+            threads.emplace_back([&names, run, i]() {
+                const size_t from = run * NSYM + i * (NSYM / NTHREADS);
+                for (size_t j = from; j < from + NSYM / NTHREADS; j++)
+                    gensym(names[j].c_str());
+            });
+        }
+
+        for (auto& t : threads)
+            t.join();
+    });
+})
+
+NONIUS_BENCHMARK("gensym: existing, 1M symbols in table", [](nonius::chronometer meter) {
+    static bool filled = false;
+    if (!filled) {
+        for (int i = 0; i < NSYM_MANY; i++)
+            gensym(fmt::format("bm_many_{}", i).c_str());
+
+        filled = true;
+    }
+
+    meter.measure([] { return gensym(sym_names[irand2(gen)].c_str()); });
+})
+
 NONIUS_BENCHMARK("printf @l%d", [] {
     char buf[1024];
     sprintf(buf, "@l%d", irand(gen));
@@ -0,0 +1,115 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_osc_trie.h"
+
+#include <nonius/nonius.h++>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ceammc::osc;
+
+/*
+ * OSC dispatch: batch of 1000 messages is dispatched to servers with 1000 and 5000
+ * subscribed addresses. At 100k msgs/s the whole batch should take less than 10ms.
+ * Linear matching of every method (as done by liblo for per-path methods)
+ * vs OscAddressTrie.
+ */
+
+constexpr size_t NUM_MSG = 1000;
+
+struct Server {
+    std::vector<std::string> methods;
+    std::vector<bool> is_pattern;
+    OscAddressTrie<size_t> trie;
+    std::vector<std::string> messages;
+};
+
+static Server server1k;
+static Server server5k;
+
+static void init_server(Server& srv, size_t n)
+{
+    std::default_random_engine gen;
+
+    // /dev{N}/ch{N}/{gain,pan,mute,freq}
+    for (size_t i = 0; i < n; i++) {
+        static const char* params[] = { "gain", "pan", "mute", "freq" };
+        srv.methods.push_back("/dev" + std::to_string(i / 64) + "/ch" + std::to_string((i / 4) % 16) + "/" + params[i % 4]);
+    }
+
+    // a few patterns
+    srv.methods.push_back("/dev0/*/gain");
+    srv.methods.push_back("/dev[0-3]/ch1/{pan,mute}");
+
+    for (size_t i = 0; i < srv.methods.size(); i++) {
+        srv.trie.insert(srv.methods[i], i);
+        srv.is_pattern.push_back(is_pattern(srv.methods[i]));
+    }
+
+    std::uniform_int_distribution<size_t> dist(0, n - 1);
+    srv.messages.reserve(NUM_MSG);
+    for (size_t i = 0; i < NUM_MSG; i++)
+        srv.messages.push_back(srv.methods[dist(gen)]);
+}
+
+static size_t dispatch_linear(const Server& srv)
+{
+    size_t res = 0;
+
+    for (auto& m : srv.messages) {
+        for (size_t i = 0; i < srv.methods.size(); i++) {
+            auto& p = srv.methods[i];
+            if (srv.is_pattern[i] ? pattern_match(p, m) : (p == m))
+                res++;
+        }
+    }
+
+    return res;
+}
+
+static size_t dispatch_trie(const Server& srv)
+{
+    size_t res = 0;
+
+    for (auto& m : srv.messages)
+        res += srv.trie.match(m, [](size_t) {});
+
+    return res;
+}
+
+static bool init()
+{
+    init_server(server1k, 1000);
+    init_server(server5k, 5000);
+    return true;
+}
+
+static const bool init_ = init();
+
+NONIUS_BENCHMARK("OSC 1k methods (linear)", [](nonius::chronometer meter) {
+    meter.measure([] { return dispatch_linear(server1k); });
+})
+
+NONIUS_BENCHMARK("OSC 1k methods (trie)", [](nonius::chronometer meter) {
+    meter.measure([] { return dispatch_trie(server1k); });
+})
+
+NONIUS_BENCHMARK("OSC 5k methods (linear)", [](nonius::chronometer meter) {
+    meter.measure([] { return dispatch_linear(server5k); });
+})
+
+NONIUS_BENCHMARK("OSC 5k methods (trie)", [](nonius::chronometer meter) {
+    meter.measure([] { return dispatch_trie(server5k); });
+})
@@ -0,0 +1,147 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "d_simd.h"
+#include "m_pd.h"
+
+#include <climits>
+#include <nonius/nonius.h++>
+#include <random>
+#include <vector>
+
+extern "C" void pd_init();
+
+// plain routines from d_arithmetic.c and d_math.c
+extern "C" t_int* plus_perf8(t_int* w);
+extern "C" t_int* scalartimes_perf8(t_int* w);
+extern "C" t_int* over_perf8(t_int* w);
+extern "C" t_int* max_perf8(t_int* w);
+extern "C" t_int* sigsqrt_perform(t_int* w);
+extern "C" t_int* abs_tilde_perform(t_int* w);
+
+constexpr int BS = 64;
+
+static std::vector<t_sample> in1(BS), in2(BS), out(BS);
+static t_float scalar = 0.75;
+static t_float clip_lo = -0.5;
+static t_float clip_hi = 0.5;
+
+static bool init()
+{
+    pd_init();
+    q8_sqrt(1); // makes the tables sigsqrt_perform() needs
+
+    std::default_random_engine gen;
+    std::uniform_real_distribution<float> dist(-4, 4);
+    for (int i = 0; i < BS; i++) {
+        in1[i] = dist(gen);
+        in2[i] = dist(gen);
+    }
+
+    return true;
+}
+
+static const bool init_ = init();
+
+static t_perfroutine simd(t_simdop op, int isa)
+{
+    return dsp_setsimd(isa) ? dsp_simdroutine(op, BS) : nullptr;
+}
+
+static void run_binop(t_perfroutine fn)
+{
+    t_int w[5] = { 0, (t_int)in1.data(), (t_int)in2.data(), (t_int)out.data(), BS };
+    if (fn)
+        fn(w);
+}
+
+static void run_scalarop(t_perfroutine fn)
+{
+    t_int w[5] = { 0, (t_int)in1.data(), (t_int)&scalar, (t_int)out.data(), BS };
+    if (fn)
+        fn(w);
+}
+
+static void run_unop(t_perfroutine fn)
+{
+    t_int w[4] = { 0, (t_int)in1.data(), (t_int)out.data(), BS };
+    if (fn)
+        fn(w);
+}
+
+static void run_clip(t_perfroutine fn)
+{
+    t_int w[6] = { 0, (t_int)in1.data(), (t_int)out.data(), (t_int)&clip_lo, (t_int)&clip_hi, BS };
+    if (fn)
+        fn(w);
+}
+
+// the plain clip~ and wrap~ routines are private to d_math.c, these are the same loops
+static t_int* clip_plain(t_int* w)
+{
+    auto in = (t_sample*)(w[1]);
+    auto out = (t_sample*)(w[2]);
+    auto lo = *(t_float*)(w[3]);
+    auto hi = *(t_float*)(w[4]);
+    int n = (int)(w[5]);
+    while (n--) {
+        t_sample f = *in++;
+        if (f < lo)
+            f = lo;
+        if (f > hi)
+            f = hi;
+        *out++ = f;
+    }
+    return w + 6;
+}
+
+static t_int* wrap_plain(t_int* w)
+{
+    auto in = (t_sample*)(w[1]);
+    auto out = (t_sample*)(w[2]);
+    int n = (int)(w[3]);
+    while (n--) {
+        t_sample f = *in++;
+        f = (f > INT_MAX || f < INT_MIN) ? 0. : f;
+        int k = (int)f;
+        if (k <= f)
+            *out++ = f - k;
+        else
+            *out++ = f - (k - 1);
+    }
+    return w + 4;
+}
+
+#define BM_SIMD(title, runner, plain, op)                                                 \
+    NONIUS_BENCHMARK(title " (scalar)", [] { runner(plain); })                            \
+    NONIUS_BENCHMARK(title " (sse2)", [](nonius::chronometer meter) {                     \
+        auto fn = simd(op, DSP_SIMD_SSE2);                                                \
+        meter.measure([fn] { runner(fn); });                                              \
+    })                                                                                    \
+    NONIUS_BENCHMARK(title " (avx2)", [](nonius::chronometer meter) {                     \
+        auto fn = simd(op, DSP_SIMD_AVX2);                                                \
+        meter.measure([fn] { runner(fn); });                                              \
+    })                                                                                    \
+    NONIUS_BENCHMARK(title " (neon)", [](nonius::chronometer meter) {                     \
+        auto fn = simd(op, DSP_SIMD_NEON);                                                \
+        meter.measure([fn] { runner(fn); });                                              \
+    })
+
+BM_SIMD("+~", run_binop, plus_perf8, SIMD_PLUS)
+BM_SIMD("*~ 0.75", run_scalarop, scalartimes_perf8, SIMD_SCALARTIMES)
+BM_SIMD("/~", run_binop, over_perf8, SIMD_OVER)
+BM_SIMD("max~", run_binop, max_perf8, SIMD_MAX)
+BM_SIMD("clip~", run_clip, clip_plain, SIMD_CLIP)
+BM_SIMD("wrap~", run_unop, wrap_plain, SIMD_WRAP)
+BM_SIMD("sqrt~", run_unop, sigsqrt_perform, SIMD_SQRT)
+BM_SIMD("abs~", run_unop, abs_tilde_perform, SIMD_ABS)
@@ -0,0 +1,189 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_sound_stream.h"
+
+#include <boost/lockfree/spsc_queue.hpp>
+#include <memory>
+#include <nonius/nonius.h++>
+#include <thread>
+#include <vector>
+
+using namespace ceammc;
+using namespace ceammc::sound;
+
+/*
+ * Every stream delivers one second of stereo 48k audio, read by the "DSP" loop
+ * in blocks of 64 frames. With N streams and T run time:
+ *   streams per core = N * 1s / T / number of workers
+ */
+
+constexpr size_t NCH = 2;
+constexpr size_t SR = 48000;
+constexpr size_t BS = 64;
+constexpr size_t CHUNK = 1024;
+constexpr size_t RING_FRAMES = 8192;
+
+class BenchStream : public StreamTask {
+    FrameRing ring_;
+    std::vector<float> chunk_;
+    std::atomic_size_t produced_ { 0 };
+
+public:
+    BenchStream()
+        : ring_(NCH, RING_FRAMES)
+        , chunk_(CHUNK * NCH)
+    {
+    }
+
+    bool process() override
+    {
+        const auto pos = produced_.load(std::memory_order_relaxed);
+        if (pos >= SR || ring_.writeAvailable() < CHUNK)
+            return false;
+
+        // decoding stub
+        for (size_t i = 0; i < chunk_.size(); i++)
+            chunk_[i] = (pos + i) * 0.0001f;
+
+        produced_.store(pos + ring_.write(chunk_.data(), CHUNK), std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t read(t_sample** out)
+    {
+        return ring_.read(out, NCH, BS);
+    }
+};
+
+static void run_pool(StreamPool& pool, size_t nstreams)
+{
+    std::vector<std::unique_ptr<BenchStream>> streams;
+    for (size_t i = 0; i < nstreams; i++) {
+        streams.emplace_back(new BenchStream);
+        pool.add(streams.back().get());
+    }
+
+    t_sample b0[BS], b1[BS];
+    t_sample* out[NCH] = { b0, b1 };
+    std::vector<size_t> consumed(nstreams, 0);
+
+    size_t done = 0;
+    while (done < nstreams) {
+        bool any = false;
+        for (size_t i = 0; i < nstreams; i++) {
+            if (consumed[i] >= SR)
+                continue;
+
+            auto n = streams[i]->read(out);
+            consumed[i] += n;
+            any = any || n > 0;
+
+            if (consumed[i] >= SR)
+                done++;
+        }
+
+        // snd.play~ wakes up the worker only when the ring has a room for the next chunk,
+        // here we measure decoding throughput
+        if (!any)
+            pool.notify();
+    }
+
+    for (auto& s : streams)
+        pool.remove(s.get());
+}
+
+// the old snd.play~ scheme: worker thread per stream, pushing single samples
+static void run_thread_per_stream(size_t nstreams)
+{
+    using Queue = boost::lockfree::spsc_queue<float, boost::lockfree::capacity<8192>>;
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < nstreams; i++)
+        queues.emplace_back(new Queue);
+
+    for (size_t i = 0; i < nstreams; i++) {
+        threads.emplace_back([&queues, i]() {
+            auto& q = *queues[i];
+            for (size_t j = 0; j < SR * NCH; j++) {
+                while (q.write_available() == 0)
+                    std::this_thread::yield();
+
+                q.push(j * 0.0001f);
+            }
+        });
+    }
+
+    t_sample out[BS * NCH];
+    std::vector<size_t> consumed(nstreams, 0);
+    size_t done = 0;
+    while (done < nstreams) {
+        bool any = false;
+        for (size_t i = 0; i < nstreams; i++) {
+            if (consumed[i] >= SR * NCH)
+                continue;
+
+            auto n = queues[i]->pop(out, BS * NCH);
+            consumed[i] += n;
+            any = any || n > 0;
+
+            if (consumed[i] >= SR * NCH)
+                done++;
+        }
+
+        if (!any)
+            std::this_thread::yield();
+    }
+
+    for (auto& t : threads)
+        t.join();
+}
+
+NONIUS_BENCHMARK("thread per stream: 16 streams x 1 sec", [] {
+    run_thread_per_stream(16);
+})
+
+NONIUS_BENCHMARK("thread per stream: 64 streams x 1 sec", [] {
+    run_thread_per_stream(64);
+})
+
+NONIUS_BENCHMARK("stream pool (1 worker): 1 stream x 1 sec", [] {
+    static StreamPool pool(1);
+    run_pool(pool, 1);
+})
+
+NONIUS_BENCHMARK("stream pool (1 worker): 16 streams x 1 sec", [] {
+    static StreamPool pool(1);
+    run_pool(pool, 16);
+})
+
+NONIUS_BENCHMARK("stream pool (1 worker): 64 streams x 1 sec", [] {
+    static StreamPool pool(1);
+    run_pool(pool, 64);
+})
+
+NONIUS_BENCHMARK("stream pool (4 workers): 16 streams x 1 sec", [] {
+    static StreamPool pool(4);
+    run_pool(pool, 16);
+})
+
+NONIUS_BENCHMARK("stream pool (4 workers): 64 streams x 1 sec", [] {
+    static StreamPool pool(4);
+    run_pool(pool, 64);
+})
+
+NONIUS_BENCHMARK("stream pool (4 workers): 200 streams x 1 sec", [] {
+    static StreamPool pool(4);
+    run_pool(pool, 200);
+})
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_canvas.h"
+#include "ceammc_pd.h"
+#include "cicm/Sources/ebox.h"
+#include "cicm/Sources/ecommon.h"
+
+extern "C" {
+#include "g_canvas.h"
+#include "s_stuff.h"
+}
+
+#include <cstdio>
+#include <nonius/nonius.h++>
+
+using namespace ceammc;
+using namespace ceammc::pd;
+
+extern "C" void pd_init();
+extern void setup_ui_knob();
+
+/*
+ * GUI traffic: 100 knobs get a new value on every scheduler tick during one second
+ * of logical time. Paints are counted with the ebox paint hook: with the redraw queue
+ * every knob should be painted 60 times, with immediate redraws - on every tick.
+ */
+
+constexpr size_t NKNOBS = 100;
+constexpr double DURATION_MS = 1000;
+
+static CanvasPtr canvas;
+static std::vector<std::shared_ptr<External>> knobs;
+static size_t paint_count = 0;
+
+static void count_paint(t_ebox*)
+{
+    paint_count++;
+}
+
+static size_t run(bool now)
+{
+    paint_count = 0;
+
+    const auto t = clock_getlogicaltime();
+    for (t_float v = 0; clock_gettimesince(t) < DURATION_MS; v += 0.001) {
+        for (auto& k : knobs) {
+            pd_float(k->pd(), v);
+            if (now)
+                ebox_redraw_now(reinterpret_cast<t_ebox*>(k->object()));
+        }
+
+        sched_tick();
+    }
+
+    return paint_count;
+}
+
+static bool init()
+{
+    pd_init();
+    epd_init();
+    setup_ui_knob();
+
+    // canvas without GUI connection: knobs are visible, but paint only to the hook
+    canvas = PureData::instance().createTopCanvas("test_canvas");
+    canvas->pd_canvas()->gl_havewindow = 1;
+    canvas->pd_canvas()->gl_mapped = 1;
+    canvas->pd_canvas()->gl_loading = 0;
+
+    for (size_t i = 0; i < NKNOBS; i++) {
+        auto k = canvas->createObject("ui.knob", AtomList());
+        gobj_vis(reinterpret_cast<t_gobj*>(k->object()), canvas->pd_canvas(), 1);
+        knobs.push_back(k);
+    }
+
+    ebox_set_paint_hook(count_paint);
+
+    printf("paints per second: queued %d, immediate %d\n", (int)run(false), (int)run(true));
+    return true;
+}
+
+static void bench(nonius::chronometer& meter, bool now)
+{
+    // not in static initialization: UI factories use static data
+    static const bool init_ = init();
+    meter.measure([now] { return run(now); });
+}
+
+NONIUS_BENCHMARK("100 knobs, queued redraw", [](nonius::chronometer meter) { bench(meter, false); })
+NONIUS_BENCHMARK("100 knobs, immediate redraw", [](nonius::chronometer meter) { bench(meter, true); })
@@ -777,6 +777,8 @@ set(DOC_FILES
     system.colorpanel
     system.command
     system.cursor
+    system.dsp_profile
+    system.dsp_stats
     system.exec
     system.exit
     system.exit
@@ -26,7 +26,7 @@
 using namespace ceammc;
 
 struct DeferMessage {
-    SmallAtomListN<8> msg;
+    HeapAtomListN<8> msg;
     std::uint8_t count;
 };
 
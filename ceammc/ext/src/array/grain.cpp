@@ -63,6 +63,144 @@ static std::string tag2str(t_symbol* tag)
     return tag ? (std::string(1, '.') + tag->s_name) : std::string {};
 }
 
+namespace {
+    constexpr size_t RENDER_CHUNK = 64;
+
+    template <GrainInterp I>
+    inline t_sample read_sample(ArrayIterator& in, size_t in_size, double arr_idx);
+
+    template <>
+    inline t_sample read_sample<GRAIN_INTERP_NONE>(ArrayIterator& in, size_t /*in_size*/, double arr_idx)
+    {
+        return in[static_cast<size_t>(arr_idx)];
+    }
+
+    template <>
+    inline t_sample read_sample<GRAIN_INTERP_LINEAR>(ArrayIterator& in, size_t in_size, double arr_idx)
+    {
+        const auto idx = static_cast<size_t>(arr_idx);
+        const auto x0 = in[idx];
+        const auto x1 = (idx + 1 >= in_size) ? x0 : in[idx + 1];
+        const double t1 = arr_idx - double(idx); // fractional part
+        return interpolate::linear<double>(x0, x1, t1);
+    }
+
+    template <>
+    inline t_sample read_sample<GRAIN_INTERP_CUBIC>(ArrayIterator& in, size_t in_size, double arr_idx)
+    {
+        const auto idx = static_cast<size_t>(arr_idx);
+        const auto x0 = (idx < 1) ? in[idx] : in[idx - 1];
+        const auto x1 = in[idx];
+        const auto x2 = (idx + 1 >= in_size) ? x1 : in[idx + 1];
+        const auto x3 = (idx + 2 >= in_size) ? x2 : in[idx + 2];
+        const double t1 = arr_idx - double(idx); // fractional part
+        return interpolate::cubic_hermite<double>(x0, x1, x2, x3, t1);
+    }
+
+    template <GrainInterp I>
+    void read_samples(ArrayIterator& in, size_t in_size, const double* arr_idx, t_sample* out, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+            out[i] = read_sample<I>(in, in_size, arr_idx[i]);
+    }
+
+    inline t_sample win_table(const t_sample* tbl, double pos, uint32_t len)
+    {
+        const double win_fpos = convert::lin2lin_clip<double>(pos, 0, len - 1, 0, WIN_SIZE - 1);
+        const double win_ipos = static_cast<size_t>(win_fpos);
+        const double win_t = win_fpos - static_cast<size_t>(win_ipos); // fractional part
+
+        return interpolate::linear<t_sample>(
+            tbl[size_t(win_ipos) + 0],
+            tbl[size_t(win_ipos) + 1],
+            win_t);
+    }
+
+    /**
+     * window value at grain logical position
+     * @note returns 1 for non-affected positions
+     */
+    template <GrainWindowType W>
+    inline t_sample win_value(double pos, uint32_t len, float param);
+
+    template <>
+    inline t_sample win_value<GRAIN_WIN_RECT>(double, uint32_t, float) { return 1; }
+
+    template <>
+    inline t_sample win_value<GRAIN_WIN_TRI>(double pos, uint32_t len, float)
+    {
+        return win_table(win_triangle.data(), pos, len);
+    }
+
+    template <>
+    inline t_sample win_value<GRAIN_WIN_HANN>(double pos, uint32_t len, float)
+    {
+        return win_table(win_hann.data(), pos, len);
+    }
+
+    template <>
+    inline t_sample win_value<GRAIN_WIN_TRPZ>(double pos, uint32_t len, float win_param)
+    {
+        const int param = (win_param <= 0) ? 512 : win_param;
+        const auto RAMP_SAMP = std::min<double>(param, len * 0.25);
+        if (pos < RAMP_SAMP)
+            return convert::lin2lin_clip<t_sample>(pos, 0, RAMP_SAMP, 0, 1);
+        else if (pos > len - RAMP_SAMP - 1)
+            return convert::lin2lin_clip<t_sample>(len - pos - 1, 0, RAMP_SAMP, 0, 1);
+        else
+            return 1;
+    }
+
+    template <>
+    inline t_sample win_value<GRAIN_WIN_LINUP>(double pos, uint32_t len, float win_param)
+    {
+        const int param = (win_param <= 0) ? 64 : win_param;
+        const auto RAMP_DOWN_SAMP = std::min<double>(param, len * 0.125);
+        const double ramp_down = len - RAMP_DOWN_SAMP - 1;
+        if (pos > ramp_down)
+            return convert::lin2lin_clip<t_sample>(len - pos - 1, 0, RAMP_DOWN_SAMP, 0, 1);
+        else
+            return convert::lin2lin_clip<t_sample>(pos, 0, ramp_down, 0, 1);
+    }
+
+    template <>
+    inline t_sample win_value<GRAIN_WIN_LINDOWN>(double pos, uint32_t len, float win_param)
+    {
+        const int param = (win_param <= 0) ? 64 : win_param;
+        const auto RAMP_UP_SAMP = std::min<double>(param, len * 0.125);
+        if (pos < RAMP_UP_SAMP)
+            return convert::lin2lin_clip<t_sample>(pos, 0, RAMP_UP_SAMP, 0, 1);
+        else
+            return convert::lin2lin_clip<t_sample>(pos - RAMP_UP_SAMP, RAMP_UP_SAMP, len - 1, 1, 0);
+    }
+
+    template <GrainWindowType W>
+    void apply_window(const double* pos, t_sample* buf, size_t n, uint32_t len, float param)
+    {
+        for (size_t i = 0; i < n; i++)
+            buf[i] *= win_value<W>(pos[i], len, param);
+    }
+
+    t_sample win_value(GrainWindowType w, double pos, uint32_t len, float param)
+    {
+        switch (w) {
+        case GRAIN_WIN_TRI:
+            return win_value<GRAIN_WIN_TRI>(pos, len, param);
+        case GRAIN_WIN_HANN:
+            return win_value<GRAIN_WIN_HANN>(pos, len, param);
+        case GRAIN_WIN_TRPZ:
+            return win_value<GRAIN_WIN_TRPZ>(pos, len, param);
+        case GRAIN_WIN_LINUP:
+            return win_value<GRAIN_WIN_LINUP>(pos, len, param);
+        case GRAIN_WIN_LINDOWN:
+            return win_value<GRAIN_WIN_LINDOWN>(pos, len, param);
+        case GRAIN_WIN_RECT:
+        default:
+            return 1;
+        }
+    }
+}
+
 Grain::Grain()
     : pan_(0.5)
     , state_(GRAIN_FINISHED)
@@ -248,9 +386,6 @@ GrainState Grain::process(ArrayIterator in, size_t in_size, t_sample** buf, uint
     if (zero_speed || zero_amp)
         return done();
 
-    const auto pan_coeffs = panSample(1);
-    const double step_incr = std::abs(play_speed_);
-
     // silence before grain in current block
     size_t i = 0;
     if (beforeGrain()) {
@@ -260,93 +395,43 @@ GrainState Grain::process(ArrayIterator in, size_t in_size, t_sample** buf, uint
             (*done_samp) += i;
     }
 
-    for (; i < bs && play_pos_ < grainEndInSamples(); i++) {
-        // only grain itself expected here, without silence before/after
-        assert(!beforeGrain() && !afterGrain());
-
-        // array play position
-        const double arr_idx = currentArrayPlayPos();
-        if (!validArrayPos(arr_idx, in_size))
+    if (!mods_) {
+        // no per-sample parameter changes: render by chunks
+        if (!renderBlock(in, in_size, buf[0] + buf_offset, buf[1] + buf_offset, bs, i, done_samp))
             return done();
+    } else {
+        // modulated grain: parameters are updated every sample
+        const auto pan_coeffs = panSample(1);
+        const double step_incr = std::abs(play_speed_);
 
-        t_sample value = 0;
-        const auto idx = static_cast<size_t>(arr_idx);
+        for (; i < bs && play_pos_ < grainEndInSamples(); i++) {
+            // only grain itself expected here, without silence before/after
+            assert(!beforeGrain() && !afterGrain());
 
-        switch (play_interp_) {
-        case GRAIN_INTERP_LINEAR: {
-            const auto x0 = in[idx];
-            const auto x1 = (idx + 1 >= in_size) ? x0 : in[idx + 1];
-            const double t1 = arr_idx - double(idx); // fractional part
-            value = interpolate::linear<double>(x0, x1, t1);
-        } break;
-        case GRAIN_INTERP_CUBIC: {
-            const auto x0 = (idx < 1) ? in[idx] : in[idx - 1];
-            const auto x1 = in[idx];
-            const auto x2 = (idx + 1 >= in_size) ? x1 : in[idx + 1];
-            const auto x3 = (idx + 2 >= in_size) ? x2 : in[idx + 2];
-            const double t1 = arr_idx - double(idx); // fractional part
-            value = interpolate::cubic_hermite<double>(x0, x1, x2, x3, t1);
-        } break;
-        case GRAIN_INTERP_NONE:
-        default:
-            value = in[idx];
-            break;
-        }
+            // array play position
+            const double arr_idx = currentArrayPlayPos();
+            if (!validArrayPos(arr_idx, in_size))
+                return done();
 
-        // apply window
-        if (win_type_ != GRAIN_WIN_RECT) {
-            const double win_fpos = convert::lin2lin_clip<double>(currentLogicPlayPos(), 0, length_ - 1, 0, WIN_SIZE - 1);
-            const double win_ipos = static_cast<size_t>(win_fpos);
-            const double win_t = win_fpos - static_cast<size_t>(win_ipos); // fractional part
-
-            switch (win_type_) {
-            case GRAIN_WIN_TRI:
-                value *= interpolate::linear<t_sample>(
-                    win_triangle[win_ipos + 0],
-                    win_triangle[win_ipos + 1],
-                    win_t);
+            t_sample value = 0;
+
+            switch (play_interp_) {
+            case GRAIN_INTERP_LINEAR:
+                value = read_sample<GRAIN_INTERP_LINEAR>(in, in_size, arr_idx);
                 break;
-            case GRAIN_WIN_HANN:
-                value *= interpolate::linear<t_sample>(
-                    win_hann[win_ipos + 0],
-                    win_hann[win_ipos + 1],
-                    win_t);
+            case GRAIN_INTERP_CUBIC:
+                value = read_sample<GRAIN_INTERP_CUBIC>(in, in_size, arr_idx);
                 break;
-            case GRAIN_WIN_TRPZ: {
-                const auto pos = currentLogicPlayPos();
-                const int param = (win_param_ <= 0) ? 512 : win_param_;
-                const auto RAMP_SAMP = std::min<double>(param, length_ * 0.25);
-                if (pos < RAMP_SAMP)
-                    value *= convert::lin2lin_clip<t_sample>(pos, 0, RAMP_SAMP, 0, 1);
-                else if (pos > length_ - RAMP_SAMP - 1)
-                    value *= convert::lin2lin_clip<t_sample>(length_ - pos - 1, 0, RAMP_SAMP, 0, 1);
-            } break;
-            case GRAIN_WIN_LINUP: {
-                const auto pos = currentLogicPlayPos();
-                const int param = (win_param_ <= 0) ? 64 : win_param_;
-                const auto RAMP_DOWN_SAMP = std::min<double>(param, length_ * 0.125);
-                const double ramp_down = length_ - RAMP_DOWN_SAMP - 1;
-                if (pos > ramp_down)
-                    value *= convert::lin2lin_clip<t_sample>(length_ - pos - 1, 0, RAMP_DOWN_SAMP, 0, 1);
-                else
-                    value *= convert::lin2lin_clip<t_sample>(pos, 0, ramp_down, 0, 1);
-            } break;
-            case GRAIN_WIN_LINDOWN: {
-                const auto pos = currentLogicPlayPos();
-                const int param = (win_param_ <= 0) ? 64 : win_param_;
-                const auto RAMP_UP_SAMP = std::min<double>(param, length_ * 0.125);
-                if (pos < RAMP_UP_SAMP)
-                    value *= convert::lin2lin_clip<t_sample>(pos, 0, RAMP_UP_SAMP, 0, 1);
-                else
-                    value *= convert::lin2lin_clip<t_sample>(pos - RAMP_UP_SAMP, RAMP_UP_SAMP, length_ - 1, 1, 0);
-
-            } break;
+            case GRAIN_INTERP_NONE:
             default:
+                value = read_sample<GRAIN_INTERP_NONE>(in, in_size, arr_idx);
                 break;
             }
-        }
 
-        if (mods_) {
+            // apply window
+            if (win_type_ != GRAIN_WIN_RECT)
+                value *= win_value(win_type_, currentLogicPlayPos(), length_, win_param_);
+
             const double t = play_pos_ - pre_delay_;
             if (mods_->modAmp())
                 amp_ = mods_->mod(GRAIN_PROP_AMP, sr, t);
@@ -356,23 +441,23 @@ GrainState Grain::process(ArrayIterator in, size_t in_size, t_sample** buf, uint
 
             if (mods_->modPan())
                 pan_ = mods_->mod(GRAIN_PROP_PAN, sr, t);
-        }
 
-        // apply amp
-        const auto vamp = value * amp_;
+            // apply amp
+            const auto vamp = value * amp_;
 
-        // apply pan
-        buf[0][i + buf_offset] += pan_coeffs.first * vamp;
-        buf[1][i + buf_offset] += pan_coeffs.second * vamp;
+            // apply pan
+            buf[0][i + buf_offset] += pan_coeffs.first * vamp;
+            buf[1][i + buf_offset] += pan_coeffs.second * vamp;
 
-        play_pos_ += step_incr;
+            play_pos_ += step_incr;
 
-        // increment done samples
-        if (done_samp)
-            (*done_samp)++;
+            // increment done samples
+            if (done_samp)
+                (*done_samp)++;
 
-        if (shouldDone())
-            return done();
+            if (shouldDone())
+                return done();
+        }
     }
 
     if (shouldDone())
@@ -391,6 +476,98 @@ GrainState Grain::process(ArrayIterator in, size_t in_size, t_sample** buf, uint
     return GRAIN_PLAYING;
 }
 
+bool Grain::renderBlock(ArrayIterator in, size_t in_size, t_sample* out0, t_sample* out1, uint32_t bs, size_t& i, uint32_t* done_samp)
+{
+    double arr_idx[RENDER_CHUNK];
+    double win_pos[RENDER_CHUNK];
+    t_sample value[RENDER_CHUNK];
+
+    const auto pan_coeffs = panSample(1);
+    const double step_incr = std::abs(play_speed_);
+    const double start = grainStartInSamples();
+    const double end = grainEndInSamples();
+    const bool forward = play_speed_ >= 0;
+
+    while (i < bs && play_pos_ < end) {
+        // play positions for the chunk
+        const size_t max_n = std::min<size_t>(RENDER_CHUNK, bs - i);
+        bool in_range = true;
+        size_t n = 0;
+        for (; n < max_n && play_pos_ < end; n++) {
+            const double pos = play_pos_ - start;
+            const double idx = forward
+                ? src_pos_ + pos
+                : src_pos_ + (double(length_) - 1) - pos;
+
+            if (!validArrayPos(idx, in_size)) {
+                in_range = false;
+                break;
+            }
+
+            win_pos[n] = pos;
+            arr_idx[n] = idx;
+            play_pos_ += step_incr;
+        }
+
+        // read source samples: one loop per interpolation type
+        switch (play_interp_) {
+        case GRAIN_INTERP_LINEAR:
+            read_samples<GRAIN_INTERP_LINEAR>(in, in_size, arr_idx, value, n);
+            break;
+        case GRAIN_INTERP_CUBIC:
+            read_samples<GRAIN_INTERP_CUBIC>(in, in_size, arr_idx, value, n);
+            break;
+        case GRAIN_INTERP_NONE:
+        default:
+            read_samples<GRAIN_INTERP_NONE>(in, in_size, arr_idx, value, n);
+            break;
+        }
+
+        // apply window: one loop per window type
+        switch (win_type_) {
+        case GRAIN_WIN_TRI:
+            apply_window<GRAIN_WIN_TRI>(win_pos, value, n, length_, win_param_);
+            break;
+        case GRAIN_WIN_HANN:
+            apply_window<GRAIN_WIN_HANN>(win_pos, value, n, length_, win_param_);
+            break;
+        case GRAIN_WIN_TRPZ:
+            apply_window<GRAIN_WIN_TRPZ>(win_pos, value, n, length_, win_param_);
+            break;
+        case GRAIN_WIN_LINUP:
+            apply_window<GRAIN_WIN_LINUP>(win_pos, value, n, length_, win_param_);
+            break;
+        case GRAIN_WIN_LINDOWN:
+            apply_window<GRAIN_WIN_LINDOWN>(win_pos, value, n, length_, win_param_);
+            break;
+        case GRAIN_WIN_RECT:
+        default:
+            break;
+        }
+
+        // apply amp and pan: no branches, vectorized by compiler
+        const t_sample amp = amp_;
+        const t_sample c0 = pan_coeffs.first;
+        const t_sample c1 = pan_coeffs.second;
+        t_sample* l = out0 + i;
+        t_sample* r = out1 + i;
+        for (size_t k = 0; k < n; k++) {
+            const auto vamp = value[k] * amp;
+            l[k] += c0 * vamp;
+            r[k] += c1 * vamp;
+        }
+
+        i += n;
+        if (done_samp)
+            (*done_samp) += n;
+
+        if (!in_range)
+            return false;
+    }
+
+    return true;
+}
+
 void Grain::setOnDone(GrainPropId id, const ByteCode& bc)
 {
     if (!ondone_)
@@ -410,6 +410,14 @@ public:
     bool hasModulation(GrainPropId id) const;
 
 private:
+    /**
+     * render grain samples without modulation by chunks, branches on
+     * interpolation and window types are done once per chunk
+     * @param i - current block position, updated
+     * @return false if array bounds were reached
+     */
+    bool renderBlock(ArrayIterator in, size_t in_size, t_sample* out0, t_sample* out1, uint32_t bs, size_t& i, uint32_t* done_samp);
+
     inline bool beforeGrain() const { return play_pos_ < grainStartInSamples(); }
     inline bool afterGrain() const { return play_pos_ >= grainEndInSamples(); }
     inline bool validArrayPos(double pos, size_t size) const { return 0 <= pos && pos < size; }
@@ -49,6 +49,7 @@ namespace {
 GrainCloud::GrainCloud(size_t n)
     : pool_(n)
 {
+    grains_.reserve(n);
 }
 
 void GrainCloud::clear()
@@ -17,25 +17,165 @@
 #include "ceammc_factory.h"
 #include "ceammc_sound.h"
 
-#include "FFTConvolver.h"
+#include "TwoStageFFTConvolver.h"
 #include "ceammc_soxr_resampler.h"
 #include "fmt/core.h"
 
+#include "atomicops.h"
+
+#include <atomic>
+#include <thread>
+
 constexpr size_t MIN_IR_SIZE = 0;
 constexpr size_t DEF_IR_SIZE = 50000;
 constexpr size_t MAX_IR_SIZE = 300000;
-constexpr size_t CONV_BLOCKSIZE = 1024;
+// head partitions: processed in audio thread
+constexpr size_t CONV_HEAD_BLOCKSIZE = 256;
+// tail partitions: processed in the worker thread
+constexpr size_t CONV_TAIL_BLOCKSIZE = 8192;
+constexpr int MIN_NCH = 1;
+constexpr int MAX_NCH = 4;
 
 static_assert(MIN_IR_SIZE <= DEF_IR_SIZE, "");
 static_assert(DEF_IR_SIZE <= MAX_IR_SIZE, "");
+static_assert(CONV_HEAD_BLOCKSIZE < CONV_TAIL_BLOCKSIZE, "");
 
 static_assert(std::is_same<float, fftconvolver::Sample>::value, "");
 
+/**
+ * Thread running the tail convolutions of all object convolvers.
+ * Sleeps until the audio thread signals that some tail block is ready.
+ */
+class ConvolveWorker {
+    std::vector<ThreadedConvolver*> jobs_;
+    moodycamel::spsc_sema::LightweightSemaphore sema_;
+    std::atomic_bool quit_ { false };
+    std::thread thread_;
+
+public:
+    ~ConvolveWorker()
+    {
+        if (thread_.joinable()) {
+            quit_ = true;
+            sema_.signal();
+            thread_.join();
+        }
+    }
+
+    void start(const std::vector<ConvImpl>& conv)
+    {
+        for (auto& c : conv)
+            jobs_.push_back(c.get());
+
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    /**
+     * @note called from the audio thread: does not block, the OS semaphore
+     * is posted only when the worker is sleeping
+     */
+    void notify() { sema_.signal(); }
+
+private:
+    void run();
+};
+
+/**
+ * Two stage convolver with the tail convolution running in the worker thread.
+ * The tail result of the previous tail block is required when the next tail block is full:
+ * if the worker has not started the job by this moment, it is done in the audio thread,
+ * so the output is never late, the number of such cases is counted.
+ */
+class ThreadedConvolver : public fftconvolver::TwoStageFFTConvolver {
+    enum State {
+        IDLE,
+        PENDING,
+        BUSY
+    };
+
+    ConvolveWorker& worker_;
+    std::atomic<int> state_ { IDLE };
+    std::atomic<size_t> late_ { 0 };
+
+public:
+    explicit ThreadedConvolver(ConvolveWorker& worker)
+        : worker_(worker)
+    {
+    }
+
+    bool init(const float* ir, size_t len)
+    {
+        waitForBackgroundProcessing();
+        return TwoStageFFTConvolver::init(CONV_HEAD_BLOCKSIZE, CONV_TAIL_BLOCKSIZE, ir, len);
+    }
+
+    void reset()
+    {
+        waitForBackgroundProcessing();
+        TwoStageFFTConvolver::reset();
+    }
+
+    size_t lateCount() const { return late_; }
+
+    /**
+     * Runs the pending tail job
+     * @note called from the worker thread
+     */
+    void runPending()
+    {
+        int expected = PENDING;
+        if (state_.compare_exchange_strong(expected, BUSY, std::memory_order_acq_rel)) {
+            doBackgroundProcessing();
+            state_.store(IDLE, std::memory_order_release);
+        }
+    }
+
+protected:
+    void startBackgroundProcessing() final
+    {
+        state_.store(PENDING, std::memory_order_release);
+        worker_.notify();
+    }
+
+    void waitForBackgroundProcessing() final
+    {
+        int expected = PENDING;
+        if (state_.compare_exchange_strong(expected, BUSY, std::memory_order_acq_rel)) {
+            // the worker was not in time: do the job here
+            late_++;
+            doBackgroundProcessing();
+            state_.store(IDLE, std::memory_order_release);
+            return;
+        }
+
+        while (state_.load(std::memory_order_acquire) != IDLE)
+            std::this_thread::yield();
+    }
+};
+
+void ConvolveWorker::run()
+{
+    while (true) {
+        sema_.wait();
+
+        if (quit_)
+            break;
+
+        for (auto c : jobs_)
+            c->runPending();
+    }
+}
+
 BaseConvolveTilde::BaseConvolveTilde(const PdArgs& args)
     : SoundExternal(args)
-    , conv_(new fftconvolver::FFTConvolver())
 {
-    createSignalOutlet();
+    nin_ = new IntProperty("@in", MIN_NCH, PropValueAccess::INITONLY);
+    nin_->checkClosedRange(MIN_NCH, MAX_NCH);
+    addProperty(nin_);
+
+    nch_ = new IntProperty("@ch", MIN_NCH, PropValueAccess::INITONLY);
+    nch_->checkClosedRange(MIN_NCH, MAX_NCH);
+    addProperty(nch_);
 
     max_size_ = new IntProperty("@maxsize", DEF_IR_SIZE);
     max_size_->checkClosedRange(MIN_IR_SIZE, MAX_IR_SIZE);
@@ -52,52 +192,77 @@ BaseConvolveTilde::BaseConvolveTilde(const PdArgs& args)
     addProperty(offset_);
 }
 
+void BaseConvolveTilde::initDone()
+{
+    const size_t NIN = nin_->value();
+    const size_t NOUT = nch_->value();
+
+    for (size_t i = 1; i < NIN; i++)
+        createSignalInlet();
+
+    for (size_t i = 0; i < NOUT; i++)
+        createSignalOutlet();
+
+    worker_.reset(new ConvolveWorker());
+    for (size_t i = 0; i < NIN * NOUT; i++)
+        conv_.emplace_back(new ThreadedConvolver(*worker_));
+
+    worker_->start(conv_);
+}
+
 void BaseConvolveTilde::setupDSP(t_signal** sig)
 {
     SoundExternal::setupDSP(sig);
 
     if (load_state_ == LOAD_OK) {
-        conv_->reset();
-        const auto offset = std::min<size_t>(offset_->value(), ir_data_.size());
-        const auto size = ir_data_.size() - offset;
-        bool rc = conv_->init(CONV_BLOCKSIZE, ir_data_.data() + offset, size);
-        if (!rc) {
-            OBJ_ERR << "can't init FFTConvolver";
-            load_state_ = NOT_LOADED;
-        } else
-            OBJ_DBG << fmt::format("IR data size: {}, offset: {}", size, offset);
+        for (size_t i = 0; i < routes_.size(); i++) {
+            auto& conv = conv_[i];
+            auto& ir = ir_data_[routes_[i].ir];
+
+            conv->reset();
+            const auto offset = std::min<size_t>(offset_->value(), ir.size());
+            const auto size = ir.size() - offset;
+            bool rc = conv->init(ir.data() + offset, size);
+            if (!rc) {
+                OBJ_ERR << "can't init FFTConvolver";
+                load_state_ = NOT_LOADED;
+                break;
+            } else
+                OBJ_DBG << fmt::format("IR[{}] data size: {}, offset: {}", routes_[i].ir, size, offset);
+        }
     }
 
-#ifdef USE_FLOAT_BUFFERS
-    in_buf64_.resize(blockSize());
-    out_buf64_.resize(blockSize());
-#endif
+    in_buf_.resize(blockSize() * nin_->value());
+    out_buf_.resize(blockSize());
 }
 
 void BaseConvolveTilde::processBlock(const t_sample** in, t_sample** out)
 {
-    if (load_state_ != LOAD_OK) {
-        for (size_t i = 0; i < blockSize(); i++)
-            out[0][i] = 0;
+    const auto BS = blockSize();
+    const size_t NIN = nin_->value();
+    const size_t NOUT = nch_->value();
 
-        return;
+    for (size_t k = 0; k < NOUT; k++) {
+        for (size_t i = 0; i < BS; i++)
+            out[k][i] = 0;
     }
 
-#ifdef USE_FLOAT_BUFFERS
-    const auto BS = blockSize();
+    if (load_state_ != LOAD_OK)
+        return;
 
     // copy to input buffer
-    for (size_t i = 0; i < BS; i++)
-        in_buf64_[i] = in[0][i];
+    for (size_t j = 0; j < NIN; j++) {
+        for (size_t i = 0; i < BS; i++)
+            in_buf_[j * BS + i] = in[j][i];
+    }
 
-    conv_->process(in_buf64_.data(), out_buf64_.data(), blockSize());
+    for (size_t r = 0; r < routes_.size(); r++) {
+        auto& route = routes_[r];
+        conv_[r]->process(in_buf_.data() + route.in * BS, out_buf_.data(), BS);
 
-    // copy from output buffer
-    for (size_t i = 0; i < BS; i++)
-        out[0][i] = out_buf64_[i];
-#else
-    conv_->process(&in[0][0], &out[0][0], blockSize());
-#endif
+        for (size_t i = 0; i < BS; i++)
+            out[route.out][i] += out_buf_[i];
+    }
 }
 
 void BaseConvolveTilde::m_load_file(t_symbol* s, const AtomListView& lv)
@@ -143,12 +308,14 @@ void BaseConvolveTilde::m_set(t_symbol* s, const AtomListView& lv)
 
     dsp::SuspendGuard dsp;
 
-    ir_data_.clear();
-    ir_data_.resize(N);
+    ir_data_.assign(1, {});
+    auto& ir = ir_data_[0];
+    ir.resize(N);
 
     for (size_t i = 0; i < N; i++)
-        ir_data_[i] = lv[i].asFloat();
+        ir[i] = lv[i].asFloat();
 
+    updateRoutes();
     load_state_ = LOAD_OK;
 
     if (norm_->value())
@@ -158,6 +325,12 @@ void BaseConvolveTilde::m_set(t_symbol* s, const AtomListView& lv)
 void BaseConvolveTilde::dump() const
 {
     SoundExternal::dump();
+
+    for (size_t i = 0; i < routes_.size(); i++) {
+        auto& r = routes_[i];
+        OBJ_POST << fmt::format("in[{}] -> IR[{}] -> out[{}], IR size: {}, late tail blocks: {}",
+            r.in, r.ir, r.out, ir_data_[r.ir].size(), conv_[i]->lateCount());
+    }
 }
 
 bool BaseConvolveTilde::loadIRFromArray(const char* name)
@@ -174,11 +347,14 @@ bool BaseConvolveTilde::loadIRFromArray(const char* name)
         return false;
     }
 
-    ir_data_.reserve(N);
-    ir_data_.clear();
+    ir_data_.assign(1, {});
+    auto& ir = ir_data_[0];
+    ir.reserve(N);
 
     for (auto it = src.begin(); it != src.begin() + N; ++it)
-        ir_data_.push_back(*it);
+        ir.push_back(*it);
+
+    updateRoutes();
 
     OBJ_DBG << fmt::format("{} IR samples loaded from array '{}'", N, name);
     return true;
@@ -197,9 +373,12 @@ bool BaseConvolveTilde::loadIRFromFile(const char* path)
         OBJ_DBG << fmt::format("resampling from {} to {} ({})", sf->sampleRate(), samplerate(), rr);
     }
 
+    // up to the IR per input/output pair
     const auto NCH = sf->channels();
-    if (NCH != 1) {
-        OBJ_DBG << fmt::format("warning: number of channels={}, using first channel for IR data", NCH);
+    const auto MAX_IR_CH = conv_.size();
+    const auto NLOAD = std::min<size_t>(NCH, MAX_IR_CH);
+    if (NCH > MAX_IR_CH) {
+        OBJ_DBG << fmt::format("warning: number of channels={}, using {} channel(s) for IR data", NCH, NLOAD);
     }
 
     auto N = std::min<size_t>(max_size_->value(), sf->frameCount() * rr);
@@ -216,9 +395,11 @@ bool BaseConvolveTilde::loadIRFromFile(const char* path)
     SoxrResampler resampler(sf->sampleRate(), samplerate(), NCH, SoxrResampler::QUICK, sox_opts);
 
     std::int64_t ntotal = 0;
-    if (!resampler.setOutputCallback([this, N, &ntotal](const float* const* data, size_t rframes, bool done) -> bool {
-            for (size_t i = 0; i < rframes && ntotal < N; i++, ntotal++)
-                ir_data_.push_back(data[0][i]);
+    if (!resampler.setOutputCallback([this, N, NLOAD, &ntotal](const float* const* data, size_t rframes, bool done) -> bool {
+            for (size_t i = 0; i < rframes && ntotal < N; i++, ntotal++) {
+                for (size_t ch = 0; ch < NLOAD; ch++)
+                    ir_data_[ch].push_back(data[ch][i]);
+            }
 
             return ntotal < N;
         })) {
@@ -230,38 +411,71 @@ bool BaseConvolveTilde::loadIRFromFile(const char* path)
     const size_t IR_BUF_FRAMES = IR_BUF_SIZE / NCH;
     float ir_buf[IR_BUF_SIZE];
 
-    ir_data_.clear();
-    ir_data_.reserve(N);
+    ir_data_.assign(NLOAD, {});
+    for (auto& ir : ir_data_)
+        ir.reserve(N);
+
     std::int64_t nfread = 0;
     std::int64_t fpos = 0;
     while ((nfread = sf->readFrames(ir_buf, IR_BUF_FRAMES, fpos)) > 0) {
         fpos += nfread;
         auto rc = resampler.process(ir_buf, nfread);
 
-        if (rc != SoxrResampler::ResultCode::Ok) {
-            resampler.processDone();
+        if (rc != SoxrResampler::ResultCode::Ok)
             break;
-        }
     }
 
-    OBJ_DBG << fmt::format("{} IR samples total: {}, loaded from file '{}'", size_t(sf->frameCount() * rr), ir_data_.size(), path);
+    // flush: a short IR can be left in the resampler buffer
+    resampler.processDone();
+
+    updateRoutes();
+
+    OBJ_DBG << fmt::format("{} IR samples total: {}, loaded from file '{}'", size_t(sf->frameCount() * rr), ir_data_[0].size(), path);
     return true;
 }
 
 void BaseConvolveTilde::normalizeIR()
 {
-    auto it = std::max_element(ir_data_.begin(), ir_data_.end(), [](float a, float b) { return std::abs(a) < std::abs(b); });
-    if (it == ir_data_.end())
+    // same gain for all channels: keep the balance between them
+    float max = 0;
+    for (auto& ir : ir_data_) {
+        for (auto x : ir)
+            max = std::max(max, std::abs(x));
+    }
+
+    if (max != 0) {
+        auto k = 1.f / max;
+        for (auto& ir : ir_data_) {
+            for (auto& x : ir)
+                x *= k;
+        }
+    }
+}
+
+void BaseConvolveTilde::updateRoutes()
+{
+    const size_t NIN = nin_->value();
+    const size_t NOUT = nch_->value();
+    const size_t NIR = ir_data_.size();
+
+    routes_.clear();
+    if (NIR == 0)
         return;
 
-    if (*it != 0) {
-        auto k = 1.f / *it;
-        for (auto& x : ir_data_)
-            x *= k;
+    if (NIN > 1 && NIR == NIN * NOUT) {
+        // IR matrix, ordered by inputs: in[0]->out[0], in[0]->out[1], ..., in[1]->out[0], ...
+        for (size_t j = 0; j < NIN; j++) {
+            for (size_t k = 0; k < NOUT; k++)
+                routes_.push_back({ j, k, j * NOUT + k });
+        }
+    } else {
+        // output per input, not loaded IR channels repeat the loaded ones
+        for (size_t k = 0; k < NOUT; k++)
+            routes_.push_back({ k % NIN, k, k % NIR });
     }
 }
 
-// for forwarding declaration of FFTConvolver
+// for forwarding declaration of ThreadedConvolver
 BaseConvolveTilde::~BaseConvolveTilde() = default;
 
 void setup_base_convolve_tilde()
@@ -15,19 +15,16 @@
 #define BASE_CONVOLVE_TILDE_H
 
 #include <memory>
+#include <vector>
 
 #include "ceammc_sound_external.h"
 using namespace ceammc;
 
-namespace fftconvolver {
-class FFTConvolver;
-}
+class ThreadedConvolver;
+class ConvolveWorker;
 
-#if PD_FLOATSIZE != 32
-#define USE_FLOAT_BUFFERS
-#endif
-
-using ConvImpl = std::unique_ptr<fftconvolver::FFTConvolver>;
+using ConvImpl = std::unique_ptr<ThreadedConvolver>;
+using IRData = std::vector<float>;
 
 class BaseConvolveTilde : public SoundExternal {
     enum SourceType {
@@ -41,22 +38,34 @@ class BaseConvolveTilde : public SoundExternal {
         LOAD_OK
     };
 
+    struct ConvRoute {
+        size_t in, out, ir;
+    };
+
 private:
-    ConvImpl conv_;
+    // convolver per route, @in x @ch at most
+    std::vector<ConvImpl> conv_;
+    // tail convolution thread, should be destroyed before the convolvers
+    std::unique_ptr<ConvolveWorker> worker_;
+    std::vector<ConvRoute> routes_;
     IntProperty* max_size_ { nullptr };
     IntProperty* offset_ { nullptr };
+    IntProperty* nin_ { nullptr };
+    IntProperty* nch_ { nullptr };
     BoolProperty* norm_ { nullptr };
-    std::vector<float> ir_data_;
+    // loaded IR channels
+    std::vector<IRData> ir_data_;
     LoadState load_state_ { NOT_LOADED };
 
-#ifdef USE_FLOAT_BUFFERS
-    std::vector<float> in_buf64_, out_buf64_;
-#endif
+    // inputs are copied: outputs can share memory with the inputs
+    std::vector<float> in_buf_;
+    std::vector<float> out_buf_;
 
 public:
     BaseConvolveTilde(const PdArgs& args);
     ~BaseConvolveTilde();
 
+    void initDone() final;
     void setupDSP(t_signal** sig) final;
     void processBlock(const t_sample** in, t_sample** out) final;
 
@@ -70,6 +79,7 @@ private:
     bool loadIRFromArray(const char* name);
     bool loadIRFromFile(const char* path);
     void normalizeIR();
+    void updateRoutes();
 };
 
 void setup_base_convolve_tilde();
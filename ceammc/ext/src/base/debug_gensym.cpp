@@ -11,8 +11,8 @@ namespace pd {
 
 void gensym_info(t_ceammc_gensym_info* info)
 {
-    t_symbol** table = pd_ceammc_gensym_hash_table();
-    const size_t sz = pd_ceammc_gensym_hash_table_size();
+    size_t sz = 0;
+    t_symbol** table = pd_ceammc_gensym_hash_table(&sz);
 
     info->table_size = sz;
     info->max_chain = 0;
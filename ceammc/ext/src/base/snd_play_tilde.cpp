@@ -11,8 +11,10 @@
  * contact the author of this file, or the owner of the project in which
  * this file belongs to.
  *****************************************************************************/
+#include <algorithm>
 #include <cassert>
-#include <thread>
+#include <mutex>
+#include <vector>
 
 #include "args/argcheck.h"
 #include "ceammc_convert.h"
@@ -20,6 +22,7 @@
 #include "ceammc_factory.h"
 #include "ceammc_pd.h"
 #include "ceammc_sound.h"
+#include "ceammc_sound_stream.h"
 #include "ceammc_soxr_resampler.h"
 #include "ceammc_units.h"
 #include "snd_play_tilde.h"
@@ -39,8 +42,6 @@ CEAMMC_DEFINE_SYM_HASH(defer)
 #define THREAD_DBG(...) logger_.debug(fmt::format(__VA_ARGS__))
 #endif
 
-#define SLEEP_SAMPLES(nsamp) std::this_thread::sleep_for(nsamp* SAMPLE_USEC);
-
 using namespace RubberBand;
 
 enum {
@@ -62,17 +63,505 @@ void eventLoop(SubscriberId id)
 
 }
 
+/**
+ * Disk stream of single snd.play~ object: decoded and resampled by the shared StreamPool
+ * workers to the block ring buffer, that is read by the DSP thread.
+ * The file head (from the @begin position, that is also the loop point) is taken
+ * from the SoundHeadCache, so start and loop do not wait for the disk.
+ */
+class SndPlayStream : public sound::StreamTask {
+public:
+    struct Params {
+        std::string path;
+        units::TimeValue begin { 0 }, end { 0 };
+        size_t samplerate { 0 };
+        bool stretch { false };
+    };
+
+    struct PreloadParams {
+        std::string path;
+        units::TimeValue pos { 0 };
+        size_t samplerate { 0 };
+    };
+
+private:
+    enum Command {
+        CMD_NONE = 0,
+        CMD_START,
+        CMD_STOP,
+    };
+
+    static constexpr size_t RING_FRAMES = 8192;
+    static constexpr size_t CHUNK_FRAMES = 1024;
+    static constexpr size_t RBS_BUF_SIZE = 512;
+
+    const SubscriberId id_;
+    ThreadPdLogger& logger_;
+    const std::atomic<float>& speed_;
+    const std::atomic<float>& pitch_;
+    const std::atomic_bool& loop_;
+    const size_t out_ch_;
+
+    // caller -> worker
+    std::mutex cmd_mtx_;
+    std::atomic_int cmd_ { CMD_NONE };
+    Params cmd_params_;
+    std::vector<PreloadParams> preload_;
+    std::atomic_bool has_preload_ { false };
+    std::atomic<std::int64_t> seek_pos_ { -1 };
+
+    // worker -> dsp
+    sound::FrameRing ring_;
+    std::atomic_size_t drop_pos_ { 0 };
+
+    // worker -> caller
+    std::atomic_bool playing_ { false };
+    std::atomic<std::int64_t> cur_pos_ { 0 }, begin_ { 0 }, end_ { 0 };
+    std::atomic<float> src_samplerate_ { 0 };
+
+    // worker only
+    sound::SoundFilePtr file_;
+    std::string path_;
+    sound::SoundHeadPtr head_, seek_head_;
+    std::int64_t file_pos_ { 0 }, file_begin_ { 0 }, file_end_ { 0 };
+    bool stretch_ { false };
+    double resample_ratio_ { 1 };
+    std::unique_ptr<SoxrResampler> resampler_;
+    std::unique_ptr<RubberBandStretcher> rbs_;
+    std::vector<float> in_buf_, out_buf_, spill_;
+    size_t spill_pos_ { 0 };
+    // RubberBandStretch uses split channel buffer layout
+    std::vector<std::vector<float>> rbs_chan_buf_;
+    std::vector<float*> rbs_buf_;
+
+public:
+    SndPlayStream(SubscriberId id, ThreadPdLogger& logger, size_t nch,
+        const std::atomic<float>& speed, const std::atomic<float>& pitch, const std::atomic_bool& loop)
+        : id_(id)
+        , logger_(logger)
+        , speed_(speed)
+        , pitch_(pitch)
+        , loop_(loop)
+        , out_ch_(nch)
+        , ring_(nch, RING_FRAMES)
+    {
+        sound::StreamPool::instance().add(this);
+    }
+
+    ~SndPlayStream()
+    {
+        sound::StreamPool::instance().remove(this);
+
+        if (file_)
+            file_->close();
+    }
+
+    /* caller thread */
+
+    void start(const Params& params)
+    {
+        {
+            std::lock_guard<std::mutex> lock(cmd_mtx_);
+            cmd_params_ = params;
+            cmd_ = CMD_START;
+        }
+
+        playing_ = true;
+        sound::StreamPool::instance().notify();
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(cmd_mtx_);
+            cmd_ = CMD_STOP;
+        }
+
+        sound::StreamPool::instance().notify();
+    }
+
+    void preload(const PreloadParams& params)
+    {
+        {
+            std::lock_guard<std::mutex> lock(cmd_mtx_);
+            preload_.push_back(params);
+            has_preload_ = true;
+        }
+
+        sound::StreamPool::instance().notify();
+    }
+
+    void seek(std::int64_t pos)
+    {
+        seek_pos_ = clip<std::int64_t>(pos, begin_, end_);
+        sound::StreamPool::instance().notify();
+    }
+
+    bool isPlaying() const { return playing_; }
+    std::int64_t position() const { return cur_pos_; }
+    std::int64_t begin() const { return begin_; }
+    float sampleRate() const { return src_samplerate_; }
+
+    /* dsp thread */
+
+    size_t read(t_sample** out, size_t nout, size_t n)
+    {
+        const auto avail = ring_.writeAvailable();
+        ring_.dropUntil(drop_pos_.load(std::memory_order_acquire));
+        const auto nread = ring_.read(out, nout, n);
+
+        // the worker is waiting for a room for the next chunk
+        if (avail < CHUNK_FRAMES && ring_.writeAvailable() >= CHUNK_FRAMES)
+            sound::StreamPool::instance().wakeup();
+
+        return nread;
+    }
+
+    /* worker thread */
+
+    bool process() final
+    {
+        bool work = processCommands();
+
+        if (!file_ || speed_ == 0)
+            return work;
+
+        auto seek_pos = seek_pos_.exchange(-1);
+        if (seek_pos >= 0) {
+            seekTo(seek_pos);
+            work = true;
+        }
+
+        if (spill_.size() > 0)
+            return flushSpill() || work;
+
+        if (ring_.writeAvailable() < CHUNK_FRAMES)
+            return work;
+
+        decodeChunk();
+        return true;
+    }
+
+private:
+    bool processCommands()
+    {
+        bool work = false;
+
+        if (has_preload_) {
+            std::vector<PreloadParams> items;
+            {
+                std::lock_guard<std::mutex> lock(cmd_mtx_);
+                items.swap(preload_);
+                has_preload_ = false;
+            }
+
+            for (auto& it : items)
+                preloadHead(it);
+
+            work = true;
+        }
+
+        if (cmd_ != CMD_NONE) {
+            int cmd = CMD_NONE;
+            Params params;
+            {
+                std::lock_guard<std::mutex> lock(cmd_mtx_);
+                cmd = cmd_.exchange(CMD_NONE);
+                if (cmd == CMD_START)
+                    params = cmd_params_;
+            }
+
+            switch (cmd) {
+            case CMD_START:
+                startPlayback(params);
+                break;
+            case CMD_STOP:
+                if (file_) {
+                    closeFile();
+                    dropBuffered();
+                    eventDone(id_);
+                }
+
+                playing_ = false;
+                break;
+            default:
+                break;
+            }
+
+            work = true;
+        }
+
+        return work;
+    }
+
+    void preloadHead(const PreloadParams& p)
+    {
+        auto f = (file_ && p.path == path_) ? file_ : sound::SoundFileFactory::openRead(p.path.c_str());
+        if (!f) {
+            THREAD_ERR("can't read soundfile '{}'", p.path);
+            return;
+        }
+
+        std::int64_t offset = 0;
+        if (!SndPlayTilde::calcBegin(p.pos, p.samplerate, f->frameCount(), offset)) {
+            THREAD_ERR("invalid preload position: {}, expected value in [{} ... {}) range",
+                offset, 0, f->frameCount());
+        } else if (sound::SoundHeadCache::instance().load(*f, p.path, offset)) {
+            THREAD_DBG("preloaded '{}' from {} samp", p.path, offset);
+        }
+
+        if (f != file_)
+            f->close();
+    }
+
+    void startPlayback(const Params& p)
+    {
+        if (file_) { // restart
+            closeFile();
+            eventDone(id_);
+        }
+
+        dropBuffered();
+
+        auto f = sound::SoundFileFactory::openRead(p.path.c_str());
+        if (!f) {
+            THREAD_ERR("can't read soundfile '{}'", p.path);
+            playing_ = false;
+            return;
+        }
+
+        f->setLogFunction([this](LogLevel lv, const char* msg) {
+            switch (lv) {
+            case LOG_ERROR:
+                return logger_.error(msg);
+            case LOG_DEBUG:
+                return logger_.debug(msg);
+            case LOG_POST:
+                return logger_.post(msg);
+            case LOG_ALL:
+                return logger_.verbose(msg);
+            default:
+                break;
+            }
+        });
+
+        const auto sr = p.samplerate;
+        THREAD_DBG("play SR={}, file SR={}, CH={}", sr, f->sampleRate(), f->channels());
+
+        std::int64_t begin = 0;
+        if (!SndPlayTilde::calcBegin(p.begin, sr, f->frameCount(), begin)) {
+            THREAD_ERR("invalid begin position: {}, expected value in [{} ... {}) range",
+                begin, 0, f->frameCount());
+            playing_ = false;
+            return;
+        }
+
+        std::int64_t end = 0;
+        if (!SndPlayTilde::calcEnd(p.end, sr, f->frameCount(), begin, end)) {
+            THREAD_ERR("invalid end position: {}, expected value in [{} ... {}] range",
+                end, begin, f->frameCount());
+            playing_ = false;
+            return;
+        }
+
+        const auto FILE_NCH = f->channels();
+        stretch_ = p.stretch;
+
+        try {
+            SoxrResamplerOptions sox_opts {
+                !stretch_, // variable rate used without stretching
+                SoxrResamplerFormat::FLOAT_I,
+                SoxrResamplerFormat::FLOAT_S,
+            };
+            resampler_.reset(new SoxrResampler(f->sampleRate(), sr, FILE_NCH, SoxrResampler::QUICK, sox_opts));
+        } catch (std::exception& e) {
+            THREAD_ERR("can't create resampler: {}", e.what());
+            playing_ = false;
+            return;
+        }
+
+        resample_ratio_ = f->sampleRate() / double(sr);
+
+        bool cb_ok = false;
+        if (stretch_) {
+            rbs_.reset(new RubberBandStretcher(sr, FILE_NCH, RubberBandStretcher::DefaultOptions | RubberBandStretcher::OptionProcessRealTime));
+            rbs_chan_buf_.assign(FILE_NCH, std::vector<float>(RBS_BUF_SIZE));
+            rbs_buf_.resize(FILE_NCH);
+            for (size_t i = 0; i < FILE_NCH; i++)
+                rbs_buf_[i] = rbs_chan_buf_[i].data();
+
+            cb_ok = resampler_->setOutputCallback(
+                [this, FILE_NCH](const float* const* data, size_t rframes, bool) -> bool {
+                    rbs_->setPitchScale(pitch_);
+                    if (speed_ != 0)
+                        rbs_->setTimeRatio(1 / speed_);
+
+                    rbs_->process(data, rframes, false);
+
+                    while (rbs_->available() > 0) {
+                        auto n = rbs_->retrieve(rbs_buf_.data(), RBS_BUF_SIZE);
+                        writeFrames(rbs_buf_.data(), n, FILE_NCH);
+                    }
+
+                    return true;
+                });
+        } else { // no stretching
+            rbs_.reset();
+            cb_ok = resampler_->setOutputCallback(
+                [this, FILE_NCH](const float* const* data, size_t rframes, bool) -> bool {
+                    writeFrames(data, rframes, FILE_NCH);
+                    return true;
+                });
+        }
+
+        if (!cb_ok) {
+            THREAD_ERR("can't set resampler callback");
+            playing_ = false;
+            return;
+        }
+
+        // the head from the begin position: used on start and every loop
+        auto& cache = sound::SoundHeadCache::instance();
+        head_ = cache.load(*f, p.path, begin);
+        seek_head_.reset();
+
+        in_buf_.resize(CHUNK_FRAMES * FILE_NCH);
+        file_ = f;
+        path_ = p.path;
+        file_begin_ = begin;
+        file_end_ = end;
+        file_pos_ = begin;
+
+        // store file info
+        src_samplerate_ = f->sampleRate();
+        begin_ = begin;
+        end_ = end;
+        cur_pos_ = begin;
+        playing_ = true;
+
+        THREAD_DBG("start playing from {} to {} samp, loop={}, samples={}",
+            file_begin_, file_end_, (bool)loop_, f->frameCount());
+    }
+
+    void decodeChunk()
+    {
+        const auto nframes = std::min<std::int64_t>(CHUNK_FRAMES, file_end_ - file_pos_);
+
+        std::int64_t nread = 0;
+        if (nframes > 0) {
+            if (head_)
+                nread = head_->readFrames(in_buf_.data(), nframes, file_pos_);
+
+            if (nread == 0 && seek_head_)
+                nread = seek_head_->readFrames(in_buf_.data(), nframes, file_pos_);
+
+            if (nread == 0)
+                nread = file_->readFrames(in_buf_.data(), nframes, file_pos_);
+        }
+
+        if (nread < 0) { // read error
+            THREAD_ERR("'{}': read error", path_);
+            closeFile();
+            playing_ = false;
+            eventDone(id_);
+        } else if (nread == 0) { // eof or @end reached
+            resampler_->processDone();
+            resampler_->reset();
+
+            if (!loop_) {
+                closeFile();
+                playing_ = false;
+                eventDone(id_);
+                return;
+            }
+
+            // start new loop
+            file_pos_ = file_begin_;
+            cur_pos_ = file_pos_;
+            eventLoop(id_);
+        } else {
+            if (!stretch_ && !resampler_->setResampleRatio(speed_ * resample_ratio_))
+                THREAD_ERR("can't set resampler ratio");
+
+            resampler_->process(in_buf_.data(), nread);
+            file_pos_ += nread;
+            cur_pos_ = file_pos_;
+        }
+    }
+
+    void seekTo(std::int64_t pos)
+    {
+        file_pos_ = clip<std::int64_t>(pos, file_begin_, file_end_);
+        cur_pos_ = file_pos_;
+
+        // use preloaded fragment if any
+        seek_head_ = sound::SoundHeadCache::instance().find(path_, file_pos_, *file_);
+
+        resampler_->reset();
+        if (rbs_)
+            rbs_->reset();
+
+        dropBuffered();
+    }
+
+    // writes split channel frames to the ring, frames that do not fit are kept in the spill buffer
+    void writeFrames(const float* const* data, size_t n, size_t nch)
+    {
+        out_buf_.resize(n * out_ch_);
+        for (size_t i = 0; i < n; i++) {
+            for (size_t c = 0; c < out_ch_; c++)
+                out_buf_[i * out_ch_ + c] = (c < nch) ? data[c][i] : 0;
+        }
+
+        const size_t nw = spill_.empty() ? ring_.write(out_buf_.data(), n) : 0;
+        if (nw < n)
+            spill_.insert(spill_.end(), out_buf_.begin() + nw * out_ch_, out_buf_.end());
+    }
+
+    bool flushSpill()
+    {
+        const auto total = spill_.size() / out_ch_;
+        const auto n = ring_.write(spill_.data() + spill_pos_ * out_ch_, total - spill_pos_);
+        spill_pos_ += n;
+
+        if (spill_pos_ == total) {
+            spill_.clear();
+            spill_pos_ = 0;
+        }
+
+        return n > 0;
+    }
+
+    void dropBuffered()
+    {
+        spill_.clear();
+        spill_pos_ = 0;
+        drop_pos_.store(ring_.writePosition(), std::memory_order_release);
+    }
+
+    void closeFile()
+    {
+        if (file_)
+            file_->close();
+
+        file_.reset();
+        head_.reset();
+        seek_head_.reset();
+        resampler_.reset();
+        rbs_.reset();
+    }
+};
+
+constexpr size_t SndPlayStream::RING_FRAMES;
+constexpr size_t SndPlayStream::CHUNK_FRAMES;
+constexpr size_t SndPlayStream::RBS_BUF_SIZE;
+
 SndPlayTilde::SndPlayTilde(const PdArgs& args)
-    : SndPlayBase(args)
+    : DispatchedObject<SoundExternal>(args)
+    , logger_(this)
     , time_begin_(0)
     , time_end_(POS_END)
-    , clock_play_([this] {
-        if (isRunning()) {
-            setQuit(true);
-            clock_play_.delay(0);
-        } else
-            runTask();
-    })
+    , clock_play_([this] { runStream(); })
 {
     n_ = new IntProperty("@n", 2, PropValueAccess::INITONLY);
     n_->checkClosedRange(1, 32);
@@ -146,12 +635,16 @@ SndPlayTilde::SndPlayTilde(const PdArgs& args)
     end->addUnit(PropValueUnits::SMPTE);
 }
 
+SndPlayTilde::~SndPlayTilde() = default;
+
 void SndPlayTilde::initDone()
 {
     for (int i = 0; i < n_->value(); i++)
         createSignalOutlet();
 
     createOutlet();
+
+    stream_.reset(new SndPlayStream(subscriberId(), logger_, n_->value(), atomic_speed_, atomic_pitch_, atomic_loop_));
 }
 
 void SndPlayTilde::onFloat(t_float f)
@@ -166,18 +659,14 @@ void SndPlayTilde::onSymbol(t_symbol* s)
 
 void SndPlayTilde::processBlock(const t_sample** in, t_sample** out)
 {
-    const auto NCH = n_->value();
-    const auto BS = blockSize();
+    const size_t NCH = n_->value();
+    const size_t BS = blockSize();
 
-    for (size_t i = 0; i < BS; i++) {
-        for (size_t k = 0; k < NCH; k++) {
-            t_sample x = 0;
-            if (outPipe().read_available())
-                outPipe().pop(x);
+    // keep buffered frames on pause
+    const size_t n = (atomic_speed_ != 0) ? stream_->read(out, NCH, BS) : 0;
 
-            out[k][i] = x;
-        }
-    }
+    for (size_t k = 0; k < NCH; k++)
+        std::fill(out[k] + n, out[k] + BS, 0);
 }
 
 void SndPlayTilde::m_start(t_symbol* s, const AtomListView& lv)
@@ -209,6 +698,7 @@ void SndPlayTilde::m_pause(t_symbol* s, const AtomListView& lv)
         atomic_speed_ = 0;
     } else { // restore speed
         atomic_speed_ = speed_pause_;
+        sound::StreamPool::instance().notify();
     }
 }
 
@@ -218,19 +708,15 @@ void SndPlayTilde::m_ff(t_symbol* s, const AtomListView& lv)
     if (!chk.check(lv, this))
         return chk.usage(this, s);
 
-    if (taskState() != TASK_RUNNING)
+    if (!isRunning())
         return;
 
     using namespace units;
 
-    TimeValue x(0, TimeValue::MS, src_samplerate_);
+    TimeValue x(0, TimeValue::MS, stream_->sampleRate());
     auto res = TimeValue::parse(lv.atomAt(0, Atom(1000)));
     if (res.matchValue(x)) {
-        file_cur_pos_ += x.toSamples();
-        if (file_cur_pos_ < file_begin_)
-            file_cur_pos_ = file_begin_;
-        else if (file_cur_pos_ > file_end_)
-            file_cur_pos_ = file_end_;
+        stream_->seek(stream_->position() + x.toSamples());
     } else {
         OBJ_ERR << res.error().msg;
     }
@@ -247,19 +733,15 @@ void SndPlayTilde::m_rewind(t_symbol* s, const AtomListView& lv)
     if (!chk.check(lv, this))
         return chk.usage(this, s);
 
-    if (taskState() != TASK_RUNNING)
+    if (!isRunning())
         return;
 
     using namespace units;
 
-    TimeValue x(0, TimeValue::MS, src_samplerate_);
+    TimeValue x(0, TimeValue::MS, stream_->sampleRate());
     auto res = TimeValue::parse(lv.atomAt(0, Atom(1000)));
     if (res.matchValue(x)) {
-        file_cur_pos_ -= x.toSamples();
-        if (file_cur_pos_ < file_begin_)
-            file_cur_pos_ = file_begin_;
-        else if (file_cur_pos_ > file_end_)
-            file_cur_pos_ = file_end_;
+        stream_->seek(stream_->position() - x.toSamples());
     } else {
         OBJ_ERR << res.error().msg;
     }
@@ -271,213 +753,52 @@ void SndPlayTilde::m_seek(t_symbol* s, const AtomListView& lv)
     if (!chk.check(lv, this))
         return chk.usage(this, s);
 
-    if (taskState() != TASK_RUNNING)
+    if (!isRunning())
         return;
 
     using namespace units;
 
-    TimeValue x(0, TimeValue::MS, src_samplerate_);
+    TimeValue x(0, TimeValue::MS, stream_->sampleRate());
     auto res = TimeValue::parse(lv.atomAt(0, Atom(0.)));
     if (res.matchValue(x)) {
         auto samp = x.toSamples();
         if (samp >= 0)
-            file_cur_pos_ = samp + file_begin_;
-
-        if (file_cur_pos_ > file_end_)
-            file_cur_pos_ = file_end_;
-
+            stream_->seek(samp + stream_->begin());
     } else {
         OBJ_ERR << res.error().msg;
     }
 }
 
-SndPlayBase::Future SndPlayTilde::createTask()
+void SndPlayTilde::m_preload(t_symbol* s, const AtomListView& lv)
 {
-    std::string fname = findInStdPaths(fname_->value()->s_name);
-    if (fname.empty()) {
-        onError(fmt::format("can't find file: '{}'", fname_->value()->s_name), gensym("not_found"));
-        return {};
-    }
-
-    const int out_ch = n_->value();
-    const int sr = samplerate();
-    const int bs = blockSize();
-    const bool use_stretch = stretch_->value();
-    auto begin = time_begin_;
-    auto end = time_end_;
-
-    return std::async([this, fname, out_ch, sr, bs, begin, end, use_stretch]() mutable {
-        auto f = sound::SoundFileFactory::openRead(fname.c_str());
-        if (!f) {
-            THREAD_ERR("can't read soundfile '{}'", fname);
-            return;
-        }
+    static const args::ArgChecker chk("POS:a?");
+    if (!chk.check(lv, this))
+        return chk.usage(this, s);
 
-        f->setLogFunction([this](LogLevel lv, const char* msg) {
-            switch (lv) {
-            case LOG_ERROR:
-                return logger_.error(msg);
-            case LOG_DEBUG:
-                return logger_.debug(msg);
-            case LOG_POST:
-                return logger_.post(msg);
-            case LOG_ALL:
-                return logger_.verbose(msg);
-            default:
-                break;
-            }
-        });
+    auto path = findFile(fname_->value());
+    if (path.empty())
+        return;
 
-        THREAD_DBG("play SR={}, file SR={}, CH={}", sr, f->sampleRate(), f->channels());
+    using namespace units;
 
-        file_begin_ = 0;
-        if (!calcBegin(begin, sr, f->frameCount(), file_begin_)) {
-            THREAD_ERR("invalid begin position: {}, expected value in [{} ... {}) range",
-                file_begin_, 0, f->frameCount());
-            return;
-        }
+    SndPlayStream::PreloadParams params;
+    params.path = path;
+    params.samplerate = samplerate();
 
-        file_end_ = 0;
-        if (!calcEnd(end, sr, f->frameCount(), file_begin_, file_end_)) {
-            THREAD_ERR("invalid end position: {}, expected value in [{} ... {}] range",
-                file_end_, file_begin_, f->frameCount());
+    // file position, @begin by default
+    params.pos = time_begin_;
+    if (!lv.empty()) {
+        auto res = TimeValue::parse(lv[0]);
+        if (!res.matchValue(params.pos)) {
+            OBJ_ERR << res.error().msg;
             return;
         }
+    }
 
-        // store file info
-        src_samplerate_ = f->sampleRate();
-        src_frames_ = f->frameCount();
-
-        THREAD_DBG("start playing from {} to {} samp, loop={}, samples={}",
-            file_begin_, file_end_, (bool)atomic_loop_, f->frameCount());
-
-        const auto FILE_NCH = f->channels();
-        const auto SAMPLE_USEC = std::chrono::microseconds(1000000 / sr);
-        constexpr size_t SOXR_BUF_SIZE = 4096;
-        constexpr size_t RBS_BUF_SIZE = 512;
-
-        // alloc buffers
-        std::array<float, SOXR_BUF_SIZE> sox_buf;
-        // RubberBandStretch uses split channel buffer layout
-        std::vector<std::array<float, RBS_BUF_SIZE>> rbs_chan_buf(FILE_NCH);
-        // vector of pointers to channel
-        std::vector<float*> rbs_buf(FILE_NCH);
-        for (size_t i = 0; i < FILE_NCH; i++)
-            rbs_buf[i] = rbs_chan_buf[i].data();
-
-        file_cur_pos_ = file_begin_;
-        setQuit(false);
-
-        SoxrResamplerOptions sox_opts {
-            !use_stretch, // variable rate used without stretching
-            SoxrResamplerFormat::FLOAT_I,
-            SoxrResamplerFormat::FLOAT_S,
-        };
-        SoxrResampler resampler(f->sampleRate(), sr, FILE_NCH, SoxrResampler::QUICK, sox_opts);
-        const double RESAMPLE_RATIO = f->sampleRate() / double(sr);
-
-        RubberBandStretcher rbs(sr, FILE_NCH, RubberBandStretcher::DefaultOptions | RubberBandStretcher::OptionProcessRealTime);
-
-        if (use_stretch) {
-            if (!resampler.setOutputCallback(
-                    [this, FILE_NCH, out_ch, SAMPLE_USEC, &rbs, &rbs_buf, &rbs_chan_buf](const float* const* data, size_t rframes, bool done) -> bool {
-                        rbs.setPitchScale(atomic_pitch_);
-                        if (atomic_speed_ != 0)
-                            rbs.setTimeRatio(1 / atomic_speed_);
-
-                        rbs.process(data, rframes, false);
-
-                        while (rbs.available() > 0) {
-                            auto n = rbs.retrieve(rbs_buf.data(), RBS_BUF_SIZE);
-                            while (!quit() && atomic_speed_ == 0)
-                                SLEEP_SAMPLES(64);
-
-                            for (int i = 0; i < n; i++) {
-                                for (auto c = 0; c < out_ch; c++) {
-                                    while (!quit() && outPipe().write_available() == 0)
-                                        SLEEP_SAMPLES(1);
-
-                                    float x = (c < FILE_NCH) ? rbs_chan_buf[c][i] : 0;
-                                    outPipe().push(x);
-                                }
-                            }
-                        }
-
-                        return true;
-                    })) {
-                THREAD_ERR("can't set resampler callback");
-                return;
-            }
-        } else { // no stretching
-            if (!resampler.setOutputCallback(
-                    [this, FILE_NCH, out_ch, SAMPLE_USEC](const float* const* data, size_t rframes, bool done) -> bool {
-                        for (size_t i = 0; i < rframes; i++) {
-                            while (!quit() && atomic_speed_ == 0)
-                                SLEEP_SAMPLES(64);
-
-                            while (!quit() && outPipe().write_available() < out_ch)
-                                SLEEP_SAMPLES(out_ch);
-
-                            for (auto c = 0; c < out_ch; c++) {
-                                float x = (c < FILE_NCH) ? data[c][i] : 0;
-                                outPipe().push(x);
-                            }
-                        }
-
-                        return true;
-                    })) {
-                THREAD_ERR("can't set resampler callback");
-                return;
-            }
-        }
-
-        /* main cycle */
-        while (!quit()) {
-            // sleep on pause
-            while (atomic_speed_ == 0)
-                SLEEP_SAMPLES(bs);
-
-            // read
-            const auto buf_frames = sox_buf.size() / f->channels();
-            auto nframes = f->readFrames(sox_buf.data(), buf_frames, file_cur_pos_);
-
-            // read error
-            if (nframes < 0) {
-                THREAD_ERR("'{}': read error", fname);
-                break; // quit
-            } else if (nframes == 0) { // no samples (eof)
-                resampler.processDone();
-                resampler.reset();
-                if (!atomic_loop_)
-                    break; // quit playing
-
-                // reset read pos
-                seekToBeg();
-                eventLoop(subscriberId());
-                continue; // start new loop
-            } else /* (nframes > 0) */ {
-                while (atomic_speed_ == 0)
-                    std::this_thread::sleep_for(bs * SAMPLE_USEC);
-
-                const auto nsamp = FILE_NCH * nframes;
-                if (!use_stretch) {
-                    auto rc = resampler.setResampleRatio(atomic_speed_ * RESAMPLE_RATIO);
-
-                    if (!rc)
-                        THREAD_ERR("can't set resampler ratio");
-                }
-
-                resampler.process(sox_buf.data(), nframes);
-                file_cur_pos_ += nframes;
-            }
-        }
-
-        f->close();
-        eventDone(subscriberId());
-    });
+    stream_->preload(params);
 }
 
-void SndPlayTilde::processTask(int event)
+bool SndPlayTilde::notify(int event)
 {
     auto last_out_idx = numOutlets() - 1;
 
@@ -499,6 +820,43 @@ void SndPlayTilde::processTask(int event)
     default:
         break;
     }
+
+    return true;
+}
+
+bool SndPlayTilde::isRunning() const
+{
+    return stream_ && stream_->isPlaying();
+}
+
+std::string SndPlayTilde::findFile(t_symbol* name)
+{
+    if (name == &s_) {
+        OBJ_ERR << "empty filename";
+        return {};
+    }
+
+    std::string path = findInStdPaths(name->s_name);
+    if (path.empty())
+        onError(fmt::format("can't find file: '{}'", name->s_name), gensym("not_found"));
+
+    return path;
+}
+
+void SndPlayTilde::runStream()
+{
+    auto path = findFile(fname_->value());
+    if (path.empty())
+        return;
+
+    SndPlayStream::Params params;
+    params.path = path;
+    params.begin = time_begin_;
+    params.end = time_end_;
+    params.samplerate = samplerate();
+    params.stretch = stretch_->value();
+
+    stream_->start(params);
 }
 
 void SndPlayTilde::start(bool value)
@@ -524,11 +882,11 @@ void SndPlayTilde::start(bool value)
             }
 
         } else {
-            runTask();
+            runStream();
         }
 
     } else
-        setQuit(true);
+        stream_->stop();
 }
 
 void SndPlayTilde::onError(const std::string& msg, t_symbol* s)
@@ -554,14 +912,15 @@ bool SndPlayTilde::calcEnd(const units::TimeValue& tm, size_t sr, size_t sampleC
     auto t = tm;
     t.setSamplerate(sr);
     std::int64_t pos = t.toSamples() + t.endOffset() * sampleCount;
-    result = pos;
-    if (result == POS_END) {
+
+    // negative value (POS_END by default): play until the end of file
+    if (pos < 0 && !t.endOffset()) {
         result = sampleCount;
-        return true;
+        return begin < sampleCount;
     }
 
-    result = clip_min<std::int64_t>(pos, sampleCount);
-    return result > begin;
+    result = clip<std::int64_t>(pos, begin + 1, sampleCount);
+    return begin < sampleCount;
 }
 
 void setup_snd_play_tilde()
@@ -570,6 +929,7 @@ void setup_snd_play_tilde()
     obj.addMethod("ff", &SndPlayTilde::m_ff);
     obj.addMethod("open", &SndPlayTilde::m_open);
     obj.addMethod("pause", &SndPlayTilde::m_pause);
+    obj.addMethod("preload", &SndPlayTilde::m_preload);
     obj.addMethod("rewind", &SndPlayTilde::m_rewind);
     obj.addMethod("seek", &SndPlayTilde::m_seek);
     obj.addMethod("start", &SndPlayTilde::m_start);
@@ -15,20 +15,20 @@
 #define SND_PLAY_TILDE_H
 
 #include "ceammc_clock.h"
-#include "ceammc_pollthread_object.h"
+#include "ceammc_log.h"
+#include "ceammc_poll_dispatcher.h"
 #include "ceammc_property_enum.h"
 #include "ceammc_sound_external.h"
 #include "ceammc_units.h"
 
-#include <boost/lockfree/spsc_queue.hpp>
+#include <atomic>
+#include <memory>
 
 using namespace ceammc;
 
-using Queue = boost::lockfree::spsc_queue<float, boost::lockfree::capacity<8192>>;
+class SndPlayStream;
 
-using SndPlayBase = PollThreadTaskObject<int, Queue, SoundExternal>;
-
-class SndPlayTilde : public SndPlayBase {
+class SndPlayTilde : public DispatchedObject<SoundExternal> {
 
     enum { POS_END = -1 };
 
@@ -49,18 +49,17 @@ private:
     std::atomic_bool atomic_loop_ { false }; // set in caller thread, read in worker thread
     // begin/end
     units::TimeValue time_begin_, time_end_;
-    std::int64_t file_begin_ { 0 }, file_end_ { 0 };
     Atom begin_ { 0.f }, end_ { POS_END };
 
-    std::atomic_size_t src_frames_ { 0 }; // number of frames in current soundfile
-    std::atomic<float> src_samplerate_ { 0 }; // sample rate of current soundfile
-    std::atomic_int64_t file_cur_pos_ { 0 }; // changed both in worker and caller threads
+    // decoded by the shared stream pool, should be destroyed before the atomics above
+    std::unique_ptr<SndPlayStream> stream_;
 
     ClockLambdaFunction clock_play_;
     bool defer_play_ { false };
 
 public:
     SndPlayTilde(const PdArgs& args);
+    ~SndPlayTilde();
     void initDone() final;
 
     void onFloat(t_float f) final;
@@ -70,20 +69,22 @@ public:
     void m_ff(t_symbol*, const AtomListView& lv);
     void m_open(t_symbol*, const AtomListView& lv);
     void m_pause(t_symbol*, const AtomListView& lv);
+    void m_preload(t_symbol*, const AtomListView& lv);
     void m_rewind(t_symbol*, const AtomListView& lv);
     void m_seek(t_symbol*, const AtomListView& lv);
     void m_start(t_symbol*, const AtomListView& lv);
     void m_stop(t_symbol*, const AtomListView& lv);
 
-    Future createTask() final;
-    void processTask(int event) final;
+    bool notify(int event) final;
 
 private:
-    inline void seekToBeg() { file_cur_pos_ = file_begin_; }
+    bool isRunning() const;
+    void runStream();
     void start(bool value);
-    void onError(const std::string& msg, t_symbol *s);
+    void onError(const std::string& msg, t_symbol* s);
+    std::string findFile(t_symbol* name);
 
-private:
+public:
     static bool calcBegin(const units::TimeValue& tm, size_t sr, size_t sampleCount, std::int64_t& result);
     static bool calcEnd(const units::TimeValue& tm, size_t sr, size_t sampleCount, std::int64_t begin, std::int64_t& result);
 };
@@ -111,7 +111,7 @@ void Envelope::m_addPoint(t_symbol* s, const AtomListView& lv)
 
     EnvelopePoint pt(point_time, point_value, stop_point, curve_type);
     pt.data = curve_data;
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->insertPoint(pt);
 }
 
@@ -126,7 +126,7 @@ void Envelope::m_removePoint(t_symbol* s, const AtomListView& lv)
         return;
     }
 
-    env_.detachData();
+    env_.ensureUniqueData();
     if (!env_->removePoint(point_idx))
         OBJ_ERR << "can't remove point at: " << point_idx;
 }
@@ -142,7 +142,7 @@ void Envelope::m_setPointTime(t_symbol* s, const AtomListView& lv)
         return;
     }
 
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->pointAt(point_idx).utime = lv[1].asFloat() * 1000;
     env_->sort();
 }
@@ -158,7 +158,7 @@ void Envelope::m_setPointValue(t_symbol* s, const AtomListView& lv)
         return;
     }
 
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->pointAt(point_idx).value = lv[1].asFloat();
 }
 
@@ -187,7 +187,7 @@ void Envelope::m_setPoint(t_symbol* s, const AtomListView& lv)
     p.value = value;
     p.stop = stop;
 
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->sort();
 }
 
@@ -202,7 +202,7 @@ void Envelope::m_setStopPoint(t_symbol* s, const AtomListView& lv)
         return;
     }
 
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->pointAt(point_idx).stop = lv[1].asInt();
 }
 
@@ -230,7 +230,7 @@ void Envelope::m_appendSegment(t_symbol* s, const AtomListView& lv)
         return;
     }
 
-    env_.detachData();
+    env_.ensureUniqueData();
     if (!env_->appendSegment(length_ms * 1000, value, ctype, curve_skew))
         OBJ_ERR << "can't append segment";
 }
@@ -257,7 +257,7 @@ void Envelope::m_setSegmentType(t_symbol* s, const AtomListView& lv)
         return;
     }
 
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->pointAt(seg_idx).type = seg_type;
 }
 
@@ -268,7 +268,7 @@ void Envelope::m_plus(t_symbol* s, const AtomListView& lv)
 
     t_float v = lv[0].asFloat();
 
-    env_.detachData();
+    env_.ensureUniqueData();
     for (size_t i = 0; i < env_->numPoints(); i++)
         env_->pointAt(i).value += v;
 }
@@ -280,7 +280,7 @@ void Envelope::m_multiply(t_symbol* s, const AtomListView& lv)
 
     t_float v = lv[0].asFloat();
 
-    env_.detachData();
+    env_.ensureUniqueData();
     for (size_t i = 0; i < env_->numPoints(); i++)
         env_->pointAt(i).value *= v;
 }
@@ -290,44 +290,44 @@ void Envelope::m_shift(t_symbol* s, const AtomListView& lv)
     if (!checkArgs(lv, ARG_FLOAT, s))
         return;
 
-    env_.detachData();
+    env_.ensureUniqueData();
     long v = lv[0].asFloat() * 1000;
     env_->shiftTime(v);
 }
 
 void Envelope::m_AR(t_symbol* s, const AtomListView& lv)
 {
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->setAR(lv);
 }
 
 void Envelope::m_ASR(t_symbol* s, const AtomListView& lv)
 {
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->setASR(lv);
 }
 
 void Envelope::m_ADSR(t_symbol* s, const AtomListView& lv)
 {
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->setADSR(lv);
 }
 
 void Envelope::m_EADSR(t_symbol* s, const AtomListView& lv)
 {
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->setEADSR(lv);
 }
 
 void Envelope::m_EASR(t_symbol* s, const AtomListView& lv)
 {
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->setEASR(lv);
 }
 
 void Envelope::m_EAR(t_symbol* s, const AtomListView& lv)
 {
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->setEAR(lv);
 }
 
@@ -338,7 +338,7 @@ void Envelope::m_step(t_symbol* s, const AtomListView& lv)
         return;
     }
 
-    env_.detachData();
+    env_.ensureUniqueData();
     if (!env_->setStep(lv))
         OBJ_ERR << "Can't set step envelope";
 }
@@ -350,35 +350,35 @@ void Envelope::m_line(t_symbol* s, const AtomListView& lv)
         return;
     }
 
-    env_.detachData();
+    env_.ensureUniqueData();
     if (!env_->setLine(lv))
         OBJ_ERR << "Can't set line envelope";
 }
 
 void Envelope::m_sin2(t_symbol* s, const AtomListView& lv)
 {
-    env_.detachData();
+    env_.ensureUniqueData();
     if (!env_->setSin2(lv))
         OBJ_ERR << "Can't set sin2 envelope";
 }
 
 void Envelope::m_exp(t_symbol* s, const AtomListView& lv)
 {
-    env_.detachData();
+    env_.ensureUniqueData();
     if (!env_->setExponential(lv))
         OBJ_ERR << "Can't set exponential envelope";
 }
 
 void Envelope::m_sigmoid(t_symbol* s, const AtomListView& lv)
 {
-    env_.detachData();
+    env_.ensureUniqueData();
     if (!env_->setSigmoid(lv))
         OBJ_ERR << "Can't set sigmoid envelope";
 }
 
 void Envelope::m_clear(t_symbol*, const AtomListView&)
 {
-    env_.detachData();
+    env_.ensureUniqueData();
     env_->clear();
 }
 
@@ -34,7 +34,7 @@ using LangFaustBase = SaveObject<EditorObject<FilesystemIFace<SoundExternal>, Ed
 class LangFaustTilde : public LangFaustBase {
 public:
     using FaustProperyList = std::vector<faust::UIProperty*>;
-    using SourceCodeLine = SmallAtomListN<8>;
+    using SourceCodeLine = HeapAtomListN<8>;
     using SourceCode = boost::container::small_vector<SourceCodeLine, 48>;
 
 private:
@@ -36,7 +36,7 @@ using LangLuaBase = SaveObject<
 
 class LangLuaJit : public LangLuaBase {
 public:
-    using FixedAtomList = SmallAtomListN<8>;
+    using FixedAtomList = HeapAtomListN<8>;
     using FixedEditorList = boost::container::small_vector<FixedAtomList, 48>;
     using Inlet = InletProxy<LangLuaJit>;
 
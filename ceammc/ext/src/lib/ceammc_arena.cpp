@@ -0,0 +1,163 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_arena.h"
+
+extern "C" {
+#include "m_pd.h"
+#include "s_stuff.h"
+}
+
+#include <algorithm>
+#include <new>
+
+namespace ceammc {
+
+// every block starts with a header pointing to its arena (nullptr for heap blocks)
+struct AtomArena::Header {
+    AtomArena* arena;
+    size_t size;
+};
+
+namespace {
+    constexpr size_t ALIGN = alignof(std::max_align_t);
+    constexpr size_t align_up(size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+    constexpr size_t HEADER_SIZE = align_up(sizeof(void*) + sizeof(size_t));
+
+    thread_local AtomArena* thread_arena = nullptr;
+
+    void arena_tick()
+    {
+        // made on the first tick, in the scheduler thread, and never freed
+        static AtomArena* arena = nullptr;
+        if (!arena) {
+            arena = new AtomArena();
+            AtomArena::bind(arena);
+        }
+
+        arena->reset();
+    }
+}
+
+constexpr size_t AtomArena::INIT_CAPACITY;
+constexpr size_t AtomArena::MAX_CAPACITY;
+
+AtomArena::AtomArena(size_t capacity)
+    : buf_(new char[align_up(capacity)])
+    , capacity_(align_up(capacity))
+    , top_(0)
+    , overflow_(0)
+    , live_(0)
+{
+}
+
+AtomArena::~AtomArena()
+{
+    if (thread_arena == this)
+        thread_arena = nullptr;
+}
+
+void* AtomArena::allocate(size_t nbytes)
+{
+    const auto total = HEADER_SIZE + align_up(nbytes);
+
+    if (top_ + total > capacity_) {
+        stats_.heap_allocs++;
+        overflow_ += total;
+        return heapAllocate(nbytes);
+    }
+
+    auto hdr = reinterpret_cast<Header*>(buf_.get() + top_);
+    hdr->arena = this;
+    hdr->size = total;
+    top_ += total;
+    live_.fetch_add(1, std::memory_order_relaxed);
+
+    stats_.arena_allocs++;
+    stats_.bytes_peak = std::max(stats_.bytes_peak, top_);
+
+    return reinterpret_cast<char*>(hdr) + HEADER_SIZE;
+}
+
+void AtomArena::deallocate(void* p) noexcept
+{
+    if (!p)
+        return;
+
+    auto hdr = reinterpret_cast<Header*>(static_cast<char*>(p) - HEADER_SIZE);
+    if (hdr->arena)
+        hdr->arena->release(hdr);
+    else
+        ::operator delete(hdr);
+}
+
+void* AtomArena::heapAllocate(size_t nbytes)
+{
+    auto hdr = static_cast<Header*>(::operator new(HEADER_SIZE + nbytes));
+    hdr->arena = nullptr;
+    hdr->size = HEADER_SIZE + nbytes;
+    return reinterpret_cast<char*>(hdr) + HEADER_SIZE;
+}
+
+void AtomArena::release(Header* hdr) noexcept
+{
+    // other threads only drop the counter: the arena itself is not thread safe
+    if (thread_arena != this) {
+        live_.fetch_sub(1, std::memory_order_acq_rel);
+        return;
+    }
+
+    // freeing the last allocated block (the usual case for temporaries)
+    if (reinterpret_cast<char*>(hdr) + hdr->size == buf_.get() + top_)
+        top_ -= hdr->size;
+
+    if (live_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        top_ = 0;
+}
+
+bool AtomArena::reset()
+{
+    if (live_.load(std::memory_order_acquire) > 0) {
+        stats_.pinned++;
+        return false;
+    }
+
+    top_ = 0;
+
+    if (overflow_ > 0 && capacity_ < MAX_CAPACITY) {
+        const auto new_cap = std::min(MAX_CAPACITY, align_up(std::max(capacity_ * 2, capacity_ + overflow_)));
+        buf_.reset(new char[new_cap]);
+        capacity_ = new_cap;
+    }
+
+    overflow_ = 0;
+    stats_.resets++;
+    return true;
+}
+
+AtomArena* AtomArena::current() noexcept
+{
+    return thread_arena;
+}
+
+void AtomArena::bind(AtomArena* arena) noexcept
+{
+    thread_arena = arena;
+}
+
+void AtomArena::setupScheduler()
+{
+    sched_addtickhook(arena_tick);
+}
+
+}
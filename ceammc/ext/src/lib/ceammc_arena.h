@@ -0,0 +1,152 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#ifndef CEAMMC_ARENA_H
+#define CEAMMC_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace ceammc {
+
+/**
+ * Bump allocator for short lived control data: message temporaries built while
+ * handling a single message. Memory is taken by moving a pointer in a
+ * preallocated buffer and is given back all at once: when the last live block
+ * is freed or, at the latest, at the end of the scheduler tick.
+ *
+ * Only the thread the arena is bound to allocates from it, other threads get
+ * heap memory. Any thread may free an arena block. If some block outlives the
+ * tick, the arena is not rewound and allocations fall back to the heap once
+ * the buffer is exhausted, so keeping arena memory is safe, but wasteful:
+ * use heap allocated containers for long lived data. The arena should outlive
+ * all blocks allocated from it.
+ */
+class AtomArena {
+public:
+    static constexpr size_t INIT_CAPACITY = 64 * 1024;
+    static constexpr size_t MAX_CAPACITY = 4 * 1024 * 1024;
+
+    struct Stats {
+        size_t arena_allocs = 0; // blocks taken from the arena
+        size_t heap_allocs = 0; // blocks taken from the heap, when the arena was full
+        size_t bytes_peak = 0; // max arena usage
+        size_t resets = 0; // successful resets
+        size_t pinned = 0; // resets skipped because of live blocks
+    };
+
+public:
+    explicit AtomArena(size_t capacity = INIT_CAPACITY);
+    ~AtomArena();
+
+    AtomArena(const AtomArena&) = delete;
+    AtomArena& operator=(const AtomArena&) = delete;
+
+    /**
+     * Allocates memory block from the arena or the heap, if it is full
+     * @note should be called only from the thread the arena is bound to
+     */
+    void* allocate(size_t nbytes);
+
+    /**
+     * Frees memory block allocated by AtomArena::allocate() or AtomArena::heapAllocate()
+     */
+    static void deallocate(void* p) noexcept;
+
+    /**
+     * Allocates a heap block that can be freed by AtomArena::deallocate()
+     */
+    static void* heapAllocate(size_t nbytes);
+
+    /**
+     * Rewinds the arena if there are no live blocks, growing the buffer if
+     * some allocations did not fit since the last reset
+     * @return true on success, false if the arena is still in use
+     */
+    bool reset();
+
+    size_t capacity() const { return capacity_; }
+    size_t used() const { return top_; }
+    size_t liveBlocks() const { return live_.load(std::memory_order_acquire); }
+
+    const Stats& stats() const { return stats_; }
+    void clearStats() { stats_ = Stats(); }
+
+public:
+    /**
+     * Returns the arena bound to the calling thread or nullptr
+     */
+    static AtomArena* current() noexcept;
+
+    /**
+     * Binds the arena to the calling thread, nullptr to unbind
+     */
+    static void bind(AtomArena* arena) noexcept;
+
+    /**
+     * Makes an arena for the thread running the Pd scheduler that is reset
+     * at the end of every scheduler tick
+     */
+    static void setupScheduler();
+
+private:
+    struct Header;
+    void release(Header* hdr) noexcept;
+
+private:
+    std::unique_ptr<char[]> buf_;
+    size_t capacity_;
+    size_t top_;
+    size_t overflow_;
+    std::atomic<size_t> live_;
+    Stats stats_;
+};
+
+/**
+ * Standard allocator drawing from the arena bound to the calling thread
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept { }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        auto arena = AtomArena::current();
+        const auto nbytes = n * sizeof(T);
+        return static_cast<T*>(arena ? arena->allocate(nbytes) : AtomArena::heapAllocate(nbytes));
+    }
+
+    void deallocate(T* p, size_t) noexcept
+    {
+        AtomArena::deallocate(p);
+    }
+};
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) noexcept { return true; }
+
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) noexcept { return false; }
+
+}
+
+#endif // CEAMMC_ARENA_H
@@ -20,6 +20,7 @@
 #include "fmt/core.h"
 #include "lex/parser_strings.h"
 
+#include <atomic>
 #include <cmath>
 #include <cstring>
 #include <functional>
@@ -29,9 +30,16 @@
 namespace ceammc {
 
 #define REF_PTR a_w.w_symbol
+// data atoms can be copied and destroyed from any thread
 struct t_ref {
     AbstractData* data;
-    uint32_t counter;
+    std::atomic<uint32_t> counter;
+
+    explicit t_ref(AbstractData* d)
+        : data(d)
+        , counter(1)
+    {
+    }
 };
 
 //#define TRACE_DATA 1
@@ -76,7 +84,7 @@ Atom::Atom(const t_atom& a)
     else if (a_type == TYPE_DATA) {
         auto ref = reinterpret_cast<t_ref*>(REF_PTR);
         if (ref) {
-            ref->counter++;
+            ref->counter.fetch_add(1, std::memory_order_relaxed);
         } else {
             LIB_ERR << "nullref dataatom: " << __FUNCTION__;
             setNull();
@@ -94,7 +102,7 @@ Atom::Atom(AbstractData* d)
         a_type = TYPE_DATA;
 
         try {
-            REF_PTR = reinterpret_cast<decltype(REF_PTR)>(new t_ref { d, 1 });
+            REF_PTR = reinterpret_cast<decltype(REF_PTR)>(new t_ref(d));
 
             TRACE(fmt::format("+ data {}", (void*)d));
         } catch (std::exception& e) { // for std::bad_alloc
@@ -113,7 +121,7 @@ Atom::Atom(const Atom& x)
 
         auto ref = reinterpret_cast<t_ref*>(REF_PTR);
         if (ref) {
-            ref->counter++;
+            ref->counter.fetch_add(1, std::memory_order_relaxed);
         } else {
             LIB_ERR << "invalid null-ref dataatom: " << __FUNCTION__;
             setNull();
@@ -268,7 +276,7 @@ uint32_t Atom::refCount() const noexcept
     if (a_type == TYPE_DATA) {
         auto ref = reinterpret_cast<t_ref*>(REF_PTR);
         if (ref)
-            return ref->counter;
+            return ref->counter.load(std::memory_order_acquire);
         else {
             LIB_ERR << "nullref dataatom: " << __FUNCTION__;
             return 0;
@@ -345,7 +353,7 @@ bool Atom::acquire() noexcept
                 LIB_ERR << "dataatom with NULL data pointer: " << __FUNCTION__;
                 return false;
             } else {
-                ref->counter++;
+                ref->counter.fetch_add(1, std::memory_order_relaxed);
                 return true;
             }
         } else {
@@ -363,10 +371,10 @@ try {
     if (a_type == TYPE_DATA) {
         auto ref = reinterpret_cast<t_ref*>(REF_PTR);
         if (ref) {
-            if (ref->counter > 0) {
-                ref->counter--;
+            const auto prev = ref->counter.fetch_sub(1, std::memory_order_acq_rel);
+            if (prev > 0) {
                 // delete data
-                if (ref->counter == 0) {
+                if (prev == 1) {
                     if (ref->data) {
                         delete ref->data;
 
@@ -381,6 +389,7 @@ try {
                     REF_PTR = nullptr;
                 }
             } else {
+                ref->counter.store(0, std::memory_order_relaxed);
                 LIB_ERR << "zero reference counter: " << __FUNCTION__;
             }
         } else {
@@ -643,6 +652,25 @@ bool Atom::detachData() noexcept
     }
 }
 
+bool Atom::isUniqueData() const noexcept
+{
+    return refCount() == 1;
+}
+
+bool Atom::ensureUniqueData() noexcept
+{
+    if (a_type != TYPE_DATA) {
+        LIB_ERR << "attempt to detach non-data atom: " << *this;
+        return false;
+    }
+
+    // the only owner: no other atom (and thread) can see the data
+    if (isUniqueData())
+        return true;
+
+    return detachData();
+}
+
 bool Atom::operator<(const Atom& b) const noexcept
 {
     if (this == &b)
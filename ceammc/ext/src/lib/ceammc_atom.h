@@ -625,6 +625,19 @@ public:
      */
     bool detachData() noexcept;
 
+    /**
+     * Copy-on-write: detach pointed data only if it is shared with other atoms
+     * @return true on success, false on error
+     * @note data atoms can be copied and destroyed from any thread, but shared data
+     *       should be treated as immutable: call this before modifying it
+     */
+    bool ensureUniqueData() noexcept;
+
+    /**
+     * @return true if atom is the only owner of the pointed data
+     */
+    bool isUniqueData() const noexcept;
+
     /**
      * Return number of data references or 0 if not a dataatom
      */
@@ -23,29 +23,37 @@
 #include <boost/container/static_vector.hpp>
 #include <boost/iterator/filter_iterator.hpp>
 
+#include "ceammc_arena.h"
 #include "ceammc_atom.h"
 #include "ceammc_atomlist_view.h"
 
 namespace ceammc {
 
-template <size_t N = 4>
-class SmallAtomListN : public boost::container::small_vector<Atom, N> {
+/**
+ * Atom list with N inplace elements. By default the storage for lists longer than N
+ * is taken from the scheduler arena (see AtomArena), so it is intended for temporaries,
+ * use HeapAtomListN for lists stored between messages
+ */
+template <size_t N = 4, typename Alloc = ArenaAllocator<Atom>>
+class SmallAtomListN : public boost::container::small_vector<Atom, N, Alloc> {
+    using Base = boost::container::small_vector<Atom, N, Alloc>;
+
 public:
     SmallAtomListN() { }
 
     SmallAtomListN(std::initializer_list<Atom> atoms)
-        : boost::container::small_vector<Atom, N>(atoms.begin(), atoms.end())
+        : Base(atoms.begin(), atoms.end())
     {
     }
 
     explicit SmallAtomListN(const AtomListView& lv)
-        : boost::container::small_vector<Atom, N>(lv.begin(), lv.end())
+        : Base(lv.begin(), lv.end())
     {
     }
 
     template <typename... Args>
     explicit SmallAtomListN(Args... args)
-        : boost::container::small_vector<Atom, N>({ atomFrom(args)... })
+        : Base({ atomFrom(args)... })
     {
     }
 
@@ -70,6 +78,9 @@ public:
     }
 };
 
+template <size_t N = 4>
+using HeapAtomListN = SmallAtomListN<N, std::allocator<Atom>>;
+
 using SmallAtomList = SmallAtomListN<8>;
 using AtomList16 = SmallAtomListN<16>;
 using AtomList32 = SmallAtomListN<32>;
@@ -225,7 +236,7 @@ public:
     }
 
 private:
-    SmallAtomListN<N> atoms_;
+    HeapAtomListN<N> atoms_;
     Type type_;
 };
 
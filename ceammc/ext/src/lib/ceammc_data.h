@@ -62,6 +62,12 @@ public:
 
     T& operator*() noexcept { return *(operator->()); }
     const T& operator*() const noexcept { return *(operator->()); }
+
+    /**
+     * Copy-on-write access: makes own data copy if it is shared
+     * @return pointer to data or nullptr on error
+     */
+    T* mutableData() noexcept { return ensureUniqueData() ? operator->() : nullptr; }
 };
 
 using MListAtom = DataAtom<DataTypeMList>;
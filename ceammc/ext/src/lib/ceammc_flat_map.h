@@ -0,0 +1,307 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#ifndef CEAMMC_FLAT_MAP_H
+#define CEAMMC_FLAT_MAP_H
+
+#include "m_pd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ceammc {
+
+/**
+ * Hash map with t_symbol* keys that iterates in insertion order.
+ *
+ * Entries are kept one after another in a single vector, so iteration and
+ * copying are linear walks over contiguous memory. Lookups go through an open
+ * addressing index (linear probing), each slot holds the key inline next to
+ * the entry position, so a probe doesn't touch the entries at all.
+ * Symbols are interned, so the pointer itself is hashed.
+ *
+ * Unlike std::map references and iterators are invalidated by insertion and
+ * erase. Erasing keeps the order of the remaining entries, but costs O(n):
+ * use erase_if() to remove many entries at once.
+ */
+template <typename T>
+class FlatSymbolMap {
+public:
+    using key_type = t_symbol*;
+    using mapped_type = T;
+    using value_type = std::pair<t_symbol*, T>;
+    using size_type = size_t;
+    using Entries = std::vector<value_type>;
+    using iterator = typename Entries::iterator;
+    using const_iterator = typename Entries::const_iterator;
+
+private:
+    struct Slot {
+        t_symbol* key;
+        uint32_t pos;
+    };
+
+    enum {
+        MIN_BITS = 3 // 8 slots
+    };
+
+    Entries entries_;
+    std::vector<Slot> slots_;
+    uint32_t bits_ = 0;
+
+public:
+    FlatSymbolMap() = default;
+
+    FlatSymbolMap(std::initializer_list<value_type> l)
+    {
+        reserve(l.size());
+        for (auto& kv : l)
+            insert(kv);
+    }
+
+    iterator begin() { return entries_.begin(); }
+    iterator end() { return entries_.end(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+    const_iterator cbegin() const { return entries_.cbegin(); }
+    const_iterator cend() const { return entries_.cend(); }
+
+    size_t size() const noexcept { return entries_.size(); }
+    bool empty() const noexcept { return entries_.empty(); }
+
+    void clear() noexcept
+    {
+        entries_.clear();
+        std::fill(slots_.begin(), slots_.end(), Slot { nullptr, 0 });
+    }
+
+    /**
+     * Preallocate space for n entries
+     */
+    void reserve(size_t n)
+    {
+        entries_.reserve(n);
+        if (needGrow(n))
+            rehash(n);
+    }
+
+    iterator find(t_symbol* key)
+    {
+        auto idx = findSlot(key);
+        return (idx < 0) ? entries_.end() : entries_.begin() + slots_[idx].pos;
+    }
+
+    const_iterator find(t_symbol* key) const
+    {
+        auto idx = findSlot(key);
+        return (idx < 0) ? entries_.end() : entries_.begin() + slots_[idx].pos;
+    }
+
+    size_t count(t_symbol* key) const { return findSlot(key) < 0 ? 0 : 1; }
+
+    T& at(t_symbol* key)
+    {
+        auto it = find(key);
+        if (it == end())
+            throw std::out_of_range("key not found");
+
+        return it->second;
+    }
+
+    const T& at(t_symbol* key) const
+    {
+        auto it = find(key);
+        if (it == end())
+            throw std::out_of_range("key not found");
+
+        return it->second;
+    }
+
+    /**
+     * Returns value for the key, new keys are appended with default value
+     */
+    T& operator[](t_symbol* key)
+    {
+        auto idx = findSlot(key);
+        if (idx >= 0)
+            return entries_[slots_[idx].pos].second;
+
+        append(key, T());
+        return entries_.back().second;
+    }
+
+    /**
+     * Inserts new entry, existing values are not changed
+     * @return pair of iterator to the entry and insertion flag
+     */
+    std::pair<iterator, bool> insert(const value_type& kv)
+    {
+        auto idx = findSlot(kv.first);
+        if (idx >= 0)
+            return { entries_.begin() + slots_[idx].pos, false };
+
+        append(kv.first, kv.second);
+        return { entries_.end() - 1, true };
+    }
+
+    /**
+     * Removes entry, the following entries are moved one position down
+     * @return iterator to the entry after removed one
+     */
+    iterator erase(const_iterator it)
+    {
+        const auto pos = static_cast<uint32_t>(it - entries_.cbegin());
+        removeSlot(findSlot(it->first));
+
+        for (auto& s : slots_) {
+            if (s.key && s.pos > pos)
+                s.pos--;
+        }
+
+        return entries_.erase(it);
+    }
+
+    size_t erase(t_symbol* key)
+    {
+        auto it = find(key);
+        if (it == end())
+            return 0;
+
+        erase(it);
+        return 1;
+    }
+
+    /**
+     * Removes all entries matching predicate in single pass
+     * @return number of removed entries
+     */
+    template <typename Pred>
+    size_t erase_if(Pred pred)
+    {
+        auto it = std::remove_if(entries_.begin(), entries_.end(), pred);
+        const size_t n = entries_.end() - it;
+        if (n > 0) {
+            entries_.erase(it, entries_.end());
+            reindex();
+        }
+
+        return n;
+    }
+
+    /**
+     * Same keys with equal values, the order of entries doesn't matter
+     */
+    bool operator==(const FlatSymbolMap& m) const
+    {
+        if (size() != m.size())
+            return false;
+
+        for (auto& kv : entries_) {
+            auto it = m.find(kv.first);
+            if (it == m.end() || !(it->second == kv.second))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool operator!=(const FlatSymbolMap& m) const { return !operator==(m); }
+
+private:
+    size_t mask() const { return slots_.size() - 1; }
+
+    size_t home(t_symbol* key) const
+    {
+        // fibonacci hashing, low pointer bits are always zero
+        const uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h >> (64 - bits_));
+    }
+
+    // keep load factor below 3/4
+    bool needGrow(size_t n) const { return n * 4 >= slots_.size() * 3; }
+
+    long findSlot(t_symbol* key) const
+    {
+        if (slots_.empty())
+            return -1;
+
+        for (size_t i = home(key);; i = (i + 1) & mask()) {
+            auto& s = slots_[i];
+            if (s.key == key)
+                return static_cast<long>(i);
+            else if (!s.key)
+                return -1;
+        }
+    }
+
+    void placeSlot(t_symbol* key, uint32_t pos)
+    {
+        size_t i = home(key);
+        while (slots_[i].key)
+            i = (i + 1) & mask();
+
+        slots_[i] = { key, pos };
+    }
+
+    // backward shift deletion: no tombstones, so probe chains stay short
+    void removeSlot(long idx)
+    {
+        size_t i = idx;
+        for (size_t j = (i + 1) & mask(); slots_[j].key; j = (j + 1) & mask()) {
+            const size_t k = home(slots_[j].key);
+            // move the slot back if its home position is not between i and j (cyclically)
+            const bool move = (i <= j) ? (k <= i || k > j) : (k <= i && k > j);
+            if (move) {
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+
+        slots_[i] = { nullptr, 0 };
+    }
+
+    void append(t_symbol* key, const T& value)
+    {
+        if (needGrow(entries_.size() + 1))
+            rehash(entries_.size() + 1);
+
+        placeSlot(key, static_cast<uint32_t>(entries_.size()));
+        entries_.emplace_back(key, value);
+    }
+
+    void rehash(size_t n)
+    {
+        uint32_t bits = MIN_BITS;
+        while ((size_t(1) << bits) * 3 <= n * 4)
+            bits++;
+
+        bits_ = bits;
+        slots_.assign(size_t(1) << bits, Slot { nullptr, 0 });
+        reindex();
+    }
+
+    void reindex()
+    {
+        std::fill(slots_.begin(), slots_.end(), Slot { nullptr, 0 });
+        for (size_t i = 0; i < entries_.size(); i++)
+            placeSlot(entries_[i].first, static_cast<uint32_t>(i));
+    }
+};
+
+}
+
+#endif // CEAMMC_FLAT_MAP_H
@@ -18,6 +18,9 @@
 
 #include "json/json.hpp"
 
+#include <memory>
+#include <vector>
+
 namespace ceammc {
 namespace json {
 
@@ -105,5 +108,228 @@ namespace json {
     {
         return to_json_struct(dict, opt).dump(opt.indent);
     }
+
+    /**
+     * SAX handler for nlohmann::json::sax_parse() that builds atoms as the values are parsed.
+     * Each open array or object has its frame: elements of an array are collected in the
+     * frame list, object entries go straight to the Dict being filled.
+     */
+    class AtomSaxBuilder {
+        using json = nlohmann::json;
+
+        struct Frame {
+            AtomList list; // array elements
+            bool compound { false }; // array has nested arrays or objects
+            std::unique_ptr<DataTypeDict> dict; // own object
+            DataTypeDict* obj { nullptr }; // object being filled
+            t_symbol* key { nullptr };
+        };
+
+        std::vector<Frame> frames_;
+        size_t depth_ { 0 };
+        DataTypeDict* target_ { nullptr };
+        const JsonElementFn* stream_ { nullptr };
+        std::string err_;
+
+    public:
+        AtomList result;
+        bool is_array { false };
+
+    public:
+        /**
+         * @param target - destination for top level object, other values are error
+         * @param stream - top level array element callback
+         */
+        AtomSaxBuilder(DataTypeDict* target = nullptr, const JsonElementFn* stream = nullptr)
+            : target_(target)
+            , stream_(stream)
+        {
+        }
+
+        const std::string& error() const { return err_; }
+
+        bool setError(const std::string& msg)
+        {
+            err_ = msg;
+            return false;
+        }
+
+        bool null() { return value(Atom()); }
+        bool boolean(bool v) { return value(Atom(v ? 1 : 0)); }
+        bool number_integer(json::number_integer_t v) { return value(Atom(static_cast<t_float>(v))); }
+        bool number_unsigned(json::number_unsigned_t v) { return value(Atom(static_cast<t_float>(v))); }
+        bool number_float(json::number_float_t v, const json::string_t&) { return value(Atom(static_cast<t_float>(v))); }
+        bool string(json::string_t& v) { return value(Atom(gensym(v.c_str()))); }
+        bool binary(json::binary_t&) { return value(Atom()); } // not used by JSON text
+
+        bool start_object(std::size_t)
+        {
+            auto& f = push();
+            if (depth_ == 1 && target_) {
+                f.obj = target_;
+            } else {
+                f.dict.reset(new DataTypeDict);
+                f.obj = f.dict.get();
+            }
+
+            return true;
+        }
+
+        bool key(json::string_t& k)
+        {
+            frames_[depth_ - 1].key = gensym(k.c_str());
+            return true;
+        }
+
+        bool end_object()
+        {
+            auto& f = frames_[--depth_];
+            f.obj = nullptr;
+
+            // target is filled in place
+            if (!f.dict)
+                return true;
+
+            return value(Atom(f.dict.release()), true);
+        }
+
+        bool start_array(std::size_t)
+        {
+            if (depth_ == 0) {
+                if (target_)
+                    return setError("JSON object expected");
+
+                is_array = true;
+            }
+
+            push();
+            return true;
+        }
+
+        bool end_array()
+        {
+            auto& f = frames_[--depth_];
+            AtomList lst(std::move(f.list));
+            f.list.clear();
+
+            if (depth_ == 0) {
+                if (!stream_)
+                    assignList(result, std::move(lst), f.compound);
+
+                return true;
+            }
+
+            auto& parent = frames_[depth_ - 1];
+            if (parent.obj) {
+                assignList(parent.obj->innerData()[parent.key], std::move(lst), f.compound);
+                return true;
+            } else
+                return value(Atom(new DataTypeMList(std::move(lst))), true);
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e)
+        {
+            return setError(e.what());
+        }
+
+    private:
+        Frame& push()
+        {
+            if (frames_.size() <= depth_)
+                frames_.emplace_back();
+
+            auto& f = frames_[depth_++];
+            f.list.clear();
+            f.compound = false;
+            f.dict.reset();
+            f.obj = nullptr;
+            f.key = nullptr;
+            return f;
+        }
+
+        // scalar value or finished object/nested array
+        bool value(const Atom& a, bool compound = false)
+        {
+            if (depth_ == 0) {
+                if (target_)
+                    return setError("JSON object expected");
+
+                if (stream_)
+                    (*stream_)(a);
+                else
+                    result = a;
+
+                return true;
+            }
+
+            auto& f = frames_[depth_ - 1];
+            if (f.obj) {
+                auto& v = f.obj->innerData()[f.key];
+                // null is an empty value
+                if (a.isNone())
+                    v.clear();
+                else
+                    v = a;
+            } else if (stream_ && depth_ == 1)
+                (*stream_)(a);
+            else {
+                f.list.append(a);
+                f.compound |= compound;
+            }
+
+            return true;
+        }
+
+        // primitive values as is, otherwise single MList, like from_json(json, AtomList&)
+        static void assignList(AtomList& dest, AtomList&& lst, bool compound)
+        {
+            if (compound)
+                dest = Atom(new DataTypeMList(std::move(lst)));
+            else
+                dest = std::move(lst);
+        }
+    };
+
+    static bool sax_parse(const char* str, size_t len, AtomSaxBuilder& sax, std::string& err)
+    {
+        try {
+            if (nlohmann::json::sax_parse(str, str + len, &sax))
+                return true;
+
+            err = sax.error();
+            return false;
+        } catch (std::exception& e) {
+            err = e.what();
+            return false;
+        }
+    }
+
+    bool from_json_string(const char* str, size_t len, AtomList& res, bool& isArray, std::string& err)
+    {
+        AtomSaxBuilder sax;
+        if (!sax_parse(str, len, sax, err))
+            return false;
+
+        res = std::move(sax.result);
+        isArray = sax.is_array;
+        return true;
+    }
+
+    bool from_json_string(const std::string& str, DataTypeDict& dict, std::string& err)
+    {
+        DataTypeDict tmp;
+        AtomSaxBuilder sax(&tmp);
+        if (!sax_parse(str.data(), str.size(), sax, err))
+            return false;
+
+        dict = std::move(tmp);
+        return true;
+    }
+
+    bool from_json_stream(const char* str, size_t len, const JsonElementFn& fn, std::string& err)
+    {
+        AtomSaxBuilder sax(nullptr, &fn);
+        return sax_parse(str, len, sax, err);
+    }
 }
 }
@@ -17,6 +17,7 @@
 #include "ceammc_atomlist.h"
 #include "ceammc_data.h"
 
+#include <functional>
 #include <string>
 
 namespace ceammc {
@@ -32,6 +33,37 @@ namespace json {
     std::string to_json_string(const DataTypeString& str, const JsonWriteOpts& opt = JsonWriteOpts());
     std::string to_json_string(const DataTypeMList& ml, const JsonWriteOpts& opt = JsonWriteOpts());
     std::string to_json_string(const DataTypeDict& dict, const JsonWriteOpts& opt = JsonWriteOpts());
+
+    /**
+     * Parses JSON straight into atoms, without building JSON document first.
+     * Conversion is the same as from_json() in datatype_json.h: strings become symbols,
+     * true/false - 1/0, null - empty atom, objects - Dict and nested arrays - MList.
+     * Dict keys are kept in document order.
+     * @param str - JSON text
+     * @param len - text length
+     * @param res - top level array elements, if all of them are primitive values,
+     *   otherwise single MList with all elements. Other values - single element list.
+     * @param isArray - set to true if top level value is array
+     * @param err - error message on failure
+     * @return true on success
+     */
+    bool from_json_string(const char* str, size_t len, AtomList& res, bool& isArray, std::string& err);
+
+    /**
+     * Parses JSON object into dict, on error dict is not changed
+     * @return true on success, false on parse error or if top level value is not an object
+     */
+    bool from_json_string(const std::string& str, DataTypeDict& dict, std::string& err);
+
+    /**
+     * Incremental parsing of huge arrays: elements of the top level array are passed
+     * to the callback as soon as they are parsed, nothing is accumulated.
+     * Nested arrays are passed as MList atoms, top level value that is not an array
+     * is passed as single atom.
+     * @return true on success, on error elements parsed so far are already passed
+     */
+    using JsonElementFn = std::function<void(const Atom&)>;
+    bool from_json_stream(const char* str, size_t len, const JsonElementFn& fn, std::string& err);
 }
 
 }
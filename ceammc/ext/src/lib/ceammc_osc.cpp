@@ -20,6 +20,7 @@
 
 CEAMMC_DEFINE_STR(none)
 
+#include <cmath>
 #include <memory>
 #include <mutex>
 #include <type_traits>
@@ -121,71 +122,355 @@ namespace osc {
         return true;
     }
 
-    OscMethodSubscriber::OscMethodSubscriber(SubscriberId id, OscMethodFn fn)
-        : id_(id)
-        , fn_(fn)
+    static inline bool is_numeric_type(char t)
     {
+        return t == LO_INT32 || t == LO_INT64 || t == LO_FLOAT || t == LO_DOUBLE;
     }
 
-    void OscMethodSubscriber::notify(const char* path, const char* types, lo_arg** argv, int argc)
+    static inline bool is_string_type(char t)
     {
-        if (fn_) {
-            OscRecvMessage msg;
-            msg.setPath(path);
-
-            for (int i = 0; i < argc; i++) {
-                OscMessageAtom atom;
-                const auto t = types[i];
-
-                switch (t) {
-                case LO_FLOAT:
-                    atom = argv[i]->f;
-                    break;
-                case LO_DOUBLE:
-                    atom = argv[i]->d;
-                    break;
-                case LO_TRUE:
-                    atom = true;
-                    break;
-                case LO_FALSE:
-                    atom = false;
-                    break;
-                case LO_INT32:
-                    atom = argv[i]->i32;
-                    break;
-                case LO_INT64:
-                    atom = argv[i]->i64;
-                    break;
-                case LO_STRING:
+        return t == LO_STRING || t == LO_SYMBOL;
+    }
+
+    // same rules as in liblo: numeric types and strings/symbols are coerced
+    static bool can_coerce_types(const char* from, const std::string& to)
+    {
+        if (strlen(from) != to.size())
+            return false;
+
+        for (size_t i = 0; i < to.size(); i++) {
+            const auto a = from[i];
+            const auto b = to[i];
+
+            if (a != b
+                && !(is_numeric_type(a) && is_numeric_type(b))
+                && !(is_string_type(a) && is_string_type(b)))
+                return false;
+        }
+
+        return true;
+    }
+
+    static double numeric_value(char t, const lo_arg* a)
+    {
+        switch (t) {
+        case LO_INT32:
+            return a->i32;
+        case LO_INT64:
+            return a->i64;
+        case LO_FLOAT:
+            return a->f;
+        case LO_DOUBLE:
+        default:
+            return a->d;
+        }
+    }
+
+    // fill record without allocations
+    static bool fill_record(OscMessageRecord& rec, const char* path, const char* types, lo_arg** argv, int argc, const std::string& dest_types)
+    {
+        if (argc > static_cast<int>(OscMessageRecord::MAX_ARGS))
+            return false;
+
+        size_t used = 0;
+        auto add_data = [&rec, &used](const void* p, size_t n, bool zero, OscMessageRecord::Arg& arg) -> bool {
+            const size_t total = n + (zero ? 1 : 0);
+            if (used + total > OscMessageRecord::DATA_SIZE)
+                return false;
+
+            memcpy(rec.data + used, p, n);
+            if (zero)
+                rec.data[used + n] = '\0';
+
+            arg.data.offset = used;
+            arg.data.size = n;
+            used += total;
+            return true;
+        };
+
+        OscMessageRecord::Arg path_arg;
+        if (!add_data(path, strlen(path), true, path_arg))
+            return false;
+
+        rec.argc = argc;
+
+        for (int i = 0; i < argc; i++) {
+            const auto src = types[i];
+            const auto t = dest_types.empty() ? src : dest_types[i];
+            auto& arg = rec.args[i];
+            rec.types[i] = t;
+
+            if (t != src) {
+                // types are already checked by can_coerce_types()
+                if (is_string_type(t)) {
+                    if (!add_data(&argv[i]->s, strlen(&argv[i]->s), true, arg))
+                        return false;
+                } else {
+                    const auto v = numeric_value(src, argv[i]);
+                    switch (t) {
+                    case LO_INT32:
+                        arg.i = static_cast<int32_t>(v);
+                        break;
+                    case LO_INT64:
+                        arg.h = static_cast<int64_t>(v);
+                        break;
+                    case LO_FLOAT:
+                        arg.f = static_cast<float>(v);
+                        break;
+                    default:
+                        arg.d = v;
+                        break;
+                    }
+                }
+
+                continue;
+            }
+
+            switch (t) {
+            case LO_FLOAT:
+                arg.f = argv[i]->f;
+                break;
+            case LO_DOUBLE:
+                arg.d = argv[i]->d;
+                break;
+            case LO_INT32:
+                arg.i = argv[i]->i32;
+                break;
+            case LO_INT64:
+                arg.h = argv[i]->i64;
+                break;
+            case LO_CHAR:
+                arg.i = static_cast<char>(argv[i]->c);
+                break;
+            case LO_STRING:
+            case LO_SYMBOL:
+                if (!add_data(&argv[i]->s, strlen(&argv[i]->s), true, arg))
+                    return false;
+                break;
+            case LO_BLOB:
+                if (!add_data(&argv[i]->blob.data, argv[i]->blob.size, false, arg))
+                    return false;
+                break;
+            case LO_MIDI:
+                memcpy(arg.m, argv[i]->m, 4);
+                break;
+            case LO_TRUE:
+            case LO_FALSE:
+            case LO_NIL:
+            case LO_INFINITUM:
+                break;
+            default:
+                fmt::print("[osc] [{}] unsupported OSC type: '{}'\n", __FUNCTION__, t);
+                rec.types[i] = LO_FALSE;
+                break;
+            }
+        }
+
+        return true;
+    }
+
+    // fill message with allocations
+    static void fill_message(OscRecvMessage& msg, const char* path, const char* types, lo_arg** argv, int argc, const std::string& dest_types)
+    {
+        msg.setPath(path);
+
+        for (int i = 0; i < argc; i++) {
+            OscMessageAtom atom;
+            const auto t = dest_types.empty() ? types[i] : dest_types[i];
+
+            if (t != types[i]) {
+                if (is_string_type(t)) {
                     atom = std::string(&argv[i]->s);
-                    break;
-                case LO_SYMBOL:
-                    atom = std::string(&argv[i]->S);
-                    break;
-                case LO_MIDI:
-                    atom = OscMessageMidi { argv[i]->m };
-                    break;
-                case LO_NIL:
-                    atom = OscMessageSpec::NIL;
-                    break;
-                case LO_INFINITUM:
-                    atom = OscMessageSpec::INF;
-                    break;
-                case LO_CHAR:
-                    atom = static_cast<char>(argv[i]->c);
-                    break;
-                case LO_BLOB:
-                    atom = OscMessageBlob(argv[i]->blob.size, &argv[i]->blob.data);
-                    break;
-                default:
-                    fmt::print("[osc] [{}] unsupported OSC type: '{}'\n", __FUNCTION__, t);
-                    break;
+                } else {
+                    const auto v = numeric_value(types[i], argv[i]);
+                    switch (t) {
+                    case LO_INT32:
+                        atom = static_cast<int32_t>(v);
+                        break;
+                    case LO_INT64:
+                        atom = static_cast<int64_t>(v);
+                        break;
+                    case LO_FLOAT:
+                        atom = static_cast<float>(v);
+                        break;
+                    default:
+                        atom = v;
+                        break;
+                    }
                 }
 
                 msg.add(atom);
+                continue;
+            }
+
+            switch (t) {
+            case LO_FLOAT:
+                atom = argv[i]->f;
+                break;
+            case LO_DOUBLE:
+                atom = argv[i]->d;
+                break;
+            case LO_TRUE:
+                atom = true;
+                break;
+            case LO_FALSE:
+                atom = false;
+                break;
+            case LO_INT32:
+                atom = argv[i]->i32;
+                break;
+            case LO_INT64:
+                atom = argv[i]->i64;
+                break;
+            case LO_STRING:
+                atom = std::string(&argv[i]->s);
+                break;
+            case LO_SYMBOL:
+                atom = std::string(&argv[i]->S);
+                break;
+            case LO_MIDI:
+                atom = OscMessageMidi { argv[i]->m };
+                break;
+            case LO_NIL:
+                atom = OscMessageSpec::NIL;
+                break;
+            case LO_INFINITUM:
+                atom = OscMessageSpec::INF;
+                break;
+            case LO_CHAR:
+                atom = static_cast<char>(argv[i]->c);
+                break;
+            case LO_BLOB:
+                atom = OscMessageBlob(argv[i]->blob.size, &argv[i]->blob.data);
+                break;
+            default:
+                fmt::print("[osc] [{}] unsupported OSC type: '{}'\n", __FUNCTION__, t);
+                break;
+            }
+
+            msg.add(atom);
+        }
+    }
+
+    bool OscMessageRecord::isInf() const
+    {
+        if (ext)
+            return ext->isSpec() && boost::get<OscMessageSpec>(ext->atoms()[0]) == OscMessageSpec::INF;
+        else
+            return argc == 1 && types[0] == 'I';
+    }
+
+    void OscMessageRecord::appendTo(AtomList32& res) const
+    {
+        if (ext) {
+            AtomList lst;
+            OscAtomVisitor visitor(lst);
+            for (auto& a : ext->atoms())
+                boost::apply_visitor(visitor, a);
+
+            for (auto& a : lst)
+                res.push_back(a);
+
+            return;
+        }
+
+        for (size_t i = 0; i < argc; i++) {
+            auto& a = args[i];
+
+            switch (types[i]) {
+            case LO_FLOAT:
+                res.push_back(Atom(a.f));
+                break;
+            case LO_DOUBLE:
+                res.push_back(Atom(a.d));
+                break;
+            case LO_INT32:
+                res.push_back(Atom(a.i));
+                break;
+            case LO_INT64:
+                res.push_back(Atom(a.h));
+                break;
+            case LO_TRUE:
+                res.push_back(Atom(1));
+                break;
+            case LO_FALSE:
+                res.push_back(Atom(0.));
+                break;
+            case LO_CHAR: {
+                char buf[2] = { static_cast<char>(a.i), '\0' };
+                res.push_back(gensym(buf));
+            } break;
+            case LO_STRING:
+            case LO_SYMBOL:
+                res.push_back(gensym(data + a.data.offset));
+                break;
+            case LO_BLOB:
+                for (size_t j = 0; j < a.data.size; j++)
+                    res.push_back(Atom(static_cast<int>(data[a.data.offset + j])));
+                break;
+            case LO_MIDI:
+                for (int j = 0; j < 4; j++)
+                    res.push_back(Atom(a.m[j]));
+                break;
+            case LO_NIL:
+                res.push_back(gensym("null"));
+                break;
+            case LO_INFINITUM:
+                res.push_back(gensym("inf"));
+                break;
+            default:
+                break;
             }
+        }
+    }
+
+    OscMethodSubscriber::OscMethodSubscriber(SubscriberId id, const char* types, OscMethodFn fn)
+        : id_(id)
+        , fn_(fn)
+        , ring_(nullptr)
+        , types_(types ? types : "")
+    {
+    }
+
+    OscMethodSubscriber::OscMethodSubscriber(SubscriberId id, const char* types, OscMessageRing* ring)
+        : id_(id)
+        , ring_(ring)
+        , types_(types ? types : "")
+    {
+    }
+
+    void OscMethodSubscriber::notify(const char* path, const char* types, lo_arg** argv, int argc, OscTimeTag time, OscDispatchStat& stat)
+    {
+        if (!types_.empty() && !can_coerce_types(types, types_))
+            return;
+
+        if (ring_) {
+            auto rec = ring_->beginWrite();
+            if (!rec) {
+                stat.dropped++;
+                return;
+            }
+
+            if (!fill_record(*rec, path, types, argv, argc, types_)) {
+                // rare oversized message: decode with allocations
+                rec->ext = std::make_shared<OscRecvMessage>();
+                fill_message(*rec->ext, path, types, argv, argc, types_);
+            }
+
+            rec->time = time;
+            ring_->commitWrite();
+            stat.queued++;
+            Dispatcher::instance().send({ id_, 0 });
+        } else if (fn_) {
+            OscRecvMessage msg;
+            fill_message(msg, path, types, argv, argc, types_);
+            msg.setTime(time);
+
+            if (fn_(msg))
+                stat.queued++;
+            else
+                stat.dropped++;
 
-            fn_(msg);
             Dispatcher::instance().send({ id_, 0 });
         }
     }
@@ -194,33 +479,35 @@ namespace osc {
     {
     }
 
-    OscServerSubscriberList::OscServerSubscriberList(SubscriberId id, OscMethodFn fn)
+    OscServerSubscriberList::OscServerSubscriberList(const OscMethodSubscriber& sub)
     {
         MutexLock g(mutex_);
-        subscribers_.emplace_front(id, fn);
+        subscribers_.push_front(sub);
     }
 
-    void OscServerSubscriberList::notifyAll(const char* path, const char* types, lo_arg** argv, int argc)
+    void OscServerSubscriberList::notifyAll(const char* path, const char* types, lo_arg** argv, int argc, OscTimeTag time, OscDispatchStat& stat)
     {
         MutexLock g(mutex_);
 
         for (auto& s : subscribers_)
-            s.notify(path, types, argv, argc);
+            s.notify(path, types, argv, argc, time, stat);
     }
 
-    void OscServerSubscriberList::subscribe(SubscriberId id, OscMethodFn fn)
+    void OscServerSubscriberList::subscribe(const OscMethodSubscriber& sub)
     {
         MutexLock g(mutex_);
 
+        const auto id = sub.id();
+
         auto it = std::find_if(
             subscribers_.begin(),
             subscribers_.end(),
             [id](const OscMethodSubscriber& m) { return m.id() == id; });
 
         if (it != subscribers_.end()) {
-            *it = { id, fn };
+            *it = sub;
         } else {
-            subscribers_.emplace_front(id, fn);
+            subscribers_.push_front(sub);
         }
     }
 
@@ -292,6 +579,7 @@ namespace osc {
     OscServer::OscServer(const char* name, int port, OscProto proto)
         : name_(name)
         , name_hash_(crc32_hash(name_))
+        , rebuild_([this]() { rebuildDispatchTree(); })
         , lo_(nullptr)
     {
         auto lo_proto = oscProtoToLiblo(proto);
@@ -304,25 +592,23 @@ namespace osc {
             lo_ = lo_server_thread_new_with_proto(str_port.c_str(), lo_proto, errorHandler);
         }
 
+        init();
+
         OscServerLogger::instance().print(fmt::format("server created: \"{}\" at {}", name_, hostname()).c_str());
     }
 
     OscServer::OscServer(const char* name, const char* url)
         : name_(name)
         , name_hash_(crc32_hash(name_))
+        , rebuild_([this]() { rebuildDispatchTree(); })
         , lo_(lo_server_thread_new_from_url(url, errorHandler))
     {
+        init();
+
         if (lo_)
             OscServerLogger::instance().print(fmt::format("server created: \"{}\" at {}", name_, hostname()).c_str());
     }
 
-    OscServer::OscServer(OscServer&& srv)
-        : name_(std::move(srv.name_))
-        , name_hash_(std::move(srv.name_hash_))
-        , lo_(std::move(srv.lo_))
-    {
-    }
-
     OscServer::~OscServer()
     {
         const auto host = hostname();
@@ -365,25 +651,27 @@ namespace osc {
         return lo_ != nullptr;
     }
 
-    void OscServer::onMessage(const char* path, const char* types, lo_arg** argv, int argc)
+    void OscServer::onMessage(const char* path, const char* types, lo_arg** argv, int argc, OscTimeTag time)
     {
-        const auto hash = crc32_hash(path);
-
-        auto it = subs_.find(hash);
-        if (it == subs_.end())
+        auto tree = std::atomic_load(&dispatch_);
+        if (!tree)
             return;
 
-        if (it->second)
-            it->second->notifyAll(path, types, argv, argc);
+        OscDispatchStat stat;
+        tree->match(path, [&](OscServerSubscriberList* s) {
+            s->notifyAll(path, types, argv, argc, time, stat);
+        });
+
+        if (stat.queued)
+            queued_ += stat.queued;
+
+        if (stat.dropped)
+            dropped_ += stat.dropped;
     }
 
     void OscServer::unsubscribeMethod(const char* path, const char* types, SubscriberId id)
     {
-        if (lo_)
-            lo_server_thread_del_method(lo_, path, types);
-
-        const auto hash = crc32_hash(path);
-        auto it = subs_.find(hash);
+        auto it = subs_.find(path);
 
         if (it == subs_.end())
             return;
@@ -419,15 +707,55 @@ namespace osc {
             return -1;
     }
 
+    void OscServer::setQueueBundles(bool value)
+    {
+        if (lo_) {
+            lo_server_enable_queue(lo_server_thread_get_server(lo_), value, 1);
+            queue_bundles_ = value;
+        }
+    }
+
     void OscServer::setDumpAll(bool value)
     {
+        dump_ = value;
+    }
+
+    void OscServer::init()
+    {
+        std::atomic_store(&dispatch_, DispatchTreePtr(new DispatchTree()));
+
         if (!lo_)
             return;
 
-        if (value)
-            lo_server_thread_add_method(lo_, nullptr, nullptr, &logHandler, nullptr);
-        else
-            lo_server_thread_del_method(lo_, nullptr, nullptr);
+        // single liblo method for all paths: dispatching is done by own address tree
+        lo_server_thread_add_method(lo_, nullptr, nullptr, &dispatchHandler, this);
+    }
+
+    void OscServer::rebuildDispatchTree()
+    {
+        DispatchTreePtr tree(new DispatchTree());
+
+        for (auto& s : subs_) {
+            if (s.second)
+                const_cast<DispatchTree*>(tree.get())->insert(s.first, s.second.get());
+        }
+
+        std::atomic_store(&dispatch_, tree);
+    }
+
+    int OscServer::dispatchHandler(const char* path, const char* types, lo_arg** argv, int argc, lo_message data, void* user_data)
+    {
+        auto srv = static_cast<OscServer*>(user_data);
+        if (!srv)
+            return 1;
+
+        if (srv->dump_)
+            logHandler(path, types, argv, argc, data, nullptr);
+
+        // bundle timetag or LO_TT_IMMEDIATE for single messages
+        auto tt = lo_message_get_timestamp(data);
+        srv->onMessage(path, types, argv, argc, (OscTimeTag(tt.sec) << 32) | tt.frac);
+        return 0;
     }
 
     void OscServer::errorHandler(int num, const char* msg, const char* where)
@@ -491,25 +819,55 @@ namespace osc {
 
     void OscServer::subscribeMethod(const char* path, const char* types, SubscriberId id, OscMethodFn fn)
     {
-        const auto hash = crc32_hash(path);
-        auto it = subs_.find(hash);
+        subscribe(path, OscMethodSubscriber(id, types, fn));
+    }
+
+    void OscServer::subscribeMethod(const char* path, const char* types, SubscriberId id, OscMessageRing* ring)
+    {
+        subscribe(path, OscMethodSubscriber(id, types, ring));
+    }
+
+    void OscServer::subscribe(const char* path, const OscMethodSubscriber& sub)
+    {
+        auto it = subs_.find(path);
 
         if (it == subs_.end()) {
-            subs_[hash].reset(new OscServerSubscriberList(id, fn));
+            subs_[path].reset(new OscServerSubscriberList(sub));
+
+            if (!rebuild_.isActive())
+                rebuild_.delay(0);
         } else if (it->second) {
-            it->second->subscribe(id, fn);
+            it->second->subscribe(sub);
         }
+    }
 
-        if (lo_) {
-            auto fn = [](const char* path, const char* types, lo_arg** argv, int argc, lo_message /*data*/, void* user_data) -> int {
-                OscServer* s = static_cast<OscServer*>(user_data);
-                if (s)
-                    s->onMessage(path, types, argv, argc);
-                return 0;
-            };
-
-            lo_server_thread_add_method(lo_, path, types, fn, this);
-        }
+    OscTimeSync& OscTimeSync::instance()
+    {
+        static OscTimeSync sync;
+        return sync;
+    }
+
+    constexpr double OscTimeSync::RESYNC_MS;
+    constexpr double OscTimeSync::SMOOTH_K;
+
+    double OscTimeSync::toLogicalTime(OscTimeTag tt)
+    {
+        lo_timetag now;
+        lo_timetag_now(&now);
+
+        return toLogicalTime(tt, toMs((OscTimeTag(now.sec) << 32) | now.frac), clock_gettimesince(0));
+    }
+
+    double OscTimeSync::toLogicalTime(OscTimeTag tt, double now, double logicalNow)
+    {
+        const double offset = now - logicalNow;
+        if (!init_ || std::abs(offset - offset_) > RESYNC_MS) {
+            offset_ = offset;
+            init_ = true;
+        } else
+            offset_ += (offset - offset_) * SMOOTH_K;
+
+        return toMs(tt) - offset_;
     }
 
     OscServerList::OscServerList()
@@ -15,15 +15,21 @@
 #define CEAMMC_OSC_H
 
 #include "ceammc_atomlist.h"
+#include "ceammc_clock.h"
+#include "ceammc_containers.h"
 #include "ceammc_datatypes.h"
 #include "ceammc_log.h"
 #include "ceammc_notify.h"
+#include "ceammc_osc_trie.h"
 #include "readerwriterqueue.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <forward_list>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -76,6 +82,11 @@ namespace osc {
 
     using OscMessageAtom = boost::variant<bool, char, int32_t, int64_t, float, double, std::string, OscMessageMidi, OscMessageSpec, OscMessageBlob>;
     using OscMethodHash = std::uint32_t;
+    // 64-bit NTP timetag: seconds since 1900 in the high word, fraction in the low word
+    using OscTimeTag = std::uint64_t;
+
+    // special timetag value from OSC spec: 'process immediately'
+    constexpr OscTimeTag OSC_TIME_IMMEDIATE = 1;
 
     class OscRecvMessage {
     public:
@@ -91,9 +102,13 @@ namespace osc {
         const OscMessageAtom& operator[](size_t n) const { return atoms_[n]; }
         void setPath(const char* path) { path_ = path; }
         const std::string& path() const { return path_; }
+        void setTime(OscTimeTag t) { time_ = t; }
+        OscTimeTag time() const { return time_; }
+        bool isImmediate() const { return time_ == OSC_TIME_IMMEDIATE; }
 
     private:
         std::string path_;
+        OscTimeTag time_ { OSC_TIME_IMMEDIATE };
         boost::container::small_vector<OscMessageAtom, 4> atoms_;
     };
 
@@ -119,6 +134,204 @@ namespace osc {
 
     using OscMethodFn = std::function<bool(const OscRecvMessage&)>;
 
+    /**
+     * Fixed size decoded message: filled in the worker thread without allocations,
+     * path, strings and blobs are stored in the inline data pool.
+     * Messages that do not fit (more than MAX_ARGS arguments or DATA_SIZE bytes)
+     * are decoded into the heap allocated OscRecvMessage instead.
+     * Atoms are created in the main thread (symbols can't be created in the worker thread)
+     */
+    struct OscMessageRecord {
+        static constexpr size_t MAX_ARGS = 32;
+        static constexpr size_t DATA_SIZE = 512;
+
+        union Arg {
+            int32_t i;
+            int64_t h;
+            float f;
+            double d;
+            uint8_t m[4];
+            // strings (null-terminated) and blobs in data pool
+            struct {
+                uint16_t offset;
+                uint16_t size;
+            } data;
+        };
+
+        OscTimeTag time;
+        uint16_t argc;
+        char types[MAX_ARGS];
+        Arg args[MAX_ARGS];
+        // path is at zero offset
+        char data[DATA_SIZE];
+        // oversized message, all other fields except time are not used
+        std::shared_ptr<OscRecvMessage> ext;
+
+        const char* path() const { return ext ? ext->path().c_str() : data; }
+        bool isImmediate() const { return time == OSC_TIME_IMMEDIATE; }
+        bool isMidi() const { return ext ? ext->isMidi() : (argc == 1 && types[0] == 'm'); }
+        bool isBlob() const { return ext ? ext->isBlob() : (argc == 1 && types[0] == 'b'); }
+        bool isSpec() const { return ext ? ext->isSpec() : (argc == 1 && (types[0] == 'N' || types[0] == 'I')); }
+        bool isInf() const;
+
+        /** append decoded atoms to the list */
+        void appendTo(AtomList32& res) const;
+    };
+
+    /**
+     * Preallocated lock-free single producer (worker thread), single consumer (main thread)
+     * ring of message records
+     */
+    class OscMessageRing {
+        std::vector<OscMessageRecord> slots_;
+        size_t mask_;
+        std::atomic<size_t> head_ { 0 };
+        std::atomic<size_t> tail_ { 0 };
+
+    public:
+        /**
+         * @param capacity - rounded to the power of two
+         */
+        explicit OscMessageRing(size_t capacity)
+        {
+            size_t n = 1;
+            while (n < capacity)
+                n <<= 1;
+
+            slots_.resize(n);
+            mask_ = n - 1;
+        }
+
+        size_t capacity() const { return slots_.size(); }
+        size_t size() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+
+        /**
+         * get slot for writing
+         * @return nullptr if ring is full
+         * @note called from worker thread
+         */
+        OscMessageRecord* beginWrite()
+        {
+            const auto t = tail_.load(std::memory_order_relaxed);
+            if (t - head_.load(std::memory_order_acquire) == slots_.size())
+                return nullptr;
+
+            return &slots_[t & mask_];
+        }
+
+        /** publish written slot */
+        void commitWrite() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+        /**
+         * @return nullptr if ring is empty
+         * @note called from main thread
+         */
+        const OscMessageRecord* front() const
+        {
+            const auto h = head_.load(std::memory_order_relaxed);
+            if (h == tail_.load(std::memory_order_acquire))
+                return nullptr;
+
+            return &slots_[h & mask_];
+        }
+
+        /** release front slot, oversized message is freed here, in the main thread */
+        void pop()
+        {
+            const auto h = head_.load(std::memory_order_relaxed);
+            slots_[h & mask_].ext.reset();
+            head_.store(h + 1, std::memory_order_release);
+        }
+    };
+
+    struct OscDispatchStat {
+        size_t queued { 0 };
+        size_t dropped { 0 };
+    };
+
+    /**
+     * Maps OSC timetags (wall clock) to Pd logical time.
+     * The offset between clocks is smoothed to hide the audio scheduler jitter.
+     * @note called from main thread only
+     */
+    class OscTimeSync {
+        double offset_ { 0 };
+        bool init_ { false };
+
+    public:
+        // clock offset jump threshold, when exceeded: resync without smoothing
+        static constexpr double RESYNC_MS = 500;
+        static constexpr double SMOOTH_K = 0.01;
+
+    public:
+        OscTimeSync() = default;
+        static OscTimeSync& instance();
+
+        /**
+         * convert timetag to logical time
+         * @return time in ms since Pd start, compatible with clock_gettimesince(0)
+         */
+        double toLogicalTime(OscTimeTag tt);
+
+        /**
+         * convert timetag to logical time with the given current clock values
+         * @param now - wall clock time in ms since 1900
+         * @param logicalNow - logical time in ms
+         */
+        double toLogicalTime(OscTimeTag tt, double now, double logicalNow);
+
+        /** current smoothed offset between wall clock and logical time */
+        double offset() const { return offset_; }
+
+        static double toMs(OscTimeTag tt)
+        {
+            return (tt >> 32) * 1000.0 + (tt & 0xFFFFFFFF) * (1000.0 / 4294967296.0);
+        }
+    };
+
+    /**
+     * Messages ordered by logical time, the same times are kept in arrival order
+     * @note main thread only, messages come from the worker thread via OscMessageRing
+     */
+    class OscTimedQueue {
+        struct Entry {
+            double time;
+            uint64_t seq;
+            OscMessageRecord msg;
+        };
+
+        struct Later {
+            bool operator()(const Entry& a, const Entry& b) const
+            {
+                return a.time > b.time || (a.time == b.time && a.seq > b.seq);
+            }
+        };
+
+        std::vector<Entry> heap_;
+        uint64_t seq_ { 0 };
+
+    public:
+        bool empty() const { return heap_.empty(); }
+        size_t size() const { return heap_.size(); }
+        double nextTime() const { return heap_.front().time; }
+
+        // heap storage is reused: no allocations after the queue has grown
+        void push(double t, const OscMessageRecord& m)
+        {
+            heap_.push_back({ t, seq_++, m });
+            std::push_heap(heap_.begin(), heap_.end(), Later());
+        }
+
+        void pop(OscMessageRecord& m)
+        {
+            std::pop_heap(heap_.begin(), heap_.end(), Later());
+            m = heap_.back().msg;
+            heap_.pop_back();
+        }
+
+        void clear() { heap_.clear(); }
+    };
+
     class OscAtomVisitor : public boost::static_visitor<> {
         AtomList& r_;
 
@@ -140,18 +353,25 @@ namespace osc {
     class OscMethodSubscriber {
         SubscriberId id_;
         OscMethodFn fn_;
+        OscMessageRing* ring_;
+        std::string types_;
 
     public:
-        OscMethodSubscriber(SubscriberId id, OscMethodFn fn);
+        /**
+         * @param types - expected OSC types, nullptr or empty: any types
+         */
+        OscMethodSubscriber(SubscriberId id, const char* types, OscMethodFn fn);
+        OscMethodSubscriber(SubscriberId id, const char* types, OscMessageRing* ring);
 
         SubscriberId id() const { return id_; }
+        const std::string& types() const { return types_; }
 
 #ifdef WITH_LIBLO
         /**
          * notify all method subscribers
          * @note called from worker thread
          */
-        void notify(const char* path, const char* types, lo_arg** argv, int argc);
+        void notify(const char* path, const char* types, lo_arg** argv, int argc, OscTimeTag time, OscDispatchStat& stat);
 #endif
     };
 
@@ -183,17 +403,17 @@ namespace osc {
 
     public:
         OscServerSubscriberList();
-        OscServerSubscriberList(SubscriberId id, OscMethodFn fn);
+        OscServerSubscriberList(const OscMethodSubscriber& sub);
 
 #ifdef WITH_LIBLO
         /**
          * Send to to all subscribers
          * @note called from worker thread
          */
-        void notifyAll(const char* path, const char* types, lo_arg** argv, int argc);
+        void notifyAll(const char* path, const char* types, lo_arg** argv, int argc, OscTimeTag time, OscDispatchStat& stat);
 #endif
 
-        void subscribe(SubscriberId id, OscMethodFn fn);
+        void subscribe(const OscMethodSubscriber& sub);
         void unsubscribe(SubscriberId id);
 
         void getSubscribers(std::unordered_set<SubscriberId>& s);
@@ -225,23 +445,35 @@ namespace osc {
 
     class OscServer {
         using SubscriberListPtr = std::unique_ptr<OscServerSubscriberList>;
-        using MethodSubscriberMap = std::unordered_map<OscMethodHash, SubscriberListPtr>;
+        // subscriber lists are never removed: dispatch tree can point to them
+        using MethodSubscriberMap = std::unordered_map<std::string, SubscriberListPtr>;
+        using DispatchTree = OscAddressTrie<OscServerSubscriberList*>;
+        using DispatchTreePtr = std::shared_ptr<const DispatchTree>;
 
     private:
         std::string name_;
         uint32_t name_hash_;
         MethodSubscriberMap subs_;
+        // built in main thread on new path, read in worker thread
+        DispatchTreePtr dispatch_;
+        // deferred rebuild: many paths are subscribed on patch load at once
+        ClockLambdaFunction rebuild_;
+        std::atomic_bool dump_ { false };
+        std::atomic<size_t> queued_ { 0 };
+        std::atomic<size_t> dropped_ { 0 };
         bool is_running_ { false };
+        bool queue_bundles_ { true };
 
         lo_server_thread lo_;
 
+        // liblo callbacks are bound to this pointer
         OscServer(const OscServer&) = delete;
+        OscServer(OscServer&&) = delete;
         OscServer& operator=(const OscServer&) = delete;
 
     public:
         OscServer(const char* name, int port, OscProto proto = OSC_PROTO_UDP);
         OscServer(const char* name, const char* url);
-        OscServer(OscServer&& srv);
         ~OscServer();
 
         const std::string& name() const { return name_; }
@@ -251,26 +483,44 @@ namespace osc {
         bool isValid() const;
         bool isRunning() const { return is_running_; }
 
+        /**
+         * if true (default), bundles with timetags in future are held by the server
+         * until their time, otherwise they are delivered immediately and should be scheduled
+         * by receivers (net.osc.receive does it in logical time)
+         */
+        void setQueueBundles(bool value);
+        bool queueBundles() const { return queue_bundles_; }
+
 #ifdef WITH_LIBLO
         // called from worker thread
-        void onMessage(const char* path, const char* types, lo_arg** argv, int argc);
+        void onMessage(const char* path, const char* types, lo_arg** argv, int argc, OscTimeTag time);
 #endif
 
         // called from main thread
         void subscribeMethod(const char* path, const char* types, SubscriberId id, OscMethodFn fn);
+        void subscribeMethod(const char* path, const char* types, SubscriberId id, OscMessageRing* ring);
         void unsubscribeMethod(const char* path, const char* types, SubscriberId id);
         void unsubscribeAll(SubscriberId id);
 
         std::string hostname() const;
         int port() const;
 
+        /** number of messages passed to subscribers */
+        size_t queuedCount() const { return queued_; }
+        /** number of messages dropped because of full subscriber queues */
+        size_t droppedCount() const { return dropped_; }
+
         void setDumpAll(bool value);
 
     private:
+        void init();
+        void subscribe(const char* path, const OscMethodSubscriber& sub);
+        void rebuildDispatchTree();
         static void errorHandler(int num, const char* msg, const char* where);
 
 #ifdef WITH_LIBLO
         static int logHandler(const char* path, const char* types, lo_arg** argv, int argc, lo_message data, void* user_data);
+        static int dispatchHandler(const char* path, const char* types, lo_arg** argv, int argc, lo_message data, void* user_data);
 #endif
     };
 
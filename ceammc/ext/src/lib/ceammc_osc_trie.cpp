@@ -0,0 +1,129 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavski. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_osc_trie.h"
+
+namespace ceammc {
+namespace osc {
+
+    namespace {
+        using It = OscStringView::const_iterator;
+
+        // [abc], [a-z], [!abc]
+        bool match_char_class(It& p, It pe, char ch)
+        {
+            // skip '['
+            ++p;
+
+            bool negate = false;
+            if (p != pe && *p == '!') {
+                negate = true;
+                ++p;
+            }
+
+            bool found = false;
+            while (p != pe && *p != ']') {
+                const char from = *p++;
+
+                if (p + 1 < pe && *p == '-' && p[1] != ']') {
+                    const char to = p[1];
+                    p += 2;
+                    if (ch >= from && ch <= to)
+                        found = true;
+                } else if (ch == from)
+                    found = true;
+            }
+
+            // skip ']'
+            if (p != pe)
+                ++p;
+
+            return found != negate;
+        }
+
+        bool match(It p, It pe, It s, It se)
+        {
+            while (p != pe) {
+                switch (*p) {
+                case '*': {
+                    while (p != pe && *p == '*')
+                        ++p;
+
+                    if (p == pe)
+                        return true;
+
+                    for (; s != se; ++s) {
+                        if (match(p, pe, s, se))
+                            return true;
+                    }
+
+                    return match(p, pe, s, se);
+                }
+                case '?':
+                    if (s == se)
+                        return false;
+
+                    ++p;
+                    ++s;
+                    break;
+                case '[':
+                    if (s == se || !match_char_class(p, pe, *s))
+                        return false;
+
+                    ++s;
+                    break;
+                case '{': {
+                    auto end = std::find(p, pe, '}');
+                    auto rest = (end == pe) ? pe : end + 1;
+                    auto alt = p + 1;
+
+                    while (true) {
+                        auto alt_end = std::find(alt, end, ',');
+                        const size_t len = alt_end - alt;
+
+                        if (size_t(se - s) >= len
+                            && std::equal(alt, alt_end, s)
+                            && match(rest, pe, s + len, se))
+                            return true;
+
+                        if (alt_end == end)
+                            return false;
+
+                        alt = alt_end + 1;
+                    }
+                }
+                default:
+                    if (s == se || *s != *p)
+                        return false;
+
+                    ++p;
+                    ++s;
+                    break;
+                }
+            }
+
+            return s == se;
+        }
+    }
+
+    bool is_pattern(const OscStringView& part)
+    {
+        return part.find_first_of("*?[{") != OscStringView::npos;
+    }
+
+    bool pattern_match(const OscStringView& pattern, const OscStringView& str)
+    {
+        return match(pattern.begin(), pattern.end(), str.begin(), str.end());
+    }
+}
+}
@@ -0,0 +1,214 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavski. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#ifndef CEAMMC_OSC_TRIE_H
+#define CEAMMC_OSC_TRIE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// we are using C++11, so
+#include <boost/utility/string_view.hpp>
+
+namespace ceammc {
+namespace osc {
+
+    using OscStringView = boost::string_view;
+
+    /**
+     * check if address part contains OSC pattern chars: '*', '?', '[', '{'
+     */
+    bool is_pattern(const OscStringView& part);
+
+    /**
+     * OSC 1.0 pattern matching of single address part (without '/')
+     * supports: '*', '?', '[abc]', '[a-z]', '[!abc]' and '{foo,bar}'
+     * @param pattern - pattern
+     * @param str - matched string
+     */
+    bool pattern_match(const OscStringView& pattern, const OscStringView& str);
+
+    /**
+     * OSC address tree with values in nodes. Address parts are stored
+     * per node: literal parts are sorted for binary search, pattern parts are
+     * checked one by one. So dispatch cost depends on address depth,
+     * not on the number of stored addresses.
+     * Both stored and looked up addresses can contain OSC patterns.
+     * @note not thread-safe: build it, then share read-only
+     */
+    template <typename T>
+    class OscAddressTrie {
+        struct Child {
+            std::string name;
+            uint32_t node;
+        };
+
+        struct Node {
+            std::vector<Child> literals; // sorted by name
+            std::vector<Child> patterns;
+            std::vector<T> values;
+        };
+
+        std::vector<Node> nodes_;
+        size_t size_ { 0 };
+
+    public:
+        OscAddressTrie()
+            : nodes_(1)
+        {
+        }
+
+        void clear()
+        {
+            nodes_.assign(1, Node());
+            size_ = 0;
+        }
+
+        /** number of stored values */
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        size_t nodeCount() const { return nodes_.size(); }
+
+        /**
+         * add value to the address
+         * @param addr - OSC address, should start with '/', can contain patterns
+         * @return false on invalid address
+         */
+        bool insert(const OscStringView& addr, const T& v)
+        {
+            if (addr.empty() || addr[0] != '/')
+                return false;
+
+            uint32_t node = 0;
+            OscStringView tail = addr.substr(1);
+
+            while (true) {
+                const auto sep = tail.find('/');
+                const auto part = tail.substr(0, sep);
+                node = findOrAddChild(node, part);
+
+                if (sep == OscStringView::npos)
+                    break;
+
+                tail = tail.substr(sep + 1);
+            }
+
+            nodes_[node].values.push_back(v);
+            size_++;
+            return true;
+        }
+
+        /**
+         * call fn(const T&) for every value matching the address
+         * @return number of matched values
+         */
+        template <typename Fn>
+        size_t match(const OscStringView& addr, Fn fn) const
+        {
+            if (addr.empty() || addr[0] != '/')
+                return 0;
+
+            return matchNode(0, addr.substr(1), fn);
+        }
+
+    private:
+        static bool nameLess(const Child& c, const OscStringView& sv) { return OscStringView(c.name) < sv; }
+
+        uint32_t findOrAddChild(uint32_t node, const OscStringView& part)
+        {
+            const bool pattern = is_pattern(part);
+
+            if (pattern) {
+                auto& pats = nodes_[node].patterns;
+                for (auto& c : pats) {
+                    if (c.name == part)
+                        return c.node;
+                }
+            } else {
+                auto& lits = nodes_[node].literals;
+                auto it = std::lower_bound(lits.begin(), lits.end(), part, nameLess);
+                if (it != lits.end() && it->name == part)
+                    return it->node;
+            }
+
+            // nodes_ reallocation invalidates references: insert after it
+            const uint32_t idx = nodes_.size();
+            nodes_.emplace_back();
+
+            Child c { part.to_string(), idx };
+            if (pattern) {
+                nodes_[node].patterns.push_back(std::move(c));
+            } else {
+                auto& lits = nodes_[node].literals;
+                auto it = std::lower_bound(lits.begin(), lits.end(), part, nameLess);
+                lits.insert(it, std::move(c));
+            }
+
+            return idx;
+        }
+
+        template <typename Fn>
+        size_t matchChild(uint32_t node, const OscStringView& tail, bool last, Fn& fn) const
+        {
+            if (last) {
+                for (auto& v : nodes_[node].values)
+                    fn(v);
+
+                return nodes_[node].values.size();
+            } else
+                return matchNode(node, tail, fn);
+        }
+
+        template <typename Fn>
+        size_t matchNode(uint32_t node, const OscStringView& addr, Fn& fn) const
+        {
+            const auto sep = addr.find('/');
+            const auto part = addr.substr(0, sep);
+            const bool last = (sep == OscStringView::npos);
+            const auto tail = last ? OscStringView() : addr.substr(sep + 1);
+
+            const auto& n = nodes_[node];
+            size_t res = 0;
+
+            if (is_pattern(part)) {
+                // pattern in incoming address: check all literals,
+                // stored patterns are matched only by exact equality
+                for (auto& c : n.literals) {
+                    if (pattern_match(part, c.name))
+                        res += matchChild(c.node, tail, last, fn);
+                }
+
+                for (auto& c : n.patterns) {
+                    if (c.name == part)
+                        res += matchChild(c.node, tail, last, fn);
+                }
+            } else {
+                auto it = std::lower_bound(n.literals.begin(), n.literals.end(), part, nameLess);
+                if (it != n.literals.end() && it->name == part)
+                    res += matchChild(it->node, tail, last, fn);
+
+                for (auto& c : n.patterns) {
+                    if (pattern_match(c.name, part))
+                        res += matchChild(c.node, tail, last, fn);
+                }
+            }
+
+            return res;
+        }
+    };
+}
+}
+
+#endif // CEAMMC_OSC_TRIE_H
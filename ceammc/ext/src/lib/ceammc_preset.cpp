@@ -12,7 +12,17 @@ extern "C" {
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace ceammc {
 
@@ -21,6 +31,7 @@ const char* Preset::SYM_PRESET_ALL = ".preset update all";
 
 PresetStorage::PresetStorage()
     : indexes_(MAX_PRESET_COUNT, PresetNameSet())
+    , dispatch_depth_(0)
 {
     SYM_PRESET_UPDATE_INDEX_ADDR = gensym(".preset index update addr");
     SYM_PRESET_INDEX_ADD = gensym(".preset index add");
@@ -178,6 +189,247 @@ static std::string makeFullPresetPath(t_canvas* c, const std::string& name)
         return name;
 }
 
+namespace {
+    /*
+     * Binary preset bank, all numbers are little endian.
+     *
+     * header:   magic "CPB1", u32 version, u32 nsymbols, u32 npresets,
+     *           u32 nvalues, u32 natoms, u32 strtab_size
+     * symbols:  u32 offset[nsymbols] into the string table
+     * strtab:   NUL-terminated strings, padded to 4 bytes
+     * presets:  { u32 name, u32 first_value, u32 nvalues }[npresets], sorted by name
+     * values:   { u32 index, u32 type, u32 selector, u32 first_atom, u32 natoms }[nvalues]
+     * atoms:    { u32 type, u32 symbol, f64 float }[natoms]
+     */
+    const char BANK_MAGIC[4] = { 'C', 'P', 'B', '1' };
+    const uint32_t BANK_VERSION = 1;
+    const uint32_t BANK_HEADER_SIZE = 4 + 6 * 4;
+    const uint32_t BANK_PRESET_SIZE = 3 * 4;
+    const uint32_t BANK_VALUE_SIZE = 5 * 4;
+    const uint32_t BANK_ATOM_SIZE = 2 * 4 + 8;
+    const uint32_t BANK_NO_SYMBOL = 0xFFFFFFFF;
+
+    enum BankAtomType : uint32_t {
+        BANK_ATOM_FLOAT = 0,
+        BANK_ATOM_SYMBOL = 1
+    };
+
+    bool is_binary_bank_path(const char* path)
+    {
+        const auto len = strlen(path);
+        return len > 4 && strcmp(path + len - 4, ".bin") == 0;
+    }
+
+    bool is_binary_bank_file(const char* path)
+    {
+        auto f = std::fopen(path, "rb");
+        if (!f)
+            return false;
+
+        char magic[4] = { 0 };
+        const bool rc = std::fread(magic, 1, 4, f) == 4 && memcmp(magic, BANK_MAGIC, 4) == 0;
+        std::fclose(f);
+        return rc;
+    }
+
+    class BankWriter {
+        std::vector<uint8_t> strtab_, presets_, values_, atoms_;
+        std::vector<uint32_t> sym_offsets_;
+        std::unordered_map<t_symbol*, uint32_t> sym_idx_;
+        uint32_t npresets_ = 0, nvalues_ = 0, natoms_ = 0;
+
+    public:
+        void addPreset(const Preset& p)
+        {
+            const auto first = nvalues_;
+            auto& data = p.data();
+            for (size_t i = 0; i < data.size(); i++) {
+                auto& m = data[i];
+                switch (m.type()) {
+                case Message::FLOAT:
+                case Message::SYMBOL:
+                    addValue(i, m.type(), nullptr, m.atomValue());
+                    break;
+                case Message::LIST:
+                    addValue(i, m.type(), nullptr, m.listValue());
+                    break;
+                case Message::ANY:
+                    addValue(i, m.type(), m.atomValue().asSymbol(), m.listValue());
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            put32(presets_, symbol(p.name()));
+            put32(presets_, first);
+            put32(presets_, nvalues_ - first);
+            npresets_++;
+        }
+
+        bool write(const char* path)
+        {
+            while (strtab_.size() % 4)
+                strtab_.push_back(0);
+
+            std::vector<uint8_t> buf;
+            buf.reserve(BANK_HEADER_SIZE + sym_offsets_.size() * 4 + strtab_.size() + presets_.size() + values_.size() + atoms_.size());
+            buf.insert(buf.end(), BANK_MAGIC, BANK_MAGIC + 4);
+            put32(buf, BANK_VERSION);
+            put32(buf, sym_offsets_.size());
+            put32(buf, npresets_);
+            put32(buf, nvalues_);
+            put32(buf, natoms_);
+            put32(buf, strtab_.size());
+
+            for (auto off : sym_offsets_)
+                put32(buf, off);
+
+            for (auto* v : { &strtab_, &presets_, &values_, &atoms_ })
+                buf.insert(buf.end(), v->begin(), v->end());
+
+            auto f = std::fopen(path, "wb");
+            if (!f)
+                return false;
+
+            const bool rc = std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+            return (std::fclose(f) == 0) && rc;
+        }
+
+    private:
+        static void put32(std::vector<uint8_t>& v, uint32_t x)
+        {
+            for (int i = 0; i < 4; i++)
+                v.push_back((x >> (i * 8)) & 0xFF);
+        }
+
+        static void put64(std::vector<uint8_t>& v, uint64_t x)
+        {
+            for (int i = 0; i < 8; i++)
+                v.push_back((x >> (i * 8)) & 0xFF);
+        }
+
+        uint32_t symbol(t_symbol* s)
+        {
+            auto it = sym_idx_.find(s);
+            if (it != sym_idx_.end())
+                return it->second;
+
+            const uint32_t idx = sym_offsets_.size();
+            sym_offsets_.push_back(strtab_.size());
+            strtab_.insert(strtab_.end(), s->s_name, s->s_name + strlen(s->s_name) + 1);
+            sym_idx_[s] = idx;
+            return idx;
+        }
+
+        void addValue(size_t idx, Message::Type t, t_symbol* sel, const AtomListView& lv)
+        {
+            put32(values_, idx);
+            put32(values_, t);
+            put32(values_, sel ? symbol(sel) : BANK_NO_SYMBOL);
+            put32(values_, natoms_);
+            put32(values_, lv.size());
+            nvalues_++;
+
+            for (auto& a : lv) {
+                double f = 0;
+                if (a.isSymbol()) {
+                    put32(atoms_, BANK_ATOM_SYMBOL);
+                    put32(atoms_, symbol(a.asT<t_symbol*>()));
+                } else {
+                    // data atoms are not supported in presets, stored as zero
+                    f = a.asFloat(0);
+                    put32(atoms_, BANK_ATOM_FLOAT);
+                    put32(atoms_, BANK_NO_SYMBOL);
+                }
+
+                uint64_t bits;
+                memcpy(&bits, &f, sizeof(bits));
+                put64(atoms_, bits);
+                natoms_++;
+            }
+        }
+    };
+
+    /**
+     * Read-only file contents: memory mapped or loaded into the buffer
+     */
+    class BankFile {
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        std::vector<uint8_t> buf_;
+#endif
+
+    public:
+        explicit BankFile(const char* path)
+        {
+#ifdef _WIN32
+            auto f = std::fopen(path, "rb");
+            if (!f)
+                return;
+
+            std::fseek(f, 0, SEEK_END);
+            const long n = std::ftell(f);
+            std::fseek(f, 0, SEEK_SET);
+
+            if (n > 0) {
+                buf_.resize(n);
+                if (std::fread(buf_.data(), 1, n, f) == size_t(n)) {
+                    data_ = buf_.data();
+                    size_ = n;
+                }
+            }
+
+            std::fclose(f);
+#else
+            const int fd = ::open(path, O_RDONLY);
+            if (fd < 0)
+                return;
+
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                auto p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    data_ = static_cast<const uint8_t*>(p);
+                    size_ = st.st_size;
+                }
+            }
+
+            ::close(fd);
+#endif
+        }
+
+        ~BankFile()
+        {
+#ifndef _WIN32
+            if (data_)
+                ::munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+        }
+
+        BankFile(const BankFile&) = delete;
+        BankFile& operator=(const BankFile&) = delete;
+
+        const uint8_t* data() const { return data_; }
+        size_t size() const { return size_; }
+
+        uint32_t u32(size_t off) const
+        {
+            auto p = data_ + off;
+            return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+        }
+
+        double f64(size_t off) const
+        {
+            const uint64_t bits = uint64_t(u32(off)) | (uint64_t(u32(off + 4)) << 32);
+            double f;
+            memcpy(&f, &bits, sizeof(f));
+            return f;
+        }
+    };
+}
+
 bool PresetStorage::write(t_canvas* c, const std::string& path) const
 {
     auto root_cnv = find_root_canvas(c);
@@ -200,6 +452,9 @@ bool PresetStorage::write(const char* path) const
         return false;
     }
 
+    if (is_binary_bank_path(path))
+        return writeBinary(path);
+
     auto bb = binbuf_new();
 
     // sort keys
@@ -263,6 +518,9 @@ bool PresetStorage::read(t_canvas* c, const std::string& path)
 
 bool PresetStorage::read(const char* path)
 {
+    if (is_binary_bank_file(path))
+        return readBinary(path);
+
     using SmallAtomList = SmallAtomListN<16>;
     using LineList = boost::container::small_vector<SmallAtomList, 64>;
     // RAII
@@ -336,6 +594,148 @@ bool PresetStorage::read(const char* path)
     return true;
 }
 
+bool PresetStorage::writeBinary(const char* path) const
+{
+    if (params_.empty()) {
+        LIB_DBG << "no presets in storage";
+        return false;
+    }
+
+    std::vector<const Preset*> presets;
+    presets.reserve(params_.size());
+    for (auto& p : params_)
+        presets.push_back(p.second.get());
+
+    std::sort(presets.begin(), presets.end(), [](const Preset* a, const Preset* b) {
+        return strcmp(a->name()->s_name, b->name()->s_name) < 0;
+    });
+
+    BankWriter bank;
+    for (auto p : presets)
+        bank.addPreset(*p);
+
+    return bank.write(path);
+}
+
+bool PresetStorage::readBinary(const char* path)
+{
+    BankFile f(path);
+    if (!f.data())
+        return false;
+
+    if (f.size() < BANK_HEADER_SIZE || memcmp(f.data(), BANK_MAGIC, 4) != 0) {
+        LIB_ERR << "not a preset bank: " << path;
+        return false;
+    }
+
+    if (f.u32(4) != BANK_VERSION) {
+        LIB_ERR << "unsupported preset bank version: " << f.u32(4);
+        return false;
+    }
+
+    const size_t nsym = f.u32(8);
+    const size_t npresets = f.u32(12);
+    const size_t nvalues = f.u32(16);
+    const size_t natoms = f.u32(20);
+    const size_t strtab_size = f.u32(24);
+
+    const size_t sym_off = BANK_HEADER_SIZE;
+    const size_t strtab_off = sym_off + nsym * 4;
+    const size_t presets_off = strtab_off + strtab_size;
+    const size_t values_off = presets_off + npresets * BANK_PRESET_SIZE;
+    const size_t atoms_off = values_off + nvalues * BANK_VALUE_SIZE;
+
+    if (atoms_off + natoms * BANK_ATOM_SIZE != f.size() || strtab_size % 4 != 0) {
+        LIB_ERR << "invalid preset bank size: " << path;
+        return false;
+    }
+
+    // resolve all symbols once
+    const auto strtab = reinterpret_cast<const char*>(f.data() + strtab_off);
+    std::vector<t_symbol*> symbols(nsym, &s_);
+    for (size_t i = 0; i < nsym; i++) {
+        const size_t off = f.u32(sym_off + i * 4);
+        if (off >= strtab_size || !memchr(strtab + off, 0, strtab_size - off)) {
+            LIB_ERR << "invalid preset bank symbol table: " << path;
+            return false;
+        }
+
+        symbols[i] = gensym(strtab + off);
+    }
+
+    auto sym_at = [&symbols](uint32_t idx) { return idx < symbols.size() ? symbols[idx] : nullptr; };
+
+    AtomList args;
+    for (size_t i = 0; i < npresets; i++) {
+        const size_t p_off = presets_off + i * BANK_PRESET_SIZE;
+        const auto name = sym_at(f.u32(p_off));
+        const size_t first_value = f.u32(p_off + 4);
+        const size_t n = f.u32(p_off + 8);
+
+        if (!name || first_value + n > nvalues) {
+            LIB_ERR << "invalid preset bank entry: " << i;
+            return false;
+        }
+
+        // as in text format: only existing presets are loaded
+        auto it = params_.find(name);
+        if (it == params_.end())
+            continue;
+
+        auto& preset = *it->second;
+
+        for (size_t j = first_value; j < first_value + n; j++) {
+            const size_t v_off = values_off + j * BANK_VALUE_SIZE;
+            const size_t idx = f.u32(v_off);
+            const auto type = static_cast<Message::Type>(f.u32(v_off + 4));
+            const auto sel = sym_at(f.u32(v_off + 8));
+            const size_t first_atom = f.u32(v_off + 12);
+            const size_t m = f.u32(v_off + 16);
+
+            if (first_atom + m > natoms) {
+                LIB_ERR << "invalid preset bank value: " << j;
+                return false;
+            }
+
+            args.clear();
+            args.reserve(m);
+            for (size_t k = first_atom; k < first_atom + m; k++) {
+                const size_t a_off = atoms_off + k * BANK_ATOM_SIZE;
+                if (f.u32(a_off) == BANK_ATOM_SYMBOL) {
+                    auto s = sym_at(f.u32(a_off + 4));
+                    args.append(s ? Atom(s) : Atom(&s_));
+                } else
+                    args.append(Atom(static_cast<t_float>(f.f64(a_off + 8))));
+            }
+
+            bool ok = false;
+            switch (type) {
+            case Message::FLOAT:
+                ok = args.size() == 1 && preset.setFloatAt(idx, args[0].asFloat());
+                break;
+            case Message::SYMBOL:
+                ok = args.size() == 1 && preset.setSymbolAt(idx, args[0].asSymbol());
+                break;
+            case Message::LIST:
+                ok = preset.setListAt(idx, args);
+                break;
+            case Message::ANY:
+                ok = sel && preset.setAnyAt(idx, sel, args);
+                break;
+            default:
+                break;
+            }
+
+            if (ok)
+                addPresetIndex(name, idx);
+            else
+                LIB_ERR << "invalid preset bank value: " << name << " [" << idx << "]";
+        }
+    }
+
+    return true;
+}
+
 AtomList PresetStorage::keys() const
 {
     AtomList res;
@@ -360,7 +760,7 @@ bool PresetStorage::hasPreset(t_symbol* name)
     return params_.find(name) != params_.end();
 }
 
-void PresetStorage::bindPreset(t_symbol* name)
+Preset* PresetStorage::bindPreset(t_symbol* name, PresetClient* client)
 {
     auto it = params_.find(name);
 
@@ -370,17 +770,32 @@ void PresetStorage::bindPreset(t_symbol* name)
         auto res = params_.insert(PresetMap::value_type(name, ptr));
         if (!res.second) {
             LIB_ERR << "can't create preset: " << name;
-            return;
+            return nullptr;
         }
 
         it = res.first;
     }
 
+    if (client)
+        clients_.push_back(client);
+
     it->second->refCountUp();
+    return it->second.get();
 }
 
-void PresetStorage::unbindPreset(t_symbol* name)
+void PresetStorage::unbindPreset(t_symbol* name, PresetClient* client)
 {
+    if (client) {
+        auto cit = std::find(clients_.begin(), clients_.end(), client);
+        if (cit != clients_.end()) {
+            // removed after dispatch
+            if (dispatch_depth_ > 0)
+                *cit = nullptr;
+            else
+                clients_.erase(cit);
+        }
+    }
+
     auto it = params_.find(name);
 
     if (it == params_.end()) {
@@ -407,7 +822,16 @@ void PresetStorage::unbindPreset(t_symbol* name)
 
 void PresetStorage::clearAll()
 {
-    params_.clear();
+    // bound presets are kept: objects refer to them
+    for (auto it = params_.begin(); it != params_.end();) {
+        if (it->second->refCount() > 0) {
+            for (auto& m : it->second->data())
+                m = Message();
+
+            ++it;
+        } else
+            it = params_.erase(it);
+    }
 
     for (auto& x : indexes_)
         x.clear();
@@ -422,6 +846,7 @@ void PresetStorage::clearAll(size_t idx)
         return;
     }
 
+    forEachClient([idx](PresetClient* c) { c->presetClear(idx); });
     pd::send_message(gensym(Preset::SYM_PRESET_ALL), gensym("clear"), Atom(idx));
 }
 
@@ -434,6 +859,7 @@ void PresetStorage::loadAll(size_t idx)
         return;
     }
 
+    forEachClient([idx](PresetClient* c) { c->presetLoad(idx); });
     pd::send_message(gensym(Preset::SYM_PRESET_ALL), gensym("load"), Atom(idx));
 }
 
@@ -446,6 +872,7 @@ void PresetStorage::storeAll(size_t idx)
         return;
     }
 
+    forEachClient([idx](PresetClient* c) { c->presetStore(idx); });
     pd::send_message(gensym(Preset::SYM_PRESET_ALL), gensym("store"), Atom(idx));
 }
 
@@ -458,11 +885,13 @@ void PresetStorage::interpAll(t_float idx)
         return;
     }
 
+    forEachClient([idx](PresetClient* c) { c->presetLoad(idx); });
     pd::send_message(gensym(Preset::SYM_PRESET_ALL), gensym("interp"), Atom(idx));
 }
 
 void PresetStorage::updateAll()
 {
+    forEachClient([](PresetClient* c) { c->presetUpdate(); });
     pd::send_message(gensym(Preset::SYM_PRESET_ALL), gensym("update"), {});
 }
 
@@ -490,6 +919,23 @@ void PresetStorage::duplicateAll()
     }
 }
 
+template <typename Fn>
+void PresetStorage::forEachClient(Fn fn)
+{
+    // clients bound while dispatching are not called
+    const size_t N = clients_.size();
+
+    dispatch_depth_++;
+    for (size_t i = 0; i < N; i++) {
+        auto c = clients_[i];
+        if (c)
+            fn(c);
+    }
+
+    if (--dispatch_depth_ == 0)
+        clients_.erase(std::remove(clients_.begin(), clients_.end(), nullptr), clients_.end());
+}
+
 PresetPtr PresetStorage::getOrCreate(t_symbol* name)
 {
     auto it = params_.find(name);
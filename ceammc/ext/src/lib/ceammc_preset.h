@@ -56,6 +56,24 @@ public:
 
 typedef std::shared_ptr<Preset> PresetPtr;
 
+/**
+ * Preset object called directly by PresetStorage on loadAll(), interpAll(), storeAll(),
+ * clearAll(idx) and updateAll(), instead of receiving a message sent to Preset::SYM_PRESET_ALL.
+ * Calls can bind or unbind other clients.
+ */
+class PresetClient {
+public:
+    virtual ~PresetClient() = default;
+
+    /**
+     * Load preset value, on interpAll() index is fractional
+     */
+    virtual void presetLoad(t_float idx) = 0;
+    virtual void presetStore(size_t idx) = 0;
+    virtual void presetClear(size_t idx) = 0;
+    virtual void presetUpdate() = 0;
+};
+
 class PresetStorage {
     PresetStorage();
     PresetStorage(const PresetStorage&);
@@ -67,6 +85,9 @@ private:
     typedef std::vector<PresetNameSet> IndexMap;
     PresetMap params_;
     IndexMap indexes_;
+    // called in bind order, unbound during dispatch are set to null and removed after
+    std::vector<PresetClient*> clients_;
+    int dispatch_depth_;
 
 public:
     static PresetStorage& instance();
@@ -90,18 +111,41 @@ public:
     bool hasValueTypeAt(t_symbol* name, Message::Type t, size_t presetIdx) const;
     bool hasFloatValueAt(t_symbol* name, size_t presetIdx);
 
+    /**
+     * Write presets, files with .bin extension are written as binary bank
+     */
     bool write(t_canvas* c, const std::string& path) const;
     bool write(const char* path) const;
+
+    /**
+     * Read presets, binary banks are recognized by contents
+     */
     bool read(t_canvas* c, const std::string& path);
     bool read(const char* path);
 
+    /**
+     * Binary bank: indexed file with the symbol table and values stored in flat arrays,
+     * read with mmap() when possible, without parsing text
+     */
+    bool writeBinary(const char* path) const;
+    bool readBinary(const char* path);
+
     AtomList keys() const;
     bool hasIndex(size_t sz) const;
 
     bool hasPreset(t_symbol* name);
-    void bindPreset(t_symbol* name);
-    void unbindPreset(t_symbol* name);
 
+    /**
+     * Increase preset ref count, creating it if not exists
+     * @param client - if not null, called by batched methods
+     * @return preset pointer, valid until unbind
+     */
+    Preset* bindPreset(t_symbol* name, PresetClient* client = nullptr);
+    void unbindPreset(t_symbol* name, PresetClient* client = nullptr);
+
+    /**
+     * Removes all presets data, unbound presets are removed
+     */
     void clearAll();
     void clearAll(size_t idx);
     void loadAll(size_t idx);
@@ -116,6 +160,9 @@ public:
     t_symbol* SYM_PRESET_INDEX_REMOVE;
 
 private:
+    template <typename Fn>
+    void forEachClient(Fn fn);
+
     PresetPtr getOrCreate(t_symbol* name);
     void addPresetIndex(t_symbol* name, size_t idx);
     void removePresetIndex(t_symbol* name, size_t idx);
@@ -0,0 +1,356 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_sound_stream.h"
+
+#include "atomicops.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ceammc {
+namespace sound {
+
+    constexpr size_t SoundHeadCache::HEAD_FRAMES;
+    constexpr size_t SoundHeadCache::DEFAULT_MAX_BYTES;
+
+    static size_t next_pow2(size_t n)
+    {
+        size_t res = 1;
+        while (res < n)
+            res <<= 1;
+
+        return res;
+    }
+
+    FrameRing::FrameRing(size_t nch, size_t capacity)
+        : nch_(std::max<size_t>(1, nch))
+        , mask_(next_pow2(std::max<size_t>(1, capacity)) - 1)
+    {
+        buf_.assign(nch_ * (mask_ + 1), 0);
+    }
+
+    size_t FrameRing::readAvailable() const
+    {
+        return wr_.load(std::memory_order_acquire) - rd_.load(std::memory_order_relaxed);
+    }
+
+    size_t FrameRing::writeAvailable() const
+    {
+        return capacity() - (wr_.load(std::memory_order_relaxed) - rd_.load(std::memory_order_acquire));
+    }
+
+    size_t FrameRing::write(const float* frames, size_t n)
+    {
+        const auto wr = wr_.load(std::memory_order_relaxed);
+        n = std::min(n, writeAvailable());
+
+        // at most two contiguous parts
+        const auto pos = wr & mask_;
+        const auto n0 = std::min(n, capacity() - pos);
+        std::memcpy(&buf_[pos * nch_], frames, n0 * nch_ * sizeof(float));
+        std::memcpy(&buf_[0], frames + n0 * nch_, (n - n0) * nch_ * sizeof(float));
+
+        wr_.store(wr + n, std::memory_order_release);
+        return n;
+    }
+
+    size_t FrameRing::read(t_sample** out, size_t nout, size_t n)
+    {
+        const auto rd = rd_.load(std::memory_order_relaxed);
+        n = std::min(n, readAvailable());
+
+        const auto NCH = std::min(nout, nch_);
+        for (size_t i = 0; i < n; i++) {
+            const float* frame = &buf_[((rd + i) & mask_) * nch_];
+
+            for (size_t c = 0; c < NCH; c++)
+                out[c][i] = frame[c];
+
+            for (size_t c = NCH; c < nout; c++)
+                out[c][i] = 0;
+        }
+
+        rd_.store(rd + n, std::memory_order_release);
+        return n;
+    }
+
+    void FrameRing::dropUntil(size_t pos)
+    {
+        const auto rd = rd_.load(std::memory_order_relaxed);
+        const auto wr = wr_.load(std::memory_order_acquire);
+
+        // the counters only grow
+        if (pos > rd)
+            rd_.store(std::min(pos, wr), std::memory_order_release);
+    }
+
+    StreamTask::~StreamTask() = default;
+
+    StreamPool::StreamPool(size_t nthreads)
+        : next_(tasks_.end())
+        , sema_(new moodycamel::spsc_sema::LightweightSemaphore)
+    {
+        for (size_t i = 0; i < std::max<size_t>(1, nthreads); i++)
+            workers_.emplace_back([this]() { run(); });
+    }
+
+    StreamPool::~StreamPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            quit_ = true;
+        }
+
+        cv_work_.notify_all();
+        sema_->signal(workers_.size());
+
+        for (auto& w : workers_)
+            w.join();
+    }
+
+    size_t StreamPool::numTasks()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return tasks_.size();
+    }
+
+    void StreamPool::add(StreamTask* task)
+    {
+        if (!task)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            tasks_.push_back({ task, false });
+        }
+
+        cv_work_.notify_one();
+        sema_->signal();
+    }
+
+    void StreamPool::remove(StreamTask* task)
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+
+        auto it = std::find_if(tasks_.begin(), tasks_.end(), [task](const Entry& e) { return e.task == task; });
+        if (it == tasks_.end())
+            return;
+
+        cv_idle_.wait(lock, [it]() { return !it->busy; });
+
+        if (next_ == it)
+            ++next_;
+
+        tasks_.erase(it);
+    }
+
+    void StreamPool::notify()
+    {
+        sema_->signal(workers_.size());
+    }
+
+    void StreamPool::wakeup()
+    {
+        sema_->signal();
+    }
+
+    StreamTask* StreamPool::acquireTask()
+    {
+        // round robin, starting after the last taken task
+        for (size_t i = 0; i < tasks_.size(); i++) {
+            if (next_ == tasks_.end())
+                next_ = tasks_.begin();
+
+            auto it = next_++;
+            if (!it->busy) {
+                it->busy = true;
+                return it->task;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void StreamPool::releaseTask(StreamTask* task)
+    {
+        for (auto& e : tasks_) {
+            if (e.task == task) {
+                e.busy = false;
+                break;
+            }
+        }
+
+        cv_idle_.notify_all();
+    }
+
+    void StreamPool::run()
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        size_t idle_count = 0;
+
+        while (!quit_) {
+            if (tasks_.empty()) {
+                cv_work_.wait(lock, [this]() { return quit_ || !tasks_.empty(); });
+                idle_count = 0;
+                continue;
+            }
+
+            // all tasks were visited without any work done
+            if (idle_count >= tasks_.size()) {
+                idle_count = 0;
+
+                lock.unlock();
+                sema_->wait();
+                lock.lock();
+                continue;
+            }
+
+            auto task = acquireTask();
+            if (!task) {
+                idle_count = tasks_.size();
+                continue;
+            }
+
+            lock.unlock();
+            const bool done = task->process();
+            lock.lock();
+
+            releaseTask(task);
+            idle_count = done ? 0 : idle_count + 1;
+        }
+    }
+
+    StreamPool& StreamPool::instance()
+    {
+        static StreamPool pool(std::min<size_t>(4, std::max<size_t>(1, std::thread::hardware_concurrency() / 2)));
+        return pool;
+    }
+
+    size_t SoundHead::readFrames(float* dest, size_t n, std::int64_t pos) const
+    {
+        const auto NFRAMES = static_cast<std::int64_t>(frameCount());
+
+        if (pos < offset || pos >= offset + NFRAMES)
+            return 0;
+
+        n = std::min<size_t>(n, offset + NFRAMES - pos);
+        std::memcpy(dest, &data[(pos - offset) * channels], n * channels * sizeof(float));
+        return n;
+    }
+
+    SoundHeadCache::SoundHeadCache(size_t maxBytes)
+        : max_bytes_(maxBytes)
+    {
+    }
+
+    SoundHeadPtr SoundHeadCache::find(const std::string& path, std::int64_t pos, const SoundFile& file)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+
+        for (auto it = items_.begin(); it != items_.end(); ++it) {
+            auto& h = it->head;
+            if (pos < h->offset || pos >= h->offset + static_cast<std::int64_t>(h->frameCount()) || it->path != path)
+                continue;
+
+            if (h->channels != file.channels()
+                || h->samplerate != file.sampleRate()
+                || h->file_frames != file.frameCount()) {
+                // the file was changed
+                bytes_ -= h->data.size() * sizeof(float);
+                items_.erase(it);
+                return nullptr;
+            }
+
+            // move to front
+            items_.splice(items_.begin(), items_, it);
+            return items_.front().head;
+        }
+
+        return nullptr;
+    }
+
+    SoundHeadPtr SoundHeadCache::load(SoundFile& file, const std::string& path, std::int64_t offset, size_t frames)
+    {
+        auto head = find(path, offset, file);
+        if (head)
+            return head;
+
+        if (!file.isOpened() || file.channels() == 0)
+            return nullptr;
+
+        // read outside of the lock
+        std::shared_ptr<SoundHead> h(new SoundHead);
+        h->channels = file.channels();
+        h->samplerate = file.sampleRate();
+        h->file_frames = file.frameCount();
+        h->offset = offset;
+        h->data.resize(frames * h->channels);
+
+        size_t total = 0;
+        while (total < frames) {
+            auto n = file.readFrames(h->data.data() + total * h->channels, frames - total, offset + total);
+            if (n < 0)
+                return nullptr;
+            else if (n == 0)
+                break;
+
+            total += n;
+        }
+
+        h->data.resize(total * h->channels);
+        h->data.shrink_to_fit();
+
+        const auto NBYTES = h->data.size() * sizeof(float);
+        if (NBYTES > max_bytes_)
+            return h;
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        items_.push_front({ path, h });
+        bytes_ += NBYTES;
+
+        // evict least recently used
+        while (bytes_ > max_bytes_ && !items_.empty()) {
+            bytes_ -= items_.back().head->data.size() * sizeof(float);
+            items_.pop_back();
+        }
+
+        return h;
+    }
+
+    void SoundHeadCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        items_.clear();
+        bytes_ = 0;
+    }
+
+    size_t SoundHeadCache::size()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return items_.size();
+    }
+
+    size_t SoundHeadCache::bytes()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return bytes_;
+    }
+
+    SoundHeadCache& SoundHeadCache::instance()
+    {
+        static SoundHeadCache cache;
+        return cache;
+    }
+}
+}
@@ -0,0 +1,234 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#ifndef CEAMMC_SOUND_STREAM_H
+#define CEAMMC_SOUND_STREAM_H
+
+#include "ceammc_sound.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace moodycamel {
+namespace spsc_sema {
+    class LightweightSemaphore;
+}
+}
+
+namespace ceammc {
+namespace sound {
+
+    /**
+     * Single producer/single consumer ring buffer of interleaved multichannel frames.
+     * Written by a stream worker, read by the DSP thread a block at a time.
+     */
+    class FrameRing {
+        std::vector<float> buf_;
+        size_t nch_;
+        size_t mask_;
+        std::atomic<size_t> rd_ { 0 }; // only grows, changed by the reader
+        std::atomic<size_t> wr_ { 0 }; // only grows, changed by the writer
+
+    public:
+        /**
+         * @param nch - number of channels
+         * @param capacity - capacity in frames, rounded up to the power of 2
+         */
+        FrameRing(size_t nch, size_t capacity);
+
+        size_t channels() const { return nch_; }
+        size_t capacity() const { return mask_ + 1; }
+
+        size_t readAvailable() const;
+        size_t writeAvailable() const;
+
+        /**
+         * Frame position of the next write, can be used with dropUntil()
+         * @note writer side
+         */
+        size_t writePosition() const { return wr_.load(std::memory_order_relaxed); }
+
+        /**
+         * Writes interleaved frames
+         * @return number of written frames
+         * @note writer side
+         */
+        size_t write(const float* frames, size_t n);
+
+        /**
+         * Reads frames to separate channel buffers. If there are more output channels
+         * than ring channels they are filled with zeroes
+         * @return number of frames read
+         * @note reader side
+         */
+        size_t read(t_sample** out, size_t nout, size_t n);
+
+        /**
+         * Drops all frames before given write position
+         * @note reader side
+         */
+        void dropUntil(size_t pos);
+
+        /**
+         * Drops all available frames
+         * @note reader side
+         */
+        void clear() { dropUntil(wr_.load(std::memory_order_acquire)); }
+    };
+
+    /**
+     * Interface for jobs run by StreamPool workers
+     */
+    class StreamTask {
+    public:
+        virtual ~StreamTask();
+
+        /**
+         * Does a chunk of work: decodes and writes some frames to the ring buffer etc.
+         * Should not block.
+         * @return true if any work was done, false if there was nothing to do
+         */
+        virtual bool process() = 0;
+    };
+
+    /**
+     * Worker threads shared by all disk streams. Every task is run by one worker at a time,
+     * workers go through the task list until there is nothing to do, then sleep until
+     * notify() or wakeup() is called. Without tasks workers sleep until add().
+     */
+    class StreamPool {
+        struct Entry {
+            StreamTask* task;
+            bool busy;
+        };
+
+        std::list<Entry> tasks_;
+        std::list<Entry>::iterator next_;
+        std::vector<std::thread> workers_;
+        std::mutex mtx_;
+        std::condition_variable cv_work_;
+        std::condition_variable cv_idle_;
+        std::unique_ptr<moodycamel::spsc_sema::LightweightSemaphore> sema_;
+        bool quit_ { false };
+
+    public:
+        explicit StreamPool(size_t nthreads);
+        ~StreamPool();
+
+        StreamPool(const StreamPool&) = delete;
+        StreamPool& operator=(const StreamPool&) = delete;
+
+        size_t numWorkers() const { return workers_.size(); }
+        size_t numTasks();
+
+        void add(StreamTask* task);
+
+        /**
+         * Removes task from the pool, waits if it is running
+         */
+        void remove(StreamTask* task);
+
+        /**
+         * Wakes up all workers, when some task got a new command
+         */
+        void notify();
+
+        /**
+         * Wakes up one worker, when the stream has a room for more data
+         * @note called from the audio thread: does not block, the OS semaphore is posted
+         * only when some worker is sleeping
+         */
+        void wakeup();
+
+        /**
+         * Shared pool, with half of hardware threads (at least 1, at most 4)
+         */
+        static StreamPool& instance();
+
+    private:
+        void run();
+        StreamTask* acquireTask();
+        void releaseTask(StreamTask* task);
+    };
+
+    /**
+     * Decoded soundfile fragment: N first frames, from the start position
+     */
+    struct SoundHead {
+        std::vector<float> data; // interleaved
+        size_t channels { 0 };
+        size_t samplerate { 0 };
+        size_t file_frames { 0 }; // to check if the file was not changed
+        std::int64_t offset { 0 };
+
+        size_t frameCount() const { return channels ? data.size() / channels : 0; }
+
+        /**
+         * Copies frames from the given absolute file position
+         * @return number of copied frames, 0 if position is out of range
+         */
+        size_t readFrames(float* dest, size_t n, std::int64_t pos) const;
+    };
+
+    using SoundHeadPtr = std::shared_ptr<const SoundHead>;
+
+    /**
+     * LRU cache of soundfile heads and loop points: starting or looping the stream from
+     * the cached position does not have to wait for the disk
+     */
+    class SoundHeadCache {
+        struct Item {
+            std::string path;
+            SoundHeadPtr head;
+        };
+
+        std::list<Item> items_; // most recent first
+        size_t bytes_ { 0 };
+        size_t max_bytes_;
+        std::mutex mtx_;
+
+    public:
+        static constexpr size_t HEAD_FRAMES = 32768;
+        static constexpr size_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+
+    public:
+        explicit SoundHeadCache(size_t maxBytes = DEFAULT_MAX_BYTES);
+
+        /**
+         * Returns cached head containing the given file position if it matches the opened file
+         */
+        SoundHeadPtr find(const std::string& path, std::int64_t pos, const SoundFile& file);
+
+        /**
+         * Returns cached head or decodes it from the opened file
+         * @return nullptr on error
+         */
+        SoundHeadPtr load(SoundFile& file, const std::string& path, std::int64_t offset, size_t frames = HEAD_FRAMES);
+
+        void clear();
+        size_t size();
+        size_t bytes();
+
+        static SoundHeadCache& instance();
+    };
+}
+}
+
+#endif // CEAMMC_SOUND_STREAM_H
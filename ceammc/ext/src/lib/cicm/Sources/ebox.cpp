@@ -31,6 +31,7 @@
 #include <inttypes.h>
 #include <string>
 #include <tuple>
+#include <vector>
 
 t_symbol* ceammc_realizeraute(t_canvas* cnv, t_symbol* s);
 std::string ceammc_raute2dollar(const char* s);
@@ -97,6 +98,8 @@ static void ebox_move(t_ebox* x);
 static void ebox_attrprocess_default(t_ebox* x);
 static void ebox_newzoom(t_ebox* x);
 static void elayer_free_content(t_elayer& l);
+static void redraw_queue_add(t_ebox* x);
+static void redraw_queue_remove(t_ebox* x);
 
 static const char* anchor_to_symbol(etextanchor_flags anchor)
 {
@@ -437,6 +440,7 @@ void ebox_new(t_ebox* x, long flags)
     x->b_flags = flags;
     x->b_ready_to_draw = false;
     x->b_have_window = false;
+    x->b_redraw_pending = false;
     x->b_layers = nullptr;
     x->b_receive_id = sym_null();
     x->b_send_id = sym_null();
@@ -488,6 +492,7 @@ void ebox_ready(t_ebox* x)
 
 void ebox_free(t_ebox* x)
 {
+    redraw_queue_remove(x);
     eobj_free(&x->b_obj);
     if (x->b_receive_id && x->b_receive_id != sym_null()) {
         // replace #n => $d
@@ -696,6 +701,13 @@ void ebox_wgetrect(t_gobj* z, t_glist* glist, int* xp1, int* yp1, int* xp2, int*
     *yp2 = int(*yp1 + x->b_rect.h * x->b_zoom);
 }
 
+static t_ebox_paint_hook ebox_paint_hook = nullptr;
+
+void ebox_set_paint_hook(t_ebox_paint_hook fn)
+{
+    ebox_paint_hook = fn;
+}
+
 static void ebox_paint(t_ebox* x)
 {
     layers_erase(x);
@@ -707,6 +719,9 @@ static void ebox_paint(t_ebox* x)
         return;
     }
 
+    if (ebox_paint_hook)
+        ebox_paint_hook(x);
+
     if (x->b_pinned)
         sys_vgui("::ceammc::ui::widget_lower %s %lx\n", x->b_canvas_id->s_name, x);
 
@@ -1989,8 +2004,83 @@ void ebox_dialog(t_ebox* x, t_symbol* s, int argc, t_atom* argv)
     }
 }
 
+/*
+ * Redraw queue: every box is painted at most once per frame, boxes queued
+ * during the frame are painted in one pass.
+ */
+static const double EBOX_REDRAW_FRAME_MS = 1000.0 / 60;
+
+struct t_eredraw_queue {
+    std::vector<t_ebox*> boxes;
+    std::vector<t_ebox*> painting;
+    t_clock* clock = nullptr;
+    double last_flush = 0;
+};
+
+static t_eredraw_queue& redraw_queue()
+{
+    static t_eredraw_queue queue;
+    return queue;
+}
+
+static void redraw_queue_flush(t_eredraw_queue* q)
+{
+    q->last_flush = clock_getlogicaltime();
+
+    // redraws requested while painting go to the next frame
+    q->painting.swap(q->boxes);
+
+    for (auto x : q->painting) {
+        if (!x)
+            continue;
+
+        x->b_redraw_pending = false;
+        if (ebox_isvisible(x))
+            ebox_paint(x);
+    }
+
+    q->painting.clear();
+}
+
+static void redraw_queue_add(t_ebox* x)
+{
+    auto& q = redraw_queue();
+    if (!q.clock)
+        q.clock = clock_new(&q, reinterpret_cast<t_method>(redraw_queue_flush));
+
+    x->b_redraw_pending = true;
+    q.boxes.push_back(x);
+
+    if (q.boxes.size() == 1) {
+        const double since = clock_gettimesince(q.last_flush);
+        clock_delay(q.clock, std::max<double>(0, EBOX_REDRAW_FRAME_MS - since));
+    }
+}
+
+static void redraw_queue_remove(t_ebox* x)
+{
+    if (!x->b_redraw_pending)
+        return;
+
+    x->b_redraw_pending = false;
+
+    auto& q = redraw_queue();
+    for (auto* v : { &q.boxes, &q.painting })
+        std::replace(v->begin(), v->end(), x, static_cast<t_ebox*>(nullptr));
+}
+
 void ebox_redraw(t_ebox* x)
 {
+    if (x->b_redraw_pending || !ebox_isvisible(x))
+        return;
+
+    redraw_queue_add(x);
+}
+
+void ebox_redraw_now(t_ebox* x)
+{
+    redraw_queue_remove(x);
+
     if (ebox_isvisible(x))
         ebox_paint(x);
 }
@@ -147,11 +147,29 @@ void ebox_set_cursor(t_ebox* x, t_cursor cursor);
 /*!
  * \fn      void ebox_redraw(t_ebox* x)
  * \brief   Notifies the t_ebox that it should be redrawn.
+ * \details The box is painted once on the next redraw frame, so several redraws
+ *          requested during the frame interval cost a single paint. All boxes queued
+ *          in the same frame are painted in one pass.
  * \param x The t_ebox pointer.
- * \todo optimize gensym
+ * \see ebox_redraw_now
  */
 void ebox_redraw(t_ebox* x);
 
+/*!
+ * \fn      void ebox_redraw_now(t_ebox* x)
+ * \brief   Paints the t_ebox immediately, the queued redraw is cancelled.
+ * \param x The t_ebox pointer.
+ */
+void ebox_redraw_now(t_ebox* x);
+
+/*!
+ * \fn      void ebox_set_paint_hook(t_ebox_paint_hook fn)
+ * \brief   Sets the function called on every t_ebox paint, for tests and benchmarks.
+ * \param fn The hook function, NULL to remove.
+ */
+typedef void (*t_ebox_paint_hook)(t_ebox* x);
+void ebox_set_paint_hook(t_ebox_paint_hook fn);
+
 /*!
  * \fn      void ebox_get_rect_for_view(t_ebox* x, t_rect *rect)
  * \brief   Retrieves the rectangle of the t_ebox.
@@ -759,6 +759,7 @@ struct t_ebox {
     bool b_visible; /*!< The visible state. */
     bool b_ready_to_draw; /*!< The ebox state for drawing. */
     bool b_have_window; /*!< The ebox window state. */
+    bool b_redraw_pending; /*!< The ebox is queued for redraw. */
     bool b_isinsubcanvas; /*!< If the box is in a sub canvas. */
     t_cursor cursor;
 
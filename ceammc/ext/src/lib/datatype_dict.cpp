@@ -20,7 +20,6 @@
 #include "ceammc_json.h"
 #include "ceammc_log.h"
 #include "ceammc_string.h"
-#include "datatype_json.h"
 #include "fmt/core.h"
 
 #include <ctime>
@@ -63,6 +62,7 @@ DataTypeDict::DataTypeDict(const std::string& str)
 
 DataTypeDict::DataTypeDict(std::initializer_list<DictKeyValue> pairs)
 {
+    dict_.reserve(pairs.size());
     for (auto& p : pairs)
         dict_.insert(p);
 }
@@ -187,12 +187,7 @@ bool DataTypeDict::operator==(const DataTypeDict& d) const noexcept
 
 void DataTypeDict::removeIf(std::function<bool(t_symbol*)> key_pred)
 {
-    for (auto it = dict_.cbegin(); it != dict_.cend(); /* increment in loop body */) {
-        if (key_pred(it->first))
-            it = dict_.erase(it);
-        else
-            ++it;
-    }
+    dict_.erase_if([&key_pred](const DictKeyValue& kv) { return key_pred(kv.first); });
 }
 
 AtomList DataTypeDict::keys() const
@@ -261,22 +256,17 @@ MaybeString DataTypeDict::toJSON(int indent, bool compressSingleList) const
 
 bool DataTypeDict::fromJSON(const std::string& str)
 {
-    using json = nlohmann::json;
-    try {
-
-        json j = json::parse(str);
-
-        if (j.empty())
-            return false;
-
-        dict_.clear();
-        dict_ = j.get<decltype(dict_)>();
-
-    } catch (json::exception& e) {
-        std::cerr << "[dict] JSON exception: " << e.what() << ", while parsing: " << str;
+    DataTypeDict res;
+    std::string err;
+    if (!json::from_json_string(str, res, err)) {
+        std::cerr << "[dict] JSON exception: " << err << ", while parsing: " << str;
         return false;
     }
 
+    if (res.size() == 0)
+        return false;
+
+    dict_ = std::move(res.dict_);
     return true;
 }
 
@@ -322,12 +312,7 @@ bool DataTypeDict::choose(Atom& key) const noexcept
     const auto N = dict_.size();
     std::mt19937 gen(time(0));
     const auto offset = std::uniform_int_distribution<size_t>(0, N - 1)(gen);
-    auto it = dict_.begin();
-
-    for (size_t i = 0; i < offset; i++)
-        ++it;
-
-    key = it->first;
+    key = (dict_.begin() + offset)->first;
     return true;
 }
 
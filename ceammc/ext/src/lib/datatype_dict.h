@@ -16,9 +16,10 @@
 
 #include "ceammc_abstractdata.h"
 #include "ceammc_atomlist.h"
+#include "ceammc_flat_map.h"
 #include "ceammc_maybe.h"
 
-#include <map>
+#include <functional>
 #include <type_traits>
 
 namespace ceammc {
@@ -27,7 +28,8 @@ using MaybeString = Maybe<std::string>;
 
 class DataTypeDict : public AbstractData {
 public:
-    using DictMap = std::map<t_symbol*, AtomList>;
+    // keys are iterated in insertion order
+    using DictMap = FlatSymbolMap<AtomList>;
     using DictKeyValue = DictMap::value_type;
 
     struct DictEntry : public DictKeyValue {
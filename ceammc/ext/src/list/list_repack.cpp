@@ -1,3 +1,4 @@
+#include "ceammc_containers.h"
 #include "ceammc_convert.h"
 #include "ceammc_factory.h"
 #include "ceammc_object.h"
@@ -29,9 +30,9 @@ public:
     {
         const size_t step = clip<size_t>(group_size_->value(), MIN_GROUP_SIZE, MAX_GROUP_SIZE);
 
-        AtomList l(lv);
+        SmallAtomList l(lv);
         for (size_t i = 0; i < l.size(); i += step) {
-            listTo(0, l.slice(i, i + step - 1, 1));
+            listTo(0, l.view().subView(i, step));
         }
 
         bangTo(1);
@@ -1,4 +1,5 @@
 #include "list_repeat.h"
+#include "ceammc_containers.h"
 #include "ceammc_factory.h"
 #include "ceammc_fn_list.h"
 #include "datatype_mlist.h"
@@ -48,12 +49,12 @@ void ListRepeat::onData(const Atom& d)
 
         atomTo(0, res);
     } else {
-        AtomList res;
+        SmallAtomList res;
 
         while (n-- > 0)
-            res.append(d);
+            res.push_back(d);
 
-        listTo(0, res);
+        listTo(0, res.view());
     }
 }
 
@@ -1,7 +1,10 @@
 #include "list_search.h"
+#include "ceammc_containers.h"
 #include "ceammc_factory.h"
 #include "datatype_mlist.h"
 
+#include <algorithm>
+
 ListSearch::ListSearch(const PdArgs& args)
     : ListBase(args)
     , subj_(args.args)
@@ -17,15 +20,15 @@ void ListSearch::parseProperties()
 
 void ListSearch::onList(const AtomListView& lv)
 {
-    AtomList l(lv); // FIX
-    AtomList idxs;
+    SmallAtomList idxs;
     idxs.reserve(subj_.size());
 
     for (size_t i = 0; i < subj_.size(); i++) {
-        idxs.append(l.findPos(subj_[i]));
+        auto it = std::find(lv.begin(), lv.end(), subj_[i]);
+        idxs.push_back(it == lv.end() ? -1 : t_float(std::distance(lv.begin(), it)));
     }
 
-    listTo(0, idxs);
+    listTo(0, idxs.view());
 }
 
 void ListSearch::onInlet(size_t n, const AtomListView& lv)
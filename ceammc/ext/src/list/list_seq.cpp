@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <cmath>
 
+#include "ceammc_containers.h"
 #include "ceammc_factory.h"
 #include "list_seq.h"
 
@@ -53,7 +54,7 @@ ListSeq::ListSeq(const PdArgs& a)
 
 void ListSeq::onBang()
 {
-    AtomList res;
+    SmallAtomList res;
     const t_float from = from_->value();
     const t_float to = to_->value();
     const t_float step = std::fabs(step_->value());
@@ -63,24 +64,24 @@ void ListSeq::onBang()
     if (from < to) {
         if (closed_range_->value()) {
             for (t_float i = from; i <= to; i += step)
-                res.append(i);
+                res.push_back(i);
         } else {
             for (t_float i = from; i < to; i += step)
-                res.append(i);
+                res.push_back(i);
         }
     } else if (from > to) {
         if (closed_range_->value()) {
             for (t_float i = from; i >= to; i -= step)
-                res.append(i);
+                res.push_back(i);
         } else {
             for (t_float i = from; i > to; i -= step)
-                res.append(i);
+                res.push_back(i);
         }
     } else {
         OBJ_ERR << "invalid sequence args: @from " << from << ", @to " << to << ", @step " << step;
     }
 
-    listTo(0, res);
+    listTo(0, res.view());
 }
 
 void ListSeq::onFloat(t_float f)
@@ -12,6 +12,7 @@
  * this file belongs to.
  *****************************************************************************/
 #include "math_expr.h"
+#include "ceammc_containers.h"
 #include "ceammc_factory.h"
 #include "ceammc_format.h"
 #include "math_expr_ast.h"
@@ -21,6 +22,7 @@
 
 MathExpr::MathExpr(const PdArgs& args)
     : BaseObject(args)
+    , map_(nullptr)
 {
     createCbListProperty(
         "@expr",
@@ -32,6 +34,9 @@ MathExpr::MathExpr(const PdArgs& args)
         })
         ->setArgIndex(0);
 
+    map_ = new BoolProperty("@map", false);
+    addProperty(map_);
+
     createInlet();
     createOutlet();
 }
@@ -83,6 +88,9 @@ void MathExpr::onList(const AtomListView& lv)
         return;
     }
 
+    if (map_->value())
+        return mapList(lv);
+
     //  bind vars
     ast_->clearVars();
     auto NVARS = std::min<size_t>(10, lv.size());
@@ -98,6 +106,42 @@ void MathExpr::onList(const AtomListView& lv)
     floatTo(0, res);
 }
 
+void MathExpr::mapList(const AtomListView& lv)
+{
+    using namespace ceammc::math;
+
+    ast_->clearVars();
+
+    SmallAtomList res;
+    res.reserve(lv.size());
+
+    // evaluate by blocks: every program instruction is done for the whole block
+    math_float_t in[Program::BLOCK_SIZE];
+    math_float_t out[Program::BLOCK_SIZE];
+
+    for (size_t i = 0; i < lv.size(); i += Program::BLOCK_SIZE) {
+        const auto N = std::min(Program::BLOCK_SIZE, lv.size() - i);
+        for (size_t j = 0; j < N; j++)
+            in[j] = lv[i + j].asFloat();
+
+        // expression not lowered to a program: evaluate the tree for every element
+        if (!ast_->map(in, out, N)) {
+            for (size_t j = 0; j < N; j++) {
+                ast_->bindVar(0, in[j]);
+                if (!ast_->eval(&out[j])) {
+                    OBJ_ERR << "eval error";
+                    return;
+                }
+            }
+        }
+
+        for (size_t j = 0; j < N; j++)
+            res.push_back(Atom(out[j]));
+    }
+
+    listTo(0, res.view());
+}
+
 void MathExpr::updateAST()
 {
     ast_.reset(new ceammc::math::Ast);
@@ -111,7 +155,7 @@ void setup_math_expr()
     obj.parsePropsMode(PdArgs::PARSE_COPY);
 
     obj.setXletsInfo({ "float: input value\n"
-                       "list: input values",
+                       "list: input values or list to map with @map",
                          "list: set new expression" },
         { "float: result expression" });
 
@@ -31,6 +31,7 @@ using AstPtr = std::unique_ptr<ceammc::math::Ast>;
 class MathExpr : public BaseObject {
     std::string expr_;
     AstPtr ast_;
+    BoolProperty* map_;
 
 public:
     MathExpr(const PdArgs& args);
@@ -42,6 +43,7 @@ public:
 
 private:
     void updateAST();
+    void mapList(const AtomListView& lv);
 };
 
 void setup_math_expr();
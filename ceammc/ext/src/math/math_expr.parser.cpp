@@ -52,38 +52,11 @@
     # include "math_expr_ast.h"
     # include "math_expr.lexer.h"
 
-    static double fn_plus(double d0, double d1) { return d0 + d1; }
-    static double fn_minus(double d0, double d1) { return d0 - d1; }
-    static double fn_mul(double d0, double d1) { return d0 * d1; }
-    static double fn_div(double d0, double d1) { return d0 / d1; }
-    static double fn_mod(double d0, double d1) { return (long)d0 % (long)d1; }
-    static double fn_pow(double d0, double d1) { return pow(d0, d1); }
-    static double fn_neg(double d0) { return -d0; }
-
-    static double fn_eq(double d0, double d1) { return d0 == d1; }
-    static double fn_ne(double d0, double d1) { return d0 != d1; }
-    static double fn_le(double d0, double d1) { return d0 <= d1; }
-    static double fn_lt(double d0, double d1) { return d0 < d1; }
-    static double fn_ge(double d0, double d1) { return d0 >= d1; }
-    static double fn_gt(double d0, double d1) { return d0 > d1; }
-    static double fn_approx_eq(double d0, double d1) {
-        const double epsilon = 1.0e-08;
-        double da0 = fabs(d0);
-        double da1 = fabs(d1);
-
-        double x = fabs(d0 - d1);
-        if (x <= epsilon)
-            return 1;
-
-        double max = (da0 < da1) ? da1 : da0;
-        return x <= (epsilon * max);
-    }
-
     # undef yylex
     # define yylex lexer.lex  // Within bison's parse() we should invoke lexer.lex(), not the global yylex()
 
 
-#line 87 "math_expr.parser.cpp"
+#line 60 "math_expr.parser.cpp"
 
 
 #ifndef YY_
@@ -176,7 +149,7 @@
 
 #line 7 "math_expr.y"
 namespace ceammc { namespace math {
-#line 180 "math_expr.parser.cpp"
+#line 153 "math_expr.parser.cpp"
 
   /// Build a parser object.
   MathExprParser::MathExprParser (ceammc::math::MathExprLexer& lexer_yyarg, ceammc::math::Ast& tree_yyarg)
@@ -659,19 +632,19 @@ namespace ceammc { namespace math {
           switch (yyn)
             {
   case 2: // input: exp
-#line 86 "math_expr.y"
+#line 59 "math_expr.y"
             { tree.root.add(yystack_[0].value.as < Node > ()); }
-#line 665 "math_expr.parser.cpp"
+#line 638 "math_expr.parser.cpp"
     break;
 
   case 3: // array_at: SYMBOL SQR_OPEN exp SQR_CLOSE
-#line 91 "math_expr.y"
+#line 64 "math_expr.y"
         { yylhs.value.as < Node > () = Node::createArrayFunc(gensym(yystack_[3].value.as < std::string > ().c_str()), yystack_[1].value.as < Node > ()); }
-#line 671 "math_expr.parser.cpp"
+#line 644 "math_expr.parser.cpp"
     break;
 
   case 4: // unary_func: SYMBOL PAR_OPEN exp PAR_CLOSE
-#line 94 "math_expr.y"
+#line 67 "math_expr.y"
     {
         UnaryFloatFunc fn;
         if (getUnaryFunction(yystack_[3].value.as < std::string > (), fn))
@@ -680,11 +653,11 @@ namespace ceammc { namespace math {
             throw std::runtime_error(std::string("unknown unary function: " + yystack_[3].value.as < std::string > ()));
         }
     }
-#line 684 "math_expr.parser.cpp"
+#line 657 "math_expr.parser.cpp"
     break;
 
   case 5: // binary_func: SYMBOL PAR_OPEN exp COMMA exp PAR_CLOSE
-#line 104 "math_expr.y"
+#line 77 "math_expr.y"
     {
         BinaryFloatFunc fn;
         if (getBinaryFunction(yystack_[5].value.as < std::string > (), fn))
@@ -692,137 +665,137 @@ namespace ceammc { namespace math {
         else
             throw std::runtime_error(std::string("unknown binary function: " + yystack_[5].value.as < std::string > ()));
     }
-#line 696 "math_expr.parser.cpp"
+#line 669 "math_expr.parser.cpp"
     break;
 
   case 6: // group: PAR_OPEN exp PAR_CLOSE
-#line 113 "math_expr.y"
+#line 86 "math_expr.y"
         { yylhs.value.as < Node > () = Node::createGroup(yystack_[1].value.as < Node > ()); }
-#line 702 "math_expr.parser.cpp"
+#line 675 "math_expr.parser.cpp"
     break;
 
   case 7: // exp: NUM
-#line 116 "math_expr.y"
+#line 89 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createValue(yystack_[0].value.as < double > ()); }
-#line 708 "math_expr.parser.cpp"
+#line 681 "math_expr.parser.cpp"
     break;
 
   case 8: // exp: REF
-#line 117 "math_expr.y"
+#line 90 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createRef(tree.ref(yystack_[0].value.as < double > ())); }
-#line 714 "math_expr.parser.cpp"
+#line 687 "math_expr.parser.cpp"
     break;
 
   case 9: // exp: exp T_EQ exp
-#line 118 "math_expr.y"
+#line 91 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_eq, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());        }
-#line 720 "math_expr.parser.cpp"
+#line 693 "math_expr.parser.cpp"
     break;
 
   case 10: // exp: exp T_APPROX_EQ exp
-#line 119 "math_expr.y"
+#line 92 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_approx_eq, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 726 "math_expr.parser.cpp"
+#line 699 "math_expr.parser.cpp"
     break;
 
   case 11: // exp: exp T_NOT_EQ exp
-#line 120 "math_expr.y"
+#line 93 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_ne, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());        }
-#line 732 "math_expr.parser.cpp"
+#line 705 "math_expr.parser.cpp"
     break;
 
   case 12: // exp: exp T_LT exp
-#line 121 "math_expr.y"
+#line 94 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_lt, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());        }
-#line 738 "math_expr.parser.cpp"
+#line 711 "math_expr.parser.cpp"
     break;
 
   case 13: // exp: exp T_LE exp
-#line 122 "math_expr.y"
+#line 95 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_le, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());        }
-#line 744 "math_expr.parser.cpp"
+#line 717 "math_expr.parser.cpp"
     break;
 
   case 14: // exp: exp T_GT exp
-#line 123 "math_expr.y"
+#line 96 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_gt, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());        }
-#line 750 "math_expr.parser.cpp"
+#line 723 "math_expr.parser.cpp"
     break;
 
   case 15: // exp: exp T_GE exp
-#line 124 "math_expr.y"
+#line 97 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_ge, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());        }
-#line 756 "math_expr.parser.cpp"
+#line 729 "math_expr.parser.cpp"
     break;
 
   case 16: // exp: exp PLUS exp
-#line 125 "math_expr.y"
+#line 98 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_plus, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());      }
-#line 762 "math_expr.parser.cpp"
+#line 735 "math_expr.parser.cpp"
     break;
 
   case 17: // exp: exp MINUS exp
-#line 126 "math_expr.y"
+#line 99 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_minus, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());     }
-#line 768 "math_expr.parser.cpp"
+#line 741 "math_expr.parser.cpp"
     break;
 
   case 18: // exp: exp MUL exp
-#line 127 "math_expr.y"
+#line 100 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_mul, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());       }
-#line 774 "math_expr.parser.cpp"
+#line 747 "math_expr.parser.cpp"
     break;
 
   case 19: // exp: exp DIV exp
-#line 128 "math_expr.y"
+#line 101 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_div, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());       }
-#line 780 "math_expr.parser.cpp"
+#line 753 "math_expr.parser.cpp"
     break;
 
   case 20: // exp: exp MOD exp
-#line 129 "math_expr.y"
+#line 102 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_mod, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());       }
-#line 786 "math_expr.parser.cpp"
+#line 759 "math_expr.parser.cpp"
     break;
 
   case 21: // exp: MINUS exp
-#line 130 "math_expr.y"
+#line 103 "math_expr.y"
                             { yylhs.value.as < Node > () = Node::createUnaryFunction(fn_neg, yystack_[0].value.as < Node > ());            }
-#line 792 "math_expr.parser.cpp"
+#line 765 "math_expr.parser.cpp"
     break;
 
   case 22: // exp: exp EXP exp
-#line 131 "math_expr.y"
+#line 104 "math_expr.y"
                           { yylhs.value.as < Node > () = Node::createBinaryFunction(fn_pow, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ());       }
-#line 798 "math_expr.parser.cpp"
+#line 771 "math_expr.parser.cpp"
     break;
 
   case 23: // exp: group
-#line 132 "math_expr.y"
+#line 105 "math_expr.y"
       { yylhs.value.as < Node > () = yystack_[0].value.as < Node > (); }
-#line 804 "math_expr.parser.cpp"
+#line 777 "math_expr.parser.cpp"
     break;
 
   case 24: // exp: array_at
-#line 133 "math_expr.y"
+#line 106 "math_expr.y"
       { yylhs.value.as < Node > () = yystack_[0].value.as < Node > (); }
-#line 810 "math_expr.parser.cpp"
+#line 783 "math_expr.parser.cpp"
     break;
 
   case 25: // exp: unary_func
-#line 134 "math_expr.y"
+#line 107 "math_expr.y"
       { yylhs.value.as < Node > () = yystack_[0].value.as < Node > (); }
-#line 816 "math_expr.parser.cpp"
+#line 789 "math_expr.parser.cpp"
     break;
 
   case 26: // exp: binary_func
-#line 135 "math_expr.y"
+#line 108 "math_expr.y"
       { yylhs.value.as < Node > () = yystack_[0].value.as < Node > (); }
-#line 822 "math_expr.parser.cpp"
+#line 795 "math_expr.parser.cpp"
     break;
 
 
-#line 826 "math_expr.parser.cpp"
+#line 799 "math_expr.parser.cpp"
 
             default:
               break;
@@ -1332,9 +1305,9 @@ namespace ceammc { namespace math {
 
 #line 7 "math_expr.y"
 } } // ceammc::math
-#line 1336 "math_expr.parser.cpp"
+#line 1309 "math_expr.parser.cpp"
 
-#line 140 "math_expr.y"
+#line 113 "math_expr.y"
 
 
 void ceammc::math::MathExprParser::error(const ceammc::math::location& loc, const std::string& str)
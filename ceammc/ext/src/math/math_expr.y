@@ -31,33 +31,6 @@
     # include "math_expr_ast.h"
     # include "math_expr.lexer.h"
 
-    static double fn_plus(double d0, double d1) { return d0 + d1; }
-    static double fn_minus(double d0, double d1) { return d0 - d1; }
-    static double fn_mul(double d0, double d1) { return d0 * d1; }
-    static double fn_div(double d0, double d1) { return d0 / d1; }
-    static double fn_mod(double d0, double d1) { return (long)d0 % (long)d1; }
-    static double fn_pow(double d0, double d1) { return pow(d0, d1); }
-    static double fn_neg(double d0) { return -d0; }
-
-    static double fn_eq(double d0, double d1) { return d0 == d1; }
-    static double fn_ne(double d0, double d1) { return d0 != d1; }
-    static double fn_le(double d0, double d1) { return d0 <= d1; }
-    static double fn_lt(double d0, double d1) { return d0 < d1; }
-    static double fn_ge(double d0, double d1) { return d0 >= d1; }
-    static double fn_gt(double d0, double d1) { return d0 > d1; }
-    static double fn_approx_eq(double d0, double d1) {
-        const double epsilon = 1.0e-08;
-        double da0 = fabs(d0);
-        double da1 = fabs(d1);
-
-        double x = fabs(d0 - d1);
-        if (x <= epsilon)
-            return 1;
-
-        double max = (da0 < da1) ? da1 : da0;
-        return x <= (epsilon * max);
-    }
-
     # undef yylex
     # define yylex lexer.lex  // Within bison's parse() we should invoke lexer.lex(), not the global yylex()
 
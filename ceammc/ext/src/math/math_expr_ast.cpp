@@ -59,6 +59,34 @@ static double d_cmn(double d0, double d1) { return boost::math::binomial_coeffic
 namespace ceammc {
 namespace math {
 
+    math_float_t fn_plus(math_float_t d0, math_float_t d1) { return d0 + d1; }
+    math_float_t fn_minus(math_float_t d0, math_float_t d1) { return d0 - d1; }
+    math_float_t fn_mul(math_float_t d0, math_float_t d1) { return d0 * d1; }
+    math_float_t fn_div(math_float_t d0, math_float_t d1) { return d0 / d1; }
+    math_float_t fn_mod(math_float_t d0, math_float_t d1) { return (long)d0 % (long)d1; }
+    math_float_t fn_pow(math_float_t d0, math_float_t d1) { return pow(d0, d1); }
+    math_float_t fn_neg(math_float_t d0) { return -d0; }
+
+    math_float_t fn_eq(math_float_t d0, math_float_t d1) { return d0 == d1; }
+    math_float_t fn_ne(math_float_t d0, math_float_t d1) { return d0 != d1; }
+    math_float_t fn_le(math_float_t d0, math_float_t d1) { return d0 <= d1; }
+    math_float_t fn_lt(math_float_t d0, math_float_t d1) { return d0 < d1; }
+    math_float_t fn_ge(math_float_t d0, math_float_t d1) { return d0 >= d1; }
+    math_float_t fn_gt(math_float_t d0, math_float_t d1) { return d0 > d1; }
+    math_float_t fn_approx_eq(math_float_t d0, math_float_t d1)
+    {
+        const double epsilon = 1.0e-08;
+        double da0 = fabs(d0);
+        double da1 = fabs(d1);
+
+        double x = fabs(d0 - d1);
+        if (x <= epsilon)
+            return 1;
+
+        double max = (da0 < da1) ? da1 : da0;
+        return x <= (epsilon * max);
+    }
+
     UnaryFloatFunc ufnNameToPtr(UFuncName n)
     {
         switch (n) {
@@ -194,6 +222,29 @@ namespace math {
         }
     }
 
+    bool Node::isConstant() const
+    {
+        switch (type_) {
+        case VAL_FLOAT:
+            return true;
+        case CONTAINTER:
+        case UFUNC:
+        case BFUNC: {
+            if (empty())
+                return false;
+
+            for (auto& c : *children_) {
+                if (!c.isConstant())
+                    return false;
+            }
+
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
     bool Node::add(const Node& n)
     {
         if (!children_ || children_->capacity() == 0) {
@@ -290,6 +341,225 @@ namespace math {
         return ss.str();
     }
 
+    constexpr size_t Program::BLOCK_SIZE;
+
+    Program::Program()
+        : depth_(0)
+    {
+    }
+
+    void Program::clear()
+    {
+        code_.clear();
+        stack_.clear();
+        depth_ = 0;
+    }
+
+    bool Program::compile(const Node& root, const math_float_t* vars)
+    {
+        clear();
+
+        if (!lower(root, vars, 0)) {
+            clear();
+            return false;
+        }
+
+        stack_.assign(depth_ * BLOCK_SIZE, 0);
+        return true;
+    }
+
+    void Program::emit(OpCode op, size_t depth)
+    {
+        Instruction i;
+        i.op = op;
+        i.value = 0;
+        code_.push_back(i);
+        depth_ = std::max(depth_, depth);
+    }
+
+    bool Program::lower(const Node& n, const math_float_t* vars, size_t depth)
+    {
+        // fold constant subexpressions, using the same functions as the tree
+        if (n.isConstant()) {
+            emit(OP_CONST, depth + 1);
+            code_.back().value = n.evalute();
+            return true;
+        }
+
+        switch (n.type()) {
+        case REF_FLOAT: {
+            auto ref = boost::get<math_float_ref_t>(n.value());
+            if (!ref || ref < vars || ref >= vars + MAX_LOCAL_VARS)
+                return false;
+
+            emit(OP_VAR, depth + 1);
+            code_.back().var = ref - vars;
+            return true;
+        }
+        case CONTAINTER:
+            return n.childCount() == 1 && lower(n.child(0), vars, depth);
+        case REF_ARRAY:
+            if (n.childCount() != 1 || !lower(n.child(0), vars, depth))
+                return false;
+
+            emit(OP_ARRAY, depth + 1);
+            code_.back().array = boost::get<t_symbol*>(n.value());
+            return true;
+        case UFUNC: {
+            if (n.childCount() != 1 || !lower(n.child(0), vars, depth))
+                return false;
+
+            auto fn = boost::get<UnaryFloatFunc>(n.value());
+            if (fn == &fn_neg)
+                emit(OP_NEG, depth + 1);
+            else {
+                emit(OP_UFUNC, depth + 1);
+                code_.back().ufn = fn;
+            }
+            return true;
+        }
+        case BFUNC: {
+            if (n.childCount() != 2
+                || !lower(n.child(0), vars, depth)
+                || !lower(n.child(1), vars, depth + 1))
+                return false;
+
+            static const std::pair<BinaryFloatFunc, OpCode> inline_ops[] = {
+                { &fn_plus, OP_ADD },
+                { &fn_minus, OP_SUB },
+                { &fn_mul, OP_MUL },
+                { &fn_div, OP_DIV },
+                { &fn_lt, OP_LT },
+                { &fn_le, OP_LE },
+                { &fn_gt, OP_GT },
+                { &fn_ge, OP_GE },
+                { &fn_eq, OP_EQ },
+                { &fn_ne, OP_NE },
+            };
+
+            auto fn = boost::get<BinaryFloatFunc>(n.value());
+            for (auto& op : inline_ops) {
+                if (op.first == fn) {
+                    emit(op.second, depth + 2);
+                    return true;
+                }
+            }
+
+            emit(OP_BFUNC, depth + 2);
+            code_.back().bfn = fn;
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+#define PROGRAM_BINARY_OP(expr)                  \
+    {                                            \
+        sp--;                                    \
+        auto a = &stack_[(sp - 1) * BLOCK_SIZE]; \
+        auto b = &stack_[sp * BLOCK_SIZE];       \
+        for (size_t j = 0; j < n; j++)           \
+            a[j] = (expr);                       \
+    }                                            \
+    break;
+
+    void Program::run(const math_float_t* vars, size_t var, const math_float_t* in, math_float_t* out, size_t n) const
+    {
+        size_t sp = 0;
+
+        for (auto& i : code_) {
+            switch (i.op) {
+            case OP_CONST: {
+                auto a = &stack_[sp++ * BLOCK_SIZE];
+                std::fill(a, a + n, i.value);
+            } break;
+            case OP_VAR: {
+                auto a = &stack_[sp++ * BLOCK_SIZE];
+                if (in && i.var == var)
+                    std::copy(in, in + n, a);
+                else
+                    std::fill(a, a + n, vars[i.var]);
+            } break;
+            case OP_ADD:
+                PROGRAM_BINARY_OP(a[j] + b[j])
+            case OP_SUB:
+                PROGRAM_BINARY_OP(a[j] - b[j])
+            case OP_MUL:
+                PROGRAM_BINARY_OP(a[j] * b[j])
+            case OP_DIV:
+                PROGRAM_BINARY_OP(a[j] / b[j])
+            case OP_LT:
+                PROGRAM_BINARY_OP(a[j] < b[j])
+            case OP_LE:
+                PROGRAM_BINARY_OP(a[j] <= b[j])
+            case OP_GT:
+                PROGRAM_BINARY_OP(a[j] > b[j])
+            case OP_GE:
+                PROGRAM_BINARY_OP(a[j] >= b[j])
+            case OP_EQ:
+                PROGRAM_BINARY_OP(a[j] == b[j])
+            case OP_NE:
+                PROGRAM_BINARY_OP(a[j] != b[j])
+            case OP_BFUNC:
+                PROGRAM_BINARY_OP(i.bfn(a[j], b[j]))
+            case OP_NEG: {
+                auto a = &stack_[(sp - 1) * BLOCK_SIZE];
+                for (size_t j = 0; j < n; j++)
+                    a[j] = -a[j];
+            } break;
+            case OP_UFUNC: {
+                auto a = &stack_[(sp - 1) * BLOCK_SIZE];
+                for (size_t j = 0; j < n; j++)
+                    a[j] = i.ufn(a[j]);
+            } break;
+            case OP_ARRAY: {
+                auto a = &stack_[(sp - 1) * BLOCK_SIZE];
+                ceammc::Array arr(i.array);
+                if (!arr.isValid()) {
+                    pd_error(0, "[math.expr] array is not found: '%s'", i.array->s_name);
+                    std::fill(a, a + n, 0);
+                    break;
+                }
+
+                const long N = arr.size();
+                for (size_t j = 0; j < n; j++) {
+                    long idx = a[j];
+                    if (idx < 0 || idx >= N) {
+                        pd_error(0, "[math.expr] invalid array index: %ld", idx);
+                        a[j] = 0;
+                    } else
+                        a[j] = arr[idx];
+                }
+            } break;
+            }
+        }
+
+        std::copy(stack_.data(), stack_.data() + n, out);
+    }
+
+#undef PROGRAM_BINARY_OP
+
+    math_float_t Program::eval(const math_float_t* vars) const
+    {
+        math_float_t res = 0;
+        if (!empty())
+            run(vars, 0, nullptr, &res, 1);
+
+        return res;
+    }
+
+    void Program::map(const math_float_t* vars, size_t var, const math_float_t* in, math_float_t* out, size_t n) const
+    {
+        if (empty()) {
+            std::fill(out, out + n, 0);
+            return;
+        }
+
+        for (size_t i = 0; i < n; i += BLOCK_SIZE)
+            run(vars, var, in + i, out + i, std::min(BLOCK_SIZE, n - i));
+    }
+
     Ast::Ast()
         : root(CONTAINTER)
         , vars {}
@@ -307,7 +577,16 @@ namespace math {
         if (!ok)
             return false;
 
-        *res = root.evalute();
+        *res = program.empty() ? root.evalute() : program.eval(vars);
+        return true;
+    }
+
+    bool Ast::map(const math_float_t* in, math_float_t* out, size_t n) const
+    {
+        if (!ok || program.empty())
+            return false;
+
+        program.map(vars, 0, in, out, n);
         return true;
     }
 
@@ -353,8 +632,11 @@ namespace math {
             if (parser.parse() != 0) {
                 invalidate();
                 return false;
-            } else
-                return true;
+            }
+
+            // the tree is still evaluated if it can't be lowered
+            program.compile(root, vars);
+            return true;
         } catch (std::exception& e) {
             pd_error(0, "[math.expr] %s", e.what());
             invalidate();
@@ -20,6 +20,7 @@
 #include <boost/variant.hpp>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace ceammc {
 namespace math {
@@ -62,6 +63,22 @@ namespace math {
     bool getUnaryFunction(const std::string& n, UnaryFloatFunc& fn);
     bool getBinaryFunction(const std::string& n, BinaryFloatFunc& fn);
 
+    // operators, used by the parser
+    math_float_t fn_plus(math_float_t d0, math_float_t d1);
+    math_float_t fn_minus(math_float_t d0, math_float_t d1);
+    math_float_t fn_mul(math_float_t d0, math_float_t d1);
+    math_float_t fn_div(math_float_t d0, math_float_t d1);
+    math_float_t fn_mod(math_float_t d0, math_float_t d1);
+    math_float_t fn_pow(math_float_t d0, math_float_t d1);
+    math_float_t fn_neg(math_float_t d0);
+    math_float_t fn_eq(math_float_t d0, math_float_t d1);
+    math_float_t fn_ne(math_float_t d0, math_float_t d1);
+    math_float_t fn_le(math_float_t d0, math_float_t d1);
+    math_float_t fn_lt(math_float_t d0, math_float_t d1);
+    math_float_t fn_ge(math_float_t d0, math_float_t d1);
+    math_float_t fn_gt(math_float_t d0, math_float_t d1);
+    math_float_t fn_approx_eq(math_float_t d0, math_float_t d1);
+
     enum NodeType {
         VAL_FLOAT = 0,
         REF_FLOAT,
@@ -98,6 +115,12 @@ namespace math {
         std::string toString() const;
         bool add(const Node& n);
 
+        size_t childCount() const { return children_ ? children_->size() : 0; }
+        const Node& child(size_t n) const { return children_->at(n); }
+
+        /** true if the value does not depend on variables or arrays */
+        bool isConstant() const;
+
     public:
         static Node createUnaryFunction(UnaryFloatFunc fn, const Node& v);
         static Node createBinaryFunction(BinaryFloatFunc fn, const Node& v0, const Node& v1);
@@ -109,9 +132,88 @@ namespace math {
 
     constexpr size_t MAX_LOCAL_VARS = 10;
 
+    enum OpCode {
+        OP_CONST = 0, // push constant
+        OP_VAR, // push variable
+        OP_ADD,
+        OP_SUB,
+        OP_MUL,
+        OP_DIV,
+        OP_NEG,
+        OP_LT,
+        OP_LE,
+        OP_GT,
+        OP_GE,
+        OP_EQ,
+        OP_NE,
+        OP_UFUNC, // replace top with fn(top)
+        OP_BFUNC, // pop two, push fn(a, b)
+        OP_ARRAY // replace top with array[top]
+    };
+
+    struct Instruction {
+        OpCode op;
+        union {
+            math_float_t value;
+            size_t var;
+            UnaryFloatFunc ufn;
+            BinaryFloatFunc bfn;
+            t_symbol* array;
+        };
+    };
+
+    /**
+     * AST lowered to the instruction stream of a stack machine, with constant
+     * subexpressions folded. Every instruction is executed for a block of
+     * values at once, so a list is evaluated in (size / BLOCK_SIZE) passes
+     * over the program and the arithmetic runs in plain vectorizable loops.
+     */
+    class Program {
+        std::vector<Instruction> code_;
+        mutable std::vector<math_float_t> stack_;
+        size_t depth_;
+
+    public:
+        static constexpr size_t BLOCK_SIZE = 256;
+
+    public:
+        Program();
+
+        /**
+         * Lowers the expression tree
+         * @param root - tree root
+         * @param vars - variable storage, the tree references point to
+         * @return true on success
+         */
+        bool compile(const Node& root, const math_float_t* vars);
+        void clear();
+
+        bool empty() const { return code_.empty(); }
+        size_t size() const { return code_.size(); }
+        size_t stackDepth() const { return depth_; }
+        const Instruction& at(size_t n) const { return code_.at(n); }
+
+        /**
+         * Evaluates single value
+         */
+        math_float_t eval(const math_float_t* vars) const;
+
+        /**
+         * Evaluates for every input value bound to the variable @p var,
+         * other variables are taken from @p vars
+         */
+        void map(const math_float_t* vars, size_t var, const math_float_t* in, math_float_t* out, size_t n) const;
+
+    private:
+        bool lower(const Node& n, const math_float_t* vars, size_t depth);
+        void emit(OpCode op, size_t depth);
+        void run(const math_float_t* vars, size_t var, const math_float_t* in, math_float_t* out, size_t n) const;
+    };
+
     struct Ast {
         Node root;
         double vars[MAX_LOCAL_VARS];
+        Program program;
         bool ok;
 
         Ast();
@@ -120,6 +222,7 @@ namespace math {
         bool isOk() const;
         void invalidate();
         bool eval(math_float_t* res) const;
+        bool map(const math_float_t* in, math_float_t* out, size_t n) const;
         void clearVars();
         bool bindVar(int idx, math_float_t v);
         math_float_ref_t ref(int idx);
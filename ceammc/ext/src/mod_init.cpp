@@ -12,6 +12,7 @@
  * this file belongs to.
  *****************************************************************************/
 #include "mod_init.h"
+#include "ceammc_arena.h"
 #include "ceammc_object.h"
 #include "ceammc_pd.h"
 #include "ceammc_platform.h"
@@ -180,6 +181,9 @@ void ceammc_init()
 
     ceammc::BaseObject::initInletDispatchNames();
 
+    // message temporaries are rewound at the end of every scheduler tick
+    ceammc::AtomArena::setupScheduler();
+
 #ifdef WITH_RUST_CORE
     ceammc_rust_log_init();
 #endif
@@ -9,10 +9,11 @@ OBJECT_STUB_SETUP(NetHttpClient, net_http_client, "net.http.client", "http.clien
 #include "ceammc_data.h"
 #include "ceammc_factory.h"
 #include "ceammc_fn_list.h"
-#include "datatype_json.h"
+#include "ceammc_json.h"
 #include "datatype_string.h"
 #include "net_http_client.h"
-#include "json/json.hpp"
+
+#include <cstring>
 
 NetHttpClient::NetHttpClient(const PdArgs& args)
     : NetHttpClientBase(args)
@@ -248,25 +249,15 @@ void NetHttpClient::processReply(const ceammc_http_client_result& res)
             atomTo(1, StringAtom(res.data));
             break;
         case ceammc_http_content_type::Json: {
-            try {
-                auto j = nlohmann::json::parse(res.data);
-
-                using js = nlohmann::json::value_t;
-                switch (j.type()) {
-                case js::array: {
-                    AtomList lst;
-                    from_json(j, lst);
-                    listTo(1, lst);
-                } break;
-                default: {
-                    Atom a;
-                    from_json(j, a);
-                    atomTo(1, a);
-                } break;
-                }
-            } catch (std::exception& e) {
-                OBJ_ERR << e.what();
-            }
+            AtomList lst;
+            bool is_array = false;
+            std::string err;
+            if (!json::from_json_string(res.data, strlen(res.data), lst, is_array, err))
+                OBJ_ERR << err;
+            else if (is_array)
+                listTo(1, lst);
+            else
+                atomTo(1, lst[0]);
 
             break;
         case ceammc_http_content_type::None:
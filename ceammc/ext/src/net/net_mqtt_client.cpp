@@ -21,11 +21,9 @@ OBJECT_STUB_SETUP(NetMqtt, net_mqtt_client, "net.mqtt");
 #include "ceammc_factory.h"
 #include "ceammc_format.h"
 #include "ceammc_json.h"
-#include "datatype_json.h"
 #include "net_mqtt_client.h"
 
 #include "fmt/core.h"
-#include "json/json.hpp"
 
 CEAMMC_DEFINE_HASH(fudi)
 CEAMMC_DEFINE_HASH(data)
@@ -226,26 +224,15 @@ void NetMqttClient::processReply(const char* topic, const uint8_t* data, size_t
         anyTo(0, sym_topic, AtomList::parseString(text.c_str()));
     } break;
     case hash_json: {
-        try {
-            std::string text(reinterpret_cast<const char*>(data), data_len);
-            auto j = nlohmann::json::parse(text);
-
-            using js = nlohmann::json::value_t;
-            switch (j.type()) {
-            case js::array: {
-                AtomList lst;
-                from_json(j, lst);
-                anyTo(0, sym_topic, lst);
-            } break;
-            default: {
-                Atom a;
-                from_json(j, a);
-                anyTo(0, sym_topic, a);
-            } break;
-            }
-        } catch (std::exception& e) {
-            OBJ_ERR << e.what();
-        }
+        AtomList lst;
+        bool is_array = false;
+        std::string err;
+        if (!json::from_json_string(reinterpret_cast<const char*>(data), data_len, lst, is_array, err))
+            OBJ_ERR << err;
+        else if (is_array)
+            anyTo(0, sym_topic, lst);
+        else
+            anyTo(0, sym_topic, lst[0]);
     } break;
     case hash_data: {
         std::string text(reinterpret_cast<const char*>(data), data_len);
@@ -17,8 +17,11 @@
 #include "ceammc_output.h"
 #include "fmt/core.h"
 
+#include <cmath>
 #include <cstring>
 
+constexpr size_t OSC_RECV_QUEUE_SIZE = 128;
+
 namespace ceammc {
 
 using namespace ceammc::osc;
@@ -32,6 +35,10 @@ namespace net {
         , server_(nullptr)
         , path_(nullptr)
         , types_(nullptr)
+        , timetag_(nullptr)
+        , latency_(nullptr)
+        , ring_(OSC_RECV_QUEUE_SIZE)
+        , clock_([this]() { releaseQueued(false); })
     {
         createInlet();
         createOutlet();
@@ -50,6 +57,24 @@ namespace net {
         types_->setSymbolCheckFn(fn, "invalid type string");
         addProperty(types_);
 
+        timetag_ = new BoolProperty("@timetag", true);
+        timetag_->setSuccessFn([this](Property*) {
+            if (!timetag_->value())
+                releaseQueued(true);
+        });
+        addProperty(timetag_);
+
+        latency_ = new FloatProperty("@latency", 0);
+        latency_->checkNonNegative();
+        latency_->setUnitsMs();
+        addProperty(latency_);
+
+        createCbIntProperty("@late", [this]() -> int { return late_; });
+        createCbFloatProperty("@ahead", [this]() -> t_float { return ahead_mean_; })
+            ->setUnitsMs();
+        createCbFloatProperty("@jitter", [this]() -> t_float { return std::sqrt(ahead_var_); })
+            ->setUnitsMs();
+
         bindReceive(gensym(OSC_DISPATCHER));
     }
 
@@ -69,11 +94,7 @@ namespace net {
     bool NetOscReceive::subscribe(const OscServerList::OscServerPtr& osc, t_symbol* path)
     {
         if (!osc.expired() && osc.lock()->isValid() && path != &s_) {
-            osc::OscMethodFn fn = [this](const OscRecvMessage& m) -> bool {
-                return pipe_.try_enqueue(m);
-            };
-
-            osc.lock()->subscribeMethod(path->s_name, types(), subscriberId(), fn);
+            osc.lock()->subscribeMethod(path->s_name, types(), subscriberId(), &ring_);
 
             OBJ_LOG << fmt::format("[osc] #{} subscribed to {} at \"{}\"", subscriberId(), path->s_name, osc.lock()->name());
             return true;
@@ -113,34 +134,89 @@ namespace net {
 
     bool NetOscReceive::notify(int code)
     {
-        OscRecvMessage msg;
-        while (pipe_.try_dequeue(msg))
-            processMessage(msg);
+        // the server queue has already held bundles until their time
+        auto osc = OscServerList::instance().findByName(server_->value());
+        const bool use_timetag = timetag_->value() && !osc.expired() && !osc.lock()->queueBundles();
+
+        while (auto msg = ring_.front()) {
+            if (msg->isImmediate() || !use_timetag)
+                processMessage(*msg);
+            else
+                schedule(*msg);
+
+            ring_.pop();
+        }
 
         return true;
     }
 
-    void NetOscReceive::processMessage(const OscRecvMessage& msg)
+    void NetOscReceive::schedule(const OscMessageRecord& msg)
     {
-        AtomList res;
-        res.reserve(msg.size());
+        const auto now = clock_gettimesince(0);
+        const auto t = OscTimeSync::instance().toLogicalTime(msg.time) + latency_->value();
+        updateStat(t - now);
 
-        OscAtomVisitor v(res);
-        for (auto& a : msg.atoms())
-            a.apply_visitor(v);
+        if (t <= now) {
+            late_++;
+            processMessage(msg);
+            return;
+        }
 
+        queue_.push(t, msg);
+        clock_.delay(queue_.nextTime() - now);
+    }
+
+    void NetOscReceive::releaseQueued(bool all)
+    {
+        // rounding error of clock time conversion
+        constexpr double TIME_EPSILON_MS = 0.001;
+
+        const auto now = clock_gettimesince(0);
+        OscMessageRecord msg;
+
+        while (!queue_.empty() && (all || queue_.nextTime() <= now + TIME_EPSILON_MS)) {
+            queue_.pop(msg);
+            processMessage(msg);
+        }
+
+        if (queue_.empty())
+            clock_.unset();
+        else
+            clock_.delay(queue_.nextTime() - now);
+    }
+
+    void NetOscReceive::updateStat(double ahead)
+    {
+        // exponential moving average: statistics of last ~64 messages
+        constexpr double K = 1.0 / 64;
+
+        if (!stat_init_) {
+            ahead_mean_ = ahead;
+            ahead_var_ = 0;
+            stat_init_ = true;
+        } else {
+            const auto d = ahead - ahead_mean_;
+            ahead_mean_ += K * d;
+            ahead_var_ = (1 - K) * (ahead_var_ + K * d * d);
+        }
+    }
+
+    void NetOscReceive::processMessage(const OscMessageRecord& msg)
+    {
         if (msg.isSpec()) {
-            auto spec = boost::get<OscMessageSpec>(msg[0]);
-            if (spec == OscMessageSpec::INF)
-                anyTo(0, gensym("inf"), AtomListView());
-            else if (spec == OscMessageSpec::NIL)
-                anyTo(0, gensym("null"), AtomListView());
-        } else if (msg.isMidi()) {
-            anyTo(0, gensym("midi"), res);
+            anyTo(0, gensym(msg.isInf() ? "inf" : "null"), AtomListView());
+            return;
+        }
+
+        AtomList32 res;
+        msg.appendTo(res);
+
+        if (msg.isMidi()) {
+            anyTo(0, gensym("midi"), res.view());
         } else if (msg.isBlob()) {
-            anyTo(0, gensym("blob"), res);
+            anyTo(0, gensym("blob"), res.view());
         } else
-            outletAtomList(outletAt(0), res, true);
+            outletAtomList(outletAt(0), res.view(), true);
     }
 
     void NetOscReceive::onInlet(size_t n, const AtomListView& lv)
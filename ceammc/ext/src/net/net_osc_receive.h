@@ -14,6 +14,7 @@
 #ifndef NET_OSC_RECEIVE_H
 #define NET_OSC_RECEIVE_H
 
+#include "ceammc_clock.h"
 #include "ceammc_object.h"
 #include "ceammc_osc.h"
 #include "ceammc_poll_dispatcher.h"
@@ -26,7 +27,17 @@ namespace net {
         SymbolProperty* server_;
         SymbolProperty* path_;
         SymbolProperty* types_;
-        osc::OscMethodPipe pipe_;
+        BoolProperty* timetag_;
+        FloatProperty* latency_;
+        osc::OscMessageRing ring_;
+        osc::OscTimedQueue queue_;
+        ClockLambdaFunction clock_;
+
+        // timetag statistics: how much messages are ahead of their time on arrival
+        size_t late_ { 0 };
+        double ahead_mean_ { 0 };
+        double ahead_var_ { 0 };
+        bool stat_init_ { false };
 
     public:
         NetOscReceive(const PdArgs& args);
@@ -34,7 +45,7 @@ namespace net {
 
         void initDone() override;
         bool notify(int code) final;
-        void processMessage(const osc::OscRecvMessage& msg);
+        void processMessage(const osc::OscMessageRecord& msg);
 
         void onInlet(size_t n, const AtomListView& lv) override;
 
@@ -43,6 +54,11 @@ namespace net {
         const char* types() const;
         bool subscribe(const osc::OscServerList::OscServerPtr& osc, t_symbol* path);
         bool unsubscribe(const osc::OscServerList::OscServerPtr& osc, t_symbol* path);
+
+    private:
+        void schedule(const osc::OscMessageRecord& msg);
+        void releaseQueued(bool all);
+        void updateStat(double ahead);
     };
 }
 }
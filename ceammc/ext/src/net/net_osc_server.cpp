@@ -28,6 +28,7 @@ namespace net {
         , url_(nullptr)
         , auto_start_(nullptr)
         , dump_(nullptr)
+        , queue_(nullptr)
     {
         createOutlet();
 
@@ -50,6 +51,16 @@ namespace net {
 
         auto_start_ = new BoolProperty("@auto_start", true);
         addProperty(auto_start_);
+
+        queue_ = new BoolProperty("@queue", true);
+        queue_->setSuccessFn([this](Property*) {
+            if (server_ && server_->isValid())
+                server_->setQueueBundles(queue_->value());
+        });
+        addProperty(queue_);
+
+        createCbIntProperty("@queued", [this]() -> int { return (server_ && server_->isValid()) ? server_->queuedCount() : 0; });
+        createCbIntProperty("@dropped", [this]() -> int { return (server_ && server_->isValid()) ? server_->droppedCount() : 0; });
     }
 
     NetOscServer::~NetOscServer()
@@ -90,6 +101,7 @@ namespace net {
             OBJ_ERR << fmt::format("can't create server '{}': {}", name, to_string(url));
         } else {
             server_->setDumpAll(dump_->value());
+            server_->setQueueBundles(queue_->value());
 
             if (auto_start_->value())
                 server_->start(true);
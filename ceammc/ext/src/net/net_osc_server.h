@@ -27,6 +27,7 @@ namespace net {
         OscUrlProperty* url_;
         BoolProperty* dump_;
         BoolProperty* auto_start_;
+        BoolProperty* queue_;
         std::shared_ptr<osc::OscServer> server_;
 
     public:
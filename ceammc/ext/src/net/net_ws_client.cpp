@@ -28,6 +28,8 @@ OBJECT_STUB_SETUP(NetWsClient, net_ws_client, "net.ws.client");
 
 #include "fmt/core.h"
 
+#include <cstring>
+
 CEAMMC_DEFINE_HASH(fudi)
 CEAMMC_DEFINE_HASH(data)
 CEAMMC_DEFINE_HASH(sym)
@@ -161,16 +163,15 @@ void NetWsClient::processText(const char* txt)
             anyTo(0, sym_text(), gensym(txt));
         } break;
         case hash_json: {
-            auto j = nlohmann::json::parse(txt);
-            if (j.is_array()) {
-                AtomList lst;
-                from_json(j, lst);
+            AtomList lst;
+            bool is_array = false;
+            std::string err;
+            if (!json::from_json_string(txt, strlen(txt), lst, is_array, err))
+                OBJ_ERR << "text reply error: " << err;
+            else if (is_array)
                 anyTo(0, sym_text(), lst);
-            } else {
-                Atom obj;
-                from_json(j, obj);
-                anyTo(0, sym_text(), obj);
-            }
+            else
+                anyTo(0, sym_text(), lst[0]);
 
         } break;
         case hash_data: {
@@ -23,16 +23,73 @@ OBJECT_STUB_SETUP(NetWsServer, net_ws_server, "net.ws.server");
 #include "ceammc_factory.h"
 #include "ceammc_format.h"
 #include "ceammc_json.h"
-#include "datatype_json.h"
 #include "net_ws_server.h"
 
 #include "fmt/core.h"
 
+#include <cstring>
+#include <limits>
+
+constexpr int DEFAULT_BACKLOG = 64;
+// flush batch immediately if it grows bigger
+constexpr size_t MAX_BATCH_SIZE = 64 * 1024;
+
+namespace {
+
+enum AtomFrameTag : std::uint8_t {
+    FRAME_FLOAT = 'f',
+    FRAME_SYMBOL = 's',
+};
+
+inline void put_u16(Bytes& out, std::uint16_t v)
+{
+    out.push_back(v & 0xFF);
+    out.push_back(v >> 8);
+}
+
+inline std::uint16_t get_u16(const std::uint8_t* data)
+{
+    return data[0] | (std::uint16_t(data[1]) << 8);
+}
+
+inline void put_f32(Bytes& out, float f)
+{
+    std::uint32_t v;
+    std::memcpy(&v, &f, sizeof(v));
+    out.push_back(v & 0xFF);
+    out.push_back((v >> 8) & 0xFF);
+    out.push_back((v >> 16) & 0xFF);
+    out.push_back(v >> 24);
+}
+
+inline float get_f32(const std::uint8_t* data)
+{
+    std::uint32_t v = data[0]
+        | (std::uint32_t(data[1]) << 8)
+        | (std::uint32_t(data[2]) << 16)
+        | (std::uint32_t(data[3]) << 24);
+
+    float f;
+    std::memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+inline bool same_target(const ceammc_ws_client_target& t0, const ceammc_ws_client_target& t1)
+{
+    return t0.sel == t1.sel && t0.id == t1.id;
+}
+
+}
+
 CEAMMC_DEFINE_HASH(fudi)
 CEAMMC_DEFINE_HASH(data)
 CEAMMC_DEFINE_HASH(sym)
 CEAMMC_DEFINE_HASH(json)
+CEAMMC_DEFINE_HASH(atoms)
 
+CEAMMC_DEFINE_STR(raw)
+
+CEAMMC_DEFINE_SYM(atoms)
 CEAMMC_DEFINE_SYM(binary)
 CEAMMC_DEFINE_SYM(closed)
 CEAMMC_DEFINE_SYM(clients)
@@ -77,8 +134,10 @@ void NetWsServer::m_close(t_symbol* s, const AtomListView& lv)
     AtomListView args;
     auto target = make_target(lv, args);
 
-    if (srv_)
+    if (srv_) {
+        flushBatches();
         ceammc_ws_server_close_clients(srv_->handle(), target);
+    }
 }
 
 void NetWsServer::m_ping(t_symbol* s, const AtomListView& lv)
@@ -90,6 +149,7 @@ void NetWsServer::m_ping(t_symbol* s, const AtomListView& lv)
     auto target = make_target(lv, args);
 
     if (srv_) {
+        flushBatches();
         auto data = toBinary(args);
         ceammc_ws_server_send_ping(srv_->handle(), data.data(), data.size(), target);
     }
@@ -104,6 +164,7 @@ void NetWsServer::m_send(t_symbol* s, const AtomListView& lv)
     auto target = make_target(lv, args);
 
     if (srv_) {
+        flushBatches();
         auto txt = to_string(args);
         ceammc_ws_server_send_text(srv_->handle(), txt.c_str(), target);
     }
@@ -118,6 +179,7 @@ void NetWsServer::m_send_binary(t_symbol* s, const AtomListView& lv)
     auto target = make_target(lv, args);
 
     if (srv_) {
+        flushBatches();
         auto data = toBinary(args);
         ceammc_ws_server_send_binary(srv_->handle(), data.data(), data.size(), target);
     }
@@ -132,6 +194,7 @@ void NetWsServer::m_send_json(t_symbol* s, const AtomListView& lv)
     auto target = make_target(lv, args);
 
     if (srv_) {
+        flushBatches();
         auto txt = toJson(args);
         ceammc_ws_server_send_text(srv_->handle(), txt.c_str(), target);
     }
@@ -145,8 +208,27 @@ void NetWsServer::m_shutdown(t_symbol* s, const AtomListView& lv)
     AtomListView args;
     auto target = make_target(lv, args);
 
-    if (srv_)
+    if (srv_) {
+        flushBatches();
         ceammc_ws_server_shutdown_clients(srv_->handle(), target);
+    }
+}
+
+void NetWsServer::m_send_atoms(t_symbol* s, const AtomListView& lv)
+{
+    if (!checkClientSelector(s, lv, REQ_ARGS_GE_0))
+        return;
+
+    AtomListView args;
+    auto target = make_target(lv, args);
+
+    if (!srv_)
+        return;
+
+    appendBatch(target, args);
+
+    if (!batch_->value())
+        flushBatches();
 }
 
 bool NetWsServer::notify(int code)
@@ -159,12 +241,28 @@ bool NetWsServer::notify(int code)
 
 NetWsServer::NetWsServer(const PdArgs& args)
     : BaseWsServer(args)
+    , flush_([this]() { flushBatches(); })
 {
     createOutlet();
     createOutlet();
 
     mode_ = new SymbolEnumProperty("@mode", { str_fudi, str_data, str_sym, str_json });
     addProperty(mode_);
+
+    binmode_ = new SymbolEnumProperty("@binmode", { str_raw, str_atoms });
+    addProperty(binmode_);
+
+    batch_ = new BoolProperty("@batch", true);
+    addProperty(batch_);
+
+    backlog_ = new IntProperty("@backlog", DEFAULT_BACKLOG);
+    backlog_->checkNonNegative();
+    backlog_->setSuccessFn([this](Property*) { updateBacklog(); });
+    addProperty(backlog_);
+
+    createCbIntProperty("@dropped", [this]() -> int {
+        return srv_ ? ceammc_ws_server_dropped(srv_->handle()) : 0;
+    });
 }
 
 void NetWsServer::m_listen(t_symbol* s, const AtomListView& lv)
@@ -213,10 +311,14 @@ void NetWsServer::m_listen(t_symbol* s, const AtomListView& lv)
                 } //
             },
             { subscriberId(), [](size_t id) { Dispatcher::instance().send({ id, 0 }); } }));
+
+    updateBacklog();
 }
 
 void NetWsServer::m_stop(t_symbol* s, const AtomListView& lv)
 {
+    flush_.unset();
+    batches_.clear();
     srv_.reset(nullptr);
 }
 
@@ -263,6 +365,87 @@ Bytes NetWsServer::toBinary(const AtomListView& lv)
     return data;
 }
 
+bool NetWsServer::toBinaryFrame(const AtomListView& lv, Bytes& out)
+{
+    constexpr size_t MAX_LEN = std::numeric_limits<std::uint16_t>::max();
+
+    if (lv.size() > MAX_LEN)
+        return false;
+
+    const auto start = out.size();
+    put_u16(out, lv.size());
+
+    for (auto& a : lv) {
+        if (a.isFloat()) {
+            out.push_back(FRAME_FLOAT);
+            put_f32(out, a.asT<t_float>());
+        } else {
+            // data atoms are sent as their string representation
+            const auto str = a.isSymbol() ? std::string(a.asT<t_symbol*>()->s_name) : to_string(a);
+            if (str.size() > MAX_LEN) {
+                out.resize(start);
+                return false;
+            }
+
+            out.push_back(FRAME_SYMBOL);
+            put_u16(out, str.size());
+            out.insert(out.end(), str.begin(), str.end());
+        }
+    }
+
+    return true;
+}
+
+bool NetWsServer::fromBinaryFrames(const std::uint8_t* data, size_t len, std::function<void(const AtomList&)> fn)
+{
+    AtomList frame;
+    auto end = data + len;
+
+    while (data < end) {
+        if (end - data < 2)
+            return false;
+
+        const auto n = get_u16(data);
+        data += 2;
+
+        frame.clear();
+        frame.reserve(n);
+
+        for (size_t i = 0; i < n; i++) {
+            if (data == end)
+                return false;
+
+            switch (*data++) {
+            case FRAME_FLOAT:
+                if (end - data < 4)
+                    return false;
+
+                frame.append(get_f32(data));
+                data += 4;
+                break;
+            case FRAME_SYMBOL: {
+                if (end - data < 2)
+                    return false;
+
+                const auto slen = get_u16(data);
+                data += 2;
+                if (end - data < slen)
+                    return false;
+
+                frame.append(gensym(std::string(reinterpret_cast<const char*>(data), slen).c_str()));
+                data += slen;
+            } break;
+            default:
+                return false;
+            }
+        }
+
+        fn(frame);
+    }
+
+    return true;
+}
+
 std::string NetWsServer::toJson(const AtomListView& lv)
 {
     try {
@@ -291,16 +474,15 @@ void NetWsServer::processText(const char* msg, const ceammc_ws_peer_info* peer)
             anyTo(0, sym_text(), gensym(msg));
         } break;
         case hash_json: {
-            auto j = nlohmann::json::parse(msg);
-            if (j.is_array()) {
-                AtomList lst;
-                from_json(j, lst);
+            AtomList lst;
+            bool is_array = false;
+            std::string err;
+            if (!json::from_json_string(msg, strlen(msg), lst, is_array, err))
+                OBJ_ERR << "text reply error: " << err;
+            else if (is_array)
                 anyTo(0, sym_text(), lst);
-            } else {
-                Atom obj;
-                from_json(j, obj);
-                anyTo(0, sym_text(), obj);
-            }
+            else
+                anyTo(0, sym_text(), lst[0]);
 
         } break;
         case hash_data: {
@@ -322,7 +504,16 @@ void NetWsServer::processText(const char* msg, const ceammc_ws_peer_info* peer)
 void NetWsServer::processBinary(const std::uint8_t* data, size_t len, const ceammc_ws_peer_info* peer)
 {
     outputInfo(peer);
-    anyTo(0, sym_binary(), fromBinary(data, len));
+
+    if (crc32_hash(binmode_->value()) == hash_atoms) {
+        bool ok = fromBinaryFrames(data, len, [this](const AtomList& lst) {
+            anyTo(0, sym_atoms(), lst);
+        });
+
+        if (!ok)
+            OBJ_ERR << "invalid atom frame from client: " << peer->id;
+    } else
+        anyTo(0, sym_binary(), fromBinary(data, len));
 }
 
 void NetWsServer::processPing(const std::uint8_t* data, size_t len, const ceammc_ws_peer_info* peer)
@@ -414,6 +605,55 @@ bool NetWsServer::checkClientSelector(t_symbol* s, const AtomListView& lv, Reque
     return true;
 }
 
+void NetWsServer::appendBatch(const ceammc_ws_client_target& target, const AtomListView& lv)
+{
+    auto it = std::find_if(batches_.begin(), batches_.end(),
+        [&target](const Batch& b) { return same_target(b.target, target); });
+
+    if (it == batches_.end()) {
+        batches_.push_back({ target, {} });
+        it = batches_.end() - 1;
+    }
+
+    if (!toBinaryFrame(lv, it->data)) {
+        OBJ_ERR << "list is too long to send: " << lv.size();
+        return;
+    }
+
+    if (it->data.size() >= MAX_BATCH_SIZE)
+        flushBatches();
+    else if (!flush_.isActive())
+        flush_.delay(0);
+}
+
+void NetWsServer::flushBatches()
+{
+    flush_.unset();
+
+    if (!srv_) {
+        batches_.clear();
+        return;
+    }
+
+    // every batch is encoded once and shared between all target clients
+    for (auto& b : batches_) {
+        if (!b.data.empty()) {
+            ceammc_ws_server_send_binary(srv_->handle(), b.data.data(), b.data.size(), b.target);
+            b.data.clear();
+        }
+    }
+
+    // keep buffers for the next tick, unless there are too many targets
+    if (batches_.size() > 8)
+        batches_.clear();
+}
+
+void NetWsServer::updateBacklog()
+{
+    if (srv_)
+        ceammc_ws_server_set_max_pending(srv_->handle(), backlog_->value());
+}
+
 void setup_net_ws_server()
 {
     ObjectFactory<NetWsServer> obj("net.ws.server");
@@ -425,6 +665,7 @@ void setup_net_ws_server()
     obj.addMethod("stop", &NetWsServer::m_stop);
     obj.addMethod("send_binary", &NetWsServer::m_send_binary);
     obj.addMethod("send_json", &NetWsServer::m_send_json);
+    obj.addMethod("send_atoms", &NetWsServer::m_send_atoms);
     obj.addMethod("shutdown", &NetWsServer::m_shutdown);
 
     obj.setXletsInfo({ "input" }, { "client messages", "client info" });
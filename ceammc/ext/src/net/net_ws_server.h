@@ -14,6 +14,7 @@
 #ifndef NET_WS_SERVER_H
 #define NET_WS_SERVER_H
 
+#include "ceammc_clock.h"
 #include "ceammc_object.h"
 #include "ceammc_poll_dispatcher.h"
 #include "ceammc_property_enum.h"
@@ -21,6 +22,7 @@
 #include "net_rust_struct.hpp"
 
 #include <cstdint>
+#include <functional>
 #include <vector>
 
 using namespace ceammc;
@@ -29,9 +31,25 @@ using Bytes = std::vector<std::uint8_t>;
 using BaseWsServer = DispatchedObject<BaseObject>;
 using WsServerImpl = net::NetService<ceammc_ws_server, ceammc_ws_server_init, ceammc_ws_server_result_cb>;
 
+/**
+ * Binary atom frame format, all numbers are little-endian.
+ * One websocket binary message contains one or more frames:
+ *   frame:  u16 atom count, atoms...
+ *   atom:   'f' f32 | 's' u16 length, utf8 bytes
+ */
 class NetWsServer : public BaseWsServer {
+    struct Batch {
+        ceammc_ws_client_target target;
+        Bytes data;
+    };
+
     std::unique_ptr<WsServerImpl> srv_;
     SymbolEnumProperty* mode_ { nullptr };
+    SymbolEnumProperty* binmode_ { nullptr };
+    BoolProperty* batch_ { nullptr };
+    IntProperty* backlog_ { nullptr };
+    std::vector<Batch> batches_;
+    ClockLambdaFunction flush_;
 
     enum RequestArgs {
         REQ_ARGS_EQ_0, // equal to zero
@@ -51,10 +69,24 @@ public:
     void m_send(t_symbol* s, const AtomListView& lv);
     void m_send_binary(t_symbol* s, const AtomListView& lv);
     void m_send_json(t_symbol* s, const AtomListView& lv);
+    void m_send_atoms(t_symbol* s, const AtomListView& lv);
     void m_shutdown(t_symbol* s, const AtomListView& lv);
 
     bool notify(int code) final;
 
+    /**
+     * append atom frame to the buffer
+     * @return false if the list or one of its strings is too long, nothing is appended then
+     */
+    static bool toBinaryFrame(const AtomListView& lv, Bytes& out);
+
+    /**
+     * decode atom frames from binary message
+     * @param fn - called for every decoded frame with AtomList argument
+     * @return false on malformed data
+     */
+    static bool fromBinaryFrames(const std::uint8_t* data, size_t len, std::function<void(const AtomList&)> fn);
+
 private:
     static AtomList fromBinary(const std::uint8_t* data, size_t len);
     static Bytes toBinary(const AtomListView& lv);
@@ -68,6 +100,10 @@ private:
     void processConnected(bool connected, const ceammc_ws_peer_info* peer);
 
     bool checkClientSelector(t_symbol* s, const AtomListView& lv, RequestArgs req);
+
+    void appendBatch(const ceammc_ws_client_target& target, const AtomListView& lv);
+    void flushBatches();
+    void updateBacklog();
 };
 
 void setup_net_ws_server();
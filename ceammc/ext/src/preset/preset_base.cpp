@@ -16,6 +16,7 @@ PresetBase::PresetBase(const PdArgs& args)
     , name_(&s_)
     , path_(&s_)
     , preset_path_(&s_)
+    , preset_(nullptr)
 {
     createOutlet();
 
@@ -79,19 +80,20 @@ void PresetBase::m_clear(t_symbol*, const AtomListView& index)
 
 void PresetBase::bind()
 {
-    bindReceive(gensym(Preset::SYM_PRESET_ALL));
-
     if (PresetStorage::instance().hasPreset(preset_path_)) {
         OBJ_DBG << "warning! preset already exists: " << preset_path_->s_name;
     }
 
-    PresetStorage::instance().bindPreset(preset_path_);
+    preset_ = PresetStorage::instance().bindPreset(preset_path_, this);
 }
 
 void PresetBase::unbind()
 {
-    unbindReceive();
-    PresetStorage::instance().unbindPreset(preset_path_);
+    if (!preset_)
+        return;
+
+    PresetStorage::instance().unbindPreset(preset_path_, this);
+    preset_ = nullptr;
 }
 
 t_symbol* PresetBase::makePath() const
@@ -142,22 +144,22 @@ void PresetBase::storeAt(size_t idx)
 
 t_float PresetBase::loadFloat(t_float idx, t_float def)
 {
-    return PresetStorage::instance().floatValueAt(preset_path_, idx, def);
+    return preset_ ? preset_->floatAt(idx, def) : def;
 }
 
 t_symbol* PresetBase::loadSymbol(size_t idx, t_symbol* def)
 {
-    return PresetStorage::instance().symbolValueAt(preset_path_, idx, def);
+    return preset_ ? preset_->symbolAt(idx, def) : def;
 }
 
 AtomListView PresetBase::loadList(size_t idx, const AtomListView& def)
 {
-    return PresetStorage::instance().listValueAt(preset_path_, idx, def);
+    return preset_ ? preset_->listAt(idx, def) : def;
 }
 
 AtomList PresetBase::loadAny(size_t idx, const AtomList& def)
 {
-    return PresetStorage::instance().anyValueAt(preset_path_, idx, def);
+    return preset_ ? preset_->anyAt(idx, def) : def;
 }
 
 void PresetBase::storeFloat(t_float f, size_t idx)
@@ -278,3 +280,23 @@ AtomList PresetBase::editorPresetValue(size_t idx) const
 {
     return {};
 }
+
+void PresetBase::presetLoad(t_float idx)
+{
+    loadFrom(idx);
+}
+
+void PresetBase::presetStore(size_t idx)
+{
+    storeAt(idx);
+}
+
+void PresetBase::presetClear(size_t idx)
+{
+    PresetStorage::instance().clearValueAt(preset_path_, idx);
+}
+
+void PresetBase::presetUpdate()
+{
+    m_update(&s_, {});
+}
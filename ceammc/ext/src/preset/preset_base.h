@@ -2,17 +2,19 @@
 #define PRESET_BASE_H
 
 #include "ceammc_object.h"
+#include "ceammc_preset.h"
 #include "ceammc_table_editor.h"
 
 using namespace ceammc;
 
-class PresetBase : public TableObject<BaseObject> {
+class PresetBase : public TableObject<BaseObject>, public PresetClient {
     FlagProperty* global_;
     FlagProperty* subpatch_;
 
     t_symbol* name_;
     t_symbol* path_;
     t_symbol* preset_path_;
+    Preset* preset_;
 
 public:
     PresetBase(const PdArgs& args);
@@ -49,6 +51,12 @@ public:
     virtual bool setEditorPreset(size_t idx, const AtomListView& lv);
     virtual AtomList editorPresetValue(size_t idx) const;
 
+    // called by PresetStorage
+    void presetLoad(t_float idx) final;
+    void presetStore(size_t idx) final;
+    void presetClear(size_t idx) final;
+    void presetUpdate() final;
+
 public:
     void m_load(t_symbol*, const AtomListView& index);
     void m_interp(t_symbol*, const AtomListView& index);
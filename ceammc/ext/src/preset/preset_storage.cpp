@@ -38,7 +38,7 @@ void PresetExternal::m_store(t_symbol*, const AtomListView& l)
 void PresetExternal::m_clear(t_symbol*, const AtomListView& l)
 {
     size_t idx = l.toT<size_t>(0);
-    pd::send_message(gensym(Preset::SYM_PRESET_ALL), gensym("clear"), Atom(idx));
+    PresetStorage::instance().clearAll(idx);
 }
 
 void PresetExternal::m_write(t_symbol*, const AtomListView& l)
@@ -12,6 +12,7 @@
  * this file belongs to.
  *****************************************************************************/
 #include "hoa_process.h"
+#include "ceammc_dsp.h"
 #include "ceammc_factory.h"
 #include "fmt/core.h"
 
@@ -24,6 +25,7 @@ HoaProcess::HoaProcess(const PdArgs& args)
     , patch_(nullptr)
     , num_(nullptr)
     , args_(nullptr)
+    , parallel_(nullptr)
     , clock_(this, &HoaProcess::clockTick)
     , mode_3d_(std::strchr(args.creationName->s_name, '3'))
 {
@@ -47,6 +49,18 @@ HoaProcess::HoaProcess(const PdArgs& args)
     num_->checkMinEq(0);
     num_->setArgIndex(0);
     addProperty(num_);
+
+    parallel_ = new BoolProperty("@parallel", false);
+    parallel_->setSuccessFn([this](Property*) {
+        // rebuild DSP chain
+        dsp::SuspendGuard dsp;
+    });
+    addProperty(parallel_);
+}
+
+HoaProcess::~HoaProcess()
+{
+    freeTasks();
 }
 
 void HoaProcess::initDone()
@@ -199,6 +213,31 @@ HoaProcess::InOutInfo HoaProcess::calcNumChannels() const
     };
 }
 
+static t_int* hoa_process_instance_perform(t_int* w)
+{
+    reinterpret_cast<ProcessInstance*>(w[1])->dspCalc();
+    return nullptr;
+}
+
+void HoaProcess::allocTasks()
+{
+    for (auto& inst : instances_) {
+        // instance chain: perform routine returning 0 ends the task
+        t_int* chain = static_cast<t_int*>(getbytes(2 * sizeof(t_int)));
+        chain[0] = reinterpret_cast<t_int>(hoa_process_instance_perform);
+        chain[1] = reinterpret_cast<t_int>(&inst);
+        tasks_.push_back(dsptask_new(chain, 2));
+    }
+}
+
+void HoaProcess::freeTasks()
+{
+    for (auto t : tasks_)
+        dsptask_free(t);
+
+    tasks_.clear();
+}
+
 void HoaProcess::sendToN(std::function<void(ProcessInstance*)> fn, size_t inst_idx)
 {
     if (inst_idx >= instances_.size()) {
@@ -475,8 +514,31 @@ void HoaProcess::processBlock(const t_sample** in, t_sample** out)
         memcpy(&in_buf_[i * BS], in[i], BS * sizeof(t_sample));
     }
 
-    for (auto& i : instances_)
-        i.dspCalc();
+    if (tasks_.empty()) {
+        for (auto& i : instances_)
+            i.dspCalc();
+    } else {
+        std::fill(extra_out_buf_.begin(), extra_out_buf_.end(), 0);
+
+        for (auto t : tasks_)
+            dsptask_fork(t);
+
+        dsptask_join();
+
+        // sum extra outputs in instance order, as the serial version does
+        const size_t NINST = instances_.size();
+        const size_t NEXTRA = NINST ? extra_out_buf_.size() / (NINST * BS) : 0;
+        const size_t OFFSET = out_buf_.size() / BS - NEXTRA;
+
+        for (size_t j = 0; j < NEXTRA; j++) {
+            t_sample* dest = &out_buf_[(OFFSET + j) * BS];
+            for (size_t i = 0; i < NINST; i++) {
+                const t_sample* src = &extra_out_buf_[(i * NEXTRA + j) * BS];
+                for (size_t k = 0; k < BS; k++)
+                    dest[k] += src[k];
+            }
+        }
+    }
 
     for (size_t i = 0; i < NOUTS; i++) {
         memcpy(out[i], &out_buf_[i * BS], BS * sizeof(t_sample));
@@ -491,6 +553,11 @@ void HoaProcess::setupDSP(t_signal** sp)
     const size_t NINST = instances_.size();
     auto info = calcNumChannels();
 
+    freeTasks();
+    extra_out_buf_.clear();
+    // instances are run by the worker threads only if we are on the main DSP thread
+    const bool parallel = parallel_->value() && NINST > 1 && dsp_parallel_available();
+
     if (info.in.num_chan > 0) {
         in_buf_.resize(info.in.num_chan * BS);
 
@@ -524,18 +591,38 @@ void HoaProcess::setupDSP(t_signal** sp)
 
         if (info.out.num_extra_chan > 0) {
             size_t offset = info.out.num_static_chan;
-            for (size_t j = 0; j < info.out.num_extra_chan; ++j) {
+            const size_t NEXTRA = info.out.num_extra_chan;
+
+            // extra outputs are shared between instances and accumulated,
+            // so each parallel instance gets its own copy summed after the join
+            if (parallel)
+                extra_out_buf_.assign(NINST * NEXTRA * BS, 0);
+
+            for (size_t j = 0; j < NEXTRA; ++j) {
                 t_sample* outbuf = &out_buf_[(offset + j) * BS];
 
                 for (size_t i = 0; i < NINST; ++i) {
-                    instances_[i].setOutletBuffer(outbuf, j + 1);
+                    if (parallel)
+                        instances_[i].setOutletBuffer(&extra_out_buf_[(i * NEXTRA + j) * BS], j + 1);
+                    else
+                        instances_[i].setOutletBuffer(outbuf, j + 1);
                 }
             }
         }
     }
 
-    for (auto& i : instances_)
-        i.canvas().setupDsp();
+    if (parallel) {
+        // instances should not share signal buffers when running in parallel
+        dsp_parallel_hold();
+        for (auto& i : instances_)
+            i.canvas().setupDsp();
+        dsp_parallel_unhold();
+
+        allocTasks();
+    } else {
+        for (auto& i : instances_)
+            i.canvas().setupDsp();
+    }
 }
 
 void HoaProcess::onClick(t_floatarg xpos, t_floatarg ypos, t_floatarg shift, t_floatarg ctrl, t_floatarg alt)
@@ -16,6 +16,7 @@
 
 #include "ceammc_clock.h"
 #include "ceammc_property_enum.h"
+#include "d_parallel.h"
 #include "hoa_common.h"
 #include "hoa_process_inlet.h"
 #include "hoa_process_instance.h"
@@ -40,11 +41,16 @@ class HoaProcess : public SoundExternal {
 
     Buffer in_buf_;
     Buffer out_buf_;
+    // per instance extra outputs, used when instances run in parallel
+    Buffer extra_out_buf_;
+    // one task per instance, empty if instances run serially
+    std::vector<t_dsptask*> tasks_;
 
     SymbolEnumProperty* domain_;
     SymbolProperty* patch_;
     IntProperty* num_;
     ListProperty* args_;
+    BoolProperty* parallel_;
     bool mode_3d_ { false };
 
     // used to send loadbang to instances
@@ -52,6 +58,7 @@ class HoaProcess : public SoundExternal {
 
 public:
     HoaProcess(const PdArgs& args);
+    ~HoaProcess() override;
 
     void processBlock(const t_sample** in, t_sample** out) override;
     void setupDSP(t_signal** sp) final;
@@ -85,6 +92,9 @@ private:
 
     InOutInfo calcNumChannels() const;
 
+    void allocTasks();
+    void freeTasks();
+
 public:
     void sendToN(std::function<void(ProcessInstance*)> fn, size_t inst_idx);
     void sendToAll(std::function<void(ProcessInstance*)> fn);
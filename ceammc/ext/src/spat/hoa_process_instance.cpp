@@ -101,8 +101,9 @@ void ProcessInstance::dspOn(bool state)
 
 void ProcessInstance::dspCalc()
 {
+    // not a bang: called from dsp tasks when instances run in parallel
     if (switch_ && dsp_state_)
-        pd::object_bang(switch_);
+        dsp_switch_run(&switch_->ob_pd);
 }
 
 bool ProcessInstance::init(t_symbol* name, const AtomListView& args)
@@ -3,6 +3,8 @@
 void setup_system_colorpanel();
 void setup_system_command();
 void setup_system_cursor();
+void setup_system_dsp_profile();
+void setup_system_dsp_stats();
 void setup_system_exec();
 void setup_system_exit();
 void setup_system_getenv();
@@ -17,6 +19,8 @@ void ceammc_system_setup()
     setup_system_colorpanel();
     setup_system_command();
     setup_system_cursor();
+    setup_system_dsp_profile();
+    setup_system_dsp_stats();
     setup_system_exec();
     setup_system_exit();
     setup_system_getenv();
@@ -0,0 +1,80 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavski. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "system_dsp_profile.h"
+#include "ceammc_factory.h"
+#include "d_profile.h"
+#include "g_canvas.h"
+
+SystemDspProfile::SystemDspProfile(const PdArgs& a)
+    : BaseObject(a)
+    , n_(nullptr)
+{
+    createOutlet();
+    createOutlet();
+
+    n_ = new IntProperty("@n", 10);
+    n_->checkMinEq(1);
+    n_->setArgIndex(0);
+    addProperty(n_);
+
+    createCbBoolProperty(
+        "@on",
+        []() -> bool { return dsp_getprofile(); },
+        [](bool v) -> bool { dsp_setprofile(v); return true; });
+}
+
+void SystemDspProfile::onBang()
+{
+    t_dspprofilestat* stats = nullptr;
+    const int N = dsp_getprofilestats(&stats);
+
+    t_float load = 0;
+    for (int i = 0; i < N; i++)
+        load += stats[i].ps_load;
+
+    floatTo(1, load);
+
+    AtomList res;
+    res.reserve(6);
+    int nout = 0;
+    for (int i = 0; i < N && nout < n_->value(); i++) {
+        auto& s = stats[i];
+        // skip deleted objects
+        if (!s.ps_canvas)
+            continue;
+
+        res.clear();
+        res.append(s.ps_class);
+        res.append(s.ps_canvas->gl_name);
+        res.append(s.ps_index);
+        res.append(s.ps_pertick);
+        res.append(s.ps_percent);
+        res.append(s.ps_load);
+        listTo(0, res);
+        nout++;
+    }
+
+    dsp_freeprofilestats(stats, N);
+}
+
+void SystemDspProfile::m_reset(t_symbol* s, const AtomListView& lv)
+{
+    dsp_resetprofile();
+}
+
+void setup_system_dsp_profile()
+{
+    ObjectFactory<SystemDspProfile> obj("system.dsp_profile");
+    obj.addMethod("reset", &SystemDspProfile::m_reset);
+}
@@ -0,0 +1,33 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavski. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#ifndef SYSTEM_DSP_PROFILE_H
+#define SYSTEM_DSP_PROFILE_H
+
+#include "ceammc_object.h"
+
+using namespace ceammc;
+
+class SystemDspProfile : public BaseObject {
+    IntProperty* n_;
+
+public:
+    SystemDspProfile(const PdArgs& a);
+    void onBang() override;
+
+    void m_reset(t_symbol* s, const AtomListView& lv);
+};
+
+void setup_system_dsp_profile();
+
+#endif // SYSTEM_DSP_PROFILE_H
@@ -0,0 +1,88 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavski. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "system_dsp_stats.h"
+#include "ceammc_factory.h"
+
+#include <array>
+
+SystemDspStats::SystemDspStats(const PdArgs& a)
+    : BaseObject(a)
+    , read_pos_(0)
+{
+    createOutlet();
+
+    // skip ticks logged before the object was created
+    std::array<t_float, SCHEDSTATS_RINGSIZE> buf;
+    while (sched_readticks(&read_pos_, buf.data(), buf.size()) > 0)
+        ;
+
+    createCbIntProperty("@ticks", [this]() -> int { return stats().ss_ticks; });
+    createCbIntProperty("@late", [this]() -> int { return stats().ss_late; });
+    createCbIntProperty("@xruns", [this]() -> int { return stats().ss_xruns; });
+
+    // times in milliseconds
+    createCbFloatProperty("@period", [this]() -> t_float { return stats().ss_period * 0.001; })
+        ->setUnitsMs();
+    createCbFloatProperty("@max", [this]() -> t_float { return stats().ss_max * 0.001; })
+        ->setUnitsMs();
+    createCbFloatProperty("@mean", [this]() -> t_float { return stats().ss_mean * 0.001; })
+        ->setUnitsMs();
+    createCbFloatProperty("@p50", [this]() -> t_float { return stats().ss_p50 * 0.001; })
+        ->setUnitsMs();
+    createCbFloatProperty("@p90", [this]() -> t_float { return stats().ss_p90 * 0.001; })
+        ->setUnitsMs();
+    createCbFloatProperty("@p99", [this]() -> t_float { return stats().ss_p99 * 0.001; })
+        ->setUnitsMs();
+
+    createCbFloatProperty("@idle", [this]() -> t_float { return stats().ss_idle; });
+    createCbListProperty("@hist", [this]() -> AtomList {
+        auto st = stats();
+        AtomList res;
+        res.reserve(SCHEDSTATS_NBINS);
+        for (auto n : st.ss_hist)
+            res.append(Atom(n));
+        return res;
+    });
+}
+
+t_schedstats SystemDspStats::stats() const
+{
+    t_schedstats st;
+    sched_getstats(&st);
+    return st;
+}
+
+void SystemDspStats::onBang()
+{
+    std::array<t_float, SCHEDSTATS_RINGSIZE> buf;
+    const int N = sched_readticks(&read_pos_, buf.data(), buf.size());
+
+    AtomList res;
+    res.reserve(N);
+    for (int i = 0; i < N; i++)
+        res.append(buf[i]);
+
+    listTo(0, res);
+}
+
+void SystemDspStats::m_reset(t_symbol* s, const AtomListView& lv)
+{
+    sched_resetstats();
+}
+
+void setup_system_dsp_stats()
+{
+    ObjectFactory<SystemDspStats> obj("system.dsp_stats");
+    obj.addMethod("reset", &SystemDspStats::m_reset);
+}
@@ -24,7 +24,7 @@
 using TlEventsBase = EditorObject<SaveObject<TlBaseObject>>;
 
 class TlEvents : public TlEventsBase {
-    using FixedAtomList = SmallAtomListN<8>;
+    using FixedAtomList = HeapAtomListN<8>;
     using FixedEditorList = boost::container::small_vector<FixedAtomList, 48>;
     FixedEditorList src_;
     parser::TimeLine tl_;
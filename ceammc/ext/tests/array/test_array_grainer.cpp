@@ -897,4 +897,72 @@ TEST_CASE("array.grainer", "[externals]")
         REQUIRE(t.cloud().grains().at(3)->timeBefore() == 96);
         REQUIRE(t.cloud().grains().at(3)->timeAfter() == 88);
     }
+
+    SECTION("chunked render")
+    {
+        // grains without modulation are rendered by chunks, the constant amp modulator
+        // forces the per-sample path: the output should be the same
+        constexpr size_t N = 1000;
+        constexpr size_t BS = 64;
+        constexpr size_t SR = 48000;
+
+        ArrayPtr aptr = cnv->createArray("array_g_chunk", N);
+        aptr->fillWith([](size_t i) -> t_float { return std::sin(i * 0.05) + 0.25 * std::cos(i * 0.31); });
+
+        const GrainInterp interps[] = { GRAIN_INTERP_NONE, GRAIN_INTERP_LINEAR, GRAIN_INTERP_CUBIC };
+        const GrainWindowType wins[] = { GRAIN_WIN_RECT, GRAIN_WIN_TRI, GRAIN_WIN_HANN, GRAIN_WIN_TRPZ, GRAIN_WIN_LINUP, GRAIN_WIN_LINDOWN };
+        const float speeds[] = { 1, 0.7, 1.3, -1, -0.7, -1.3 };
+        // the last one reaches the array end
+        const size_t positions[] = { 100, 700 };
+
+        auto init_grain = [](Grain& g, size_t pos, GrainInterp interp, GrainWindowType win, float speed) {
+            g.setArrayPosInSamples(pos);
+            g.setLengthInSamples(600);
+            g.setTimeBefore(37);
+            g.setTimeAfter(10);
+            g.setAmplitude(0.5);
+            g.setPan(0.25);
+            g.setSpeed(speed);
+            g.setPlayInterpolation(interp);
+            g.setWinType(win);
+            g.start(0);
+        };
+
+        for (auto pos : positions) {
+            for (auto interp : interps) {
+                for (auto win : wins) {
+                    for (auto speed : speeds) {
+                        INFO("pos: " << pos << ", interp: " << int(interp) << ", win: " << int(win) << ", speed: " << speed);
+
+                        Grain g0, g1;
+                        init_grain(g0, pos, interp, win, speed);
+                        init_grain(g1, pos, interp, win, speed);
+                        g1.setModulation(GRAIN_PROP_AMP, GrainPropModulator(GRAIN_MOD_SIN, 1, 0.5, 0.5));
+                        REQUIRE_FALSE(g0.hasModulation(GRAIN_PROP_AMP));
+                        REQUIRE(g1.hasModulation(GRAIN_PROP_AMP));
+
+                        size_t nblocks = 0;
+                        for (; nblocks < 100 && g0.playStatus() == GRAIN_PLAYING; nblocks++) {
+                            DspVector l0(BS, 0), r0(BS, 0), l1(BS, 0), r1(BS, 0);
+                            t_sample* buf0[] = { l0.data(), r0.data() };
+                            t_sample* buf1[] = { l1.data(), r1.data() };
+                            uint32_t done0 = 0, done1 = 0;
+
+                            const auto st0 = g0.process(aptr->begin(), aptr->size(), buf0, BS, SR, 0, &done0);
+                            const auto st1 = g1.process(aptr->begin(), aptr->size(), buf1, BS, SR, 0, &done1);
+
+                            REQUIRE(st0 == st1);
+                            REQUIRE(done0 == done1);
+                            REQUIRE(l0 == l1);
+                            REQUIRE(r0 == r1);
+                        }
+
+                        REQUIRE(nblocks > 0);
+                        REQUIRE(g0.playStatus() == GRAIN_FINISHED);
+                        REQUIRE(g1.playStatus() == GRAIN_FINISHED);
+                    }
+                }
+            }
+        }
+    }
 }
@@ -0,0 +1,213 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "base_convolve_tilde.h"
+#include "test_base.h"
+#include "test_external.h"
+#include "test_sound.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+PD_COMPLETE_SND_TEST_SETUP(BaseConvolveTilde, base, convolve_tilde);
+
+static std::vector<t_sample> direct_conv(const std::vector<t_sample>& x, const AtomList& ir)
+{
+    std::vector<t_sample> res(x.size(), 0);
+    for (size_t n = 0; n < x.size(); n++) {
+        for (size_t k = 0; k < ir.size() && k <= n; k++)
+            res[n] += x[n - k] * ir[k].asFloat();
+    }
+
+    return res;
+}
+
+static std::vector<t_sample> rand_signal(size_t n)
+{
+    std::vector<t_sample> res(n);
+    for (auto& x : res)
+        x = (rand() % 2001 - 1000) / 1000.0;
+
+    return res;
+}
+
+static size_t peak_pos(const std::vector<t_sample>& v)
+{
+    size_t pos = 0;
+    for (size_t i = 1; i < v.size(); i++) {
+        if (std::fabs(v[i]) > std::fabs(v[pos]))
+            pos = i;
+    }
+
+    return pos;
+}
+
+TEST_CASE("convolve~", "[externals]")
+{
+    pd_test_init();
+
+    SECTION("init")
+    {
+        TExt t("convolve~", L(), true);
+        REQUIRE(t.numInputChannels() == 1);
+        REQUIRE(t.numOutputChannels() == 1);
+
+        TExt t1("convolve~", LA("@in", 2, "@ch", 4), true);
+        REQUIRE(t1.numInputChannels() == 2);
+        REQUIRE(t1.numOutputChannels() == 4);
+    }
+
+    SECTION("short IR")
+    {
+        const AtomList ir { 0.5, -0.25, 0.125, 1, 0, -0.75, 0.3 };
+        const size_t NBLOCKS = 10;
+
+        TExt t("convolve~", LA("@norm", 0.f), true);
+        t.m_set(&s_, ir);
+
+        TestSignal<1, 1> sig;
+        DSP<TestSignal<1, 1>, TExt> dsp(sig, t);
+
+        auto x = rand_signal(NBLOCKS * dsp.BS);
+        auto y = direct_conv(x, ir);
+
+        for (size_t b = 0; b < NBLOCKS; b++) {
+            for (size_t i = 0; i < dsp.BS; i++)
+                sig.buf_in[0][i] = x[b * dsp.BS + i];
+
+            dsp.processBlock();
+
+            for (size_t i = 0; i < dsp.BS; i++)
+                REQUIRE(std::fabs(dsp.out(0, i) - y[b * dsp.BS + i]) < 1e-5);
+        }
+    }
+
+    SECTION("long IR: tail convolution")
+    {
+        // head, first and background tail partitions
+        const size_t TAIL_POS = 17000;
+        AtomList ir;
+        ir.fill(Atom(0.f), TAIL_POS + 1000);
+        ir[0] = Atom(1);
+        ir[100] = Atom(-0.5);
+        ir[9000] = Atom(0.25);
+        ir[TAIL_POS] = Atom(0.5);
+
+        TExt t("convolve~", LA("@norm", 0.f, "@maxsize", 20000), true);
+        t.m_set(&s_, ir);
+
+        TestSignal<1, 1> sig;
+        DSP<TestSignal<1, 1>, TExt> dsp(sig, t);
+
+        std::vector<t_sample> out;
+        for (size_t b = 0; b < (TAIL_POS + 1000) / dsp.BS; b++) {
+            sig.fillInput(0);
+            if (b == 0)
+                sig.buf_in[0][0] = 1;
+
+            dsp.processBlock();
+
+            for (size_t i = 0; i < dsp.BS; i++)
+                out.push_back(dsp.out(0, i));
+        }
+
+        for (size_t i = 0; i < out.size(); i++)
+            REQUIRE(std::fabs(out[i] - ir[i].asFloat()) < 1e-5);
+    }
+
+    SECTION("mono IR copied to all outputs")
+    {
+        const AtomList ir { 1, 0.5, 0.25 };
+
+        TExt t("convolve~", LA("@ch", 3, "@norm", 0.f), true);
+        t.m_set(&s_, ir);
+
+        TestSignal<1, 3> sig;
+        DSP<TestSignal<1, 3>, TExt> dsp(sig, t);
+
+        auto x = rand_signal(dsp.BS);
+        auto y = direct_conv(x, ir);
+        for (size_t i = 0; i < dsp.BS; i++)
+            sig.buf_in[0][i] = x[i];
+
+        dsp.processBlock();
+
+        for (size_t k = 0; k < 3; k++) {
+            for (size_t i = 0; i < dsp.BS; i++)
+                REQUIRE(std::fabs(dsp.out(k, i) - y[i]) < 1e-5);
+        }
+    }
+
+    SECTION("mono IR: output per input")
+    {
+        const AtomList ir { 1, -0.5 };
+
+        TExt t("convolve~", LA("@in", 2, "@ch", 2, "@norm", 0.f), true);
+        t.m_set(&s_, ir);
+
+        TestSignal<2, 2> sig;
+        DSP<TestSignal<2, 2>, TExt> dsp(sig, t);
+
+        auto x0 = rand_signal(dsp.BS);
+        auto x1 = rand_signal(dsp.BS);
+        auto y0 = direct_conv(x0, ir);
+        auto y1 = direct_conv(x1, ir);
+        for (size_t i = 0; i < dsp.BS; i++) {
+            sig.buf_in[0][i] = x0[i];
+            sig.buf_in[1][i] = x1[i];
+        }
+
+        dsp.processBlock();
+
+        for (size_t i = 0; i < dsp.BS; i++) {
+            REQUIRE(std::fabs(dsp.out(0, i) - y0[i]) < 1e-5);
+            REQUIRE(std::fabs(dsp.out(1, i) - y1[i]) < 1e-5);
+        }
+    }
+
+    SECTION("true stereo IR")
+    {
+        // channel N has impulse at sample N: LL=0, LR=1, RL=2, RR=3
+        TExt t("convolve~", LA("@in", 2, "@ch", 2, "@norm", 0.f), true);
+        t.m_load_file(&s_, LA(TEST_DATA_DIR "/base/ir_ch04_48k_16samp.wav"));
+
+        TestSignal<2, 2> sig;
+        DSP<TestSignal<2, 2>, TExt> dsp(sig, t);
+
+        auto out = [&dsp](size_t k) {
+            std::vector<t_sample> res;
+            for (size_t i = 0; i < dsp.BS; i++)
+                res.push_back(dsp.out(k, i));
+            return res;
+        };
+
+        // left input only
+        sig.fillInput(0);
+        sig.buf_in[0][0] = 1;
+        dsp.processBlock();
+        REQUIRE(peak_pos(out(0)) == 0);
+        REQUIRE(peak_pos(out(1)) == 1);
+
+        // wait for the tail
+        sig.fillInput(0);
+        for (int i = 0; i < 4; i++)
+            dsp.processBlock();
+
+        // right input only
+        sig.buf_in[1][0] = 1;
+        dsp.processBlock();
+        REQUIRE(peak_pos(out(0)) == 2);
+        REQUIRE(peak_pos(out(1)) == 3);
+    }
+}
@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "snd_play_tilde.h"
+#include "test_base.h"
+#include "test_external.h"
+#include "test_sound.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+PD_COMPLETE_SND_TEST_SETUP(SndPlayTilde, snd, play_tilde);
+
+using TV = units::TimeValue;
+
+TEST_CASE("snd.play~", "[externals]")
+{
+    pd_test_init();
+
+    SECTION("calcEnd")
+    {
+        std::int64_t res = 0;
+
+        // default: until the end
+        REQUIRE(SndPlayTilde::calcEnd(TV(-1), 48000, 4800, 0, res));
+        REQUIRE(res == 4800);
+
+        REQUIRE(SndPlayTilde::calcEnd(TV(100, TV::SAMPLE), 48000, 4800, 0, res));
+        REQUIRE(res == 100);
+        REQUIRE(SndPlayTilde::calcEnd(TV(10, TV::MS), 48000, 4800, 0, res));
+        REQUIRE(res == 480);
+        REQUIRE(SndPlayTilde::calcEnd(TV(4800, TV::SAMPLE), 48000, 4800, 0, res));
+        REQUIRE(res == 4800);
+
+        // clipped to the file end
+        REQUIRE(SndPlayTilde::calcEnd(TV(10000, TV::SAMPLE), 48000, 4800, 0, res));
+        REQUIRE(res == 4800);
+
+        // at least one sample after begin
+        REQUIRE(SndPlayTilde::calcEnd(TV(100, TV::SAMPLE), 48000, 4800, 200, res));
+        REQUIRE(res == 201);
+        REQUIRE(SndPlayTilde::calcEnd(TV(0, TV::SAMPLE), 48000, 4800, 0, res));
+        REQUIRE(res == 1);
+
+        // begin out of range
+        REQUIRE_FALSE(SndPlayTilde::calcEnd(TV(100, TV::SAMPLE), 48000, 4800, 4800, res));
+    }
+
+    SECTION("play @end")
+    {
+        // snd_mono_48k.wav: 4800 samples with 2^10 value
+        TExt t("snd.play~", LA(1, TEST_DATA_DIR "/snd_mono_48k.wav", "@end", "100samp"));
+        TestSignal<0, 1> sig;
+        DSP<TestSignal<0, 1>, TExt> dsp(sig, t);
+
+        t.sendFloat(1);
+
+        // decoded by the stream pool threads
+        size_t nsamp = 0;
+        for (int i = 0; i < 100; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            dsp.processBlock();
+
+            for (size_t k = 0; k < dsp.BS; k++) {
+                if (std::fabs(sig.out[0][k]) > 0.01)
+                    nsamp++;
+            }
+        }
+
+        // resampler can smear the edges a bit
+        REQUIRE(nsamp >= 90);
+        REQUIRE(nsamp <= 110);
+    }
+}
@@ -0,0 +1,242 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "catch.hpp"
+#include "test_base.h"
+
+#include "ceammc_arena.h"
+#include "ceammc_containers.h"
+
+#include <thread>
+
+using namespace ceammc;
+
+namespace {
+struct ArenaBinder {
+    AtomArena arena;
+    ArenaBinder(size_t cap = AtomArena::INIT_CAPACITY)
+        : arena(cap)
+    {
+        AtomArena::bind(&arena);
+    }
+    ~ArenaBinder() { AtomArena::bind(nullptr); }
+};
+}
+
+TEST_CASE("AtomArena", "[core]")
+{
+    test::pdPrintToStdError();
+
+    SECTION("init")
+    {
+        AtomArena a;
+        REQUIRE(a.capacity() == AtomArena::INIT_CAPACITY);
+        REQUIRE(a.used() == 0);
+        REQUIRE(a.liveBlocks() == 0);
+        REQUIRE(AtomArena::current() == nullptr);
+    }
+
+    SECTION("lifo")
+    {
+        ArenaBinder b;
+        auto& a = b.arena;
+
+        auto p0 = a.allocate(16);
+        REQUIRE(p0);
+        REQUIRE(a.liveBlocks() == 1);
+        const auto u0 = a.used();
+        REQUIRE(u0 > 16);
+
+        auto p1 = a.allocate(100);
+        REQUIRE(p1 > p0);
+        REQUIRE(a.liveBlocks() == 2);
+        const auto u1 = a.used();
+        REQUIRE(u1 > u0);
+
+        // top block is popped
+        AtomArena::deallocate(p1);
+        REQUIRE(a.liveBlocks() == 1);
+        REQUIRE(a.used() == u0);
+
+        // memory is reused
+        auto p2 = a.allocate(100);
+        REQUIRE(p2 == p1);
+        AtomArena::deallocate(p2);
+
+        // rewind on last free
+        AtomArena::deallocate(p0);
+        REQUIRE(a.liveBlocks() == 0);
+        REQUIRE(a.used() == 0);
+        REQUIRE(a.stats().arena_allocs == 3);
+        REQUIRE(a.stats().heap_allocs == 0);
+    }
+
+    SECTION("non lifo")
+    {
+        ArenaBinder b;
+        auto& a = b.arena;
+
+        auto p0 = a.allocate(16);
+        auto p1 = a.allocate(16);
+        const auto u = a.used();
+
+        AtomArena::deallocate(p0);
+        REQUIRE(a.liveBlocks() == 1);
+        REQUIRE(a.used() == u);
+
+        AtomArena::deallocate(p1);
+        REQUIRE(a.liveBlocks() == 0);
+        REQUIRE(a.used() == 0);
+    }
+
+    SECTION("reset")
+    {
+        ArenaBinder b;
+        auto& a = b.arena;
+
+        auto p0 = a.allocate(16);
+        REQUIRE_FALSE(a.reset());
+        REQUIRE(a.stats().pinned == 1);
+        REQUIRE(a.stats().resets == 0);
+        REQUIRE(a.used() > 0);
+
+        AtomArena::deallocate(p0);
+        REQUIRE(a.reset());
+        REQUIRE(a.stats().resets == 1);
+        REQUIRE(a.used() == 0);
+
+        a.clearStats();
+        REQUIRE(a.stats().resets == 0);
+        REQUIRE(a.stats().pinned == 0);
+    }
+
+    SECTION("heap fallback")
+    {
+        ArenaBinder b(1024);
+        auto& a = b.arena;
+        REQUIRE(a.capacity() == 1024);
+
+        auto p0 = a.allocate(512);
+        auto p1 = a.allocate(1024);
+        REQUIRE(a.stats().arena_allocs == 1);
+        REQUIRE(a.stats().heap_allocs == 1);
+        REQUIRE(a.liveBlocks() == 1);
+
+        AtomArena::deallocate(p1);
+        AtomArena::deallocate(p0);
+        REQUIRE(a.liveBlocks() == 0);
+
+        // grows on reset
+        REQUIRE(a.reset());
+        REQUIRE(a.capacity() >= 2048);
+
+        auto p2 = a.allocate(1024);
+        REQUIRE(a.stats().arena_allocs == 2);
+        REQUIRE(a.stats().heap_allocs == 1);
+        AtomArena::deallocate(p2);
+    }
+
+    SECTION("max capacity")
+    {
+        ArenaBinder b(AtomArena::MAX_CAPACITY);
+        auto& a = b.arena;
+
+        auto p = a.allocate(AtomArena::MAX_CAPACITY);
+        REQUIRE(a.stats().heap_allocs == 1);
+        AtomArena::deallocate(p);
+
+        REQUIRE(a.reset());
+        REQUIRE(a.capacity() == AtomArena::MAX_CAPACITY);
+    }
+
+    SECTION("unbound")
+    {
+        AtomArena::deallocate(nullptr);
+
+        auto p = AtomArena::heapAllocate(32);
+        REQUIRE(p);
+        AtomArena::deallocate(p);
+
+        ArenaAllocator<Atom> alloc;
+        auto atoms = alloc.allocate(10);
+        REQUIRE(atoms);
+        alloc.deallocate(atoms, 10);
+    }
+
+    SECTION("other thread")
+    {
+        ArenaBinder b;
+        auto& a = b.arena;
+
+        auto p0 = a.allocate(16);
+        auto p1 = a.allocate(16);
+        const auto u = a.used();
+
+        void* p2 = nullptr;
+        AtomArena* other = &a;
+        std::thread t([&]() {
+            // not bound in this thread
+            other = AtomArena::current();
+            AtomArena::deallocate(p1);
+            p2 = ArenaAllocator<char>().allocate(16);
+        });
+        t.join();
+
+        REQUIRE(other == nullptr);
+        REQUIRE(a.liveBlocks() == 1);
+        REQUIRE(a.used() == u);
+        REQUIRE(a.stats().arena_allocs == 2);
+
+        AtomArena::deallocate(p2);
+        AtomArena::deallocate(p0);
+        REQUIRE(a.liveBlocks() == 0);
+        REQUIRE(a.used() == 0);
+    }
+
+    SECTION("SmallAtomList")
+    {
+        ArenaBinder b;
+        auto& a = b.arena;
+
+        {
+            SmallAtomListN<2> l;
+            l.push_back(1);
+            l.push_back(2);
+            REQUIRE(a.liveBlocks() == 0);
+
+            l.push_back(3);
+            REQUIRE(a.liveBlocks() == 1);
+            REQUIRE(a.stats().arena_allocs == 1);
+
+            for (int i = 0; i < 100; i++)
+                l.push_back(i);
+
+            REQUIRE(l.size() == 103);
+            REQUIRE(l[0] == Atom(1));
+            REQUIRE(l[102] == Atom(99));
+            REQUIRE(a.liveBlocks() == 1);
+        }
+
+        REQUIRE(a.liveBlocks() == 0);
+        REQUIRE(a.used() == 0);
+
+        {
+            HeapAtomListN<2> l { 1, 2, 3, 4 };
+            REQUIRE(l.size() == 4);
+            REQUIRE(a.liveBlocks() == 0);
+        }
+
+        REQUIRE(a.stats().arena_allocs > 1);
+        REQUIRE(a.stats().heap_allocs == 0);
+    }
+}
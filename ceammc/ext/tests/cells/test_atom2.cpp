@@ -17,6 +17,9 @@
 
 #include "catch.hpp"
 
+#include <thread>
+#include <vector>
+
 using namespace ceammc;
 
 static Atom DOLL_SYM(const char* s)
@@ -477,6 +480,63 @@ TEST_CASE("Atom2", "[core]")
         REQUIRE(i.refCount() == 1);
     }
 
+    SECTION("copy on write")
+    {
+        using IntAtom = DataAtom<IntData>;
+
+        IntAtom i0(100);
+        auto p0 = i0.asData();
+        REQUIRE(i0.isUniqueData());
+
+        // unique: no copy
+        REQUIRE(i0.ensureUniqueData());
+        REQUIRE(i0.asData() == p0);
+        REQUIRE(i0.mutableData() == p0);
+
+        // shared: copy
+        IntAtom i1(i0);
+        REQUIRE_FALSE(i0.isUniqueData());
+        REQUIRE_FALSE(i1.isUniqueData());
+        REQUIRE(i1.refCount() == 2);
+
+        i1.mutableData()->setValue(200);
+        REQUIRE(i1.asData() != p0);
+        REQUIRE(i0.asData() == p0);
+        REQUIRE(i0->value() == 100);
+        REQUIRE(i1->value() == 200);
+        REQUIRE(i0.isUniqueData());
+        REQUIRE(i1.isUniqueData());
+
+        Atom f(1);
+        REQUIRE_FALSE(f.isUniqueData());
+        REQUIRE_FALSE(f.ensureUniqueData());
+        REQUIRE(f == Atom(1));
+    }
+
+    SECTION("threads")
+    {
+        Atom a(new IntData(100));
+        auto p = a.asData();
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([a]() {
+                for (int j = 0; j < 10000; j++) {
+                    Atom copy(a);
+                    Atom other;
+                    other = copy;
+                }
+            });
+        }
+
+        for (auto& t : threads)
+            t.join();
+
+        REQUIRE(a.refCount() == 1);
+        REQUIRE(a.asData() == p);
+        REQUIRE(a.asD<IntData>()->value() == 100);
+    }
+
     SECTION("floatAt*")
     {
         REQUIRE(S("A").asFloatGreaterThen(0, 5000) == F(5000));
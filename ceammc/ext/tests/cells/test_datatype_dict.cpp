@@ -404,6 +404,68 @@ TEST_CASE("DataTypeDict", "[core]")
         REQUIRE(d == Dict("[c: 3 b: 2]"));
     }
 
+    SECTION("order")
+    {
+        Dict d;
+        d.insert("z", A(1));
+        d.insert("a", A(2));
+        d.insert("m", A(3));
+        REQUIRE(d.keys() == LA("z", "a", "m"));
+        REQUIRE(d.toString() == "[z: 1 a: 2 m: 3]");
+
+        // overwrite keeps position
+        d.insert("a", A(20));
+        REQUIRE(d.keys() == LA("z", "a", "m"));
+        REQUIRE(d.at("a") == LF(20));
+
+        REQUIRE(d.remove("z"));
+        REQUIRE(d.keys() == LA("a", "m"));
+        d.insert("z", A(1));
+        REQUIRE(d.keys() == LA("a", "m", "z"));
+
+        // equality doesn't depend on order
+        REQUIRE(d == Dict("[z: 1 m: 3 a: 20]"));
+        REQUIRE_FALSE(d == Dict("[z: 1 m: 3 a: 2]"));
+    }
+
+    SECTION("many keys")
+    {
+        const int N = 1000;
+        auto key = [](int i) { return gensym(("key" + std::to_string(i)).c_str()); };
+
+        Dict d;
+        for (int i = 0; i < N; i++)
+            d.insert(key(i), A(i));
+
+        REQUIRE(d.size() == N);
+
+        for (int i = 0; i < N; i += 2)
+            REQUIRE(d.remove(key(i)));
+
+        d.removeIf([&key](t_symbol* k) { return k == key(1) || k == key(N - 1); });
+
+        REQUIRE(d.size() == N / 2 - 2);
+        for (int i = 0; i < N; i++) {
+            const bool found = (i % 2 == 1) && i != 1 && i != N - 1;
+            REQUIRE(d.contains(key(i)) == found);
+            if (found)
+                REQUIRE(d.at(key(i)) == LF(i));
+        }
+
+        int prev = 1;
+        for (auto& kv : d) {
+            const int i = kv.second[0].asInt();
+            REQUIRE(i > prev);
+            prev = i;
+        }
+
+        Dict d2(d);
+        REQUIRE(d2 == d);
+        d2.clear();
+        REQUIRE(d2.size() == 0);
+        REQUIRE_FALSE(d2.contains(key(3)));
+    }
+
     SECTION("fromDataString")
     {
         Dict d;
@@ -0,0 +1,218 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "catch.hpp"
+#include "ceammc_pd.h"
+#include "test_base.h"
+
+#include <cstring>
+#include <memory>
+
+#ifndef PD
+#define PD
+#endif
+
+extern "C" {
+#include "x_vexp.h"
+
+struct ex_ex* ex_eval(struct expr* expr, struct ex_ex* eptr, struct ex_ex* optr, int idx);
+}
+
+using namespace ceammc;
+
+namespace {
+
+constexpr int BS = 64;
+
+using ExternalPtr = std::unique_ptr<pd::External>;
+
+ExternalPtr make_expr(const char* name, const char* args)
+{
+    auto bb = binbuf_new();
+    binbuf_text(bb, args, strlen(args));
+    ExternalPtr res(new pd::External(name, AtomList(bb)));
+    binbuf_free(bb);
+    return res;
+}
+
+t_expr* to_expr(const ExternalPtr& ext)
+{
+    return ext->isNull() ? nullptr : reinterpret_cast<t_expr*>(ext->object());
+}
+
+t_float in[MAX_VARS][BS];
+t_float tree[BS];
+t_float bytecode[BS];
+
+void setup_inputs(t_expr* x)
+{
+    for (int i = 0; i < MAX_VARS; i++) {
+        for (int j = 0; j < BS; j++)
+            in[i][j] = ((i * 31 + j * 17) % 41 - 20) * 0.25;
+
+        auto& v = x->exp_var[i];
+        if (v.ex_type == ET_FI)
+            v.ex_flt = 1.5 - i;
+        else if (v.ex_type == ET_II)
+            v.ex_int = 3 - i;
+        else if (!IS_EXPR(x) && (i == 0 || v.ex_type == ET_VI || v.ex_type == ET_XI))
+            v.ex_vec = in[i];
+    }
+
+    if (!IS_FEXPR_TILDE(x))
+        return;
+
+    // fexpr~ history
+    for (int i = 0; i < x->exp_nexpr; i++) {
+        for (int j = 0; j < BS; j++) {
+            x->exp_p_res[i][j] = j * 0.5 - i;
+            x->exp_tmpres[i][j] = 7 - j * 0.125;
+        }
+    }
+}
+
+bool same(t_float a, t_float b)
+{
+    return std::memcmp(&a, &b, sizeof(a)) == 0 || (a != a && b != b);
+}
+
+// compares the tree walker and the compiled program on the same object
+bool compare(const char* name, const char* args)
+{
+    auto ext = make_expr(name, args);
+    auto x = to_expr(ext);
+    if (!x) {
+        std::cerr << "not created: " << name << ' ' << args << "\n";
+        return false;
+    }
+
+    for (int i = 0; i < x->exp_nexpr; i++) {
+        if (!x->exp_prog[i]) {
+            std::cerr << "not compiled: " << name << ' ' << args << " [" << i << "]\n";
+            return false;
+        }
+    }
+
+    setup_inputs(x);
+
+    for (int i = 0; i < x->exp_nexpr; i++) {
+        if (IS_EXPR(x)) {
+            struct ex_ex a, b;
+            a.ex_type = b.ex_type = 0;
+            ex_eval(x, x->exp_stack[i], &a, 0);
+            ex_run(x, x->exp_prog[i], &b, 0);
+
+            if (a.ex_type != b.ex_type)
+                return false;
+            if (a.ex_type == ET_INT && a.ex_int != b.ex_int)
+                return false;
+            if (a.ex_type == ET_FLT && !same(a.ex_flt, b.ex_flt))
+                return false;
+        } else if (IS_EXPR_TILDE(x)) {
+            struct ex_ex a, b;
+            a.ex_type = b.ex_type = ET_VEC;
+            a.ex_vec = tree;
+            b.ex_vec = bytecode;
+            ex_eval(x, x->exp_stack[i], &a, 0);
+            ex_run(x, x->exp_prog[i], &b, 0);
+
+            for (int j = 0; j < BS; j++) {
+                if (!same(tree[j], bytecode[j]))
+                    return false;
+            }
+        } else {
+            for (int j = 0; j < BS; j++) {
+                struct ex_ex a, b;
+                a.ex_type = b.ex_type = 0;
+                ex_eval(x, x->exp_stack[i], &a, j);
+                ex_run(x, x->exp_prog[i], &b, j);
+
+                t_float fa = (a.ex_type == ET_INT) ? a.ex_int : a.ex_flt;
+                t_float fb = (b.ex_type == ET_INT) ? b.ex_int : b.ex_flt;
+                if (!same(fa, fb))
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+}
+
+TEST_CASE("expr", "[core]")
+{
+    test::pdPrintToStdError();
+
+    SECTION("compile")
+    {
+        auto e0 = make_expr("expr~", "$v1 * 0.5 + $v2");
+        REQUIRE(to_expr(e0));
+        REQUIRE(to_expr(e0)->exp_prog[0]);
+
+        auto e1 = make_expr("fexpr~", "$x1 * 0.1 + $y1[-1] * 0.9");
+        REQUIRE(to_expr(e1));
+        REQUIRE(to_expr(e1)->exp_prog[0]);
+
+        auto e2 = make_expr("expr", "$f1 * 2 \\; $f1 + 1");
+        REQUIRE(to_expr(e2));
+        REQUIRE(to_expr(e2)->exp_nexpr == 2);
+        REQUIRE(to_expr(e2)->exp_prog[0]);
+        REQUIRE(to_expr(e2)->exp_prog[1]);
+
+        // tables are left to the tree walker
+        auto e3 = make_expr("expr~", "$s2[$v1]");
+        REQUIRE(to_expr(e3));
+        REQUIRE_FALSE(to_expr(e3)->exp_prog[0]);
+    }
+
+    SECTION("expr")
+    {
+        REQUIRE(compare("expr", "$f1 + 1"));
+        REQUIRE(compare("expr", "$i1 / $i2"));
+        REQUIRE(compare("expr", "$i1 % $i2 \\; $i1 % 0"));
+        REQUIRE(compare("expr", "7 / 2 \\; 7.0 / 2 \\; $f1 / 0"));
+        REQUIRE(compare("expr", "$f1 << 2 \\; $f2 >> 1 \\; $i3 & 6 | 1 ^ 3"));
+        REQUIRE(compare("expr", "$f1 && $f2 || !$f1 \\; -$f1 + ~$i3"));
+        REQUIRE(compare("expr", "$f1 < $f2 \\; $f1 <= $f2 \\; $f1 == $f2 \\; $f1 != $f2"));
+        REQUIRE(compare("expr", "min($f1 \\, $i3) + max($i3 \\, 3) + sqrt($i3 * $i3)"));
+        REQUIRE(compare("expr", "if($f1 > 0 \\, $f1 * 2 \\, $i3) \\; if($i3 \\, 1 \\, 2.5)"));
+        REQUIRE(compare("expr", "pow($f1 \\, 2) + fmod($f1 \\, 3) + floor($f1) + int($f2)"));
+    }
+
+    SECTION("expr~")
+    {
+        REQUIRE(compare("expr~", "$v1"));
+        REQUIRE(compare("expr~", "$v1 * $v2 + $v3 * $f4"));
+        REQUIRE(compare("expr~", "($v1 + 1) * ($v2 - 2) / ($v3 + 3)"));
+        REQUIRE(compare("expr~", "$v1 / $v2 \\; $v1 % $v2 \\; $v1 / 0"));
+        REQUIRE(compare("expr~", "$v1 << 1 \\; $v2 >> 1 \\; $v1 & $v2 \\; ~$v2 \\; -$v1"));
+        REQUIRE(compare("expr~", "$v1 && $v2 \\; $v1 || 0 \\; !$v1 \\; $v1 > $v2"));
+        REQUIRE(compare("expr~", "3 + 4 \\; 7 / 2 \\; $f2 * 2 \\; $i3 / 3 \\; sqrt($i3)"));
+        REQUIRE(compare("expr~", "min($v1 \\, $v2) + max($v1 \\, 0) + int($v1) + rint($v2)"));
+        REQUIRE(compare("expr~", "if($v1 > 0 \\, $v2 \\, $v3 * 2) \\; if($v1 \\, 2 \\, $v2)"));
+        REQUIRE(compare("expr~", "if($f2 > 0 \\, $v1 \\, $v3) \\; if($i4 \\, $v1 * 2 \\, -$v1) + 1"));
+        REQUIRE(compare("expr~", "sin($v1) * cos($v2) + atan2($v1 \\, $v2) + pow($v1 \\, 2)"));
+    }
+
+    SECTION("fexpr~")
+    {
+        REQUIRE(compare("fexpr~", "$x1 + $y1"));
+        REQUIRE(compare("fexpr~", "$x1[0] * 0.5 + $y1[-1] * 0.5"));
+        REQUIRE(compare("fexpr~", "$x1[-1] + $x1[-2] + $x1"));
+        REQUIRE(compare("fexpr~", "$x1[-1.5] + $y1[-2] \\; $x1 - $y2"));
+        REQUIRE(compare("fexpr~", "$x1 * $f2 + $y1 * 0.9"));
+        REQUIRE(compare("fexpr~", "if($x1 > 0 \\, $x1 \\, $y1)"));
+        REQUIRE(compare("fexpr~", "$x1 / $x2 + $x1 % 3 + sin($x2)"));
+    }
+}
@@ -0,0 +1,143 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "catch.hpp"
+#include "d_fftplan.h"
+#include "test_base.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Buffer = std::vector<t_sample>;
+
+Buffer make_signal(int n, int seed)
+{
+    Buffer res(n);
+    for (int i = 0; i < n; i++)
+        res[i] = std::sin(i * 0.37 + seed) + ((i * 31 + seed * 17) % 41 - 20) * 0.01;
+
+    return res;
+}
+
+// max difference relative to the largest value of b
+double diff(const Buffer& a, const Buffer& b)
+{
+    double d = 0, m = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        d = std::max<double>(d, std::fabs(a[i] - b[i]));
+        m = std::max<double>(m, std::fabs(b[i]));
+    }
+
+    return m > 0 ? d / m : d;
+}
+
+struct SimdBackend {
+    SimdBackend() { fft_setbackend(FFT_BACKEND_SIMD); }
+    ~SimdBackend() { fft_setbackend(FFT_BACKEND_LIBRARY); }
+};
+
+// the same transform with both backends
+template <typename Fn>
+double compare(Fn fn)
+{
+    fft_setbackend(FFT_BACKEND_LIBRARY);
+    auto lib = fn();
+    SimdBackend simd;
+    return diff(fn(), lib);
+}
+
+}
+
+TEST_CASE("fft", "[core]")
+{
+    test::pdPrintToStdError();
+
+    SECTION("backend")
+    {
+        REQUIRE(fft_setbackend(FFT_BACKEND_LIBRARY));
+        REQUIRE(fft_getbackend() == FFT_BACKEND_LIBRARY);
+        REQUIRE_FALSE(fft_setbackend(-1));
+
+        if (fft_setbackend(FFT_BACKEND_SIMD)) {
+            REQUIRE(fft_getbackend() == FFT_BACKEND_SIMD);
+            REQUIRE(std::string(fft_backendname(FFT_BACKEND_SIMD)) == "simd");
+        }
+
+        fft_setbackend(FFT_BACKEND_LIBRARY);
+    }
+
+    SECTION("plans")
+    {
+        t_fftplancache cache = { { 0 }, [](int logn) -> void* { return new int(logn); } };
+        auto p = fftplan_get(&cache, 10);
+        REQUIRE(p);
+        REQUIRE(*static_cast<int*>(p) == 10);
+        REQUIRE(fftplan_get(&cache, 10) == p);
+        REQUIRE_FALSE(fftplan_get(&cache, -1));
+        REQUIRE_FALSE(fftplan_get(&cache, FFTPLAN_MAXLOGN + 1));
+        delete static_cast<int*>(p);
+    }
+
+    SECTION("same results")
+    {
+        for (int n = 4; n <= 65536; n *= 2) {
+            auto fft = [n]() {
+                auto re = make_signal(n, 1), im = make_signal(n, 2);
+                mayer_fft(n, re.data(), im.data());
+                re.insert(re.end(), im.begin(), im.end());
+                return re;
+            };
+
+            auto ifft = [n]() {
+                auto re = make_signal(n, 3), im = make_signal(n, 4);
+                mayer_ifft(n, re.data(), im.data());
+                re.insert(re.end(), im.begin(), im.end());
+                return re;
+            };
+
+            auto rfft = [n]() {
+                auto x = make_signal(n, 5);
+                mayer_realfft(n, x.data());
+                return x;
+            };
+
+            auto rifft = [n]() {
+                auto x = make_signal(n, 6);
+                mayer_realifft(n, x.data());
+                return x;
+            };
+
+            REQUIRE(compare(fft) < 1e-5);
+            REQUIRE(compare(ifft) < 1e-5);
+            REQUIRE(compare(rfft) < 1e-5);
+            REQUIRE(compare(rifft) < 1e-5);
+        }
+    }
+
+    SECTION("round trip")
+    {
+        SimdBackend simd;
+        const int n = 1024;
+        auto x = make_signal(n, 7);
+        auto y = x;
+        mayer_realfft(n, y.data());
+        mayer_realifft(n, y.data());
+        for (auto& v : y)
+            v /= n;
+
+        REQUIRE(diff(y, x) < 1e-5);
+    }
+}
@@ -101,6 +101,72 @@ TEST_CASE("json", "[core]")
         dict1.at("a") = DA("[b: c]");
         REQUIRE(dict1.toJsonString() == R"({"a":{"b":"c"}})");
     }
+
+    SECTION("from_json_string")
+    {
+        AtomList res;
+        bool is_array = false;
+        std::string err;
+
+#define REQUIRE_FROM_JSON(str, arr, lst)                                  \
+    {                                                                     \
+        const std::string s(str);                                         \
+        REQUIRE(from_json_string(s.data(), s.size(), res, is_array, err)); \
+        REQUIRE(is_array == arr);                                         \
+        REQUIRE(res == lst);                                              \
+    }
+
+        REQUIRE_FROM_JSON("1", false, LF(1));
+        REQUIRE_FROM_JSON("-2.5", false, LF(-2.5));
+        REQUIRE_FROM_JSON("true", false, LF(1));
+        REQUIRE_FROM_JSON("false", false, LF(0));
+        REQUIRE_FROM_JSON("null", false, LA(Atom()));
+        REQUIRE_FROM_JSON(R"("abc")", false, LA("abc"));
+        REQUIRE_FROM_JSON("[]", true, L());
+        REQUIRE_FROM_JSON(R"([1, 2, "a", true])", true, LA(1, 2, "a", 1));
+        REQUIRE_FROM_JSON("[1, [2, 3], 4]", true, LA(MA(1, MA(2, 3), 4)));
+        REQUIRE_FROM_JSON(R"([{"a": 1}])", true, LA(MA(DA("[a: 1]"))));
+        REQUIRE_FROM_JSON("{}", false, LA(DA()));
+        REQUIRE_FROM_JSON(R"({"a": 1, "b": [1, 2], "c": [1, [2]], "d": null, "e": {"x": "y"}})", false,
+            LA(DA("[a: 1 b: 1 2 c: (1 (2)) d: e: [x: y]]")));
+
+        // document order
+        REQUIRE_FROM_JSON(R"({"z": 1, "a": 2})", false, LA(DA("[z: 1 a: 2]")));
+        REQUIRE(res[0].asD<DataTypeDict>()->keys() == LA("z", "a"));
+
+        const std::string bad("[1, 2");
+        REQUIRE_FALSE(from_json_string(bad.data(), bad.size(), res, is_array, err));
+        REQUIRE_FALSE(err.empty());
+
+        DataTypeDict dict("[a: b]");
+        REQUIRE(from_json_string(R"({"x": [1, 2]})", dict, err));
+        REQUIRE(dict == DataTypeDict("[x: 1 2]"));
+        REQUIRE_FALSE(from_json_string("[1, 2]", dict, err));
+        REQUIRE_FALSE(from_json_string("1", dict, err));
+        REQUIRE_FALSE(from_json_string("{\"a\":", dict, err));
+        REQUIRE(dict == DataTypeDict("[x: 1 2]"));
+    }
+
+    SECTION("from_json_stream")
+    {
+        AtomList res;
+        std::string err;
+        auto fn = [&res](const Atom& a) { res.append(a); };
+
+        const std::string arr(R"([1, "a", [2, 3], {"b": 4}, null])");
+        REQUIRE(from_json_stream(arr.data(), arr.size(), fn, err));
+        REQUIRE(res == LA(1, "a", MA(2, 3), DA("[b: 4]"), Atom()));
+
+        res.clear();
+        const std::string obj(R"({"b": 4})");
+        REQUIRE(from_json_stream(obj.data(), obj.size(), fn, err));
+        REQUIRE(res == LA(DA("[b: 4]")));
+
+        res.clear();
+        const std::string bad("[1, 2, x]");
+        REQUIRE_FALSE(from_json_stream(bad.data(), bad.size(), fn, err));
+        REQUIRE(res == LF(1, 2));
+    }
 }
 
 #endif // TEST_JSON_CPP
@@ -0,0 +1,137 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "catch.hpp"
+#include "test_base.h"
+
+#include "ceammc_osc_trie.h"
+
+using namespace ceammc;
+using namespace ceammc::osc;
+
+namespace {
+std::vector<int> find_all(const OscAddressTrie<int>& t, const char* addr)
+{
+    std::vector<int> res;
+    t.match(addr, [&res](int v) { res.push_back(v); });
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+std::vector<int> V(std::initializer_list<int> l) { return l; }
+}
+
+TEST_CASE("osc_trie", "[core]")
+{
+    SECTION("is_pattern")
+    {
+        REQUIRE_FALSE(is_pattern(""));
+        REQUIRE_FALSE(is_pattern("abc"));
+        REQUIRE(is_pattern("*"));
+        REQUIRE(is_pattern("a?"));
+        REQUIRE(is_pattern("[ab]"));
+        REQUIRE(is_pattern("{a,b}"));
+    }
+
+    SECTION("pattern_match")
+    {
+        REQUIRE(pattern_match("", ""));
+        REQUIRE(pattern_match("abc", "abc"));
+        REQUIRE_FALSE(pattern_match("abc", "ab"));
+        REQUIRE_FALSE(pattern_match("ab", "abc"));
+
+        REQUIRE(pattern_match("*", ""));
+        REQUIRE(pattern_match("*", "abc"));
+        REQUIRE(pattern_match("a*", "abc"));
+        REQUIRE(pattern_match("*c", "abc"));
+        REQUIRE(pattern_match("a*c", "abc"));
+        REQUIRE(pattern_match("a**c", "ac"));
+        REQUIRE_FALSE(pattern_match("a*d", "abc"));
+
+        REQUIRE(pattern_match("a?c", "abc"));
+        REQUIRE_FALSE(pattern_match("a?c", "ac"));
+        REQUIRE(pattern_match("???", "abc"));
+
+        REQUIRE(pattern_match("[abc]", "b"));
+        REQUIRE_FALSE(pattern_match("[abc]", "d"));
+        REQUIRE(pattern_match("ch[1-4]", "ch3"));
+        REQUIRE_FALSE(pattern_match("ch[1-4]", "ch5"));
+        REQUIRE(pattern_match("ch[!1-4]", "ch5"));
+        REQUIRE_FALSE(pattern_match("ch[!1-4]", "ch2"));
+        REQUIRE(pattern_match("[a-]", "-"));
+
+        REQUIRE(pattern_match("{freq,amp}", "freq"));
+        REQUIRE(pattern_match("{freq,amp}", "amp"));
+        REQUIRE_FALSE(pattern_match("{freq,amp}", "gain"));
+        REQUIRE(pattern_match("{a,ab}c", "abc"));
+        REQUIRE(pattern_match("x{,1}", "x"));
+        REQUIRE(pattern_match("x{,1}", "x1"));
+        REQUIRE(pattern_match("*{1,2}", "ch2"));
+    }
+
+    SECTION("literal")
+    {
+        OscAddressTrie<int> t;
+        REQUIRE(t.empty());
+        REQUIRE_FALSE(t.insert("", 1));
+        REQUIRE_FALSE(t.insert("a/b", 1));
+
+        REQUIRE(t.insert("/a", 1));
+        REQUIRE(t.insert("/a/b", 2));
+        REQUIRE(t.insert("/a/c", 3));
+        REQUIRE(t.insert("/a/b", 4));
+        REQUIRE(t.insert("/b/a", 5));
+        REQUIRE(t.size() == 5);
+        REQUIRE(t.nodeCount() == 6);
+
+        REQUIRE(find_all(t, "/a") == V({ 1 }));
+        REQUIRE(find_all(t, "/a/b") == V({ 2, 4 }));
+        REQUIRE(find_all(t, "/a/c") == V({ 3 }));
+        REQUIRE(find_all(t, "/b/a") == V({ 5 }));
+        REQUIRE(find_all(t, "/b").empty());
+        REQUIRE(find_all(t, "/a/b/c").empty());
+        REQUIRE(find_all(t, "a/b").empty());
+        REQUIRE(find_all(t, "").empty());
+
+        t.clear();
+        REQUIRE(t.empty());
+        REQUIRE(find_all(t, "/a").empty());
+    }
+
+    SECTION("stored patterns")
+    {
+        OscAddressTrie<int> t;
+        t.insert("/synth/*/freq", 1);
+        t.insert("/synth/ch[1-2]/{freq,amp}", 2);
+        t.insert("/synth/ch1/freq", 3);
+
+        REQUIRE(find_all(t, "/synth/ch1/freq") == V({ 1, 2, 3 }));
+        REQUIRE(find_all(t, "/synth/ch2/amp") == V({ 2 }));
+        REQUIRE(find_all(t, "/synth/ch3/freq") == V({ 1 }));
+        REQUIRE(find_all(t, "/synth/ch3/amp").empty());
+    }
+
+    SECTION("address patterns")
+    {
+        OscAddressTrie<int> t;
+        t.insert("/mixer/ch1/gain", 1);
+        t.insert("/mixer/ch2/gain", 2);
+        t.insert("/mixer/ch2/pan", 3);
+        t.insert("/mixer/*/gain", 4);
+
+        REQUIRE(find_all(t, "/mixer/ch?/gain") == V({ 1, 2 }));
+        REQUIRE(find_all(t, "/mixer/ch2/*") == V({ 2, 3, 4 }));
+        REQUIRE(find_all(t, "/mixer/*/gain") == V({ 1, 2, 4 }));
+        REQUIRE(find_all(t, "/*/*/{pan,mute}") == V({ 3 }));
+    }
+}
@@ -0,0 +1,305 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "catch.hpp"
+#include "test_base.h"
+
+#include "ceammc_sound_stream.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace ceammc;
+using namespace ceammc::sound;
+
+namespace {
+
+// in memory soundfile: sample value is frame * 10 + channel
+class MemSoundFile : public SoundFile {
+public:
+    size_t nch, nframes, sr;
+    size_t reads { 0 };
+
+    MemSoundFile(size_t ch, size_t frames, size_t rate = 48000)
+        : nch(ch)
+        , nframes(frames)
+        , sr(rate)
+    {
+    }
+
+    bool probe(const char*) const override { return true; }
+    bool open(const char*, OpenMode, const SoundFileOpenParams&) override { return true; }
+    bool isOpened() const override { return true; }
+    bool close() override { return true; }
+    size_t frameCount() const override { return nframes; }
+    size_t sampleRate() const override { return sr; }
+    size_t channels() const override { return nch; }
+    std::int64_t read(t_word*, size_t, size_t, std::int64_t) override { return -1; }
+
+    std::int64_t readFrames(float* dest, size_t sz, std::int64_t offset) override
+    {
+        reads++;
+
+        if (offset >= (std::int64_t)nframes)
+            return 0;
+
+        sz = std::min<size_t>(sz, nframes - offset);
+        for (size_t i = 0; i < sz; i++) {
+            for (size_t c = 0; c < nch; c++)
+                dest[i * nch + c] = (offset + i) * 10 + c;
+        }
+
+        return sz;
+    }
+};
+
+class CountTask : public StreamTask {
+public:
+    std::atomic_int count { 0 };
+    int max_count;
+
+    CountTask(int max)
+        : max_count(max)
+    {
+    }
+
+    bool process() override
+    {
+        if (count >= max_count)
+            return false;
+
+        count++;
+        return true;
+    }
+};
+
+}
+
+TEST_CASE("sound::stream", "[core]")
+{
+    test::pdPrintToStdError();
+
+    SECTION("FrameRing")
+    {
+        FrameRing r(2, 6);
+        REQUIRE(r.channels() == 2);
+        REQUIRE(r.capacity() == 8);
+        REQUIRE(r.readAvailable() == 0);
+        REQUIRE(r.writeAvailable() == 8);
+
+        float in[20] = { 0, 1, 10, 11, 20, 21, 30, 31, 40, 41, 50, 51, 60, 61, 70, 71, 80, 81, 90, 91 };
+        REQUIRE(r.write(in, 10) == 8);
+        REQUIRE(r.readAvailable() == 8);
+        REQUIRE(r.writeAvailable() == 0);
+        REQUIRE(r.writePosition() == 8);
+
+        t_sample b0[8], b1[8], b2[8];
+        t_sample* out[3] = { b0, b1, b2 };
+        REQUIRE(r.read(out, 3, 3) == 3);
+        REQUIRE(b0[0] == 0);
+        REQUIRE(b1[0] == 1);
+        REQUIRE(b2[0] == 0);
+        REQUIRE(b0[2] == 20);
+        REQUIRE(b1[2] == 21);
+        REQUIRE(b2[2] == 0);
+        REQUIRE(r.readAvailable() == 5);
+
+        // wrap
+        REQUIRE(r.write(in + 16, 2) == 2);
+        REQUIRE(r.read(out, 1, 8) == 7);
+        REQUIRE(b0[0] == 30);
+        REQUIRE(b0[4] == 70);
+        REQUIRE(b0[5] == 80);
+        REQUIRE(b0[6] == 90);
+        REQUIRE(r.readAvailable() == 0);
+
+        // drop
+        REQUIRE(r.write(in, 4) == 4);
+        REQUIRE(r.writePosition() == 14);
+        r.dropUntil(12);
+        REQUIRE(r.readAvailable() == 2);
+        REQUIRE(r.read(out, 1, 8) == 2);
+        REQUIRE(b0[0] == 20);
+        REQUIRE(b0[1] == 30);
+
+        // never back
+        r.dropUntil(10);
+        REQUIRE(r.readAvailable() == 0);
+        // never after the write position
+        r.dropUntil(100);
+        REQUIRE(r.readAvailable() == 0);
+        REQUIRE(r.write(in, 2) == 2);
+        REQUIRE(r.readAvailable() == 2);
+        r.clear();
+        REQUIRE(r.readAvailable() == 0);
+        REQUIRE(r.writeAvailable() == 8);
+    }
+
+    SECTION("FrameRing threads")
+    {
+        FrameRing r(1, 64);
+        const size_t N = 100000;
+        float last = -1;
+        bool ordered = true;
+
+        std::thread writer([&r]() {
+            for (size_t i = 0; i < N;) {
+                float x = i;
+                if (r.write(&x, 1))
+                    i++;
+            }
+        });
+
+        size_t total = 0;
+        t_sample buf[16];
+        t_sample* out[1] = { buf };
+        while (total < N) {
+            auto n = r.read(out, 1, 16);
+            for (size_t i = 0; i < n; i++) {
+                ordered = ordered && (buf[i] == last + 1);
+                last = buf[i];
+            }
+
+            total += n;
+        }
+
+        writer.join();
+        REQUIRE(ordered);
+        REQUIRE(last == N - 1);
+    }
+
+    SECTION("StreamPool")
+    {
+        StreamPool pool(2);
+        REQUIRE(pool.numWorkers() == 2);
+        REQUIRE(pool.numTasks() == 0);
+
+        CountTask t0(1000), t1(1000), t2(1000);
+        pool.add(&t0);
+        pool.add(&t1);
+        pool.add(&t2);
+        REQUIRE(pool.numTasks() == 3);
+
+        for (int i = 0; i < 500; i++) {
+            if (t0.count == 1000 && t1.count == 1000 && t2.count == 1000)
+                break;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+
+        REQUIRE(t0.count == 1000);
+        REQUIRE(t1.count == 1000);
+        REQUIRE(t2.count == 1000);
+
+        pool.remove(&t1);
+        REQUIRE(pool.numTasks() == 2);
+        pool.remove(&t1);
+        REQUIRE(pool.numTasks() == 2);
+
+        // wake up on notify
+        t0.max_count = 2000;
+        pool.notify();
+        for (int i = 0; i < 500 && t0.count < 2000; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+        REQUIRE(t0.count == 2000);
+
+        pool.remove(&t0);
+        pool.remove(&t2);
+        REQUIRE(pool.numTasks() == 0);
+    }
+
+    SECTION("SoundHead")
+    {
+        MemSoundFile f(2, 100);
+        SoundHeadCache cache;
+        auto h = cache.load(f, "mem", 10, 20);
+        REQUIRE(h);
+        REQUIRE(h->channels == 2);
+        REQUIRE(h->samplerate == 48000);
+        REQUIRE(h->file_frames == 100);
+        REQUIRE(h->offset == 10);
+        REQUIRE(h->frameCount() == 20);
+
+        float buf[20];
+        REQUIRE(h->readFrames(buf, 4, 9) == 0);
+        REQUIRE(h->readFrames(buf, 4, 30) == 0);
+        REQUIRE(h->readFrames(buf, 4, 10) == 4);
+        REQUIRE(buf[0] == 100);
+        REQUIRE(buf[1] == 101);
+        REQUIRE(buf[7] == 131);
+        REQUIRE(h->readFrames(buf, 10, 28) == 2);
+        REQUIRE(buf[0] == 280);
+        REQUIRE(buf[3] == 291);
+
+        // till the end of file
+        h = cache.load(f, "mem", 90, 20);
+        REQUIRE(h->frameCount() == 10);
+    }
+
+    SECTION("SoundHeadCache")
+    {
+        MemSoundFile f(2, 1000);
+        const size_t HEAD_BYTES = 100 * 2 * sizeof(float);
+        SoundHeadCache cache(HEAD_BYTES * 2);
+        REQUIRE(cache.size() == 0);
+        REQUIRE(cache.bytes() == 0);
+        REQUIRE_FALSE(cache.find("mem", 0, f));
+
+        auto h0 = cache.load(f, "mem", 0, 100);
+        REQUIRE(h0);
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.bytes() == HEAD_BYTES);
+
+        // cached
+        const auto nreads = f.reads;
+        REQUIRE(cache.load(f, "mem", 0, 100) == h0);
+        REQUIRE(cache.find("mem", 50, f) == h0);
+        REQUIRE(cache.load(f, "mem", 99, 100) == h0);
+        REQUIRE(f.reads == nreads);
+        REQUIRE_FALSE(cache.find("mem", 100, f));
+        REQUIRE_FALSE(cache.find("mem2", 0, f));
+
+        auto h1 = cache.load(f, "mem", 500, 100);
+        REQUIRE(h1 != h0);
+        REQUIRE(cache.size() == 2);
+        REQUIRE(cache.bytes() == 2 * HEAD_BYTES);
+
+        // h0 is used recently, h1 is evicted
+        REQUIRE(cache.find("mem", 0, f) == h0);
+        auto h2 = cache.load(f, "mem2", 0, 100);
+        REQUIRE(cache.size() == 2);
+        REQUIRE(cache.find("mem", 0, f) == h0);
+        REQUIRE(cache.find("mem2", 0, f) == h2);
+        REQUIRE_FALSE(cache.find("mem", 500, f));
+
+        // evicted head is still valid
+        REQUIRE(h1->frameCount() == 100);
+
+        // too big
+        auto h3 = cache.load(f, "mem3", 0, 1000);
+        REQUIRE(h3);
+        REQUIRE(h3->frameCount() == 1000);
+        REQUIRE(cache.size() == 2);
+
+        // file was changed
+        MemSoundFile f2(1, 1000);
+        REQUIRE_FALSE(cache.find("mem", 0, f2));
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.bytes() == HEAD_BYTES);
+
+        cache.clear();
+        REQUIRE(cache.size() == 0);
+        REQUIRE(cache.bytes() == 0);
+    }
+}
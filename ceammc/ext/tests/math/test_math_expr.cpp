@@ -37,6 +37,7 @@ TEST_CASE("math.expr", "[externals]")
             REQUIRE(t.numOutlets() == 1);
 
             REQUIRE_PROPERTY(t, @expr, "");
+            REQUIRE_PROPERTY(t, @map, 0);
         }
 
         {
@@ -215,4 +216,42 @@ TEST_CASE("math.expr", "[externals]")
         REQUIRE_EXPR(t, "arr1[1+1-2+(100*(3-3))]", 1, 100);
         REQUIRE_EXPR(t, "arr1[10]", 1, 0);
     }
+
+    SECTION("map")
+    {
+        TObj t("math.expr", LA("$f*2", "@map", 1));
+        REQUIRE_PROPERTY(t, @map, 1);
+
+        WHEN_SEND_LIST_TO(0, t, L());
+        REQUIRE_LIST_AT_OUTLET(0, t, L());
+
+        WHEN_SEND_LIST_TO(0, t, LF(1, 2, 3));
+        REQUIRE_LIST_AT_OUTLET(0, t, LF(2, 4, 6));
+
+        // float is not mapped
+        WHEN_SEND_FLOAT_TO(0, t, 10);
+        REQUIRE_FLOAT_AT_OUTLET(0, t, 20);
+
+        WHEN_SEND_LIST_TO(1, t, LA("max($f, 2)+$f1-(1+2)"));
+        WHEN_SEND_LIST_TO(0, t, LF(1, 2, 3, 4));
+        REQUIRE_LIST_AT_OUTLET(0, t, LF(-1, -1, 0, 1));
+
+        WHEN_SEND_LIST_TO(1, t, LA("$f<2"));
+        WHEN_SEND_LIST_TO(0, t, LF(1, 2, 3));
+        REQUIRE_LIST_AT_OUTLET(0, t, LF(1, 0, 0));
+
+        // longer than the evaluation block
+        WHEN_SEND_LIST_TO(1, t, LA("sqrt($f)+1"));
+        AtomList in, out;
+        for (int i = 0; i < 1000; i++) {
+            in.append(Atom(i * i));
+            out.append(Atom(i + 1));
+        }
+        WHEN_SEND_LIST_TO(0, t, in);
+        REQUIRE_LIST_AT_OUTLET(0, t, out);
+
+        t.setProperty("@map", LF(0));
+        WHEN_SEND_LIST_TO(0, t, LF(16, 2));
+        REQUIRE_FLOAT_AT_OUTLET(0, t, 5);
+    }
 }
@@ -16,7 +16,10 @@
 #include "test_external.h"
 
 #include <chrono>
+#include <cmath>
+#include <string>
 #include <thread>
+#include <vector>
 
 using namespace ceammc::osc;
 using namespace ceammc::net;
@@ -46,4 +49,233 @@ TEST_CASE("osc", "[net]")
         sleep_ms(200);
         REQUIRE(s.isRunning());
     }
+
+    SECTION("OscMessageRing")
+    {
+        OscMessageRing ring(3);
+        REQUIRE(ring.capacity() == 4);
+        REQUIRE(ring.size() == 0);
+        REQUIRE(ring.front() == nullptr);
+
+        auto write = [&ring](int v) -> bool {
+            auto rec = ring.beginWrite();
+            if (!rec)
+                return false;
+
+            rec->argc = 1;
+            rec->types[0] = 'i';
+            rec->args[0].i = v;
+            ring.commitWrite();
+            return true;
+        };
+
+        for (int i = 0; i < 4; i++)
+            REQUIRE(write(i));
+
+        // full
+        REQUIRE(ring.size() == 4);
+        REQUIRE_FALSE(write(100));
+        REQUIRE(ring.size() == 4);
+
+        // wraparound
+        for (int i = 4; i < 20; i++) {
+            REQUIRE(ring.front());
+            REQUIRE(ring.front()->args[0].i == i - 4);
+            ring.pop();
+            REQUIRE(write(i));
+            REQUIRE(ring.size() == 4);
+        }
+
+        for (int i = 16; i < 20; i++) {
+            REQUIRE(ring.front()->args[0].i == i);
+            ring.pop();
+        }
+
+        REQUIRE(ring.size() == 0);
+        REQUIRE(ring.front() == nullptr);
+    }
+
+    SECTION("OscMethodSubscriber ring")
+    {
+        OscMessageRing ring(2);
+        OscDispatchStat stat;
+        AtomList32 res;
+
+        lo_arg f, i;
+        f.f = 1.5;
+        i.i32 = 7;
+        // strings are stored in place of lo_arg
+        char str[8] = "hello";
+        lo_arg* argv[] = { &f, &i, reinterpret_cast<lo_arg*>(str) };
+
+        OscMethodSubscriber any(1, nullptr, &ring);
+        any.notify("/a/b", "fis", argv, 3, OSC_TIME_IMMEDIATE, stat);
+        REQUIRE(stat.queued == 1);
+        REQUIRE(ring.size() == 1);
+
+        auto rec = ring.front();
+        REQUIRE(rec);
+        REQUIRE(rec->path() == std::string("/a/b"));
+        REQUIRE(rec->isImmediate());
+        REQUIRE(std::string(rec->types, rec->argc) == "fis");
+        rec->appendTo(res);
+        REQUIRE(AtomList(res.view()) == LA(1.5, 7, "hello"));
+        ring.pop();
+
+        // type coercion
+        OscMethodSubscriber coerce(2, "dhS", &ring);
+        coerce.notify("/a/b", "fis", argv, 3, 100, stat);
+        REQUIRE(stat.queued == 2);
+
+        rec = ring.front();
+        REQUIRE(rec);
+        REQUIRE(rec->time == 100);
+        REQUIRE(std::string(rec->types, rec->argc) == "dhS");
+        res.clear();
+        rec->appendTo(res);
+        REQUIRE(AtomList(res.view()) == LA(1.5, 7, "hello"));
+        ring.pop();
+
+        // float to int
+        OscMethodSubscriber to_int(3, "iis", &ring);
+        to_int.notify("/a/b", "fis", argv, 3, 100, stat);
+        res.clear();
+        ring.front()->appendTo(res);
+        REQUIRE(AtomList(res.view()) == LA(1, 7, "hello"));
+        ring.pop();
+
+        // types not matched: skipped
+        OscMethodSubscriber ints(4, "ii", &ring);
+        ints.notify("/a/b", "fis", argv, 3, 100, stat);
+        REQUIRE(stat.queued == 3);
+        REQUIRE(stat.dropped == 0);
+        REQUIRE(ring.size() == 0);
+
+        // full ring: dropped
+        any.notify("/a/b", "fis", argv, 3, 100, stat);
+        any.notify("/a/b", "fis", argv, 3, 100, stat);
+        any.notify("/a/b", "fis", argv, 3, 100, stat);
+        REQUIRE(stat.queued == 5);
+        REQUIRE(stat.dropped == 1);
+        REQUIRE(ring.size() == 2);
+        ring.pop();
+        ring.pop();
+
+        // oversized: too many arguments
+        std::vector<lo_arg> vals(OscMessageRecord::MAX_ARGS + 8);
+        std::vector<lo_arg*> pvals;
+        for (size_t k = 0; k < vals.size(); k++) {
+            vals[k].i32 = k;
+            pvals.push_back(&vals[k]);
+        }
+
+        std::string itypes(vals.size(), 'i');
+        any.notify("/many", itypes.c_str(), pvals.data(), pvals.size(), 200, stat);
+        REQUIRE(stat.queued == 6);
+
+        rec = ring.front();
+        REQUIRE(rec);
+        REQUIRE(rec->ext);
+        REQUIRE(rec->time == 200);
+        REQUIRE(rec->path() == std::string("/many"));
+        res.clear();
+        rec->appendTo(res);
+        REQUIRE(res.size() == vals.size());
+        REQUIRE(res.back() == A(vals.size() - 1));
+        ring.pop();
+
+        // oversized: too long string
+        std::string long_str(OscMessageRecord::DATA_SIZE + 100, 'x');
+        lo_arg* long_argv[] = { reinterpret_cast<lo_arg*>(&long_str[0]) };
+        any.notify("/long", "s", long_argv, 1, 200, stat);
+        REQUIRE(stat.queued == 7);
+
+        rec = ring.front();
+        REQUIRE(rec);
+        REQUIRE(rec->ext);
+        REQUIRE_FALSE(rec->isBlob());
+        res.clear();
+        rec->appendTo(res);
+        REQUIRE(AtomList(res.view()) == LA(long_str.c_str()));
+        ring.pop();
+
+        // slot is reused for the regular message
+        any.notify("/a/b", "fis", argv, 3, 100, stat);
+        any.notify("/a/b", "fis", argv, 3, 100, stat);
+        REQUIRE(ring.size() == 2);
+        REQUIRE_FALSE(ring.front()->ext);
+        ring.pop();
+        REQUIRE_FALSE(ring.front()->ext);
+        ring.pop();
+    }
+
+    SECTION("OscTimedQueue")
+    {
+        OscTimedQueue q;
+        REQUIRE(q.empty());
+        REQUIRE(q.size() == 0);
+
+        auto push = [&q](double t, int v) {
+            OscMessageRecord rec;
+            rec.argc = 1;
+            rec.types[0] = 'i';
+            rec.args[0].i = v;
+            q.push(t, rec);
+        };
+
+        push(30, 0);
+        push(10, 1);
+        push(20, 2);
+        // same time: arrival order
+        push(10, 3);
+        push(20, 4);
+        push(10, 5);
+        REQUIRE(q.size() == 6);
+        REQUIRE(q.nextTime() == 10);
+
+        OscMessageRecord rec;
+        std::vector<int> order;
+        std::vector<double> times;
+        while (!q.empty()) {
+            times.push_back(q.nextTime());
+            q.pop(rec);
+            order.push_back(rec.args[0].i);
+        }
+
+        REQUIRE(order == std::vector<int> { 1, 3, 5, 2, 4, 0 });
+        REQUIRE(times == std::vector<double> { 10, 10, 10, 20, 20, 30 });
+
+        push(1, 0);
+        push(2, 0);
+        q.clear();
+        REQUIRE(q.empty());
+    }
+
+    SECTION("OscTimeSync")
+    {
+        REQUIRE(OscTimeSync::toMs(OscTimeTag(100) << 32) == 100000);
+        REQUIRE(OscTimeSync::toMs((OscTimeTag(100) << 32) | 0x80000000) == 100500);
+
+        const OscTimeTag tt = OscTimeTag(100) << 32;
+        OscTimeSync sync;
+
+        // first call: exact offset
+        REQUIRE(sync.toLogicalTime(tt, 99000, 1000) == 2000);
+        REQUIRE(sync.offset() == 98000);
+
+        // scheduler jitter is smoothed
+        const double t1 = sync.toLogicalTime(tt, 99010, 1000);
+        REQUIRE(sync.offset() - 98000 == Approx(10 * OscTimeSync::SMOOTH_K));
+        REQUIRE(2000 - t1 == Approx(10 * OscTimeSync::SMOOTH_K));
+
+        // converges to the new offset
+        for (int i = 0; i < 2000; i++)
+            sync.toLogicalTime(tt, 99010, 1000);
+
+        REQUIRE(std::abs(sync.offset() - 98010) < 0.001);
+
+        // clock jump: resync without smoothing
+        REQUIRE(sync.toLogicalTime(tt, 99010 + OscTimeSync::RESYNC_MS + 1000, 1000) == 1990 - OscTimeSync::RESYNC_MS - 1000);
+        REQUIRE(sync.offset() == 98010 + OscTimeSync::RESYNC_MS + 1000);
+    }
 }
@@ -18,6 +18,8 @@
 #include "test_base.h"
 #include "test_external.h"
 
+#include "lo/lo.h"
+
 #include <thread>
 
 extern "C" {
@@ -41,6 +43,24 @@ static void poll_ms(int ms)
 
 constexpr int POLL_DEFAULT = 50;
 
+static void send_bundle(const char* port, const char* path, float v, double delayMs)
+{
+    lo_timetag tt;
+    lo_timetag_now(&tt);
+    const uint64_t frac = tt.frac + static_cast<uint64_t>(delayMs * 0.001 * 4294967296.0);
+    tt.sec += frac >> 32;
+    tt.frac = frac & 0xFFFFFFFF;
+
+    auto addr = lo_address_new("localhost", port);
+    auto msg = lo_message_new();
+    lo_message_add_float(msg, v);
+    auto bundle = lo_bundle_new(tt);
+    lo_bundle_add_message(bundle, path, msg);
+    lo_send_bundle(addr, bundle);
+    lo_bundle_free_recursive(bundle);
+    lo_address_free(addr);
+}
+
 using namespace ceammc::net;
 
 PD_COMPLETE_TEST_SETUP(NetOscReceive, net, osc_receive)
@@ -200,4 +220,28 @@ TEST_CASE("net.osc.receive", "[externals]")
         send.call("send", LA("/x", "ABC", 1));
         REQUIRE_OSC_NO_RECV(t);
     }
+
+    SECTION("bundle timetag")
+    {
+        TExt s("net.osc.server", "test:bundle", "osc.udp://:9014");
+        poll_ms(POLL_DEFAULT);
+        TExt t("net.osc.receive", "/x", "test:bundle");
+        t->setProperty("@latency", LF(100));
+        poll_ms(POLL_DEFAULT);
+
+        // @queue 1: the server has held the bundle until its time, output it without extra delay
+        send_bundle("9014", "/x", 1, 10);
+        REQUIRE_OSC_SEND_FLOAT(t, 1);
+        REQUIRE_PROPERTY(t, @late, LF(0));
+        REQUIRE_PROPERTY(t, @ahead, LF(0));
+        t.clearAll();
+
+        // @queue 0: scheduled by the receiver in logical time
+        s->setProperty("@queue", LF(0));
+        send_bundle("9014", "/x", 2, 10);
+        REQUIRE_OSC_NO_RECV(t);
+        t.schedTicks(200);
+        REQUIRE(t.hasOutputAt(0));
+        REQUIRE(t.outputFloatAt(0) == 2);
+    }
 }
@@ -0,0 +1,114 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "net_ws_server.h"
+#include "test_base.h"
+#include "test_external.h"
+
+#include <string>
+#include <vector>
+
+using Frames = std::vector<AtomList>;
+
+static bool decode(const Bytes& data, size_t len, Frames& res)
+{
+    res.clear();
+    return NetWsServer::fromBinaryFrames(data.data(), len, [&res](const AtomList& l) { res.push_back(l); });
+}
+
+TEST_CASE("net.ws.server frames", "[externals]")
+{
+    test::pdPrintToStdError();
+
+    SECTION("round trip")
+    {
+        const Frames src {
+            LF(1, -2.5, 0.1),
+            LA("abc", 100, "def"),
+            L(),
+            LA("привет мир"),
+        };
+
+        Bytes data;
+        for (auto& f : src)
+            REQUIRE(NetWsServer::toBinaryFrame(f.view(), data));
+
+        // u16 + 3 * (1 + f32)
+        REQUIRE(data.size() > 17);
+        REQUIRE(data[0] == 3);
+        REQUIRE(data[1] == 0);
+        REQUIRE(data[2] == 'f');
+
+        Frames res;
+        REQUIRE(decode(data, data.size(), res));
+        REQUIRE(res == src);
+    }
+
+    SECTION("truncated")
+    {
+        const Frames src {
+            LF(1, 2),
+            LA("abc"),
+            LA("a", 2, "bcd"),
+        };
+
+        Bytes data;
+        std::vector<size_t> frame_ends;
+        for (auto& f : src) {
+            REQUIRE(NetWsServer::toBinaryFrame(f.view(), data));
+            frame_ends.push_back(data.size());
+        }
+
+        // every cut inside of the frame is an error, cut after the frame: less frames
+        Frames res;
+        size_t nframes = 0;
+        for (size_t i = 1; i < data.size(); i++) {
+            const bool frame_end = (i == frame_ends[nframes]);
+            if (frame_end)
+                nframes++;
+
+            REQUIRE(decode(data, i, res) == frame_end);
+            if (frame_end)
+                REQUIRE(res.size() == nframes);
+        }
+
+        REQUIRE(decode(data, 0, res));
+        REQUIRE(res.empty());
+    }
+
+    SECTION("malformed")
+    {
+        Frames res;
+        const Bytes unknown_tag { 1, 0, 'x', 0, 0, 0, 0 };
+        REQUIRE_FALSE(decode(unknown_tag, unknown_tag.size(), res));
+
+        const Bytes long_str { 1, 0, 's', 10, 0, 'a', 'b' };
+        REQUIRE_FALSE(decode(long_str, long_str.size(), res));
+    }
+
+    SECTION("too long")
+    {
+        Bytes data;
+        REQUIRE(NetWsServer::toBinaryFrame(LF(1).view(), data));
+        const auto n = data.size();
+
+        AtomList lst;
+        lst.fill(Atom(1), 65536);
+        REQUIRE_FALSE(NetWsServer::toBinaryFrame(lst.view(), data));
+        REQUIRE(data.size() == n);
+
+        const std::string str(65536, 'a');
+        REQUIRE_FALSE(NetWsServer::toBinaryFrame(LA(1, str.c_str()).view(), data));
+        REQUIRE(data.size() == n);
+    }
+}
@@ -17,6 +17,10 @@
 #include "preset_base.h"
 
 #include "test_base.h"
+
+#include <cstdio>
+#include <functional>
+
 using PresetBaseTest = TestExternal<PresetBase>;
 
 TEST_CASE("ceammc_preset", "[PureData]")
@@ -384,4 +388,120 @@ TEST_CASE("ceammc_preset", "[PureData]")
             REQUIRE(s.interListValue(SYM("L"), 2, L()) == L());
         }
     }
+
+    SECTION("binary bank")
+    {
+        PresetStorage& s = PresetStorage::instance();
+        s.clearAll();
+
+        s.setFloatValueAt(SYM("F"), 0, -1024);
+        s.setFloatValueAt(SYM("F"), 255, 0.125);
+        s.setSymbolValueAt(SYM("SYM"), 1, SYM("some string    with spaces, and ;"));
+        s.setListValueAt(SYM("LST"), 2, LA(1, 2, 3, "a", "b", "c", "d, e, f;"));
+        s.setListValueAt(SYM("LST"), 3, L());
+        s.setAnyValueAt(SYM("ANY"), 4, SYM("sample"), LF(1, 3));
+
+        REQUIRE(s.write("./presets.bin"));
+        REQUIRE(platform::path_exists("./presets.bin"));
+
+        s.setFloatValueAt(SYM("F"), 0, 1);
+        s.clearValueAt(SYM("F"), 255);
+        s.setSymbolValueAt(SYM("SYM"), 1, SYM("?"));
+        s.clearValueAt(SYM("LST"), 2);
+        s.setAnyValueAt(SYM("ANY"), 4, SYM("other"), L());
+
+        REQUIRE(s.read("./presets.bin"));
+        REQUIRE(s.keys().size() == 4);
+        REQUIRE(s.floatValueAt(SYM("F"), 0) == -1024);
+        REQUIRE(s.floatValueAt(SYM("F"), 255) == 0.125);
+        REQUIRE(s.symbolValueAt(SYM("SYM"), 1, &s_) == SYM("some string    with spaces, and ;"));
+        REQUIRE(s.listValueAt(SYM("LST"), 2) == LA(1, 2, 3, "a", "b", "c", "d, e, f;"));
+        REQUIRE(s.hasValueTypeAt(SYM("LST"), Message::LIST, 3));
+        REQUIRE(s.anyValueAt(SYM("ANY"), 4) == LA("sample", 1, 3));
+        REQUIRE(s.hasIndex(255));
+
+        // only existing presets are loaded
+        s.clearAll();
+        s.setFloatValueAt(SYM("F"), 1, 1);
+        REQUIRE(s.read("./presets.bin"));
+        REQUIRE(s.keys() == LA("F"));
+        REQUIRE(s.floatValueAt(SYM("F"), 0) == -1024);
+        REQUIRE(s.floatValueAt(SYM("F"), 1) == 1);
+
+        REQUIRE(platform::remove("./presets.bin"));
+        REQUIRE_FALSE(s.readBinary("./presets.bin"));
+
+        // truncated bank
+        FILE* f = fopen("./presets.bin", "wb");
+        REQUIRE(f);
+        fwrite("CPB1\1\0\0\0", 1, 8, f);
+        fclose(f);
+        REQUIRE_FALSE(s.read("./presets.bin"));
+        REQUIRE(platform::remove("./presets.bin"));
+    }
+
+    SECTION("batched recall")
+    {
+        struct Client : public PresetClient {
+            std::vector<t_float> load;
+            size_t store = 0, clear = 0, update = 0;
+            std::function<void()> on_load;
+
+            void presetLoad(t_float idx) override
+            {
+                load.push_back(idx);
+                if (on_load)
+                    on_load();
+            }
+            void presetStore(size_t idx) override { store = idx; }
+            void presetClear(size_t idx) override { clear = idx; }
+            void presetUpdate() override { update++; }
+        };
+
+        PresetStorage& s = PresetStorage::instance();
+        s.clearAll();
+
+        Client c0, c1;
+        Preset* p0 = s.bindPreset(SYM("c0"), &c0);
+        REQUIRE(p0);
+        REQUIRE(p0->name() == SYM("c0"));
+        REQUIRE(s.bindPreset(SYM("c1"), &c1));
+
+        s.loadAll(3);
+        s.interpAll(1.5);
+        s.storeAll(4);
+        s.clearAll(5);
+        s.updateAll();
+
+        REQUIRE(c0.load.size() == 2);
+        REQUIRE(c0.load[0] == 3);
+        REQUIRE(c0.load[1] == 1.5);
+        REQUIRE(c1.load == c0.load);
+        REQUIRE(c0.store == 4);
+        REQUIRE(c1.clear == 5);
+        REQUIRE(c1.update == 1);
+
+        // bound presets are kept, data is removed
+        p0->setFloatAt(0, 100);
+        s.clearAll();
+        REQUIRE(s.hasPreset(SYM("c0")));
+        REQUIRE_FALSE(p0->hasDataAt(0));
+
+        // unbind while dispatching
+        c0.on_load = [&]() { s.unbindPreset(SYM("c1"), &c1); };
+        s.loadAll(1);
+        REQUIRE(c0.load.size() == 3);
+        REQUIRE(c1.load.size() == 2);
+        REQUIRE_FALSE(s.hasPreset(SYM("c1")));
+
+        c0.on_load = nullptr;
+        s.loadAll(2);
+        REQUIRE(c0.load.size() == 4);
+        REQUIRE(c1.load.size() == 2);
+
+        s.unbindPreset(SYM("c0"), &c0);
+        s.loadAll(2);
+        REQUIRE(c0.load.size() == 4);
+        REQUIRE_FALSE(s.hasPreset(SYM("c0")));
+    }
 }
@@ -40,6 +40,7 @@ TEST_CASE("hoa.process~", "[externals]")
             REQUIRE(t.numOutlets() == 0);
             REQUIRE_PROPERTY(t, @domain, S("harmonics"));
             REQUIRE_PROPERTY_FLOAT(t, @n, 0);
+            REQUIRE_PROPERTY_FLOAT(t, @parallel, 0);
         }
 
         SECTION("no patch")
@@ -374,6 +375,49 @@ TEST_CASE("hoa.process~", "[externals]")
         }
     }
 
+    SECTION("audio 15 plane parallel")
+    {
+        dsp_setthreads(2);
+
+        TExt t("hoa.process~", LA(3, QPATH("hoa_test_12"), "planewaves", "@parallel", 1));
+        REQUIRE(t.numInlets() == 3);
+        REQUIRE(t.numOutlets() == 4);
+        REQUIRE_PROPERTY_FLOAT(t, @parallel, 1);
+
+        pd::External sig1("sig~", LF(1));
+        REQUIRE(sig1.connectTo(0, t, 0));
+        pd::External sig2("sig~", LF(-1));
+        REQUIRE(sig2.connectTo(0, t, 1));
+        pd::External sig3("sig~", LF(2.5));
+        REQUIRE(sig3.connectTo(0, t, 2));
+
+        cnv->addExternal(sig1);
+        cnv->addExternal(sig2);
+        cnv->addExternal(sig3);
+        cnv->addExternal(t);
+
+        canvas_resume_dsp(1);
+        t.schedTicks(1);
+        canvas_suspend_dsp();
+
+        REQUIRE(t->outputBuffer().size() != 0);
+
+        // same as serial: extra output is the sum of all instances
+        for (size_t i = 0; i < t->outputBuffer().size(); i++) {
+            auto samp = t->outputBuffer()[i];
+            if (i / t->blockSize() == 0)
+                REQUIRE(samp == 2);
+            else if (i / t->blockSize() == 1)
+                REQUIRE(samp == -2);
+            else if (i / t->blockSize() == 2)
+                REQUIRE(samp == 5);
+            else if (i / t->blockSize() == 3)
+                REQUIRE(samp == -5);
+        }
+
+        dsp_setthreads(0);
+    }
+
     SECTION("audio 16 plane")
     {
         TExt t("hoa.process~", LA(3, QPATH("hoa_test_13"), "planewaves"));
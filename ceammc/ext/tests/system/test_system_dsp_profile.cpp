@@ -0,0 +1,61 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavski. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "system_dsp_profile.h"
+#include "d_profile.h"
+#include "test_system_base.h"
+
+PD_COMPLETE_TEST_SETUP(SystemDspProfile, system, dsp_profile)
+
+TEST_CASE("system.dsp_profile", "[externals]")
+{
+    pd_test_init();
+
+    SECTION("init")
+    {
+        TObj t("system.dsp_profile");
+        REQUIRE(t.numInlets() == 1);
+        REQUIRE(t.numOutlets() == 2);
+        REQUIRE_PROPERTY(t, @n, 10);
+        REQUIRE_PROPERTY(t, @on, 0);
+    }
+
+    SECTION("args")
+    {
+        TObj t("system.dsp_profile", LF(4));
+        REQUIRE_PROPERTY(t, @n, 4);
+    }
+
+    SECTION("on")
+    {
+        TExt t("system.dsp_profile");
+        REQUIRE_FALSE(dsp_getprofile());
+
+        t->setProperty("@on", LF(1));
+        REQUIRE(dsp_getprofile());
+        REQUIRE_PROPERTY(t, @on, 1);
+
+        t->setProperty("@on", LF(0));
+        REQUIRE_FALSE(dsp_getprofile());
+        REQUIRE_PROPERTY(t, @on, 0);
+    }
+
+    SECTION("no data")
+    {
+        TExt t("system.dsp_profile");
+        t.call("reset");
+        t.bang();
+        REQUIRE_FALSE(t.hasNewMessages(0));
+        REQUIRE(floatAt(t, 1_out) == 0);
+    }
+}
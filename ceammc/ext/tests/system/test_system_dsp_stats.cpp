@@ -0,0 +1,86 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavski. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "system_dsp_stats.h"
+#include "test_system_base.h"
+
+PD_COMPLETE_TEST_SETUP(SystemDspStats, system, dsp_stats)
+
+TEST_CASE("system.dsp_stats", "[externals]")
+{
+    pd_test_init();
+
+    SECTION("init")
+    {
+        TObj t("system.dsp_stats");
+        REQUIRE(t.numInlets() == 1);
+        REQUIRE(t.numOutlets() == 1);
+        REQUIRE(t.hasProperty("@period"));
+        REQUIRE(t.hasProperty("@ticks"));
+        REQUIRE(t.hasProperty("@late"));
+        REQUIRE(t.hasProperty("@xruns"));
+        REQUIRE(t.hasProperty("@max"));
+        REQUIRE(t.hasProperty("@mean"));
+        REQUIRE(t.hasProperty("@p50"));
+        REQUIRE(t.hasProperty("@p90"));
+        REQUIRE(t.hasProperty("@p99"));
+        REQUIRE(t.hasProperty("@idle"));
+        REQUIRE(t.hasProperty("@hist"));
+    }
+
+    SECTION("ticks")
+    {
+        TExt t("system.dsp_stats");
+        t.call("reset");
+
+        // period is 10ms
+        schedstats_tick(1200, 10000);
+        schedstats_tick(400, 10000);
+        schedstats_tick(13300, 10000);
+        schedstats_xrun();
+
+        REQUIRE_PROPERTY(t, @ticks, 3);
+        REQUIRE_PROPERTY(t, @late, 1);
+        REQUIRE_PROPERTY(t, @xruns, 1);
+        REQUIRE_PROPERTY_FLOAT(t, @period, 10);
+        REQUIRE_PROPERTY_FLOAT(t, @max, 13.3);
+        REQUIRE_PROPERTY_FLOAT(t, @mean, 14.9 / 3);
+        // upper edge of the 10-15% bin
+        REQUIRE_PROPERTY_FLOAT(t, @p50, 1.5);
+        REQUIRE_PROPERTY_FLOAT(t, @p99, 13.3);
+
+        auto hist = t->property("@hist")->get();
+        REQUIRE(hist.size() == SCHEDSTATS_NBINS);
+        REQUIRE(hist[0] == A(1));
+        REQUIRE(hist[2] == A(1));
+        REQUIRE(hist[26] == A(1));
+
+        t.bang();
+        REQUIRE(t.hasNewMessages(0));
+        auto ticks = t.lastMessage(0).listValue();
+        REQUIRE(ticks.size() == 3);
+        REQUIRE(ticks[0].asFloat() == Approx(0.12));
+        REQUIRE(ticks[1].asFloat() == Approx(0.04));
+        REQUIRE(ticks[2].asFloat() == Approx(1.33));
+
+        t.clearAll();
+        t.bang();
+        REQUIRE(t.lastMessage(0).listValue().empty());
+
+        t.call("reset");
+        schedstats_tick(100, 10000);
+        REQUIRE_PROPERTY(t, @ticks, 1);
+        REQUIRE_PROPERTY(t, @late, 0);
+        REQUIRE_PROPERTY(t, @xruns, 0);
+    }
+}
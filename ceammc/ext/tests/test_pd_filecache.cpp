@@ -0,0 +1,115 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_pd.h"
+#include "test_base.h"
+
+extern "C" {
+#include "s_stuff.h"
+}
+
+#include <cstdio>
+#include <ctime>
+#include <utime.h>
+
+using namespace ceammc;
+
+static const char* FNAME = "test_filecache.pd";
+
+static std::string full_path()
+{
+    return std::string(TEST_BIN_DIR) + "/" + FNAME;
+}
+
+static void set_mtime(time_t t)
+{
+    utimbuf tb;
+    tb.actime = t;
+    tb.modtime = t;
+    REQUIRE(utime(full_path().c_str(), &tb) == 0);
+}
+
+static void write_file(const AtomList& data)
+{
+    t_binbuf* b = binbuf_new();
+    binbuf_add(b, data.size(), data.toPdData());
+    binbuf_addsemi(b);
+    REQUIRE(binbuf_write(b, FNAME, TEST_BIN_DIR, 0) == 0);
+    binbuf_free(b);
+}
+
+static void write_file_external(const char* txt)
+{
+    // bypassing Pd: cache is not notified
+    FILE* f = fopen(full_path().c_str(), "w");
+    REQUIRE(f);
+    fputs(txt, f);
+    fclose(f);
+}
+
+static std::string read_cached()
+{
+    t_binbuf* b = binbuf_new();
+    REQUIRE(binbuf_read_cached(b, FNAME, TEST_BIN_DIR) == 0);
+    char* txt = nullptr;
+    int len = 0;
+    binbuf_gettext(b, &txt, &len);
+    std::string res(txt, len);
+    freebytes(txt, len);
+    binbuf_free(b);
+    return res;
+}
+
+TEST_CASE("pd file cache", "[PureData]")
+{
+    const bool i = []() { PureData::instance(); return true; }();
+    test::pdPrintToStdError();
+
+    const time_t T0 = time(nullptr) - 100;
+
+    SECTION("mtime")
+    {
+        write_file(LF(1, 2, 3));
+        set_mtime(T0);
+        REQUIRE(read_cached() == "1 2 3;\n");
+
+        // same size and mtime: cached version
+        write_file_external("4 5 6;\n");
+        set_mtime(T0);
+        REQUIRE(read_cached() == "1 2 3;\n");
+
+        // changed mtime: parsed again
+        set_mtime(T0 + 10);
+        REQUIRE(read_cached() == "4 5 6;\n");
+        REQUIRE(read_cached() == "4 5 6;\n");
+
+        // changed size
+        write_file_external("4 5 6 7;\n");
+        set_mtime(T0 + 10);
+        REQUIRE(read_cached() == "4 5 6 7;\n");
+    }
+
+    SECTION("forget on write")
+    {
+        write_file(LF(1, 2, 3));
+        set_mtime(T0);
+        REQUIRE(read_cached() == "1 2 3;\n");
+
+        // same size and mtime, but written by Pd
+        write_file(LF(7, 8, 9));
+        set_mtime(T0);
+        REQUIRE(read_cached() == "7 8 9;\n");
+    }
+
+    std::remove(full_path().c_str());
+}
@@ -0,0 +1,69 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_canvas.h"
+#include "ceammc_pd.h"
+#include "d_parallel.h"
+#include "test_base.h"
+
+using namespace ceammc;
+
+static void bang_nested(const char* name, int nthreads, t_float* res)
+{
+    dsp_setthreads(nthreads);
+
+    auto cnv = PureData::instance().createTopCanvas(TEST_DATA_DIR "/parallel");
+    auto out = cnv->createArray((std::string(name) + "-out").c_str(), 64);
+    out->fillWith(0.f);
+
+    REQUIRE(cnv->createAbstraction(10, 10, gensym("test_parallel_01"), LA(name)));
+    // put the subpatch into a parallel region
+    pd_float(gensym((std::string(name) + "-parallel").c_str())->s_thing, 1);
+
+    canvas_resume_dsp(1);
+    // run the switched off subpatch nested in the region once
+    pd_bang(gensym((std::string(name) + "-bang").c_str())->s_thing);
+    canvas_suspend_dsp();
+
+    for (size_t i = 0; i < 64; i++)
+        res[i] = (*out)[i];
+
+    dsp_setthreads(0);
+}
+
+TEST_CASE("pd parallel", "[PureData]")
+{
+    const bool i = []() { PureData::instance(); return true; }();
+    test::pdPrintToStdError();
+
+    SECTION("nested switch~ bang")
+    {
+        t_float serial[64], parallel[64];
+
+        bang_nested("p0", 0, serial);
+        for (size_t i = 0; i < 64; i++)
+            REQUIRE(serial[i] == 7);
+
+        bang_nested("p1", 2, parallel);
+        for (size_t i = 0; i < 64; i++)
+            REQUIRE(parallel[i] == 7);
+    }
+
+    SECTION("switch run")
+    {
+        auto cnv = PureData::instance().createTopCanvas(TEST_DATA_DIR "/parallel");
+        auto obj = cnv->createObject("f", L());
+        REQUIRE(obj);
+        REQUIRE(dsp_switch_run(obj->pd()) == 0);
+    }
+}
@@ -0,0 +1,296 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_canvas.h"
+#include "ceammc_pd.h"
+#include "d_simd.h"
+#include "test_base.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace ceammc;
+
+namespace {
+
+using Buffer = std::vector<t_sample>;
+
+constexpr size_t N = 128;
+
+enum OpArgs {
+    OP_BINARY, // in1, in2, out, n
+    OP_SCALAR, // in, &f, out, n
+    OP_UNARY, // in, out, n
+    OP_CLIP // in, out, &lo, &hi, n
+};
+
+struct Op {
+    t_simdop op;
+    const char* name;
+    OpArgs args;
+    t_float f0, f1;
+    // sqrt~ and rsqrt~ are approximated by tables in the plain routines
+    double eps;
+};
+
+const Op ops[] = {
+    { SIMD_PLUS, "+~", OP_BINARY, 0, 0, 0 },
+    { SIMD_SCALARPLUS, "+~", OP_SCALAR, 0.5, 0, 0 },
+    { SIMD_MINUS, "-~", OP_BINARY, 0, 0, 0 },
+    { SIMD_SCALARMINUS, "-~", OP_SCALAR, 0.5, 0, 0 },
+    { SIMD_TIMES, "*~", OP_BINARY, 0, 0, 0 },
+    { SIMD_SCALARTIMES, "*~", OP_SCALAR, 0.5, 0, 0 },
+    { SIMD_OVER, "/~", OP_BINARY, 0, 0, 0 },
+    { SIMD_SCALAROVER, "/~", OP_SCALAR, 3, 0, 0 },
+    { SIMD_MAX, "max~", OP_BINARY, 0, 0, 0 },
+    { SIMD_SCALARMAX, "max~", OP_SCALAR, 0.1, 0, 0 },
+    { SIMD_MIN, "min~", OP_BINARY, 0, 0, 0 },
+    { SIMD_SCALARMIN, "min~", OP_SCALAR, 0.1, 0, 0 },
+    { SIMD_CLIP, "clip~", OP_CLIP, -0.5, 0.75, 0 },
+    { SIMD_WRAP, "wrap~", OP_UNARY, 0, 0, 0 },
+    { SIMD_SQRT, "sqrt~", OP_UNARY, 0, 0, 1e-4 },
+    { SIMD_RSQRT, "rsqrt~", OP_UNARY, 0, 0, 1e-4 },
+    { SIMD_ABS, "abs~", OP_UNARY, 0, 0, 0 },
+};
+
+// no zeros: rsqrt~ of 0 is "very large" in both, but not the same
+t_sample input_a(size_t i)
+{
+    switch (i % 32) {
+    case 3:
+        return 1e10;
+    case 5:
+        return -1e10;
+    case 7:
+        return -3.25;
+    case 11:
+        return 2;
+    default:
+        return std::sin(i * 0.37) * 4 + (int((i * 31) % 41) - 20) * 0.013 + 0.001;
+    }
+}
+
+t_sample input_b(size_t i)
+{
+    return (i % 5 == 0) ? 0 : std::cos(i * 0.23) * 2;
+}
+
+bool equal(const Buffer& a, const Buffer& b, double eps)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (size_t i = 0; i < a.size(); i++) {
+        if (eps == 0 && a[i] != b[i])
+            return false;
+        else if (std::fabs(a[i] - b[i]) > eps * std::max<double>(1, std::fabs(b[i])))
+            return false;
+    }
+
+    return true;
+}
+
+struct TestArrays {
+    CanvasPtr cnv;
+    ArrayPtr a, b, out;
+
+    TestArrays()
+        : cnv(PureData::instance().createTopCanvas(TEST_DATA_DIR "/simd_arrays"))
+    {
+        a = cnv->createArray("simd-a", N);
+        b = cnv->createArray("simd-b", N);
+        out = cnv->createArray("simd-out", N);
+        a->fillWith([](size_t i) -> t_float { return input_a(i); });
+        b->fillWith([](size_t i) -> t_float { return input_b(i); });
+    }
+};
+
+TestArrays& arrays()
+{
+    static TestArrays arr;
+    return arr;
+}
+
+void connect(const CanvasPtr& cnv, int src, int out, int dest, int in)
+{
+    pd::message_to(cnv->pd(), gensym("connect"), LA(src, out, dest, in));
+}
+
+// runs the object once on the test arrays with the given instruction set and block size
+Buffer run_object(const Op& op, int isa, int n)
+{
+    REQUIRE(dsp_setsimd(isa));
+    arrays().out->fillWith(0.f);
+
+    auto cnv = PureData::instance().createTopCanvas(TEST_DATA_DIR "/simd");
+    cnv->createPdObject(10, 10, gensym("tabreceive~"), LA("simd-a"));
+    cnv->createPdObject(100, 10, gensym("tabreceive~"), LA("simd-b"));
+
+    switch (op.args) {
+    case OP_SCALAR:
+        cnv->createPdObject(10, 50, gensym(op.name), LF(op.f0));
+        break;
+    case OP_CLIP:
+        cnv->createPdObject(10, 50, gensym(op.name), LF(op.f0, op.f1));
+        break;
+    default:
+        cnv->createPdObject(10, 50, gensym(op.name));
+        break;
+    }
+
+    cnv->createPdObject(10, 90, gensym("tabsend~"), LA("simd-out"));
+    cnv->createPdObject(200, 10, gensym("r"), LA("simd-bang"));
+    cnv->createPdObject(200, 50, gensym("switch~"), LA(n));
+
+    connect(cnv, 0, 0, 2, 0);
+    if (op.args == OP_BINARY)
+        connect(cnv, 1, 0, 2, 1);
+    connect(cnv, 2, 0, 3, 0);
+    connect(cnv, 4, 0, 5, 0);
+
+    canvas_resume_dsp(1);
+    // run the switched off canvas once
+    pd_bang(gensym("simd-bang")->s_thing);
+    canvas_suspend_dsp();
+    cnv->free();
+
+    Buffer res(n);
+    for (int i = 0; i < n; i++)
+        res[i] = (*arrays().out)[i];
+
+    return res;
+}
+
+// calls the routine directly on the buffers shifted by one sample from their allocation,
+// so the vector loads and stores are unaligned
+Buffer run_routine(const Op& op, int n, bool inplace)
+{
+    auto fn = dsp_simdroutine(op.op, n);
+    REQUIRE(fn);
+
+    Buffer in1(n + 1), in2(n + 1), out(n + 1);
+    for (int i = 0; i < n; i++) {
+        in1[i + 1] = input_a(i);
+        in2[i + 1] = input_b(i);
+    }
+
+    auto a = in1.data() + 1;
+    auto b = in2.data() + 1;
+    auto c = inplace ? a : out.data() + 1;
+    auto f0 = op.f0;
+    auto f1 = op.f1;
+
+    switch (op.args) {
+    case OP_BINARY: {
+        t_int w[] = { 0, (t_int)a, (t_int)b, (t_int)c, n };
+        REQUIRE(fn(w) == w + 5);
+    } break;
+    case OP_SCALAR: {
+        t_int w[] = { 0, (t_int)a, (t_int)&f0, (t_int)c, n };
+        REQUIRE(fn(w) == w + 5);
+    } break;
+    case OP_UNARY: {
+        t_int w[] = { 0, (t_int)a, (t_int)c, n };
+        REQUIRE(fn(w) == w + 4);
+    } break;
+    case OP_CLIP: {
+        t_int w[] = { 0, (t_int)a, (t_int)c, (t_int)&f0, (t_int)&f1, n };
+        REQUIRE(fn(w) == w + 6);
+    } break;
+    }
+
+    return Buffer(c, c + n);
+}
+
+}
+
+TEST_CASE("pd simd", "[PureData]")
+{
+    const bool i = []() { PureData::instance(); return true; }();
+    test::pdPrintToStdError();
+
+    const int isa_list[] = { DSP_SIMD_SSE2, DSP_SIMD_AVX2, DSP_SIMD_NEON };
+    const int default_isa = dsp_getsimd();
+
+    SECTION("isa")
+    {
+        REQUIRE(dsp_hassimd(DSP_SIMD_NONE));
+        REQUIRE_FALSE(dsp_hassimd(-1));
+        REQUIRE(dsp_setsimd(DSP_SIMD_NONE));
+        REQUIRE(dsp_getsimd() == DSP_SIMD_NONE);
+        REQUIRE(dsp_simdroutine(SIMD_PLUS, 64) == nullptr);
+        REQUIRE(dsp_setsimd(default_isa));
+    }
+
+    SECTION("block size")
+    {
+        for (auto isa : isa_list) {
+            if (!dsp_hassimd(isa))
+                continue;
+
+            REQUIRE(dsp_setsimd(isa));
+            for (auto& op : ops) {
+                INFO(dsp_simdname(isa) << ' ' << op.name);
+                // the plain routines are used for these
+                REQUIRE(dsp_simdroutine(op.op, 0) == nullptr);
+                REQUIRE(dsp_simdroutine(op.op, 1) == nullptr);
+                REQUIRE(dsp_simdroutine(op.op, 7) == nullptr);
+                REQUIRE(dsp_simdroutine(op.op, 12) == nullptr);
+                REQUIRE(dsp_simdroutine(op.op, 63) == nullptr);
+                REQUIRE(dsp_simdroutine(op.op, 8) != nullptr);
+            }
+        }
+
+        REQUIRE(dsp_setsimd(default_isa));
+    }
+
+    SECTION("objects")
+    {
+        for (int n : { 8, 16, 64 }) {
+            for (auto& op : ops) {
+                const auto plain = run_object(op, DSP_SIMD_NONE, n);
+
+                for (auto isa : isa_list) {
+                    if (!dsp_hassimd(isa))
+                        continue;
+
+                    INFO(dsp_simdname(isa) << ' ' << op.name << " n=" << n);
+                    REQUIRE(equal(run_object(op, isa, n), plain, op.eps));
+                }
+            }
+        }
+
+        REQUIRE(dsp_setsimd(default_isa));
+    }
+
+    SECTION("unaligned")
+    {
+        for (int n : { 8, 24, 64 }) {
+            for (auto& op : ops) {
+                const auto plain = run_object(op, DSP_SIMD_NONE, n);
+
+                for (auto isa : isa_list) {
+                    if (!dsp_hassimd(isa))
+                        continue;
+
+                    INFO(dsp_simdname(isa) << ' ' << op.name << " n=" << n);
+                    REQUIRE(dsp_setsimd(isa));
+                    REQUIRE(equal(run_routine(op, n, false), plain, op.eps));
+                    REQUIRE(equal(run_routine(op, n, true), plain, op.eps));
+                }
+            }
+        }
+
+        REQUIRE(dsp_setsimd(default_isa));
+    }
+}
@@ -0,0 +1,150 @@
+/*****************************************************************************
+ * Copyright 2023 Serge Poltavsky. All rights reserved.
+ *
+ * This file may be distributed under the terms of GNU Public License version
+ * 3 (GPL v3) as defined by the Free Software Foundation (FSF). A copy of the
+ * license should have been included with this file, or the project in which
+ * this file belongs to. You may also find the details of GPL v3 at:
+ * http://www.gnu.org/licenses/gpl-3.0.txt
+ *
+ * If you have any questions regarding the use of this file, feel free to
+ * contact the author of this file, or the owner of the project in which
+ * this file belongs to.
+ *****************************************************************************/
+#include "ceammc_canvas.h"
+#include "ceammc_pd.h"
+#include "test_ui.h"
+
+#include <map>
+
+extern "C" {
+#include "g_canvas.h"
+#include "s_stuff.h"
+}
+
+using namespace ceammc;
+using ExternalPtr = std::shared_ptr<pd::External>;
+
+static std::map<t_ebox*, int> paints;
+
+static void count_paint(t_ebox* x)
+{
+    paints[x]++;
+}
+
+static int total_paints()
+{
+    int n = 0;
+    for (auto& kv : paints)
+        n += kv.second;
+
+    return n;
+}
+
+static void run_ms(double ms)
+{
+    const auto t = clock_getlogicaltime();
+    while (clock_gettimesince(t) < ms)
+        sched_tick();
+}
+
+// canvas opened without GUI: objects are visible but paint only to the hook
+static CanvasPtr make_visible_canvas()
+{
+    auto cnv = PureData::instance().createTopCanvas("test_ui_redraw");
+    cnv->pd_canvas()->gl_havewindow = 1;
+    cnv->pd_canvas()->gl_mapped = 1;
+    cnv->pd_canvas()->gl_loading = 0;
+    return cnv;
+}
+
+static t_ebox* make_knob(CanvasPtr cnv, std::vector<ExternalPtr>& objs)
+{
+    auto obj = cnv->createObject("ui.knob", L());
+    REQUIRE(obj);
+    objs.push_back(obj);
+
+    gobj_vis(reinterpret_cast<t_gobj*>(obj->object()), cnv->pd_canvas(), 1);
+    return reinterpret_cast<t_ebox*>(obj->object());
+}
+
+TEST_CASE("ebox redraw", "[ebox]")
+{
+    test_ui_main_init();
+    ebox_set_paint_hook(count_paint);
+
+    SECTION("deduplication")
+    {
+        auto cnv = make_visible_canvas();
+        std::vector<ExternalPtr> objs;
+        auto k0 = make_knob(cnv, objs);
+        auto k1 = make_knob(cnv, objs);
+        REQUIRE(ebox_isvisible(k0));
+        REQUIRE(ebox_isvisible(k1));
+        run_ms(50);
+        paints.clear();
+
+        // many redraws in one frame: single paint per box
+        for (int i = 0; i < 100; i++) {
+            ebox_redraw(k0);
+            ebox_redraw(k1);
+        }
+
+        REQUIRE(total_paints() == 0);
+        run_ms(20);
+        REQUIRE(paints[k0] == 1);
+        REQUIRE(paints[k1] == 1);
+
+        // nothing queued: no paints
+        run_ms(100);
+        REQUIRE(total_paints() == 2);
+
+        // immediate paint cancels the queued one
+        ebox_redraw(k0);
+        ebox_redraw_now(k0);
+        REQUIRE(paints[k0] == 2);
+        run_ms(20);
+        REQUIRE(paints[k0] == 2);
+    }
+
+    SECTION("paints per frame")
+    {
+        auto cnv = make_visible_canvas();
+        std::vector<ExternalPtr> objs;
+        auto k0 = make_knob(cnv, objs);
+        run_ms(50);
+        paints.clear();
+
+        // redraw on every scheduler tick for 1 second
+        const auto t = clock_getlogicaltime();
+        while (clock_gettimesince(t) < 1000) {
+            ebox_redraw(k0);
+            sched_tick();
+        }
+
+        // 60 fps
+        REQUIRE(paints[k0] >= 58);
+        REQUIRE(paints[k0] <= 61);
+    }
+
+    SECTION("freed box is removed from the queue")
+    {
+        auto cnv = make_visible_canvas();
+        std::vector<ExternalPtr> objs;
+        auto k0 = make_knob(cnv, objs);
+        auto k1 = make_knob(cnv, objs);
+        run_ms(50);
+        paints.clear();
+
+        ebox_redraw(k0);
+        ebox_redraw(k1);
+        objs[0].reset();
+
+        run_ms(20);
+        REQUIRE(paints.count(k0) == 0);
+        REQUIRE(paints[k1] == 1);
+    }
+
+    ebox_set_paint_hook(nullptr);
+    paints.clear();
+}
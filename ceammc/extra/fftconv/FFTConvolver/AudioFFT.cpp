@@ -33,6 +33,10 @@
 #elif defined (AUDIOFFT_FFTW3)
   #define AUDIOFFT_FFTW3_USED
   #include <fftw3.h>
+#elif defined (AUDIOFFT_PD)
+  #define AUDIOFFT_PD_USED
+  #include "m_pd.h"
+  #include <vector>
 #else
   #if !defined(AUDIOFFT_OOURA)
     #define AUDIOFFT_OOURA
@@ -999,6 +1003,95 @@ namespace audiofft
 #endif // AUDIOFFT_FFTW3_USED
 
 
+  // ================================================================
+
+
+#ifdef AUDIOFFT_PD_USED
+
+
+  /**
+   * @internal
+   * @class PdFFT
+   * @brief FFT implementation using the FFT of the Pd core (mayer_realfft() and
+   * mayer_realifft()), which shares its plans between all objects and threads
+   * and is vectorized if the CPU allows
+   */
+  class PdFFT : public detail::AudioFFTImpl
+  {
+  public:
+    PdFFT() :
+      detail::AudioFFTImpl(),
+      _size(0),
+      _buffer()
+    {
+    }
+
+    PdFFT(const PdFFT&) = delete;
+    PdFFT& operator=(const PdFFT&) = delete;
+
+    virtual void init(size_t size) override
+    {
+      if (_size != size)
+      {
+        _buffer.resize(size);
+        _size = size;
+      }
+    }
+
+    virtual void fft(const float* data, float* re, float* im) override
+    {
+      detail::ConvertBuffer(_buffer.data(), data, _size);
+
+      const int n = static_cast<int>(_size);
+      mayer_realfft(n, _buffer.data());
+
+      // Pd keeps the real parts in [0, n/2] and the negated imaginary parts
+      // backwards in [n/2+1, n-1]
+      const size_t size2 = _size / 2;
+      re[0] = static_cast<float>(_buffer[0]);
+      im[0] = 0.0f;
+      for (size_t i = 1; i < size2; ++i)
+      {
+        re[i] = static_cast<float>(_buffer[i]);
+        im[i] = static_cast<float>(-_buffer[_size - i]);
+      }
+      re[size2] = static_cast<float>(_buffer[size2]);
+      im[size2] = 0.0f;
+    }
+
+    virtual void ifft(float* data, const float* re, const float* im) override
+    {
+      const size_t size2 = _size / 2;
+      _buffer[0] = re[0];
+      for (size_t i = 1; i < size2; ++i)
+      {
+        _buffer[i] = re[i];
+        _buffer[_size - i] = -im[i];
+      }
+      _buffer[size2] = re[size2];
+
+      const int n = static_cast<int>(_size);
+      mayer_realifft(n, _buffer.data());
+
+      detail::ScaleBuffer(data, _buffer.data(), 1.0f / static_cast<float>(_size), _size);
+    }
+
+  private:
+    size_t _size;
+    std::vector<t_sample> _buffer;
+  };
+
+
+  /**
+   * @internal
+   * @brief Concrete FFT implementation
+   */
+  typedef PdFFT AudioFFTImplementation;
+
+
+#endif // AUDIOFFT_PD_USED
+
+
   // =============================================================
 
 
@@ -30,7 +30,8 @@
 *
 * - Real-complex FFT and complex-real inverse FFT for power-of-2-sized real data.
 *
-* - Uniform interface to different FFT implementations (currently Ooura, FFTW3 and Apple Accelerate).
+* - Uniform interface to different FFT implementations (currently Ooura, FFTW3, Apple Accelerate
+*   and the FFT of the Pd core).
 *
 * - Complex data is handled in "split-complex" format, i.e. there are separate
 *   arrays for the real and imaginary parts which can be useful for SIMD optimizations
@@ -56,6 +57,9 @@
 *   AUDIOFFT_APPLE_ACCELERATE  (however, please check whether your
 *   project suits the according license).
 *
+* - Inside Pd, define AUDIOFFT_PD to use Pd's own FFT (mayer_realfft()),
+*   which shares its tables with all other FFT users in the process.
+*
 *
 * Remarks:
 *
@@ -734,6 +734,10 @@ ceammc_ws_server *ceammc_ws_server_create(ceammc_ws_server_init params,
                                           ceammc_ws_server_result_cb cb_reply,
                                           ceammc_callback_notify cb_notify);
 
+/// number of outgoing messages dropped because of client back-pressure
+/// @param srv - pointer to websocket server
+size_t ceammc_ws_server_dropped(const ceammc_ws_server *srv);
+
 /// free websocket server
 /// @param src - pointer to server
 void ceammc_ws_server_free(ceammc_ws_server *srv);
@@ -770,6 +774,12 @@ bool ceammc_ws_server_send_text(ceammc_ws_server *srv,
                                 const char *msg,
                                 ceammc_ws_client_target target);
 
+/// set max number of pending outgoing data messages per client
+/// if slow client queue is full, new text and binary messages for it are dropped
+/// @param srv - pointer to websocket server
+/// @param n - max pending messages, 0 - unlimited
+bool ceammc_ws_server_set_max_pending(ceammc_ws_server *srv, size_t n);
+
 /// abort all client connections without handshake
 /// @param srv - pointer to websocket server
 /// @param target - specify target clients
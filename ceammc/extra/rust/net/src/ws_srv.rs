@@ -148,17 +148,29 @@ impl Token {
 
 #[derive(Debug, Clone)]
 enum ClientRequest {
-    SendText(String),
-    SendBinary(Vec<u8>),
+    SendText(Arc<String>),
+    SendBinary(Arc<Vec<u8>>),
     SendPing(Vec<u8>),
     Close,
     Shutdown,
 }
 
+impl ClientRequest {
+    /// data messages can be dropped for slow clients, control messages - never
+    fn is_droppable(&self) -> bool {
+        match self {
+            ClientRequest::SendText(_) | ClientRequest::SendBinary(_) => true,
+            _ => false,
+        }
+    }
+}
+
 type Tx = UnboundedSender<ClientRequest>;
 struct ClientInfo {
     peer: PeerInfo,
     tx: Tx,
+    /// number of messages queued for the client but not yet written to the socket
+    pending: Arc<AtomicUsize>,
 }
 type PeerMap = Arc<Mutex<HashMap<SocketAddr, ClientInfo>>>;
 
@@ -166,6 +178,10 @@ type PeerMap = Arc<Mutex<HashMap<SocketAddr, ClientInfo>>>;
 pub struct ws_server {
     srv: WsClientService,
     peer_map: PeerMap,
+    /// max number of pending data messages per client, 0 - unlimited
+    max_pending: usize,
+    /// number of data messages dropped for slow clients
+    dropped: usize,
 }
 
 impl ws_server {
@@ -204,11 +220,15 @@ async fn handle_server_to_client(
 ) {
     match req {
         ClientRequest::SendText(txt) => {
+            // tungstenite::Message owns its payload: every client but the last one
+            // makes its own copy here, in its own task, not in the Pd thread
+            let txt = Arc::try_unwrap(txt).unwrap_or_else(|txt| (*txt).clone());
             if let Err(err) = cli_tx.send(Message::Text(txt)).await {
                 reply_error(cb_notify, rep_tx, err.to_string()).await;
             }
         }
         ClientRequest::SendBinary(data) => {
+            let data = Arc::try_unwrap(data).unwrap_or_else(|data| (*data).clone());
             if let Err(err) = cli_tx.send(Message::Binary(data)).await {
                 reply_error(cb_notify, rep_tx, err.to_string()).await;
             }
@@ -265,9 +285,11 @@ async fn accept_connection(
                 addr: CString::new(addr.to_string()).unwrap_or_default(),
                 id: cli_id,
             };
+            let pending = Arc::new(AtomicUsize::new(0));
             let cli_info = ClientInfo {
                 peer: peer.clone(),
                 tx,
+                pending: pending.clone(),
             };
             peer_map.lock().unwrap().insert(addr, cli_info);
             reply_message(WsServerReply::Connected(peer.clone()), &cb_notify, &rep_tx).await;
@@ -300,7 +322,10 @@ async fn accept_connection(
                     }
                     req = rx.recv() => {
                         match req {
-                            Some(req) => handle_server_to_client(req,&mut write, &cb_notify, &rep_tx).await,
+                            Some(req) => {
+                                handle_server_to_client(req,&mut write, &cb_notify, &rep_tx).await;
+                                pending.fetch_sub(1, Ordering::Relaxed);
+                            },
                             None => break,
                         }
                     }
@@ -403,6 +428,8 @@ pub extern "C" fn ceammc_ws_server_create(
                             rep_rx,
                         ),
                         peer_map: connected_clients,
+                        max_pending: 0,
+                        dropped: 0,
                     }))
                 }
                 Err(err) => {
@@ -459,88 +486,102 @@ pub struct ws_client_target {
     id: usize,               // client id
 }
 
+/// queue message to the client
+/// @return Ok(false) if data message was dropped because of client back-pressure
+fn send_to_client(
+    info: &ClientInfo,
+    msg: ClientRequest,
+    max_pending: usize,
+) -> Result<bool, String> {
+    if max_pending > 0
+        && msg.is_droppable()
+        && info.pending.load(Ordering::Relaxed) >= max_pending
+    {
+        debug!("client [{}] is too slow, message dropped", info.peer.id);
+        return Ok(false);
+    }
+
+    match info.tx.send(msg) {
+        Ok(_) => {
+            info.pending.fetch_add(1, Ordering::Relaxed);
+            Ok(true)
+        }
+        Err(err) => Err(err.to_string()),
+    }
+}
+
 fn send_message(srv: &mut ws_server, msg: ClientRequest, target: ws_client_target) -> bool {
-    match target.sel {
-        ws_client_selector::ALL => {
-            let mut has_errors = false;
-            for (_addr, info) in srv.peer_map.lock().unwrap().iter() {
-                debug!("send to ALL: [{}]", info.peer.id);
-                if let Err(err) = info.tx.send(msg.clone()) {
-                    srv.srv.on_error(err.to_string().as_str());
-                    has_errors = true;
-                }
+    let max_pending = srv.max_pending;
+    let mut dropped = 0;
+    let mut has_errors = false;
+
+    {
+        let peers = srv.peer_map.lock().unwrap();
+
+        let mut send = |info: &ClientInfo, msg: ClientRequest| match send_to_client(
+            info,
+            msg,
+            max_pending,
+        ) {
+            Ok(true) => {}
+            Ok(false) => dropped += 1,
+            Err(err) => {
+                srv.srv.on_error(err.as_str());
+                has_errors = true;
             }
-            return if has_errors { false } else { true };
-        }
-        ws_client_selector::FIRST => match srv
-            .peer_map
-            .lock()
-            .unwrap()
-            .iter()
-            .min_by(|x, y| x.1.peer.id.cmp(&y.1.peer.id))
-        {
-            Some((_addr, info)) => {
-                debug!("send to FIRST: [{}]", info.peer.id);
-                if let Err(err) = info.tx.send(msg) {
-                    srv.srv.on_error(err.to_string().as_str());
-                    return false;
-                } else {
-                    return true;
+        };
+
+        match target.sel {
+            ws_client_selector::ALL => {
+                // only the Arc is cloned here, the payload is copied later by client tasks
+                for (_addr, info) in peers.iter() {
+                    debug!("send to ALL: [{}]", info.peer.id);
+                    send(info, msg.clone());
                 }
             }
-            None => {
-                srv.srv.on_error("no connected clients");
-                return false;
-            }
-        },
-        ws_client_selector::LAST => match srv
-            .peer_map
-            .lock()
-            .unwrap()
-            .iter()
-            .max_by(|x, y| x.1.peer.id.cmp(&y.1.peer.id))
-        {
-            Some((_addr, info)) => {
-                debug!("send to LAST: [{}]", info.peer.id);
-                if let Err(err) = info.tx.send(msg) {
-                    srv.srv.on_error(err.to_string().as_str());
-                    return false;
-                } else {
-                    return true;
+            ws_client_selector::FIRST => {
+                match peers.iter().min_by(|x, y| x.1.peer.id.cmp(&y.1.peer.id)) {
+                    Some((_addr, info)) => {
+                        debug!("send to FIRST: [{}]", info.peer.id);
+                        send(info, msg);
+                    }
+                    None => {
+                        srv.srv.on_error("no connected clients");
+                        has_errors = true;
+                    }
                 }
             }
-            None => {
-                srv.srv.on_error("no connected clients");
-                return false;
+            ws_client_selector::LAST => {
+                match peers.iter().max_by(|x, y| x.1.peer.id.cmp(&y.1.peer.id)) {
+                    Some((_addr, info)) => {
+                        debug!("send to LAST: [{}]", info.peer.id);
+                        send(info, msg);
+                    }
+                    None => {
+                        srv.srv.on_error("no connected clients");
+                        has_errors = true;
+                    }
+                }
             }
-        },
-        ws_client_selector::ID => {
-            for (_addr, info) in srv.peer_map.lock().unwrap().iter() {
-                if info.peer.id == target.id {
+            ws_client_selector::ID => {
+                if let Some((_addr, info)) = peers.iter().find(|x| x.1.peer.id == target.id) {
                     debug!("send to ID: [{}]", info.peer.id);
-                    if let Err(err) = info.tx.send(msg) {
-                        srv.srv.on_error(err.to_string().as_str());
-                        return false;
-                    } else {
-                        return true;
-                    }
+                    send(info, msg);
                 }
             }
-        }
-        ws_client_selector::EXCEPT => {
-            for (_addr, info) in srv.peer_map.lock().unwrap().iter() {
-                if info.peer.id != target.id {
-                    debug!("send EXCEPT {}: [{}]", target.id, info.peer.id);
-                    if let Err(err) = info.tx.send(msg.clone()) {
-                        srv.srv.on_error(err.to_string().as_str());
-                        return false;
+            ws_client_selector::EXCEPT => {
+                for (_addr, info) in peers.iter() {
+                    if info.peer.id != target.id {
+                        debug!("send EXCEPT {}: [{}]", target.id, info.peer.id);
+                        send(info, msg.clone());
                     }
                 }
             }
         }
     }
 
-    true
+    srv.dropped += dropped;
+    !has_errors
 }
 
 /// send text message to connected clients
@@ -564,7 +605,7 @@ pub extern "C" fn ceammc_ws_server_send_text(
     }
 
     let msg = unsafe { CStr::from_ptr(msg) }.to_string_lossy().to_string();
-    send_message(srv, ClientRequest::SendText(msg), target)
+    send_message(srv, ClientRequest::SendText(Arc::new(msg)), target)
 }
 
 /// send binary message to connected clients
@@ -586,9 +627,11 @@ pub extern "C" fn ceammc_ws_server_send_binary(
     let srv = unsafe { &mut *srv };
 
     let msg = if data.is_null() || len == 0 {
-        ClientRequest::SendBinary(vec![])
+        ClientRequest::SendBinary(Arc::new(vec![]))
     } else {
-        ClientRequest::SendBinary(unsafe { std::slice::from_raw_parts(data, len) }.to_vec())
+        ClientRequest::SendBinary(Arc::new(
+            unsafe { std::slice::from_raw_parts(data, len) }.to_vec(),
+        ))
     };
 
     send_message(srv, msg, target)
@@ -654,6 +697,33 @@ pub extern "C" fn ceammc_ws_server_shutdown_clients(
     send_message(srv, ClientRequest::Shutdown, target)
 }
 
+/// set max number of pending outgoing data messages per client
+/// if slow client queue is full, new text and binary messages for it are dropped
+/// @param srv - pointer to websocket server
+/// @param n - max pending messages, 0 - unlimited
+#[no_mangle]
+pub extern "C" fn ceammc_ws_server_set_max_pending(srv: *mut ws_server, n: usize) -> bool {
+    if srv.is_null() {
+        return false;
+    }
+
+    let srv = unsafe { &mut *srv };
+    srv.max_pending = n;
+    true
+}
+
+/// number of outgoing messages dropped because of client back-pressure
+/// @param srv - pointer to websocket server
+#[no_mangle]
+pub extern "C" fn ceammc_ws_server_dropped(srv: *const ws_server) -> usize {
+    if srv.is_null() {
+        return 0;
+    }
+
+    let srv = unsafe { &*srv };
+    srv.dropped
+}
+
 /// request connected client id
 /// @param srv - pointer to server
 /// @param user - user data pointer to callback
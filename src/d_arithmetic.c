@@ -9,6 +9,18 @@ to reset the value.
 */
 
 #include "m_pd.h"
+#include "d_simd.h"
+
+    /* put a binop on the DSP chain, using the vectorized routine for it if
+    there is one, else the unrolled one if the block size allows */
+static void binop_dsp(t_simdop op, t_perfroutine plain, t_perfroutine perf8,
+    void *in1, void *in2, t_sample *out, int n)
+{
+    t_perfroutine f = dsp_simdroutine(op, n);
+    if (!f)
+        f = (n&7 ? plain : perf8);
+    dsp_add(f, 4, in1, in2, out, (t_int)n);
+}
 
 /* ----------------------------- plus ----------------------------- */
 static t_class *plus_class, *scalarplus_class;
@@ -82,12 +94,8 @@ static void plus_dsp(t_plus *x, t_signal **sp)
 
 static void scalarplus_dsp(t_scalarplus *x, t_signal **sp)
 {
-    if (sp[0]->s_n&7)
-        dsp_add(scalarplus_perform, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
-    else
-        dsp_add(scalarplus_perf8, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
+    binop_dsp(SIMD_SCALARPLUS, scalarplus_perform, scalarplus_perf8,
+        sp[0]->s_vec, &x->x_g, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void plus_setup(void)
@@ -202,22 +210,14 @@ t_int *scalarminus_perf8(t_int *w)
 
 static void minus_dsp(t_minus *x, t_signal **sp)
 {
-    if (sp[0]->s_n&7)
-        dsp_add(minus_perform, 4,
-            sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, (t_int)sp[0]->s_n);
-    else
-        dsp_add(minus_perf8, 4,
-            sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, (t_int)sp[0]->s_n);
+    binop_dsp(SIMD_MINUS, minus_perform, minus_perf8,
+        sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, sp[0]->s_n);
 }
 
 static void scalarminus_dsp(t_scalarminus *x, t_signal **sp)
 {
-    if (sp[0]->s_n&7)
-        dsp_add(scalarminus_perform, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
-    else
-        dsp_add(scalarminus_perf8, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
+    binop_dsp(SIMD_SCALARMINUS, scalarminus_perform, scalarminus_perf8,
+        sp[0]->s_vec, &x->x_g, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void minus_setup(void)
@@ -333,22 +333,14 @@ t_int *scalartimes_perf8(t_int *w)
 
 static void times_dsp(t_times *x, t_signal **sp)
 {
-    if (sp[0]->s_n&7)
-        dsp_add(times_perform, 4,
-            sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, (t_int)sp[0]->s_n);
-    else
-        dsp_add(times_perf8, 4,
-            sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, (t_int)sp[0]->s_n);
+    binop_dsp(SIMD_TIMES, times_perform, times_perf8,
+        sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, sp[0]->s_n);
 }
 
 static void scalartimes_dsp(t_scalartimes *x, t_signal **sp)
 {
-    if (sp[0]->s_n&7)
-        dsp_add(scalartimes_perform, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
-    else
-        dsp_add(scalartimes_perf8, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
+    binop_dsp(SIMD_SCALARTIMES, scalartimes_perform, scalartimes_perf8,
+        sp[0]->s_vec, &x->x_g, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void times_setup(void)
@@ -475,22 +467,14 @@ t_int *scalarover_perf8(t_int *w)
 
 static void over_dsp(t_over *x, t_signal **sp)
 {
-    if (sp[0]->s_n&7)
-        dsp_add(over_perform, 4,
-            sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, (t_int)sp[0]->s_n);
-    else
-        dsp_add(over_perf8, 4,
-            sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, (t_int)sp[0]->s_n);
+    binop_dsp(SIMD_OVER, over_perform, over_perf8,
+        sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, sp[0]->s_n);
 }
 
 static void scalarover_dsp(t_scalarover *x, t_signal **sp)
 {
-    if (sp[0]->s_n&7)
-        dsp_add(scalarover_perform, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
-    else
-        dsp_add(scalarover_perf8, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
+    binop_dsp(SIMD_SCALAROVER, scalarover_perform, scalarover_perf8,
+        sp[0]->s_vec, &x->x_g, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void over_setup(void)
@@ -617,22 +601,14 @@ t_int *scalarmax_perf8(t_int *w)
 
 static void max_dsp(t_max *x, t_signal **sp)
 {
-    if (sp[0]->s_n&7)
-        dsp_add(max_perform, 4,
-            sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, (t_int)sp[0]->s_n);
-    else
-        dsp_add(max_perf8, 4,
-            sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, (t_int)sp[0]->s_n);
+    binop_dsp(SIMD_MAX, max_perform, max_perf8,
+        sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, sp[0]->s_n);
 }
 
 static void scalarmax_dsp(t_scalarmax *x, t_signal **sp)
 {
-    if (sp[0]->s_n&7)
-        dsp_add(scalarmax_perform, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
-    else
-        dsp_add(scalarmax_perf8, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
+    binop_dsp(SIMD_SCALARMAX, scalarmax_perform, scalarmax_perf8,
+        sp[0]->s_vec, &x->x_g, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void max_setup(void)
@@ -759,22 +735,14 @@ t_int *scalarmin_perf8(t_int *w)
 
 static void min_dsp(t_min *x, t_signal **sp)
 {
-    if (sp[0]->s_n&7)
-        dsp_add(min_perform, 4,
-            sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, (t_int)sp[0]->s_n);
-    else
-        dsp_add(min_perf8, 4,
-            sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, (t_int)sp[0]->s_n);
+    binop_dsp(SIMD_MIN, min_perform, min_perf8,
+        sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, sp[0]->s_n);
 }
 
 static void scalarmin_dsp(t_scalarmin *x, t_signal **sp)
 {
-    if (sp[0]->s_n&7)
-        dsp_add(scalarmin_perform, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
-    else
-        dsp_add(scalarmin_perf8, 4, sp[0]->s_vec, &x->x_g,
-            sp[1]->s_vec, (t_int)sp[0]->s_n);
+    binop_dsp(SIMD_SCALARMIN, scalarmin_perform, scalarmin_perf8,
+        sp[0]->s_vec, &x->x_g, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void min_setup(void)
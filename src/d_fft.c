@@ -9,6 +9,8 @@ to implement the "fft~", etc, Pd objects.  If using Mayer, also compile
 d_fft_mayer.c; if ooura, use d_fft_fftsg.c instead; if fftw, use d_fft_fftw.c
 and also link in the fftw library.  You can only have one of these three
 linked in.  The configure script can be used to select which one.
+Independently of that, the Ooura and fftw interfaces hand power-of-two sizes
+to the vectorized FFT in d_fftplan.c unless "pd fft-backend" says otherwise.
 */
 
 /* ------------------ initialization and cleanup -------------------------- */
@@ -21,6 +21,7 @@ for another, more permissive-sounding copyright notice.  -MSP
 /* ---------- Pd interface to OOURA FFT; imitate Mayer API ---------- */
 #include "m_pd.h"
 #include "m_imp.h"
+#include "d_fftplan.h"
 
 #ifdef _WIN32
 # include <malloc.h> /* MSVC or mingw on windows */
@@ -33,71 +34,73 @@ for another, more permissive-sounding copyright notice.  -MSP
 #define FFTFLT double
 void cdft(int, int, FFTFLT *, int *, FFTFLT *);
 void rdft(int, int, FFTFLT *, int *, FFTFLT *);
+void makewt(int nw, int *ip, FFTFLT *w);
+void makect(int nc, int *ip, FFTFLT *c);
 
 int ilog2(int n);
 
-static PERTHREAD int ooura_maxn;
-static PERTHREAD int *ooura_bitrev;
-static PERTHREAD int ooura_bitrevsize;
-static PERTHREAD FFTFLT *ooura_costab;
-static PERTHREAD FFTFLT *ooura_buffer;
+    /* Ooura's tables for transforms of n = 2^logn, as cdft() and rdft() would
+    make them on their first call.  They are made once per size and shared
+    by all threads; since they are complete, the routines only read them. */
+typedef struct _oouraplan
+{
+    int *op_bitrev;
+    FFTFLT *op_costab;
+} t_oouraplan;
 
-static int ooura_init( int n)
+static void *ooura_makeplan(int logn)
 {
-    n = (1 << ilog2(n));
+    int n = 1 << logn;
+    t_oouraplan *p = (t_oouraplan *)t_getbytes(sizeof(*p));
+    if (!p)
+        return (0);
+    p->op_bitrev = (int *)t_getbytes(sizeof(int) * (2 + (1 << (logn/2))));
+    p->op_costab = (FFTFLT *)t_getbytes(n * sizeof(FFTFLT)/2);
+    if (!p->op_bitrev || !p->op_costab)
+    {
+        pd_error(0, "out of memory allocating FFT buffer");
+        return (0);
+    }
+    makewt(n >> 2, p->op_bitrev, p->op_costab);
+    makect(n >> 2, p->op_bitrev, p->op_costab + (n >> 2));
+    return (p);
+}
+
+static t_fftplancache ooura_plans = {{0}, ooura_makeplan};
+
+    /* the work buffer is per thread */
+static FFT_THREADLOCAL int ooura_maxn;
+static FFT_THREADLOCAL FFTFLT *ooura_buffer;
+
+static t_oouraplan *ooura_init(int n)
+{
+    int logn = ilog2(n);
+    n = (1 << logn);
     if (n < 4)
         return (0);
     if (n > ooura_maxn)
     {
         if (ooura_maxn)
-        {
-            t_freebytes(ooura_bitrev, ooura_bitrevsize);
-            t_freebytes(ooura_costab, ooura_maxn * sizeof(FFTFLT) / 2);
             t_freebytes(ooura_buffer, ooura_maxn * sizeof(FFTFLT));
-        }
-        ooura_bitrevsize = sizeof(int) * (2 + (1 << (ilog2(n)/2)));
-        ooura_bitrev = (int *)t_getbytes(ooura_bitrevsize);
-        ooura_bitrev[0] = 0;
-        if (!ooura_bitrev)
-        {
-            pd_error(0, "out of memory allocating FFT buffer");
-            ooura_maxn = 0;
-            return (0);
-        }
-        ooura_costab = (FFTFLT *)t_getbytes(n * sizeof(FFTFLT)/2);
-        if (!ooura_costab)
-        {
-            pd_error(0, "out of memory allocating FFT buffer");
-            t_freebytes(ooura_bitrev, ooura_bitrevsize);
-            ooura_maxn = 0;
-            return (0);
-        }
         ooura_buffer = (FFTFLT *)t_getbytes(n * sizeof(FFTFLT));
         if (!ooura_buffer)
         {
             pd_error(0, "out of memory allocating FFT buffer");
-            t_freebytes(ooura_bitrev, ooura_bitrevsize);
-            t_freebytes(ooura_costab, n * sizeof(FFTFLT) / 2);
             ooura_maxn = 0;
             return (0);
         }
         ooura_maxn = n;
-        ooura_bitrev[0] = 0;
     }
-    return (1);
+    return ((t_oouraplan *)fftplan_get(&ooura_plans, logn));
 }
 
 static void ooura_term( void)
 {
     if (!ooura_maxn)
         return;
-    t_freebytes(ooura_bitrev, ooura_bitrevsize);
-    t_freebytes(ooura_costab, ooura_maxn * sizeof(FFTFLT)/2);
     t_freebytes(ooura_buffer, ooura_maxn * sizeof(FFTFLT));
     ooura_maxn = 0;
-    ooura_bitrev = 0;
-    ooura_bitrevsize = 0;
-    ooura_costab = 0;
+    ooura_buffer = 0;
 }
 
 /* -------- initialization and cleanup -------- */
@@ -111,7 +114,15 @@ void mayer_init( void)
 void mayer_term( void)
 {
     if (--mayer_refcount == 0)  /* clean up */
+    {
         ooura_term();
+        fftplan_term();
+    }
+}
+
+const char *mayer_libraryname(void)
+{
+    return ("ooura");
 }
 
 /* -------- public routines -------- */
@@ -125,7 +136,10 @@ EXTERN void mayer_dofft(t_sample *fz1, t_sample *fz2, int n, int sgn)
     FFTFLT *buf, *fp3;
     int i;
     t_sample *fp1, *fp2;
-    if (!ooura_init(2*n))
+    t_oouraplan *plan;
+    if (fftplan_simd_complex(n, fz1, fz2, (sgn > 0)))
+        return;
+    if (!(plan = ooura_init(2*n)))
         return;
     buf = ooura_buffer;
     for (i = 0, fp1 = fz1, fp2 = fz2, fp3 = buf; i < n; i++)
@@ -134,7 +148,7 @@ EXTERN void mayer_dofft(t_sample *fz1, t_sample *fz2, int n, int sgn)
         fp3[1] = *fp2++;
         fp3 += 2;
     }
-    cdft(2*n, sgn, buf, ooura_bitrev, ooura_costab);
+    cdft(2*n, sgn, buf, plan->op_bitrev, plan->op_costab);
     for (i = 0, fp1 = fz1, fp2 = fz2, fp3 = buf; i < n; i++)
     {
         *fp1++ = fp3[0];
@@ -158,12 +172,15 @@ EXTERN void mayer_realfft(int n, t_sample *fz)
     FFTFLT *buf, *fp3;
     int i, nover2 = n/2;
     t_sample *fp1, *fp2;
-    if (!ooura_init(n))
+    t_oouraplan *plan;
+    if (fftplan_simd_real(n, fz))
+        return;
+    if (!(plan = ooura_init(n)))
         return;
     buf = ooura_buffer;
     for (i = 0, fp1 = fz, fp3 = buf; i < n; i++, fp1++, fp3++)
         buf[i] = fz[i];
-    rdft(n, 1, buf, ooura_bitrev, ooura_costab);
+    rdft(n, 1, buf, plan->op_bitrev, plan->op_costab);
     fz[0] = buf[0];
     fz[nover2] = buf[1];
     for (i = 1, fp1 = fz+1, fp2 = fz+(n-1), fp3 = buf+2; i < nover2;
@@ -176,7 +193,10 @@ EXTERN void mayer_realifft(int n, t_sample *fz)
     FFTFLT *buf, *fp3;
     int i, nover2 = n/2;
     t_sample *fp1, *fp2;
-    if (!ooura_init(n))
+    t_oouraplan *plan;
+    if (fftplan_simd_realinverse(n, fz))
+        return;
+    if (!(plan = ooura_init(n)))
         return;
     buf = ooura_buffer;
     buf[0] = fz[0];
@@ -184,7 +204,7 @@ EXTERN void mayer_realifft(int n, t_sample *fz)
     for (i = 1, fp1 = fz+1, fp2 = fz+(n-1), fp3 = buf+2; i < nover2;
         i++, fp1++, fp2--, fp3 += 2)
             fp3[0] = *fp1, fp3[1] = *fp2;
-    rdft(n, -1, buf, ooura_bitrev, ooura_costab);
+    rdft(n, -1, buf, plan->op_bitrev, plan->op_costab);
     for (i = 0, fp1 = fz, fp3 = buf; i < n; i++, fp1++, fp3++)
         fz[i] = 2*buf[i];
 }
@@ -196,11 +216,13 @@ void pd_fft(t_float *buf, int npoints, int inverse)
     FFTFLT *buf2 = (FFTFLT *)alloca(2 * npoints * sizeof(FFTFLT)), *bp2;
     t_float *fp;
     int i;
-    if (!ooura_init(2*npoints))
+    t_oouraplan *plan;
+    if (!(plan = ooura_init(2*npoints)))
         return;
     for (i = 0, bp2 = buf2, fp = buf; i < 2 * npoints; i++, bp2++, fp++)
         *bp2 = *fp;
-    cdft(2*npoints, (inverse ? 1 : -1), buf2, ooura_bitrev, ooura_costab);
+    cdft(2*npoints, (inverse ? 1 : -1), buf2, plan->op_bitrev,
+        plan->op_costab);
     for (i = 0, bp2 = buf2, fp = buf; i < 2 * npoints; i++, bp2++, fp++)
         *fp = *bp2;
 }
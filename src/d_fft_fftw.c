@@ -8,6 +8,7 @@
 
 #include "m_pd.h"
 #include "m_imp.h" // ceammc 
+#include "d_fftplan.h"
 #include <fftw3.h>
 
 int ilog2(int n);
@@ -168,9 +169,15 @@ void mayer_term(void)
     {
         cfftw_term();
         rfftw_term();
+        fftplan_term();
     }
 }
 
+const char *mayer_libraryname(void)
+{
+    return ("fftw");
+}
+
 
 EXTERN void mayer_fht(t_sample *fz, int n)
 {
@@ -181,8 +188,10 @@ static void mayer_do_cfft(int n, t_sample *fz1, t_sample *fz2, int fwd)
 {
     int i;
     float *fz;
-    cfftw_info *p = cfftw_getplan(n, fwd);
-    if (!p)
+    cfftw_info *p;
+    if (fftplan_simd_complex(n, fz1, fz2, !fwd))
+        return;
+    if (!(p = cfftw_getplan(n, fwd)))
         return;
 
     for (i = 0, fz = (float *)p->in; i < n; i++)
@@ -213,8 +222,10 @@ EXTERN void mayer_ifft(int n, t_sample *fz1, t_sample *fz2)
 EXTERN void mayer_realfft(int n, t_sample *fz)
 {
     int i;
-    rfftw_info *p = rfftw_getplan(n, 1);
-    if (!p)
+    rfftw_info *p;
+    if (fftplan_simd_real(n, fz))
+        return;
+    if (!(p = rfftw_getplan(n, 1)))
         return;
 
     for (i = 0; i < n; i++)
@@ -229,8 +240,10 @@ EXTERN void mayer_realfft(int n, t_sample *fz)
 EXTERN void mayer_realifft(int n, t_sample *fz)
 {
     int i;
-    rfftw_info *p = rfftw_getplan(n, 0);
-    if (!p)
+    rfftw_info *p;
+    if (fftplan_simd_realinverse(n, fz))
+        return;
+    if (!(p = rfftw_getplan(n, 0)))
         return;
 
     for (i = 0; i < n/2+1; i++)
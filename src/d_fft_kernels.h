@@ -0,0 +1,108 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* butterfly passes of the vectorized FFT in d_fftplan.c.  Like
+d_simd_kernels.h this is included by d_simd.c once per instruction set.
+
+The transform is a radix-2 decimation in frequency on "n" complex points held
+in separate real and imaginary arrays.  A pass with span h combines points h
+apart in each block of 2h points; "twr" and "twi" hold the twiddle factors
+of all passes one after the other, h for each, starting with span n/2.
+Passes are done two at a time when possible, so that the data are read and
+written half as often.  Only spans of at least SIMD_WIDTH are done here; the
+return value is the span of the next pass, for the caller to finish with
+scalar code before reordering the output.
+
+The twiddle factors are those of the forward transform; "sign" is -1 to flip
+their imaginary parts for the inverse one. */
+
+SIMD_TARGET static int SIMD_NAME(fft_passes)(t_sample *re, t_sample *im,
+    int n, const t_sample *twr, const t_sample *twi, t_sample sign)
+{
+    t_simdvec vsign = simd_set1(sign);
+    int h = n >> 1, q, b, k;
+
+        /* two passes at once: span h, then span q = h/2 */
+    for (; h >= 2 * SIMD_WIDTH; h >>= 2)
+    {
+        const t_sample *t2r = twr + h, *t2i = twi + h;
+        q = h >> 1;
+        for (b = 0; b < n; b += 2 * h)
+        {
+            t_sample *r0 = re + b, *r1 = r0 + q, *r2 = r1 + q, *r3 = r2 + q;
+            t_sample *i0 = im + b, *i1 = i0 + q, *i2 = i1 + q, *i3 = i2 + q;
+            for (k = 0; k < q; k += SIMD_WIDTH)
+            {
+                t_simdvec x0r = simd_load(r0 + k), x0i = simd_load(i0 + k);
+                t_simdvec x1r = simd_load(r1 + k), x1i = simd_load(i1 + k);
+                t_simdvec x2r = simd_load(r2 + k), x2i = simd_load(i2 + k);
+                t_simdvec x3r = simd_load(r3 + k), x3i = simd_load(i3 + k);
+                t_simdvec w1r = simd_load(twr + k),
+                    w1i = simd_mul(simd_load(twi + k), vsign);
+                t_simdvec w3r = simd_load(twr + q + k),
+                    w3i = simd_mul(simd_load(twi + q + k), vsign);
+                t_simdvec w2r = simd_load(t2r + k),
+                    w2i = simd_mul(simd_load(t2i + k), vsign);
+                t_simdvec a0r, a0i, a1r, a1i, a2r, a2i, a3r, a3i, dr, di;
+
+                a0r = simd_add(x0r, x2r);
+                a0i = simd_add(x0i, x2i);
+                dr = simd_sub(x0r, x2r);
+                di = simd_sub(x0i, x2i);
+                a2r = simd_sub(simd_mul(dr, w1r), simd_mul(di, w1i));
+                a2i = simd_add(simd_mul(dr, w1i), simd_mul(di, w1r));
+                a1r = simd_add(x1r, x3r);
+                a1i = simd_add(x1i, x3i);
+                dr = simd_sub(x1r, x3r);
+                di = simd_sub(x1i, x3i);
+                a3r = simd_sub(simd_mul(dr, w3r), simd_mul(di, w3i));
+                a3i = simd_add(simd_mul(dr, w3i), simd_mul(di, w3r));
+
+                simd_store(r0 + k, simd_add(a0r, a1r));
+                simd_store(i0 + k, simd_add(a0i, a1i));
+                dr = simd_sub(a0r, a1r);
+                di = simd_sub(a0i, a1i);
+                simd_store(r1 + k,
+                    simd_sub(simd_mul(dr, w2r), simd_mul(di, w2i)));
+                simd_store(i1 + k,
+                    simd_add(simd_mul(dr, w2i), simd_mul(di, w2r)));
+                simd_store(r2 + k, simd_add(a2r, a3r));
+                simd_store(i2 + k, simd_add(a2i, a3i));
+                dr = simd_sub(a2r, a3r);
+                di = simd_sub(a2i, a3i);
+                simd_store(r3 + k,
+                    simd_sub(simd_mul(dr, w2r), simd_mul(di, w2i)));
+                simd_store(i3 + k,
+                    simd_add(simd_mul(dr, w2i), simd_mul(di, w2r)));
+            }
+        }
+        twr += h + q;
+        twi += h + q;
+    }
+
+        /* one pass left that fits in vectors */
+    if (h >= SIMD_WIDTH)
+    {
+        for (b = 0; b < n; b += 2 * h)
+        {
+            t_sample *r0 = re + b, *r1 = r0 + h, *i0 = im + b, *i1 = i0 + h;
+            for (k = 0; k < h; k += SIMD_WIDTH)
+            {
+                t_simdvec x0r = simd_load(r0 + k), x0i = simd_load(i0 + k);
+                t_simdvec x1r = simd_load(r1 + k), x1i = simd_load(i1 + k);
+                t_simdvec wr = simd_load(twr + k),
+                    wi = simd_mul(simd_load(twi + k), vsign);
+                t_simdvec dr = simd_sub(x0r, x1r), di = simd_sub(x0i, x1i);
+                simd_store(r0 + k, simd_add(x0r, x1r));
+                simd_store(i0 + k, simd_add(x0i, x1i));
+                simd_store(r1 + k,
+                    simd_sub(simd_mul(dr, wr), simd_mul(di, wi)));
+                simd_store(i1 + k,
+                    simd_add(simd_mul(dr, wi), simd_mul(di, wr)));
+            }
+        }
+        h >>= 1;
+    }
+    return (h);
+}
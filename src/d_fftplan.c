@@ -0,0 +1,352 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* FFT plan cache and the vectorized FFT, see d_fftplan.h.  The butterfly
+passes that use SIMD instructions are in d_fft_kernels.h (compiled in
+d_simd.c); here are the plans, the few passes too short for vectors, the
+bit reversal and the conversions for real input and output. */
+
+#include "m_pd.h"
+#include "d_fftplan.h"
+#include "d_simd.h"
+#include <math.h>
+#include <string.h>
+#include <pthread.h>
+
+/* ------------------------- the plan cache ----------------------------- */
+
+    /* plans are published with a release store after they are complete, so
+    that a thread that finds one (with an acquire load) also sees what is in
+    it.  Making them is rare and takes a lock. */
+#define PLAN_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define PLAN_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+static pthread_mutex_t fftplan_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void *fftplan_get(t_fftplancache *cache, int logn)
+{
+    void *plan;
+    if (logn < 0 || logn > FFTPLAN_MAXLOGN)
+        return (0);
+    if ((plan = PLAN_LOAD(cache->pc_plan[logn])))
+        return (plan);
+    pthread_mutex_lock(&fftplan_mutex);
+        /* recheck in case another thread made it while we waited */
+    if (!(plan = cache->pc_plan[logn]) && (plan = (*cache->pc_make)(logn)))
+        PLAN_STORE(cache->pc_plan[logn], plan);
+    pthread_mutex_unlock(&fftplan_mutex);
+    return (plan);
+}
+
+/* ----------------------- the vectorized FFT --------------------------- */
+
+int ilog2(int n);
+
+    /* smallest size done here; below that the library is about as fast */
+#define SIMD_MINCOMPLEX 16
+
+typedef struct _simdplan
+{
+    int p_n;                /* number of complex points */
+    t_sample *p_twr;        /* twiddle factors for each pass, n - 1 of them */
+    t_sample *p_twi;
+    int *p_rev;             /* bit reversed indices */
+    int *p_swap;            /* the same as pairs of indices to swap */
+    int p_nswap;
+    t_sample *p_rc;         /* cos and sin of 2 pi k / 2n for the real */
+    t_sample *p_rs;         /* transform of 2n points, k < n/2 */
+} t_simdplan;
+
+static void *simdplan_make(int logn)
+{
+    int n = 1 << logn, h, k, i, j, nswap = 0;
+    t_simdplan *p = (t_simdplan *)getbytes(sizeof(*p));
+    p->p_n = n;
+    p->p_twr = (t_sample *)getbytes(n * sizeof(t_sample));
+    p->p_twi = (t_sample *)getbytes(n * sizeof(t_sample));
+    for (h = n >> 1, i = 0; h >= 1; h >>= 1)
+    {
+        for (k = 0; k < h; k++, i++)
+        {
+            double phase = -3.14159265358979323846 * k / h;
+            p->p_twr[i] = cos(phase);
+            p->p_twi[i] = sin(phase);
+        }
+    }
+    p->p_rev = (int *)getbytes(n * sizeof(int));
+    p->p_swap = (int *)getbytes(n * sizeof(int));
+    for (i = 0; i < n; i++)
+    {
+        for (j = 0, k = 0; k < logn; k++)
+            j |= ((i >> k) & 1) << (logn - 1 - k);
+        p->p_rev[i] = j;
+        if (i < j)
+            p->p_swap[nswap++] = i, p->p_swap[nswap++] = j;
+    }
+    p->p_nswap = nswap / 2;
+    p->p_rc = (t_sample *)getbytes((n/2 + 1) * sizeof(t_sample));
+    p->p_rs = (t_sample *)getbytes((n/2 + 1) * sizeof(t_sample));
+    for (k = 0; k < n/2; k++)
+    {
+        double phase = 3.14159265358979323846 * k / n;
+        p->p_rc[k] = cos(phase);
+        p->p_rs[k] = sin(phase);
+    }
+    return (p);
+}
+
+static t_fftplancache simdplan_cache = {{0}, simdplan_make};
+
+    /* the passes with spans shorter than a vector, starting with span h;
+    the last two are done together with their trivial twiddle factors. */
+static void simdplan_shortpasses(t_simdplan *p, t_sample *re, t_sample *im,
+    int h, t_sample sign)
+{
+    int n = p->p_n, b, k;
+    const t_sample *twr = p->p_twr + (n - 2*h), *twi = p->p_twi + (n - 2*h);
+    for (; h > 2; h >>= 1)
+    {
+        for (b = 0; b < n; b += 2*h)
+        {
+            t_sample *r0 = re + b, *r1 = r0 + h, *i0 = im + b, *i1 = i0 + h;
+            for (k = 0; k < h; k++)
+            {
+                t_sample wr = twr[k], wi = twi[k] * sign;
+                t_sample dr = r0[k] - r1[k], di = i0[k] - i1[k];
+                r0[k] += r1[k];
+                i0[k] += i1[k];
+                r1[k] = dr * wr - di * wi;
+                i1[k] = dr * wi + di * wr;
+            }
+        }
+        twr += h;
+        twi += h;
+    }
+    if (h == 2)
+    {
+        for (b = 0; b < n; b += 4)
+        {
+            t_sample *r = re + b, *i = im + b;
+            t_sample a0r = r[0] + r[2], a0i = i[0] + i[2];
+            t_sample a2r = r[0] - r[2], a2i = i[0] - i[2];
+            t_sample a1r = r[1] + r[3], a1i = i[1] + i[3];
+                /* times -i for the forward transform, i for the inverse */
+            t_sample a3r = (i[1] - i[3]) * sign, a3i = (r[3] - r[1]) * sign;
+            r[0] = a0r + a1r, i[0] = a0i + a1i;
+            r[1] = a0r - a1r, i[1] = a0i - a1i;
+            r[2] = a2r + a3r, i[2] = a2i + a3i;
+            r[3] = a2r - a3r, i[3] = a2i - a3i;
+        }
+    }
+    else if (h == 1)
+    {
+        for (b = 0; b < n; b += 2)
+        {
+            t_sample dr = re[b] - re[b+1], di = im[b] - im[b+1];
+            re[b] += re[b+1];
+            im[b] += im[b+1];
+            re[b+1] = dr;
+            im[b+1] = di;
+        }
+    }
+}
+
+    /* unnormalized complex transform in place, leaving the output in bit
+    reversed order; sign is 1 for forward and -1 for inverse */
+static void simdplan_passes(t_simdplan *p, t_simdfftpasses passes,
+    t_sample *re, t_sample *im, t_sample sign)
+{
+    int h = (*passes)(re, im, p->p_n, p->p_twr, p->p_twi, sign);
+    if (h)
+        simdplan_shortpasses(p, re, im, h, sign);
+}
+
+    /* the same in natural order */
+static void simdplan_complex(t_simdplan *p, t_simdfftpasses passes,
+    t_sample *re, t_sample *im, t_sample sign)
+{
+    const int *swap = p->p_swap;
+    int i;
+    simdplan_passes(p, passes, re, im, sign);
+    for (i = p->p_nswap; i--; swap += 2)
+    {
+        t_sample f = re[swap[0]];
+        re[swap[0]] = re[swap[1]];
+        re[swap[1]] = f;
+        f = im[swap[0]];
+        im[swap[0]] = im[swap[1]];
+        im[swap[1]] = f;
+    }
+}
+
+    /* scratch memory for the real transforms, per thread */
+static FFT_THREADLOCAL t_sample *fftplan_buf;
+static FFT_THREADLOCAL int fftplan_bufsize;
+
+static t_sample *fftplan_getbuf(int n)
+{
+    if (n > fftplan_bufsize)
+    {
+        if (fftplan_buf)
+            freebytes(fftplan_buf, fftplan_bufsize * sizeof(t_sample));
+        if (!(fftplan_buf = (t_sample *)getbytes(n * sizeof(t_sample))))
+        {
+            fftplan_bufsize = 0;
+            return (0);
+        }
+        fftplan_bufsize = n;
+    }
+    return (fftplan_buf);
+}
+
+void fftplan_term(void)
+{
+    if (fftplan_buf)
+        freebytes(fftplan_buf, fftplan_bufsize * sizeof(t_sample));
+    fftplan_buf = 0;
+    fftplan_bufsize = 0;
+}
+
+/* ------------------------ choosing the backend ------------------------ */
+
+static int fft_backend = FFT_BACKEND_SIMD;
+
+    /* the SIMD passes and the plan for a complex transform of n points, or
+    0 to leave it to the library */
+static t_simdfftpasses fftplan_passes(int n, t_simdplan **pp)
+{
+    t_simdfftpasses passes;
+    if (fft_backend != FFT_BACKEND_SIMD || n < SIMD_MINCOMPLEX ||
+        (n & (n - 1)) || !(passes = dsp_simdfft()))
+            return (0);
+    if (!(*pp = (t_simdplan *)fftplan_get(&simdplan_cache, ilog2(n))))
+        return (0);
+    return (passes);
+}
+
+int fftplan_simd_complex(int n, t_sample *re, t_sample *im, int inverse)
+{
+    t_simdplan *p;
+    t_simdfftpasses passes = fftplan_passes(n, &p);
+    if (!passes)
+        return (0);
+    simdplan_complex(p, passes, re, im, (inverse ? -1 : 1));
+    return (1);
+}
+
+    /* the real transform of n points is done as a complex one of n/2 points
+    made of the even and odd input samples, from which the spectrum is then
+    unscrambled.  Output is as mayer_realfft(): real parts in fz[0 ... n/2],
+    imaginary parts in fz[n-1 ... n/2+1], negated. */
+int fftplan_simd_real(int n, t_sample *fz)
+{
+    t_simdplan *p;
+    t_simdfftpasses passes = fftplan_passes(n/2, &p);
+    int nc = n/2, k;
+    const int *rev;
+    t_sample *zr, *zi;
+    if (!passes || !(zr = fftplan_getbuf(n)))
+        return (0);
+    zi = zr + nc;
+    rev = p->p_rev;
+    for (k = 0; k < nc; k++)
+        zr[k] = fz[2*k], zi[k] = fz[2*k+1];
+        /* the output of the complex transform is read in bit reversed
+        order rather than reordered first */
+    simdplan_passes(p, passes, zr, zi, 1);
+    fz[0] = zr[0] + zi[0];
+    fz[nc] = zr[0] - zi[0];
+    for (k = 1; k < nc/2; k++)
+    {
+            /* spectra of the even (e) and odd (o) samples */
+        int m = nc - k, rk = rev[k], rm = rev[m];
+        t_sample er = 0.5f * (zr[rk] + zr[rm]), ei = 0.5f * (zi[rk] - zi[rm]);
+        t_sample odr = 0.5f * (zi[rk] + zi[rm]),
+            odi = 0.5f * (zr[rm] - zr[rk]);
+        t_sample c = p->p_rc[k], s = p->p_rs[k];
+        t_sample tr = odr * c + odi * s, ti = odi * c - odr * s;
+        fz[k] = er + tr;
+        fz[n-k] = -(ei + ti);
+        fz[m] = er - tr;
+        fz[n-m] = ei - ti;
+    }
+    fz[nc/2] = zr[rev[nc/2]];
+    fz[n - nc/2] = zi[rev[nc/2]];
+    return (1);
+}
+
+    /* the other way round, as mayer_realifft() (unnormalized) */
+int fftplan_simd_realinverse(int n, t_sample *fz)
+{
+    t_simdplan *p;
+    t_simdfftpasses passes = fftplan_passes(n/2, &p);
+    int nc = n/2, k;
+    const int *rev;
+    t_sample *zr, *zi;
+    if (!passes || !(zr = fftplan_getbuf(n)))
+        return (0);
+    zi = zr + nc;
+    rev = p->p_rev;
+    zr[0] = fz[0] + fz[nc];
+    zi[0] = fz[0] - fz[nc];
+    for (k = 1; k < nc/2; k++)
+    {
+        int m = nc - k;
+        t_sample xr = fz[k], xi = -fz[n-k], yr = fz[m], yi = -fz[n-m];
+        t_sample ar = xr + yr, ai = xi - yi, br = xr - yr, bi = xi + yi;
+        t_sample c = p->p_rc[k], s = p->p_rs[k];
+        t_sample ur = -(br * s + bi * c), ui = br * c - bi * s;
+        zr[k] = ar + ur;
+        zi[k] = ai + ui;
+        zr[m] = ar - ur;
+        zi[m] = ui - ai;
+    }
+    zr[nc/2] = 2 * fz[nc/2];
+    zi[nc/2] = 2 * fz[n - nc/2];
+    simdplan_passes(p, passes, zr, zi, -1);
+    for (k = 0; k < nc; k++)
+        fz[2*k] = zr[rev[k]], fz[2*k+1] = zi[rev[k]];
+    return (1);
+}
+
+int fft_getbackend(void)
+{
+    return (fft_backend == FFT_BACKEND_SIMD && dsp_simdfft() ?
+        FFT_BACKEND_SIMD : FFT_BACKEND_LIBRARY);
+}
+
+int fft_setbackend(int backend)
+{
+    if (backend == FFT_BACKEND_SIMD && !dsp_simdfft())
+        return (0);
+    if (backend != FFT_BACKEND_SIMD && backend != FFT_BACKEND_LIBRARY)
+        return (0);
+    fft_backend = backend;
+    return (1);
+}
+
+const char *fft_backendname(int backend)
+{
+    return (backend == FFT_BACKEND_SIMD ? "simd" : mayer_libraryname());
+}
+
+    /* "pd fft-backend" posts the FFT in use, "pd fft-backend <name>"
+    switches to another one ("simd" or the library's name).  The SIMD one
+    needs "pd dsp-simd" to be on. */
+void glob_fftbackend(void *dummy, t_symbol *s, int argc, t_atom *argv)
+{
+    if (argc)
+    {
+        const char *name = atom_getsymbol(argv)->s_name;
+        int backend = (!strcmp(name, fft_backendname(FFT_BACKEND_SIMD)) ?
+            FFT_BACKEND_SIMD : FFT_BACKEND_LIBRARY);
+        if (strcmp(name, fft_backendname(backend)) ||
+            !fft_setbackend(backend))
+                pd_error(0, "fft-backend: '%s' not available", name);
+    }
+    else post("fft-backend: using %s (available: %s%s)",
+        fft_backendname(fft_getbackend()),
+        fft_backendname(FFT_BACKEND_LIBRARY),
+        (dsp_simdfft() ? " simd" : ""));
+}
@@ -0,0 +1,75 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* FFT plans shared by the Mayer-style FFT routines (d_fft_fftsg.c or
+d_fft_fftw.c) and a vectorized FFT that can stand in for them.
+
+A plan holds whatever a transform of one size needs that doesn't change from
+one call to the next (twiddle factors, bit reversal tables).  Plans are made
+the first time a size is asked for, kept until Pd exits and never written
+again, so any number of threads can use them at the same time; scratch memory
+is per thread.
+
+Which FFT the Mayer routines use can be chosen at run time with
+"pd fft-backend": "simd" is the vectorized FFT below, using the instruction
+set picked by "pd dsp-simd", the other one is the library Pd was built
+with.  The vectorized one is used by default if the CPU has SIMD. */
+
+#pragma once
+
+#include "m_pd.h"
+
+#if defined(_LANGUAGE_C_PLUS_PLUS) || defined(__cplusplus)
+extern "C" {
+#endif
+
+#define FFT_BACKEND_LIBRARY 0   /* Ooura or FFTW, whichever Pd was built with */
+#define FFT_BACKEND_SIMD 1
+
+#define FFTPLAN_MAXLOGN 30
+
+    /* for scratch memory: this has to be per thread even if Pd isn't built
+    for multiple instances (when PERTHREAD is empty), as parts of the DSP
+    chain may run in worker threads (see d_parallel.h) */
+#ifdef _MSC_VER
+#define FFT_THREADLOCAL __declspec(thread)
+#else
+#define FFT_THREADLOCAL __thread
+#endif
+
+typedef void *(*t_fftplanmaker)(int logn);
+
+    /* plans for each power of two, made by pc_make on first use */
+typedef struct _fftplancache
+{
+    void *pc_plan[FFTPLAN_MAXLOGN + 1];
+    t_fftplanmaker pc_make;
+} t_fftplancache;
+
+    /* the plan for 2^logn points, or 0 if it couldn't be made */
+void *fftplan_get(t_fftplancache *cache, int logn);
+
+EXTERN int fft_getbackend(void);
+    /* returns 0 if the backend isn't available */
+EXTERN int fft_setbackend(int backend);
+EXTERN const char *fft_backendname(int backend);
+
+    /* the vectorized FFT with the Mayer conventions: these return 0 without
+    touching the data if the SIMD backend isn't in use or can't do "n"
+    points, and the caller should do the transform itself.  The complex one
+    works in place on separate real and imaginary parts; "inverse" is 0
+    for mayer_fft(), 1 for mayer_ifft(). */
+int fftplan_simd_complex(int n, t_sample *re, t_sample *im, int inverse);
+int fftplan_simd_real(int n, t_sample *fz);
+int fftplan_simd_realinverse(int n, t_sample *fz);
+
+    /* free the calling thread's scratch memory, from mayer_term() */
+void fftplan_term(void);
+
+    /* name of the library, defined in d_fft_fftsg.c or d_fft_fftw.c */
+const char *mayer_libraryname(void);
+
+#if defined(_LANGUAGE_C_PLUS_PLUS) || defined(__cplusplus)
+}
+#endif
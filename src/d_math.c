@@ -7,6 +7,7 @@
 */
 
 #include "m_pd.h"
+#include "d_simd.h"
 #include <math.h>
 #include <limits.h>
 #define LOGTEN 2.302585092994046
@@ -52,7 +53,12 @@ static t_int *clip_perform(t_int *w)
 
 static void clip_dsp(t_clip *x, t_signal **sp)
 {
-    dsp_add(clip_perform, 4, x, sp[0]->s_vec, sp[1]->s_vec, (t_int)sp[0]->s_n);
+    t_perfroutine simd = dsp_simdroutine(SIMD_CLIP, sp[0]->s_n);
+    if (simd)
+        dsp_add(simd, 5, sp[0]->s_vec, sp[1]->s_vec, &x->x_lo, &x->x_hi,
+            (t_int)sp[0]->s_n);
+    else dsp_add(clip_perform, 4, x, sp[0]->s_vec, sp[1]->s_vec,
+        (t_int)sp[0]->s_n);
 }
 
 static void clip_setup(void)
@@ -171,7 +177,9 @@ static t_int *sigrsqrt_perform(t_int *w)
 
 static void sigrsqrt_dsp(t_sigrsqrt *x, t_signal **sp)
 {
-    dsp_add(sigrsqrt_perform, 3, sp[0]->s_vec, sp[1]->s_vec, (t_int)sp[0]->s_n);
+    t_perfroutine simd = dsp_simdroutine(SIMD_RSQRT, sp[0]->s_n);
+    dsp_add((simd ? simd : sigrsqrt_perform), 3,
+        sp[0]->s_vec, sp[1]->s_vec, (t_int)sp[0]->s_n);
 }
 
 void sigrsqrt_setup(void)
@@ -230,7 +238,9 @@ t_int *sigsqrt_perform(t_int *w)    /* not static; also used in d_fft.c */
 
 static void sigsqrt_dsp(t_sigsqrt *x, t_signal **sp)
 {
-    dsp_add(sigsqrt_perform, 3, sp[0]->s_vec, sp[1]->s_vec, (t_int)sp[0]->s_n);
+    t_perfroutine simd = dsp_simdroutine(SIMD_SQRT, sp[0]->s_n);
+    dsp_add((simd ? simd : sigsqrt_perform), 3,
+        sp[0]->s_vec, sp[1]->s_vec, (t_int)sp[0]->s_n);
 }
 
 void sigsqrt_setup(void)
@@ -294,8 +304,9 @@ static t_int *sigwrap_old_perform(t_int *w)
 
 static void sigwrap_dsp(t_sigwrap *x, t_signal **sp)
 {
-    dsp_add((pd_compatibilitylevel < 48 ?
-        sigwrap_old_perform : sigwrap_perform),
+    t_perfroutine simd = dsp_simdroutine(SIMD_WRAP, sp[0]->s_n);
+    dsp_add((pd_compatibilitylevel < 48 ? sigwrap_old_perform :
+        (simd ? simd : sigwrap_perform)),
             3, sp[0]->s_vec, sp[1]->s_vec, (t_int)sp[0]->s_n);
 }
 
@@ -774,7 +785,8 @@ t_int *abs_tilde_perform(t_int *w)
 
 static void abs_tilde_dsp(t_abs_tilde *x, t_signal **sp)
 {
-    dsp_add(abs_tilde_perform, 3,
+    t_perfroutine simd = dsp_simdroutine(SIMD_ABS, sp[0]->s_n);
+    dsp_add((simd ? simd : abs_tilde_perform), 3,
         sp[0]->s_vec, sp[1]->s_vec, (t_int)sp[0]->s_n);
 }
 
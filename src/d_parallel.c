@@ -0,0 +1,236 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* worker pool that runs the DSP "tasks" forked from the main DSP chain.
+See d_parallel.h for how tasks get made.
+
+Forked tasks are put in a ring which is written only by the DSP thread.
+Workers (and the DSP thread itself, while it waits in a join) claim tasks
+from the ring with a compare-and-swap on a running counter, so nothing on
+the audio path ever takes a lock; the only time a mutex is touched is to wake
+up workers that went to sleep because there was nothing to do.  The counters
+only ever grow, so a worker holding a stale value can never claim a slot
+twice.
+
+Workers inherit the scheduling priority of the thread that starts them,
+which is Pd's main thread. */
+
+#include "m_pd.h"
+#include "d_parallel.h"
+#include <pthread.h>
+#include <string.h>
+
+    /* maximum number of tasks forked between two joins.  If there are more
+    the extra ones are simply run in place by the DSP thread. */
+#define DSPTASK_RINGSIZE 1024
+#define DSPTASK_RINGMASK (DSPTASK_RINGSIZE - 1)
+    /* how often a worker polls the ring before it goes to sleep */
+#define DSPTASK_SPINCOUNT 10000
+
+#define DSP_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define DSP_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#define DSP_INCREMENT(x) __atomic_add_fetch(&(x), 1, __ATOMIC_ACQ_REL)
+#define DSP_DECREMENT(x) __atomic_sub_fetch(&(x), 1, __ATOMIC_ACQ_REL)
+
+#if defined(__i386__) || defined(__x86_64__)
+#define DSP_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define DSP_PAUSE() __asm__ __volatile__("yield")
+#else
+#define DSP_PAUSE()
+#endif
+
+struct _dsptask
+{
+    t_int *t_chain;         /* private DSP chain, ending in a zero return */
+    int t_chainsize;        /* its size in t_ints */
+};
+
+static t_dsptask *dsptask_ring[DSPTASK_RINGSIZE];
+static unsigned long dsptask_posted;    /* tasks handed to the pool */
+static unsigned long dsptask_claimed;   /* tasks somebody started on */
+static unsigned long dsptask_done;      /* tasks finished */
+
+static pthread_t dsp_threadvec[DSP_MAXTHREADS];
+static int dsp_nthreads;
+static int dsp_quit;
+static int dsp_nsleeping;
+static pthread_mutex_t dsp_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dsp_cond = PTHREAD_COND_INITIALIZER;
+
+/* ------------------------- tasks ------------------------------- */
+
+t_dsptask *dsptask_new(t_int *chain, int chainsize)
+{
+    t_dsptask *x = (t_dsptask *)getbytes(sizeof(*x));
+    x->t_chain = chain;
+    x->t_chainsize = chainsize;
+    return (x);
+}
+
+void dsptask_free(t_dsptask *x)
+{
+    freebytes(x->t_chain, x->t_chainsize * sizeof(*x->t_chain));
+    freebytes(x, sizeof(*x));
+}
+
+t_int *dsptask_getchain(t_dsptask *x)
+{
+    return (x->t_chain);
+}
+
+static void dsptask_run(t_dsptask *x)
+{
+    t_int *ip;
+    for (ip = x->t_chain; ip; ) ip = (*(t_perfroutine)(*ip))(ip);
+}
+
+    /* claim one posted task and run it.  Return 0 if there was none. */
+static int dsptask_runone(void)
+{
+    unsigned long claimed = DSP_LOAD(dsptask_claimed);
+    while (claimed < DSP_LOAD(dsptask_posted))
+    {
+        if (__atomic_compare_exchange_n(&dsptask_claimed, &claimed,
+            claimed + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            dsptask_run(dsptask_ring[claimed & DSPTASK_RINGMASK]);
+            DSP_INCREMENT(dsptask_done);
+            return (1);
+        }
+    }
+    return (0);
+}
+
+/* ------------------ DSP chain entry points --------------------- */
+
+    /* hand a task to the pool.  Only the DSP thread may fork. */
+void dsptask_fork(t_dsptask *x)
+{
+    unsigned long posted = dsptask_posted;
+        /* run in place if there's nobody to give it to or the ring is full */
+    if (!dsp_nthreads || posted - DSP_LOAD(dsptask_done) >= DSPTASK_RINGSIZE)
+        dsptask_run(x);
+    else
+    {
+        dsptask_ring[posted & DSPTASK_RINGMASK] = x;
+        __atomic_store_n(&dsptask_posted, posted + 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&dsp_nsleeping, __ATOMIC_SEQ_CST))
+        {
+            pthread_mutex_lock(&dsp_mutex);
+            pthread_cond_signal(&dsp_cond);
+            pthread_mutex_unlock(&dsp_mutex);
+        }
+    }
+}
+
+    /* wait until every task forked so far has finished */
+void dsptask_join(void)
+{
+    unsigned long posted = dsptask_posted;
+        /* help out with whatever hasn't been started yet... */
+    while (dsptask_runone())
+        ;
+        /* ... then wait for the workers to finish the rest. */
+    while (DSP_LOAD(dsptask_done) != posted)
+        DSP_PAUSE();
+}
+
+t_int *dsptask_fork_perform(t_int *w)
+{
+    dsptask_fork((t_dsptask *)(w[1]));
+    return (w+2);
+}
+
+t_int *dsptask_join_perform(t_int *w)
+{
+    dsptask_join();
+    return (w+1);
+}
+
+/* ------------------------- workers ------------------------------ */
+
+static int dsp_workavailable(void)
+{
+    return (DSP_LOAD(dsptask_claimed) < DSP_LOAD(dsptask_posted));
+}
+
+static void *dsp_workermain(void *dummy)
+{
+    int spin = 0;
+#ifdef PDINSTANCE
+    pd_setinstance(&pd_maininstance);
+#endif
+    while (!DSP_LOAD(dsp_quit))
+    {
+        if (dsptask_runone())
+        {
+            spin = 0;
+            continue;
+        }
+        if (spin++ < DSPTASK_SPINCOUNT)
+        {
+            DSP_PAUSE();
+            continue;
+        }
+        pthread_mutex_lock(&dsp_mutex);
+        __atomic_add_fetch(&dsp_nsleeping, 1, __ATOMIC_SEQ_CST);
+        while (!DSP_LOAD(dsp_quit) && !dsp_workavailable())
+            pthread_cond_wait(&dsp_cond, &dsp_mutex);
+        __atomic_sub_fetch(&dsp_nsleeping, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&dsp_mutex);
+        spin = 0;
+    }
+    return (0);
+}
+
+static void dsp_stopthreads(void)
+{
+    int i;
+    pthread_mutex_lock(&dsp_mutex);
+    DSP_STORE(dsp_quit, 1);
+    pthread_cond_broadcast(&dsp_cond);
+    pthread_mutex_unlock(&dsp_mutex);
+    for (i = 0; i < dsp_nthreads; i++)
+        pthread_join(dsp_threadvec[i], 0);
+    dsp_nthreads = 0;
+    DSP_STORE(dsp_quit, 0);
+}
+
+    /* set the number of worker threads.  This is called from Pd's main
+    thread with the Pd lock held, so the DSP chain isn't running and all
+    forked tasks have been joined.  Zero turns parallel DSP off. */
+void dsp_setthreads(int nthreads)
+{
+    int i, dspwas;
+    if (nthreads < 0)
+        nthreads = 0;
+    if (nthreads > DSP_MAXTHREADS)
+        nthreads = DSP_MAXTHREADS;
+    if (nthreads == dsp_nthreads)
+        return;
+    dspwas = canvas_suspend_dsp();
+    dsp_stopthreads();
+    for (i = 0; i < nthreads; i++)
+    {
+        if (pthread_create(&dsp_threadvec[i], 0, dsp_workermain, 0))
+        {
+            pd_error(0, "dsp-threads: couldn't start worker thread %d", i);
+            break;
+        }
+        dsp_nthreads++;
+    }
+    logpost(0, PD_VERBOSE, "parallel DSP: %d worker thread(s)", dsp_nthreads);
+    canvas_resume_dsp(dspwas);
+}
+
+int dsp_getthreads(void)
+{
+    return (dsp_nthreads);
+}
+
+void glob_dspthreads(void *dummy, t_floatarg f)
+{
+    dsp_setthreads(f);
+}
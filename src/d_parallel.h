@@ -0,0 +1,71 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* parallel execution of independent parts of the DSP chain.
+
+While the DSP graph is sorted, a caller can open a "parallel region" with
+dsp_parallel_begin().  Everything added to the DSP chain until the matching
+dsp_parallel_end() is cut out of the main chain into a private "task" chain,
+and a fork is put on the main chain in its place.  At run time the fork hands
+the task to a pool of worker threads; a join, added automatically before
+the first unit generator that reads one of the task's outputs (and always at
+the end of the chain), waits for all forked tasks to finish.  Signal buffers
+released while tasks are outstanding are not reused until the join, so the
+result is identical to the serial chain as long as the parallel parts only
+talk to each other through signal connections.
+
+Parallel regions don't nest; an inner region is simply kept inline.  With
+no worker threads (the default) regions are also kept inline so the chain
+is exactly the one Pd always built.
+
+Objects that run several independent jobs from inside one perform routine
+(hoa.process~ running its instances, say) can also use the pool directly:
+make a task per job with dsptask_new() from a getbytes()-allocated chain
+whose last routine returns 0, then dsptask_fork() them all and
+dsptask_join() from the perform routine.  Only do this if
+dsp_parallel_available() was true when the object's "dsp" method was called.
+A task that runs a switched-off subpatch must use dsp_switch_run() instead
+of sending a bang to its [switch~].
+If the jobs are subgraphs the object sorts itself, bracket their sorting
+with dsp_parallel_hold() and dsp_parallel_unhold() so that they don't end up
+sharing signal buffers.
+
+Whatever runs in a task, including perform routines in a parallel region,
+must not call into the message system (clocks, outlets, post()). */
+
+#pragma once
+
+#include "m_pd.h"
+
+#if defined(_LANGUAGE_C_PLUS_PLUS) || defined(__cplusplus)
+extern "C" {
+#endif
+
+#define DSP_MAXTHREADS 64
+
+typedef struct _dsptask t_dsptask;
+
+    /* worker pool, in d_parallel.c */
+EXTERN void dsp_setthreads(int nthreads);
+EXTERN int dsp_getthreads(void);
+EXTERN t_dsptask *dsptask_new(t_int *chain, int chainsize);
+EXTERN void dsptask_free(t_dsptask *x);
+EXTERN void dsptask_fork(t_dsptask *x);
+EXTERN void dsptask_join(void);
+t_int *dsptask_getchain(t_dsptask *x);
+t_int *dsptask_fork_perform(t_int *w);
+t_int *dsptask_join_perform(t_int *w);
+
+    /* chain construction, in d_ugen.c */
+EXTERN int dsp_parallel_begin(void);
+EXTERN t_dsptask *dsp_parallel_end(int onset, t_signal **outsigs, int nout);
+EXTERN void dsp_parallel_join(void);
+EXTERN int dsp_parallel_available(void);
+EXTERN void dsp_parallel_hold(void);
+EXTERN void dsp_parallel_unhold(void);
+EXTERN int dsp_switch_run(t_pd *x);
+
+#if defined(_LANGUAGE_C_PLUS_PLUS) || defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,269 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* DSP profiler, see d_profile.h.  The per-object records are made by
+d_ugen.c while the DSP graph is sorted and live until the next time the
+graph is sorted with the profiler on, so that a report can still be had
+after the profiler (or DSP) has been switched off. */
+
+#include "m_pd.h"
+#include "g_canvas.h"
+#include "d_profile.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define DSPPROFILE_CYCLES() __rdtsc()
+#elif defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define DSPPROFILE_CYCLES() __rdtsc()
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+    /* default length of the report posted by "pd dsp-profile" */
+#define DSPPROFILE_NREPORT 20
+
+extern int clone_get_n(t_gobj *x);
+extern t_glist *clone_get_copy(t_gobj *x, int i);
+
+typedef unsigned long long t_dspticks;
+
+struct _dspprofile
+{
+    t_object *p_object;
+    t_symbol *p_class;
+    t_dspticks p_ticks;         /* total time */
+    unsigned long p_calls;      /* number of calls */
+    struct _dspprofile *p_next;
+};
+
+static int dspprofile_on;
+static t_dspprofile *dspprofile_list;
+static int dspprofile_count;
+    /* for converting ticks to real time */
+static t_dspticks dspprofile_startticks;
+static double dspprofile_starttime;
+    /* for counting DSP ticks */
+static double dspprofile_startlogical;
+
+static t_dspticks dspprofile_now(void)
+{
+#if defined(DSPPROFILE_CYCLES)
+    return (DSPPROFILE_CYCLES());
+#elif defined(_WIN32)
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (now.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((t_dspticks)now.tv_sec * 1000000000 + now.tv_nsec);
+#endif
+}
+
+static void dspprofile_startclock(void)
+{
+    dspprofile_startticks = dspprofile_now();
+    dspprofile_starttime = sys_getrealtime();
+    dspprofile_startlogical = clock_getlogicaltime();
+}
+
+    /* timing wrapper put before a perform routine: w[1] is the record and
+    w[2] the routine itself, whose arguments follow it as usual. */
+t_int *dspprofile_perform(t_int *w)
+{
+    t_dspprofile *x = (t_dspprofile *)(w[1]);
+    t_dspticks start = dspprofile_now();
+    t_int *next = (*(t_perfroutine)(w[2]))(w + 2);
+    x->p_ticks += dspprofile_now() - start;
+    x->p_calls++;
+    return (next);
+}
+
+t_dspprofile *dspprofile_new(t_object *ob)
+{
+    t_dspprofile *x = (t_dspprofile *)getbytes(sizeof(*x));
+    x->p_object = ob;
+    x->p_class = gensym(class_getname(pd_class(&ob->ob_pd)));
+    x->p_ticks = 0;
+    x->p_calls = 0;
+    x->p_next = dspprofile_list;
+    dspprofile_list = x;
+    dspprofile_count++;
+    return (x);
+}
+
+void dspprofile_clear(void)
+{
+    t_dspprofile *x;
+    while ((x = dspprofile_list))
+    {
+        dspprofile_list = x->p_next;
+        freebytes(x, sizeof(*x));
+    }
+    dspprofile_count = 0;
+    dspprofile_startclock();
+}
+
+void dsp_setprofile(int on)
+{
+    on = (on != 0);
+    if (on == dspprofile_on)
+        return;
+    dspprofile_on = on;
+    canvas_update_dsp();
+}
+
+int dsp_getprofile(void)
+{
+    return (dspprofile_on);
+}
+
+void dsp_resetprofile(void)
+{
+    t_dspprofile *x;
+    for (x = dspprofile_list; x; x = x->p_next)
+        x->p_ticks = 0, x->p_calls = 0;
+    dspprofile_startclock();
+}
+
+/* ------------------------- statistics ------------------------------ */
+
+static int dspprofile_objcompare(const void *p1, const void *p2)
+{
+    const t_dspprofilestat *s1 = p1, *s2 = p2;
+    return (s1->ps_object < s2->ps_object ? -1 :
+        (s1->ps_object > s2->ps_object));
+}
+
+static int dspprofile_costcompare(const void *p1, const void *p2)
+{
+    const t_dspprofilestat *s1 = p1, *s2 = p2;
+    return (s1->ps_usec < s2->ps_usec ? 1 : (s1->ps_usec > s2->ps_usec ? -1 :
+        strcmp(s1->ps_class->s_name, s2->ps_class->s_name)));
+}
+
+    /* find the canvases the profiled objects are in.  We don't look at the
+    objects themselves since some of them might have been deleted. */
+static void dspprofile_findcanvas(t_glist *gl,
+    t_dspprofilestat *stats, int n)
+{
+    t_gobj *g;
+    int i, index;
+    for (g = gl->gl_list, index = 0; g; g = g->g_next, index++)
+    {
+        t_dspprofilestat key, *s;
+        key.ps_object = (t_object *)g;
+        if ((s = bsearch(&key, stats, n, sizeof(*stats),
+            dspprofile_objcompare)))
+        {
+            s->ps_canvas = gl;
+            s->ps_index = index;
+        }
+        if (pd_class(&g->g_pd) == canvas_class)
+            dspprofile_findcanvas((t_glist *)g, stats, n);
+        else for (i = clone_get_n(g); i--; )
+            dspprofile_findcanvas(clone_get_copy(g, i), stats, n);
+    }
+}
+
+int dsp_getprofilestats(t_dspprofilestat **stats)
+{
+    t_dspprofilestat *vec;
+    t_dspprofile *x;
+    t_glist *gl;
+    double elapsed = sys_getrealtime() - dspprofile_starttime,
+        tickspersec = 0, total = 0,
+        dspticks = clock_gettimesince(dspprofile_startlogical) *
+            sys_getsr() / (1000. * sys_getblksize()),
+        tickusec = 1e6 * sys_getblksize() / sys_getsr();
+    int i, n = dspprofile_count;
+    *stats = 0;
+    if (!n)
+        return (0);
+    if (elapsed > 0)
+        tickspersec = (double)(dspprofile_now() - dspprofile_startticks)
+            / elapsed;
+    if (tickspersec <= 0)
+        tickspersec = 1e9;
+    vec = (t_dspprofilestat *)getbytes(n * sizeof(*vec));
+    for (x = dspprofile_list, i = 0; x && i < n; x = x->p_next, i++)
+    {
+        vec[i].ps_object = x->p_object;
+        vec[i].ps_class = x->p_class;
+        vec[i].ps_canvas = 0;
+        vec[i].ps_index = -1;
+        vec[i].ps_usec = (double)x->p_ticks * 1e6 / tickspersec;
+        vec[i].ps_pertick = (dspticks >= 1 ? vec[i].ps_usec / dspticks : 0);
+        vec[i].ps_percent = 0;
+        vec[i].ps_load = 100. * vec[i].ps_pertick / tickusec;
+        vec[i].ps_calls = x->p_calls;
+        total += vec[i].ps_usec;
+    }
+    qsort(vec, n, sizeof(*vec), dspprofile_objcompare);
+    for (gl = pd_getcanvaslist(); gl; gl = gl->gl_next)
+        dspprofile_findcanvas(gl, vec, n);
+    for (i = 0; i < n; i++)
+        vec[i].ps_percent = (total > 0 ? 100. * vec[i].ps_usec / total : 0);
+    qsort(vec, n, sizeof(*vec), dspprofile_costcompare);
+    *stats = vec;
+    return (n);
+}
+
+void dsp_freeprofilestats(t_dspprofilestat *stats, int n)
+{
+    if (stats)
+        freebytes(stats, n * sizeof(*stats));
+}
+
+static void dspprofile_report(int nreport)
+{
+    t_dspprofilestat *stats;
+    int i, n = dsp_getprofilestats(&stats);
+    double total = 0, load = 0;
+    if (!n)
+    {
+        post("dsp-profile: no data%s", (dspprofile_on ? "" :
+            " (turn it on with \"dsp-profile 1\")"));
+        return;
+    }
+    for (i = 0; i < n; i++)
+        total += stats[i].ps_usec, load += stats[i].ps_load;
+    post("dsp-profile: %d objects, %g ms total, %.2f%% DSP load", n,
+        total * 0.001, load);
+    post("   share    us/tick     load  object");
+    for (i = 0; i < n && i < nreport; i++)
+    {
+        t_dspprofilestat *s = &stats[i];
+        if (s->ps_canvas)
+            post("%7.2f%% %10.3f %7.2f%%  %s (%s #%d)", s->ps_percent,
+                s->ps_pertick, s->ps_load, s->ps_class->s_name,
+                    s->ps_canvas->gl_name->s_name, s->ps_index);
+        else post("%7.2f%% %10.3f %7.2f%%  %s (deleted)", s->ps_percent,
+            s->ps_pertick, s->ps_load, s->ps_class->s_name);
+    }
+    dsp_freeprofilestats(stats, n);
+}
+
+    /* "pd dsp-profile 1|0" turns profiling on or off, "pd dsp-profile reset"
+    zeroes the counts and "pd dsp-profile [report [n]]" prints the n most
+    expensive objects. */
+void glob_dspprofile(void *dummy, t_symbol *s, int argc, t_atom *argv)
+{
+    if (argc && argv->a_type == A_FLOAT)
+        dsp_setprofile(atom_getfloat(argv) != 0);
+    else if (argc && atom_getsymbol(argv) == gensym("reset"))
+        dsp_resetprofile();
+    else if (!argc || atom_getsymbol(argv) == gensym("report"))
+    {
+        int n = (argc > 1 ? atom_getfloat(argv + 1) : DSPPROFILE_NREPORT);
+        dspprofile_report(n > 0 ? n : DSPPROFILE_NREPORT);
+    }
+    else pd_error(0, "dsp-profile: unknown argument '%s'",
+        atom_getsymbol(argv)->s_name);
+}
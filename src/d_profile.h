@@ -0,0 +1,55 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* DSP profiler.
+
+When profiling is on, every perform routine an object puts on the DSP chain
+from its "dsp" method is preceded by a call that times it, and the times are
+added up per object.  Code Pd adds by itself (block~ prologs and epilogs,
+fan-in sums, and so on) isn't timed.  Turning the profiler on or off rebuilds
+the DSP chain, and the counts start over each time the chain is rebuilt with
+the profiler on.  Only the main Pd instance is profiled.
+
+Times are taken from the CPU's cycle counter where there is one and
+converted to microseconds by comparing against the real time clock. */
+
+#pragma once
+
+#include "m_pd.h"
+
+#if defined(_LANGUAGE_C_PLUS_PLUS) || defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef struct _dspprofile t_dspprofile;
+
+typedef struct _dspprofilestat
+{
+    t_object *ps_object;    /* the object, don't use it if ps_canvas is 0 */
+    t_symbol *ps_class;     /* class name */
+    t_glist *ps_canvas;     /* canvas it's in, or 0 if it was deleted */
+    int ps_index;           /* its index in the canvas */
+    double ps_usec;         /* total time spent, in microseconds */
+    double ps_pertick;      /* average time per DSP tick, in microseconds */
+    double ps_percent;      /* share of the time of all profiled objects */
+    double ps_load;         /* share of the real time a DSP tick may take */
+    unsigned long ps_calls; /* number of times its code was run */
+} t_dspprofilestat;
+
+EXTERN void dsp_setprofile(int on);
+EXTERN int dsp_getprofile(void);
+EXTERN void dsp_resetprofile(void);
+    /* get per-object statistics sorted by cost, most expensive first.
+    Returns the number of entries; free them with dsp_freeprofilestats(). */
+EXTERN int dsp_getprofilestats(t_dspprofilestat **stats);
+EXTERN void dsp_freeprofilestats(t_dspprofilestat *stats, int n);
+
+    /* used by d_ugen.c while sorting the DSP graph */
+t_dspprofile *dspprofile_new(t_object *ob);
+void dspprofile_clear(void);
+t_int *dspprofile_perform(t_int *w);
+
+#if defined(_LANGUAGE_C_PLUS_PLUS) || defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,376 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* vectorized perform routines, see d_simd.h.  The routines themselves are
+in d_simd_kernels.h and d_fft_kernels.h; here we define the vector primitives
+for each instruction set, include the routines for it and pick one set at run
+time. */
+
+#include "m_pd.h"
+#include "d_simd.h"
+#include <float.h>
+#include <string.h>
+
+#if PD_FLOATSIZE == 32
+#if defined(__x86_64__) || defined(__i386__) || \
+    defined(_M_X64) || defined(_M_IX86)
+#define SIMD_X86
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_ARM64
+#endif
+#endif
+
+    /* on x86, GCC and clang need to be told which routines may use which
+    instructions, as Pd isn't compiled for anything beyond the baseline */
+#if defined(SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SIMD_TARGET_SSE2
+#define SIMD_TARGET_AVX2
+#endif
+
+/* ------------------------------ SSE2 -------------------------------- */
+
+#ifdef SIMD_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+
+#define SIMD_NAME(x) sse2_##x
+#define SIMD_TARGET SIMD_TARGET_SSE2
+#define SIMD_WIDTH 4
+#define t_simdvec __m128
+#define simd_load _mm_loadu_ps
+#define simd_store _mm_storeu_ps
+#define simd_set1 _mm_set1_ps
+#define simd_add _mm_add_ps
+#define simd_sub _mm_sub_ps
+#define simd_mul _mm_mul_ps
+#define simd_max _mm_max_ps
+#define simd_min _mm_min_ps
+#define simd_sqrt(v) _mm_sqrt_ps(_mm_max_ps((v), _mm_setzero_ps()))
+#define simd_abs(v) _mm_andnot_ps(_mm_set1_ps(-0.f), (v))
+#define simd_clip(v, lo, hi) _mm_min_ps(_mm_max_ps((v), (lo)), (hi))
+
+SIMD_TARGET static __m128 sse2_over(__m128 a, __m128 b)
+{
+    return (_mm_and_ps(_mm_div_ps(a, b),
+        _mm_cmpneq_ps(b, _mm_setzero_ps())));
+}
+#define simd_over sse2_over
+
+    /* like the plain routine: 0 for negative input, and a very large
+    number instead of infinity for 0 */
+SIMD_TARGET static __m128 sse2_rsqrt(__m128 f)
+{
+    __m128 x = _mm_max_ps(f, _mm_set1_ps(FLT_MIN)),
+        g = _mm_rsqrt_ps(x);
+    g = _mm_mul_ps(g, _mm_sub_ps(_mm_set1_ps(1.5f),
+        _mm_mul_ps(_mm_set1_ps(0.5f), _mm_mul_ps(x, _mm_mul_ps(g, g)))));
+    return (_mm_and_ps(g, _mm_cmpge_ps(f, _mm_setzero_ps())));
+}
+#define simd_rsqrt sse2_rsqrt
+
+    /* f minus the integer below it, 0 if f is beyond the int range */
+SIMD_TARGET static __m128 sse2_wrap(__m128 f)
+{
+    __m128 k;
+    f = _mm_and_ps(f, _mm_cmple_ps(simd_abs(f), _mm_set1_ps(2147483648.f)));
+    k = _mm_cvtepi32_ps(_mm_cvttps_epi32(f));
+    k = _mm_sub_ps(k, _mm_and_ps(_mm_cmpgt_ps(k, f), _mm_set1_ps(1.f)));
+    return (_mm_sub_ps(f, k));
+}
+#define simd_wrap sse2_wrap
+
+#include "d_simd_kernels.h"
+#include "d_fft_kernels.h"
+
+#undef SIMD_NAME
+#undef SIMD_TARGET
+#undef SIMD_WIDTH
+#undef t_simdvec
+#undef simd_load
+#undef simd_store
+#undef simd_set1
+#undef simd_add
+#undef simd_sub
+#undef simd_mul
+#undef simd_max
+#undef simd_min
+#undef simd_sqrt
+#undef simd_abs
+#undef simd_clip
+#undef simd_over
+#undef simd_rsqrt
+#undef simd_wrap
+
+/* ------------------------------ AVX2 -------------------------------- */
+
+#define SIMD_NAME(x) avx2_##x
+#define SIMD_TARGET SIMD_TARGET_AVX2
+#define SIMD_WIDTH 8
+#define t_simdvec __m256
+#define simd_load _mm256_loadu_ps
+#define simd_store _mm256_storeu_ps
+#define simd_set1 _mm256_set1_ps
+#define simd_add _mm256_add_ps
+#define simd_sub _mm256_sub_ps
+#define simd_mul _mm256_mul_ps
+#define simd_max _mm256_max_ps
+#define simd_min _mm256_min_ps
+#define simd_sqrt(v) _mm256_sqrt_ps(_mm256_max_ps((v), _mm256_setzero_ps()))
+#define simd_abs(v) _mm256_andnot_ps(_mm256_set1_ps(-0.f), (v))
+#define simd_clip(v, lo, hi) _mm256_min_ps(_mm256_max_ps((v), (lo)), (hi))
+
+SIMD_TARGET static __m256 avx2_over(__m256 a, __m256 b)
+{
+    return (_mm256_and_ps(_mm256_div_ps(a, b),
+        _mm256_cmp_ps(b, _mm256_setzero_ps(), _CMP_NEQ_UQ)));
+}
+#define simd_over avx2_over
+
+SIMD_TARGET static __m256 avx2_rsqrt(__m256 f)
+{
+    __m256 x = _mm256_max_ps(f, _mm256_set1_ps(FLT_MIN)),
+        g = _mm256_rsqrt_ps(x);
+    g = _mm256_mul_ps(g, _mm256_sub_ps(_mm256_set1_ps(1.5f),
+        _mm256_mul_ps(_mm256_set1_ps(0.5f),
+            _mm256_mul_ps(x, _mm256_mul_ps(g, g)))));
+    return (_mm256_and_ps(g,
+        _mm256_cmp_ps(f, _mm256_setzero_ps(), _CMP_GE_OQ)));
+}
+#define simd_rsqrt avx2_rsqrt
+
+SIMD_TARGET static __m256 avx2_wrap(__m256 f)
+{
+    __m256 k;
+    f = _mm256_and_ps(f, _mm256_cmp_ps(simd_abs(f),
+        _mm256_set1_ps(2147483648.f), _CMP_LE_OQ));
+    k = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(f));
+    k = _mm256_sub_ps(k, _mm256_and_ps(_mm256_cmp_ps(k, f, _CMP_GT_OQ),
+        _mm256_set1_ps(1.f)));
+    return (_mm256_sub_ps(f, k));
+}
+#define simd_wrap avx2_wrap
+
+#include "d_simd_kernels.h"
+#include "d_fft_kernels.h"
+
+#undef SIMD_NAME
+#undef SIMD_TARGET
+#undef SIMD_WIDTH
+#undef t_simdvec
+#undef simd_load
+#undef simd_store
+#undef simd_set1
+#undef simd_add
+#undef simd_sub
+#undef simd_mul
+#undef simd_max
+#undef simd_min
+#undef simd_sqrt
+#undef simd_abs
+#undef simd_clip
+#undef simd_over
+#undef simd_rsqrt
+#undef simd_wrap
+
+#endif /* SIMD_X86 */
+
+/* ------------------------------ NEON -------------------------------- */
+
+#ifdef SIMD_ARM64
+#include <arm_neon.h>
+
+#define SIMD_NAME(x) neon_##x
+#define SIMD_TARGET
+#define SIMD_WIDTH 4
+#define t_simdvec float32x4_t
+#define simd_load vld1q_f32
+#define simd_store vst1q_f32
+#define simd_set1 vdupq_n_f32
+#define simd_add vaddq_f32
+#define simd_sub vsubq_f32
+#define simd_mul vmulq_f32
+#define simd_max vmaxq_f32
+#define simd_min vminq_f32
+#define simd_sqrt(v) vsqrtq_f32(vmaxq_f32((v), vdupq_n_f32(0)))
+#define simd_abs vabsq_f32
+#define simd_clip(v, lo, hi) vminq_f32(vmaxq_f32((v), (lo)), (hi))
+
+static float32x4_t neon_and(float32x4_t v, uint32x4_t mask)
+{
+    return (vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), mask)));
+}
+
+static float32x4_t neon_over(float32x4_t a, float32x4_t b)
+{
+    return (neon_and(vdivq_f32(a, b),
+        vmvnq_u32(vceqq_f32(b, vdupq_n_f32(0)))));
+}
+#define simd_over neon_over
+
+static float32x4_t neon_rsqrt(float32x4_t f)
+{
+    float32x4_t x = vmaxq_f32(f, vdupq_n_f32(FLT_MIN)),
+        g = vrsqrteq_f32(x);
+    g = vmulq_f32(g, vrsqrtsq_f32(vmulq_f32(x, g), g));
+    g = vmulq_f32(g, vrsqrtsq_f32(vmulq_f32(x, g), g));
+    return (neon_and(g, vcgeq_f32(f, vdupq_n_f32(0))));
+}
+#define simd_rsqrt neon_rsqrt
+
+static float32x4_t neon_wrap(float32x4_t f)
+{
+    float32x4_t k;
+    f = neon_and(f, vcleq_f32(vabsq_f32(f), vdupq_n_f32(2147483648.f)));
+    k = vcvtq_f32_s32(vcvtq_s32_f32(f));
+    k = vsubq_f32(k, neon_and(vdupq_n_f32(1.f), vcgtq_f32(k, f)));
+    return (vsubq_f32(f, k));
+}
+#define simd_wrap neon_wrap
+
+#include "d_simd_kernels.h"
+#include "d_fft_kernels.h"
+
+#endif /* SIMD_ARM64 */
+
+/* --------------------- choosing the instruction set ------------------- */
+
+static int simd_available = -1;     /* bit mask of usable instruction sets */
+static int simd_isa;                /* the one in use */
+
+static int simd_detect(void)
+{
+    int mask = 1 << DSP_SIMD_NONE;
+#if defined(SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    if (info[3] & (1 << 26))
+        mask |= 1 << DSP_SIMD_SSE2;
+        /* AVX2 also needs the OS to save the upper halves of registers */
+    if ((info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6)
+    {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5))
+            mask |= 1 << DSP_SIMD_AVX2;
+    }
+#elif defined(SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        mask |= 1 << DSP_SIMD_SSE2;
+    if (__builtin_cpu_supports("avx2"))
+        mask |= 1 << DSP_SIMD_AVX2;
+#elif defined(SIMD_ARM64)
+    mask |= 1 << DSP_SIMD_NEON;     /* always there on 64-bit ARM */
+#endif
+    return (mask);
+}
+
+static void simd_init(void)
+{
+    if (simd_available >= 0)
+        return;
+    simd_available = simd_detect();
+    if (simd_available & (1 << DSP_SIMD_AVX2))
+        simd_isa = DSP_SIMD_AVX2;
+    else if (simd_available & (1 << DSP_SIMD_SSE2))
+        simd_isa = DSP_SIMD_SSE2;
+    else if (simd_available & (1 << DSP_SIMD_NEON))
+        simd_isa = DSP_SIMD_NEON;
+    else simd_isa = DSP_SIMD_NONE;
+}
+
+t_perfroutine dsp_simdroutine(t_simdop op, int n)
+{
+    if ((n & 7) || n <= 0 || op < 0 || op >= SIMD_NOPS)
+        return (0);
+    simd_init();
+    switch (simd_isa)
+    {
+#ifdef SIMD_X86
+    case DSP_SIMD_SSE2: return (sse2_routines[op]);
+    case DSP_SIMD_AVX2: return (avx2_routines[op]);
+#endif
+#ifdef SIMD_ARM64
+    case DSP_SIMD_NEON: return (neon_routines[op]);
+#endif
+    default: return (0);
+    }
+}
+
+t_simdfftpasses dsp_simdfft(void)
+{
+    simd_init();
+    switch (simd_isa)
+    {
+#ifdef SIMD_X86
+    case DSP_SIMD_SSE2: return (sse2_fft_passes);
+    case DSP_SIMD_AVX2: return (avx2_fft_passes);
+#endif
+#ifdef SIMD_ARM64
+    case DSP_SIMD_NEON: return (neon_fft_passes);
+#endif
+    default: return (0);
+    }
+}
+
+int dsp_getsimd(void)
+{
+    simd_init();
+    return (simd_isa);
+}
+
+int dsp_hassimd(int isa)
+{
+    simd_init();
+    return (isa >= 0 && isa <= DSP_SIMD_NEON && (simd_available & (1 << isa)));
+}
+
+int dsp_setsimd(int isa)
+{
+    if (!dsp_hassimd(isa))
+        return (0);
+    if (isa != simd_isa)
+    {
+        simd_isa = isa;
+        canvas_update_dsp();
+    }
+    return (1);
+}
+
+static const char *simd_names[] = {"off", "sse2", "avx2", "neon"};
+
+const char *dsp_simdname(int isa)
+{
+    return (isa >= 0 && isa <= DSP_SIMD_NEON ? simd_names[isa] : "?");
+}
+
+    /* "pd dsp-simd" posts the instruction sets available and the one in use,
+    "pd dsp-simd <name>" switches to another one ("off" for none). */
+void glob_dspsimd(void *dummy, t_symbol *s, int argc, t_atom *argv)
+{
+    int i;
+    if (argc)
+    {
+        const char *name = atom_getsymbol(argv)->s_name;
+        for (i = 0; i <= DSP_SIMD_NEON; i++)
+            if (!strcmp(name, simd_names[i]))
+                break;
+        if (!dsp_setsimd(i))
+            pd_error(0, "dsp-simd: '%s' not available", name);
+    }
+    else
+    {
+        char buf[MAXPDSTRING];
+        buf[0] = 0;
+        for (i = 0; i <= DSP_SIMD_NEON; i++)
+            if (dsp_hassimd(i))
+                strcat(buf, " "), strcat(buf, simd_names[i]);
+        post("dsp-simd: using %s (available:%s)",
+            dsp_simdname(dsp_getsimd()), buf);
+    }
+}
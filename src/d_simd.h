@@ -0,0 +1,72 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* vectorized perform routines for the most used signal operations.
+
+There is one set of routines for each instruction set Pd knows about (SSE2 and
+AVX2 on Intel, NEON on 64-bit ARM); the best one the CPU has is picked when
+Pd starts and can be changed later, for instance for comparing them, with
+"pd dsp-simd".  The routines only handle blocks that are a multiple of 8
+samples long, and only exist if Pd is compiled for 32-bit samples; otherwise
+dsp_simdroutine() returns 0 and the caller falls back to its own routines.
+
+Arguments are the same as for the plain routines of the same operation
+(see d_arithmetic.c and d_math.c) except for clip~ whose arguments are
+input, output, pointers to low and high limit and the block size. */
+
+#pragma once
+
+#include "m_pd.h"
+
+#if defined(_LANGUAGE_C_PLUS_PLUS) || defined(__cplusplus)
+extern "C" {
+#endif
+
+    /* instruction sets */
+#define DSP_SIMD_NONE 0
+#define DSP_SIMD_SSE2 1
+#define DSP_SIMD_AVX2 2
+#define DSP_SIMD_NEON 3
+
+typedef enum _simdop
+{
+    SIMD_PLUS,          /* in1, in2, out, n */
+    SIMD_SCALARPLUS,    /* in, &f, out, n */
+    SIMD_MINUS,
+    SIMD_SCALARMINUS,
+    SIMD_TIMES,
+    SIMD_SCALARTIMES,
+    SIMD_OVER,
+    SIMD_SCALAROVER,
+    SIMD_MAX,
+    SIMD_SCALARMAX,
+    SIMD_MIN,
+    SIMD_SCALARMIN,
+    SIMD_CLIP,          /* in, out, &lo, &hi, n */
+    SIMD_WRAP,          /* in, out, n */
+    SIMD_SQRT,
+    SIMD_RSQRT,
+    SIMD_ABS,
+    SIMD_NOPS
+} t_simdop;
+
+    /* routine for "op" on blocks of "n" samples, or 0 if there is none */
+EXTERN t_perfroutine dsp_simdroutine(t_simdop op, int n);
+    /* the instruction set in use, DSP_SIMD_NONE if SIMD routines are off */
+EXTERN int dsp_getsimd(void);
+    /* switch to another instruction set, rebuilding the DSP chain.  Returns 0
+    if the CPU (or this build of Pd) doesn't have it. */
+EXTERN int dsp_setsimd(int isa);
+EXTERN int dsp_hassimd(int isa);
+EXTERN const char *dsp_simdname(int isa);
+
+    /* butterfly passes of the vectorized FFT in d_fftplan.c (see
+    d_fft_kernels.h), or 0 if SIMD routines are off */
+typedef int (*t_simdfftpasses)(t_sample *re, t_sample *im, int n,
+    const t_sample *twr, const t_sample *twi, t_sample sign);
+t_simdfftpasses dsp_simdfft(void);
+
+#if defined(_LANGUAGE_C_PLUS_PLUS) || defined(__cplusplus)
+}
+#endif
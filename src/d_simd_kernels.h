@@ -0,0 +1,120 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* perform routines for d_simd.c, which includes this file once per
+instruction set after defining:
+
+    SIMD_NAME(x)    name of a routine for this instruction set
+    SIMD_TARGET     function attributes needed to compile the routines
+    SIMD_WIDTH      number of samples in a vector (4 or 8)
+    t_simdvec       the vector type
+    simd_load(p), simd_store(p, v), simd_set1(f)
+    simd_add, simd_sub, simd_mul, simd_max, simd_min
+    simd_over(a, b)     a / b, or 0 where b is 0
+    simd_clip(v, lo, hi)
+    simd_wrap(v), simd_sqrt(v), simd_rsqrt(v), simd_abs(v)
+
+All routines expect the block size to be a multiple of 8.  Loads and stores
+are unaligned; input and output may be the same. */
+
+#define SIMD_BINOP(name, op)                                                \
+SIMD_TARGET static t_int *SIMD_NAME(name##_perform)(t_int *w)               \
+{                                                                           \
+    t_sample *in1 = (t_sample *)(w[1]);                                     \
+    t_sample *in2 = (t_sample *)(w[2]);                                     \
+    t_sample *out = (t_sample *)(w[3]);                                     \
+    int n = (int)(w[4]), i;                                                 \
+    for (i = 0; i < n; i += SIMD_WIDTH)                                     \
+        simd_store(out + i, op(simd_load(in1 + i), simd_load(in2 + i)));    \
+    return (w+5);                                                           \
+}
+
+#define SIMD_SCALARBINOP(name, op)                                          \
+SIMD_TARGET static t_int *SIMD_NAME(name##_perform)(t_int *w)               \
+{                                                                           \
+    t_sample *in = (t_sample *)(w[1]);                                      \
+    t_simdvec g = simd_set1(*(t_float *)(w[2]));                            \
+    t_sample *out = (t_sample *)(w[3]);                                     \
+    int n = (int)(w[4]), i;                                                 \
+    for (i = 0; i < n; i += SIMD_WIDTH)                                     \
+        simd_store(out + i, op(simd_load(in + i), g));                      \
+    return (w+5);                                                           \
+}
+
+#define SIMD_UNOP(name, op)                                                 \
+SIMD_TARGET static t_int *SIMD_NAME(name##_perform)(t_int *w)               \
+{                                                                           \
+    t_sample *in = (t_sample *)(w[1]);                                      \
+    t_sample *out = (t_sample *)(w[2]);                                     \
+    int n = (int)(w[3]), i;                                                 \
+    for (i = 0; i < n; i += SIMD_WIDTH)                                     \
+        simd_store(out + i, op(simd_load(in + i)));                         \
+    return (w+4);                                                           \
+}
+
+SIMD_BINOP(plus, simd_add)
+SIMD_SCALARBINOP(scalarplus, simd_add)
+SIMD_BINOP(minus, simd_sub)
+SIMD_SCALARBINOP(scalarminus, simd_sub)
+SIMD_BINOP(times, simd_mul)
+SIMD_SCALARBINOP(scalartimes, simd_mul)
+SIMD_BINOP(over, simd_over)
+SIMD_BINOP(max, simd_max)
+SIMD_SCALARBINOP(scalarmax, simd_max)
+SIMD_BINOP(min, simd_min)
+SIMD_SCALARBINOP(scalarmin, simd_min)
+SIMD_UNOP(wrap, simd_wrap)
+SIMD_UNOP(sqrt, simd_sqrt)
+SIMD_UNOP(rsqrt, simd_rsqrt)
+SIMD_UNOP(abs, simd_abs)
+
+    /* multiply by the reciprocal like scalarover_perf8() does */
+SIMD_TARGET static t_int *SIMD_NAME(scalarover_perform)(t_int *w)
+{
+    t_sample *in = (t_sample *)(w[1]);
+    t_float f = *(t_float *)(w[2]);
+    t_sample *out = (t_sample *)(w[3]);
+    int n = (int)(w[4]), i;
+    t_simdvec g = simd_set1(f ? 1.f / f : 0);
+    for (i = 0; i < n; i += SIMD_WIDTH)
+        simd_store(out + i, simd_mul(simd_load(in + i), g));
+    return (w+5);
+}
+
+SIMD_TARGET static t_int *SIMD_NAME(clip_perform)(t_int *w)
+{
+    t_sample *in = (t_sample *)(w[1]);
+    t_sample *out = (t_sample *)(w[2]);
+    t_simdvec lo = simd_set1(*(t_float *)(w[3]));
+    t_simdvec hi = simd_set1(*(t_float *)(w[4]));
+    int n = (int)(w[5]), i;
+    for (i = 0; i < n; i += SIMD_WIDTH)
+        simd_store(out + i, simd_clip(simd_load(in + i), lo, hi));
+    return (w+6);
+}
+
+    /* in the order of t_simdop */
+static const t_perfroutine SIMD_NAME(routines)[SIMD_NOPS] = {
+    SIMD_NAME(plus_perform),
+    SIMD_NAME(scalarplus_perform),
+    SIMD_NAME(minus_perform),
+    SIMD_NAME(scalarminus_perform),
+    SIMD_NAME(times_perform),
+    SIMD_NAME(scalartimes_perform),
+    SIMD_NAME(over_perform),
+    SIMD_NAME(scalarover_perform),
+    SIMD_NAME(max_perform),
+    SIMD_NAME(scalarmax_perform),
+    SIMD_NAME(min_perform),
+    SIMD_NAME(scalarmin_perform),
+    SIMD_NAME(clip_perform),
+    SIMD_NAME(wrap_perform),
+    SIMD_NAME(sqrt_perform),
+    SIMD_NAME(rsqrt_perform),
+    SIMD_NAME(abs_perform),
+};
+
+#undef SIMD_BINOP
+#undef SIMD_SCALARBINOP
+#undef SIMD_UNOP
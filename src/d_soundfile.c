@@ -14,6 +14,9 @@ objects use Posix-like threads. */
 #include "d_soundfile.h"
 #ifdef _WIN32
 #include <io.h>
+#include <sys/timeb.h>
+#else
+#include <sys/time.h>
 #endif
 #include <fcntl.h>
 #include <stdio.h>
@@ -1581,8 +1584,9 @@ static void soundfiler_setup(void)
 /* READSF uses the Posix threads package; for the moment we're Linux
 only although this should be portable to the other platforms.
 
-Each instance of readsf~ owns a "child" thread for doing the Posix file reading.
-The parent thread signals the child each time:
+The Posix file reading for all instances of readsf~ (and writing for writesf~)
+is done by a shared pool of "child" threads, see below.
+The parent thread requests the pool each time:
     (1) a file wants opening or closing;
     (2) we've eaten another 1/16 of the shared buffer (so that the
         child thread should check if it's time to read some more.)
@@ -1619,6 +1623,9 @@ typedef enum _soundfile_state
 
 static t_class *readsf_class;
 
+struct _readsf;
+typedef int (*t_sfpool_stepfn)(struct _readsf *x);
+
 typedef struct _readsf
 {
     t_object x_obj;
@@ -1647,9 +1654,16 @@ typedef struct _readsf
     size_t x_frameswritten;   /**< writesf~ only; frames written */
     t_float x_f;              /**< writesf~ only; scalar for signal inlet */
     pthread_mutex_t x_mutex;
-    pthread_cond_t x_requestcondition;
     pthread_cond_t x_answercondition;
-    pthread_t x_childthread;
+        /* I/O pool state */
+    t_soundfile x_childsf;    /**< the child's copy of x_sf, owns the fd */
+    t_sfpool_stepfn x_poolstep; /**< does a piece of I/O work */
+    struct _readsf *x_poolnext; /**< next in the request queue */
+    int x_poolstate;          /**< queued/busy flags, guarded by pool mutex */
+    int x_poolurgency;        /**< request priority, guarded by pool mutex */
+    struct _readsf *x_poolinboxnext; /**< next in the inbox */
+    int x_poolinbox;          /**< true while in the inbox, atomic */
+    int x_poolwant;           /**< requested urgency + 1 or 0, atomic */
 #ifdef PDINSTANCE
     t_pdinstance *x_pd_this;  /**< pointer to the owner pd instance */
 #endif
@@ -1680,288 +1694,503 @@ static void readsf_fakewait(pthread_mutex_t *b)
 #define sfread_cond_signal(a)
 #endif
 
-static void *readsf_child_main(void *zz)
+/* ----- the shared I/O pool ----- */
+
+/* Instead of a thread per object, file I/O of all readsf~ and writesf~
+objects is done by a small pool of threads (at most SFPOOL_MAXTHREADS,
+no more than the number of objects).  An object that needs service is
+put to the request queue, with its "urgency": how empty its read buffer
+is, or how full its write buffer is, in 1/1000ths.  Open, close and quit
+requests come first.  A thread takes the most urgent object from the
+queue, locks its mutex and does a single step of work: one read or
+write, as big as the contiguous free (or filled) part of the buffer
+allows, up to SFPOOL_MAXREAD bytes; then the object is queued again if
+there is more to do.  So many streams do not get a thread each and do
+not compete with each other with small uncoordinated reads.  An object
+is never serviced by two threads at a time.  The lock order is the
+object's mutex first, then the pool mutex.
+
+Requests don't take the pool mutex, since readsf~ and writesf~ make them
+from their perform routines: the object is pushed to a lock-free "inbox"
+and a sleeping thread is woken only if the mutex is free.  The threads
+move the inbox to the queue whenever they hold the mutex.  A request that
+finds the mutex taken wakes nobody, so the threads don't sleep for longer
+than SFPOOL_WAITMSEC.
+*/
+
+#define SFPOOL_MAXTHREADS 4
+#define SFPOOL_MAXREAD (4 * READSIZE)   /* coalesced read/write limit */
+
+#define SFPOOL_WAITMSEC 10      /* longest sleep without looking at the inbox */
+
+#define SFPOOL_IDLE -1          /* nothing to do until the next request */
+#define SFPOOL_URGENT 1001      /* open/close/quit requests */
+
+    /* object pool state flags */
+#define SFPOOL_QUEUED 1
+#define SFPOOL_BUSY 2
+#define SFPOOL_AGAIN 4          /* requested while busy */
+
+#define SFPOOL_LOAD(x) __atomic_load_n(&(x), __ATOMIC_SEQ_CST)
+#define SFPOOL_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_SEQ_CST)
+#define SFPOOL_EXCHANGE(x, v) __atomic_exchange_n(&(x), (v), __ATOMIC_SEQ_CST)
+#define SFPOOL_CAS(x, old, v) __atomic_compare_exchange_n(&(x), &(old), (v), \
+    0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+
+static struct _sfpool
+{
+    pthread_mutex_t p_mutex;
+    pthread_cond_t p_requestcondition;  /* the queue is not empty */
+    pthread_cond_t p_idlecondition;     /* some object became idle */
+    t_readsf *p_queue;
+    t_readsf *p_inbox;      /* requests not queued yet, atomic */
+    int p_nthreads;
+    int p_nclients;
+    int p_nsleeping;        /* threads waiting for a request, atomic */
+} sfpool = {
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    0, 0, 0, 0, 0
+};
+
+    /** call with the pool mutex locked */
+static void sfpool_push(t_readsf *x, int urgency)
+{
+    if (x->x_poolstate & SFPOOL_QUEUED)
+    {
+        if (urgency > x->x_poolurgency)
+            x->x_poolurgency = urgency;
+        return;
+    }
+    x->x_poolurgency = urgency;
+    x->x_poolstate |= SFPOOL_QUEUED;
+    x->x_poolnext = sfpool.p_queue;
+    sfpool.p_queue = x;
+    pthread_cond_signal(&sfpool.p_requestcondition);
+}
+
+    /** take the most urgent object from the queue.
+    call with the pool mutex locked */
+static t_readsf *sfpool_pop(void)
 {
-    t_readsf *x = zz;
-    t_soundfile sf = {0};
-    soundfile_clear(&sf);
-#ifdef PDINSTANCE
-    pd_this = x->x_pd_this;
-#endif
-#ifdef DEBUG_SOUNDFILE_THREADS
-    fprintf(stderr, "readsf~: 1\n");
+    t_readsf **best = 0, **xp;
+    t_readsf *x;
+    for (xp = &sfpool.p_queue; *xp; xp = &(*xp)->x_poolnext)
+        if (!best || (*xp)->x_poolurgency >= (*best)->x_poolurgency)
+            best = xp;
+    if (!best)
+        return 0;
+    x = *best;
+    *best = x->x_poolnext;
+    x->x_poolnext = 0;
+    x->x_poolstate &= ~SFPOOL_QUEUED;
+    return x;
+}
+
+    /** move requests from the inbox to the queue.
+    call with the pool mutex locked */
+static void sfpool_collect(void)
+{
+    t_readsf *x = SFPOOL_EXCHANGE(sfpool.p_inbox, 0), *next;
+    for (; x; x = next)
+    {
+        int want;
+        next = x->x_poolinboxnext;
+            /* from here on a new request puts it to the inbox again */
+        SFPOOL_STORE(x->x_poolinbox, 0);
+        if (!(want = SFPOOL_EXCHANGE(x->x_poolwant, 0)))
+            continue;
+        if (x->x_poolstate & SFPOOL_BUSY)
+        {
+            if (!(x->x_poolstate & SFPOOL_AGAIN) ||
+                want - 1 > x->x_poolurgency)
+                    x->x_poolurgency = want - 1;
+            x->x_poolstate |= SFPOOL_AGAIN;
+        }
+        else sfpool_push(x, want - 1);
+    }
+}
+
+    /** wait for a request, call with the pool mutex locked */
+static void sfpool_wait(void)
+{
+    struct timespec ts;
+    double timeout;
+#ifdef _WIN32
+    struct __timeb64 tb;
+    _ftime64(&tb);
+    timeout = (double)tb.time + tb.millitm * 0.001;
+#else
+    struct timeval now;
+    gettimeofday(&now, 0);
+    timeout = (double)now.tv_sec + (1./1000000.) * now.tv_usec;
 #endif
-    pthread_mutex_lock(&x->x_mutex);
+    timeout += SFPOOL_WAITMSEC * 0.001;
+    ts.tv_sec = (long long)timeout;
+    ts.tv_nsec = (timeout - (double)ts.tv_sec) * 1e9;
+    __atomic_add_fetch(&sfpool.p_nsleeping, 1, __ATOMIC_SEQ_CST);
+    if (!SFPOOL_LOAD(sfpool.p_inbox))
+        pthread_cond_timedwait(&sfpool.p_requestcondition, &sfpool.p_mutex,
+            &ts);
+    __atomic_sub_fetch(&sfpool.p_nsleeping, 1, __ATOMIC_SEQ_CST);
+}
+
+static void *sfpool_main(void *dummy)
+{
+    pthread_mutex_lock(&sfpool.p_mutex);
     while (1)
     {
-        int fifohead;
-        char *buf;
-#ifdef DEBUG_SOUNDFILE_THREADS
-        fprintf(stderr, "readsf~: 0\n");
-#endif
-        if (x->x_requestcode == REQUEST_NOTHING)
+        int urgency;
+        t_readsf *x;
+        sfpool_collect();
+        if (!(x = sfpool_pop()))
         {
-#ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "readsf~: wait 2\n");
-#endif
-            sfread_cond_signal(&x->x_answercondition);
-            sfread_cond_wait(&x->x_requestcondition, &x->x_mutex);
-#ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "readsf~: 3\n");
+            sfpool_wait();
+            continue;
+        }
+        x->x_poolstate |= SFPOOL_BUSY;
+        pthread_mutex_unlock(&sfpool.p_mutex);
+
+#ifdef PDINSTANCE
+        pd_this = x->x_pd_this;
 #endif
+        pthread_mutex_lock(&x->x_mutex);
+        urgency = (*x->x_poolstep)(x);
+        pthread_mutex_unlock(&x->x_mutex);
+
+        pthread_mutex_lock(&sfpool.p_mutex);
+        if (x->x_poolstate & SFPOOL_AGAIN)
+        {
+            if (x->x_poolurgency > urgency)
+                urgency = x->x_poolurgency;
+            x->x_poolstate &= ~SFPOOL_AGAIN;
         }
-        else if (x->x_requestcode == REQUEST_OPEN)
+        x->x_poolstate &= ~SFPOOL_BUSY;
+        if (urgency != SFPOOL_IDLE)
+            sfpool_push(x, urgency);
+        pthread_cond_broadcast(&sfpool.p_idlecondition);
+    }
+    return 0;
+}
+
+    /** ask the pool to service the object.  Replaces signaling the
+    per-object "request" condition.  Never blocks, so it is safe to call
+    from perform routines. */
+static void sfpool_request(t_readsf *x, int urgency)
+{
+    int want = SFPOOL_LOAD(x->x_poolwant);
+    t_readsf *head;
+        /* raise the requested urgency, the pool takes the highest one */
+    while (want < urgency + 1 &&
+        !SFPOOL_CAS(x->x_poolwant, want, urgency + 1))
+            ;
+    if (SFPOOL_EXCHANGE(x->x_poolinbox, 1))
+        return;     /* already in the inbox */
+    head = SFPOOL_LOAD(sfpool.p_inbox);
+    do x->x_poolinboxnext = head;
+    while (!SFPOOL_CAS(sfpool.p_inbox, head, x));
+    if (SFPOOL_LOAD(sfpool.p_nsleeping) &&
+        !pthread_mutex_trylock(&sfpool.p_mutex))
+    {
+        pthread_cond_signal(&sfpool.p_requestcondition);
+        pthread_mutex_unlock(&sfpool.p_mutex);
+    }
+}
+
+    /** register a new object, adding a thread if needed */
+static void sfpool_addclient(t_readsf *x, t_sfpool_stepfn fn)
+{
+    x->x_poolnext = x->x_poolinboxnext = 0;
+    x->x_poolstate = x->x_poolinbox = x->x_poolwant = 0;
+    x->x_poolurgency = 0;
+    x->x_poolstep = fn;
+    pthread_mutex_lock(&sfpool.p_mutex);
+    sfpool.p_nclients++;
+    if (sfpool.p_nthreads < sfpool.p_nclients &&
+        sfpool.p_nthreads < SFPOOL_MAXTHREADS)
+    {
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        if (!pthread_create(&thread, &attr, sfpool_main, 0))
+            sfpool.p_nthreads++;
+        pthread_attr_destroy(&attr);
+    }
+    pthread_mutex_unlock(&sfpool.p_mutex);
+}
+
+    /** unregister an object: drop it from the queue and wait until no
+    thread is servicing it.  Call without the object's mutex. */
+static void sfpool_removeclient(t_readsf *x)
+{
+    t_readsf **xp;
+    pthread_mutex_lock(&sfpool.p_mutex);
+    sfpool_collect();
+    for (xp = &sfpool.p_queue; *xp; xp = &(*xp)->x_poolnext)
+        if (*xp == x)
         {
-            ssize_t bytesread;
-            size_t wantbytes;
+            *xp = x->x_poolnext;
+            break;
+        }
+    x->x_poolstate &= ~(SFPOOL_QUEUED | SFPOOL_AGAIN);
+    while (x->x_poolstate & SFPOOL_BUSY)
+        pthread_cond_wait(&sfpool.p_idlecondition, &sfpool.p_mutex);
+    sfpool.p_nclients--;
+    pthread_mutex_unlock(&sfpool.p_mutex);
+}
 
-                /* copy file stuff out of the data structure so we can
-                relinquish the mutex while we're in open_soundfile_via_path() */
-            size_t onsetframes = x->x_onsetframes;
-            const char *filename = x->x_filename;
-            const char *dirname = canvas_getdir(x->x_canvas)->s_name;
+    /** fifo fill level in 1/1000ths, call with the object's mutex locked */
+static int sfpool_filllevel(t_readsf *x)
+{
+    int used = x->x_fifohead - x->x_fifotail;
+    if (x->x_fifosize <= 0)
+        return 0;
+    if (used < 0)
+        used += x->x_fifosize;
+    return (int)(1000. * used / x->x_fifosize);
+}
 
-#ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "readsf~: 4\n");
-#endif
-                /* alter the request code so that an ensuing "open" will get
-                noticed. */
-            x->x_requestcode = REQUEST_BUSY;
-            x->x_fileerror = 0;
+    /** readers want service when the buffer is empty */
+static int readsf_urgency(t_readsf *x)
+{
+    return 1000 - sfpool_filllevel(x);
+}
 
-                /* if there's already a file open, close it */
-            if (sf.sf_fd >= 0)
-            {
-                pthread_mutex_unlock(&x->x_mutex);
-                sys_close(sf.sf_fd);
-                sf.sf_fd = -1;
-                pthread_mutex_lock(&x->x_mutex);
-                x->x_sf.sf_fd = -1;
-                if (x->x_requestcode != REQUEST_BUSY)
-                    goto lost;
-            }
-                /* cache sf *after* closing as x->sf's type
-                    may have changed in readsf_open() */
-            soundfile_copy(&sf, &x->x_sf);
+    /** writers want service when the buffer is full */
+static int writesf_urgency(t_readsf *x)
+{
+    return sfpool_filllevel(x);
+}
 
-                /* open the soundfile with the mutex unlocked */
-            pthread_mutex_unlock(&x->x_mutex);
-            open_soundfile_via_path(dirname, filename, &sf, onsetframes);
-            pthread_mutex_lock(&x->x_mutex);
+    /** request pending after the step?  Call with the object's mutex locked */
+static int sfpool_pending(t_readsf *x)
+{
+    return (x->x_requestcode == REQUEST_NOTHING ||
+        x->x_requestcode == REQUEST_BUSY) ? SFPOOL_IDLE : SFPOOL_URGENT;
+}
 
+    /** fell out of the read loop: close the file if necessary,
+    set EOF and signal once more */
+static void readsf_lost(t_readsf *x)
+{
+    t_soundfile *sf = &x->x_childsf;
+    if (x->x_requestcode == REQUEST_BUSY)
+        x->x_requestcode = REQUEST_NOTHING;
 #ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "readsf~: 5\n");
-#endif
-            if (sf.sf_fd < 0)
-            {
-                x->x_fileerror = errno;
-                x->x_eof = 1;
-#ifdef DEBUG_SOUNDFILE_THREADS
-                fprintf(stderr, "readsf~: open failed %s %s\n",
-                    filename, dirname);
-#endif
-                goto lost;
-            }
-                /* copy back into the instance structure. */
-            soundfile_copy(&x->x_sf, &sf);
-                /* check if another request has been made; if so, field it */
-            if (x->x_requestcode != REQUEST_BUSY)
-                goto lost;
-#ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "readsf~: 6\n");
-#endif
-            x->x_fifohead = 0;
-                    /* set fifosize from bufsize.  fifosize must be a
-                    multiple of the number of bytes eaten for each DSP
-                    tick.  We pessimistically assume MAXVECSIZE samples
-                    per tick since that could change.  There could be a
-                    problem here if the vector size increases while a
-                    soundfile is being played...  */
-            x->x_fifosize = x->x_bufsize - (x->x_bufsize %
-                (sf.sf_bytesperframe * MAXVECSIZE));
-                    /* arrange for the "request" condition to be signaled 16
-                    times per buffer */
-#ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "readsf~: fifosize %d\n", x->x_fifosize);
+    fprintf(stderr, "readsf~: lost\n");
 #endif
-            x->x_sigcountdown = x->x_sigperiod = (x->x_fifosize /
-                (16 * sf.sf_bytesperframe * x->x_vecsize));
-                /* in a loop, wait for the fifo to get hungry and feed it */
+    if (sf->sf_fd >= 0)
+    {
+        int fd = sf->sf_fd;
+            /* only set EOF if there is no pending "open" request!
+            Otherwise, we might accidentally set EOF after it has been
+            unset in readsf_open() and the stream would fail silently. */
+        if (x->x_requestcode != REQUEST_OPEN)
+            x->x_eof = 1;
+        x->x_sf.sf_fd = -1;
+        sf->sf_fd = -1;
+        pthread_mutex_unlock(&x->x_mutex);
+        sys_close(fd);
+        pthread_mutex_lock(&x->x_mutex);
+    }
+    sfread_cond_signal(&x->x_answercondition);
+}
 
-            while (x->x_requestcode == REQUEST_BUSY)
-            {
-                int fifosize = x->x_fifosize;
-#ifdef DEBUG_SOUNDFILE_THREADS
-                fprintf(stderr, "readsf~: 77\n");
-#endif
-                if (x->x_eof)
-                    break;
-                if (x->x_fifohead >= x->x_fifotail)
-                {
-                        /* if the head is >= the tail, we can immediately read
-                        to the end of the fifo.  Unless, that is, we would
-                        read all the way to the end of the buffer and the
-                        "tail" is zero; this would fill the buffer completely
-                        which isn't allowed because you can't tell a completely
-                        full buffer from an empty one. */
-                    if (x->x_fifotail || (fifosize - x->x_fifohead > READSIZE))
-                    {
-                        wantbytes = fifosize - x->x_fifohead;
-                        if (wantbytes > READSIZE)
-                            wantbytes = READSIZE;
-                        if (sf.sf_bytelimit >= 0 && wantbytes > (size_t)sf.sf_bytelimit)
-                            wantbytes = sf.sf_bytelimit;
-#ifdef DEBUG_SOUNDFILE_THREADS
-                        fprintf(stderr, "readsf~: head %d, tail %d, size %ld\n",
-                            x->x_fifohead, x->x_fifotail, wantbytes);
-#endif
-                    }
-                    else
-                    {
-#ifdef DEBUG_SOUNDFILE_THREADS
-                        fprintf(stderr, "readsf~: wait 7a...\n");
-#endif
-                        sfread_cond_signal(&x->x_answercondition);
-#ifdef DEBUG_SOUNDFILE_THREADS
-                        fprintf(stderr, "readsf~: signaled...\n");
-#endif
-                        sfread_cond_wait(&x->x_requestcondition, &x->x_mutex);
-#ifdef DEBUG_SOUNDFILE_THREADS
-                        fprintf(stderr, "readsf~: 7a ... done\n");
-#endif
-                        continue;
-                    }
-                }
-                else
-                {
-                        /* otherwise check if there are at least READSIZE
-                        bytes to read.  If not, wait and loop back. */
-                    wantbytes =  x->x_fifotail - x->x_fifohead - 1;
-                    if (wantbytes < READSIZE)
-                    {
-#ifdef DEBUG_SOUNDFILE_THREADS
-                        fprintf(stderr, "readsf~: wait 7...\n");
-#endif
-                        sfread_cond_signal(&x->x_answercondition);
-                        sfread_cond_wait(&x->x_requestcondition, &x->x_mutex);
-#ifdef DEBUG_SOUNDFILE_THREADS
-                        fprintf(stderr, "readsf~: 7 ... done\n");
-#endif
-                        continue;
-                    }
-                    else wantbytes = READSIZE;
-                    if (sf.sf_bytelimit >= 0 && wantbytes > (size_t)sf.sf_bytelimit)
-                        wantbytes = sf.sf_bytelimit;
-                }
-#ifdef DEBUG_SOUNDFILE_THREADS
-                fprintf(stderr, "readsf~: 8\n");
-#endif
-                buf = x->x_buf;
-                fifohead = x->x_fifohead;
-                pthread_mutex_unlock(&x->x_mutex);
-                bytesread = read(sf.sf_fd, buf + fifohead, wantbytes);
-                pthread_mutex_lock(&x->x_mutex);
-                if (x->x_requestcode != REQUEST_BUSY)
-                    break;
-                if (bytesread < 0)
-                {
+    /** one read to the fifo, as big as the contiguous free space allows */
+static int readsf_fill(t_readsf *x)
+{
+    t_soundfile *sf = &x->x_childsf;
+    int fifosize = x->x_fifosize, fifohead;
+    ssize_t bytesread;
+    size_t wantbytes;
+
+    if (x->x_eof)
+    {
+        readsf_lost(x);
+        return sfpool_pending(x);
+    }
+    if (x->x_fifohead >= x->x_fifotail)
+    {
+            /* if the head is >= the tail, we can immediately read
+            to the end of the fifo.  Unless, that is, we would
+            read all the way to the end of the buffer and the
+            "tail" is zero; this would fill the buffer completely
+            which isn't allowed because you can't tell a completely
+            full buffer from an empty one. */
+        if (x->x_fifotail || (fifosize - x->x_fifohead > READSIZE))
+            wantbytes = fifosize - x->x_fifohead;
+        else
+        {
+                /* full: wait for the next request */
+            sfread_cond_signal(&x->x_answercondition);
+            return SFPOOL_IDLE;
+        }
+    }
+    else
+    {
+            /* otherwise check if there are at least READSIZE
+            bytes to read.  If not, wait for the next request. */
+        wantbytes = x->x_fifotail - x->x_fifohead - 1;
+        if (wantbytes < READSIZE)
+        {
+            sfread_cond_signal(&x->x_answercondition);
+            return SFPOOL_IDLE;
+        }
+    }
+    if (wantbytes > SFPOOL_MAXREAD)
+        wantbytes = SFPOOL_MAXREAD;
+    if (sf->sf_bytelimit >= 0 && wantbytes > (size_t)sf->sf_bytelimit)
+        wantbytes = sf->sf_bytelimit;
 #ifdef DEBUG_SOUNDFILE_THREADS
-                    fprintf(stderr, "readsf~: fileerror %d\n", errno);
+    fprintf(stderr, "readsf~: head %d, tail %d, size %ld\n",
+        x->x_fifohead, x->x_fifotail, wantbytes);
 #endif
-                    x->x_fileerror = errno;
-                    break;
-                }
-                else if (bytesread == 0)
-                {
-                    x->x_eof = 1;
-                    break;
-                }
-                else
-                {
-                    x->x_fifohead += bytesread;
-                    sf.sf_bytelimit -= bytesread;
-                    if (x->x_fifohead == fifosize)
-                        x->x_fifohead = 0;
-                    if (sf.sf_bytelimit <= 0)
-                    {
-                        x->x_eof = 1;
-                        break;
-                    }
-                }
+    fifohead = x->x_fifohead;
+    pthread_mutex_unlock(&x->x_mutex);
+    bytesread = read(sf->sf_fd, x->x_buf + fifohead, wantbytes);
+    pthread_mutex_lock(&x->x_mutex);
+    if (x->x_requestcode != REQUEST_BUSY)
+    {
+        readsf_lost(x);
+        return sfpool_pending(x);
+    }
+    if (bytesread < 0)
+    {
 #ifdef DEBUG_SOUNDFILE_THREADS
-                fprintf(stderr, "readsf~: after, head %d tail %d\n",
-                    x->x_fifohead, x->x_fifotail);
+        fprintf(stderr, "readsf~: fileerror %d\n", errno);
 #endif
-                    /* signal parent in case it's waiting for data */
-                sfread_cond_signal(&x->x_answercondition);
-            }
+        x->x_fileerror = errno;
+        readsf_lost(x);
+        return sfpool_pending(x);
+    }
+    else if (bytesread == 0)
+    {
+        x->x_eof = 1;
+        readsf_lost(x);
+        return sfpool_pending(x);
+    }
+    x->x_fifohead += bytesread;
+    sf->sf_bytelimit -= bytesread;
+    if (x->x_fifohead == fifosize)
+        x->x_fifohead = 0;
+    if (sf->sf_bytelimit <= 0)
+    {
+        x->x_eof = 1;
+        readsf_lost(x);
+        return sfpool_pending(x);
+    }
+        /* signal parent in case it's waiting for data */
+    sfread_cond_signal(&x->x_answercondition);
+        /* and come back for more, if nobody needs it more */
+    return readsf_urgency(x);
+}
+
+    /** the I/O pool step for readsf~, called with the object's mutex locked */
+static int readsf_step(t_readsf *x)
+{
+    t_soundfile *sf = &x->x_childsf;
+    if (x->x_requestcode == REQUEST_OPEN)
+    {
+            /* copy file stuff out of the data structure so we can
+            relinquish the mutex while we're in open_soundfile_via_path() */
+        size_t onsetframes = x->x_onsetframes;
+        const char *filename = x->x_filename;
+        const char *dirname = canvas_getdir(x->x_canvas)->s_name;
 
-        lost:
-            if (x->x_requestcode == REQUEST_BUSY)
-                x->x_requestcode = REQUEST_NOTHING;
 #ifdef DEBUG_SOUNDFILE_THREADS
-                fprintf(stderr, "readsf~: lost\n");
+        fprintf(stderr, "readsf~: open\n");
 #endif
-                /* fell out of read loop: close file if necessary,
-                set EOF and signal once more */
-            if (sf.sf_fd >= 0)
-            {
-                    /* only set EOF if there is no pending "open" request!
-                    Otherwise, we might accidentally set EOF after it has been
-                    unset in readsf_open() and the stream would fail silently. */
-                if (x->x_requestcode != REQUEST_OPEN)
-                    x->x_eof = 1;
-                x->x_sf.sf_fd = -1;
-                    /* use cached sf */
-                pthread_mutex_unlock(&x->x_mutex);
-                sys_close(sf.sf_fd);
-                sf.sf_fd = -1;
-                pthread_mutex_lock(&x->x_mutex);
-            }
-            sfread_cond_signal(&x->x_answercondition);
-        }
-        else if (x->x_requestcode == REQUEST_CLOSE)
+            /* alter the request code so that an ensuing "open" will get
+            noticed. */
+        x->x_requestcode = REQUEST_BUSY;
+        x->x_fileerror = 0;
+
+            /* if there's already a file open, close it */
+        if (sf->sf_fd >= 0)
         {
-            if (sf.sf_fd >= 0)
+            int fd = sf->sf_fd;
+            sf->sf_fd = -1;
+            pthread_mutex_unlock(&x->x_mutex);
+            sys_close(fd);
+            pthread_mutex_lock(&x->x_mutex);
+            x->x_sf.sf_fd = -1;
+            if (x->x_requestcode != REQUEST_BUSY)
             {
-                x->x_sf.sf_fd = -1;
-                    /* use cached sf */
-                pthread_mutex_unlock(&x->x_mutex);
-                sys_close(sf.sf_fd);
-                sf.sf_fd = -1;
-                pthread_mutex_lock(&x->x_mutex);
+                readsf_lost(x);
+                return sfpool_pending(x);
             }
-            if (x->x_requestcode == REQUEST_CLOSE)
-                x->x_requestcode = REQUEST_NOTHING;
-            sfread_cond_signal(&x->x_answercondition);
         }
-        else if (x->x_requestcode == REQUEST_QUIT)
+            /* cache sf *after* closing as x->sf's type
+                may have changed in readsf_open() */
+        soundfile_copy(sf, &x->x_sf);
+
+            /* open the soundfile with the mutex unlocked */
+        pthread_mutex_unlock(&x->x_mutex);
+        open_soundfile_via_path(dirname, filename, sf, onsetframes);
+        pthread_mutex_lock(&x->x_mutex);
+
+        if (sf->sf_fd < 0)
         {
-            if (sf.sf_fd >= 0)
-            {
-                x->x_sf.sf_fd = -1;
-                    /* use cached sf */
-                pthread_mutex_unlock(&x->x_mutex);
-                sys_close(sf.sf_fd);
-                sf.sf_fd = -1;
-                pthread_mutex_lock(&x->x_mutex);
-            }
-            x->x_requestcode = REQUEST_NOTHING;
-            sfread_cond_signal(&x->x_answercondition);
-            break;
+            x->x_fileerror = errno;
+            x->x_eof = 1;
+#ifdef DEBUG_SOUNDFILE_THREADS
+            fprintf(stderr, "readsf~: open failed %s %s\n",
+                filename, dirname);
+#endif
+            readsf_lost(x);
+            return sfpool_pending(x);
         }
-        else
+            /* copy back into the instance structure. */
+        soundfile_copy(&x->x_sf, sf);
+            /* check if another request has been made; if so, field it */
+        if (x->x_requestcode != REQUEST_BUSY)
         {
+            readsf_lost(x);
+            return sfpool_pending(x);
+        }
+        x->x_fifohead = 0;
+                /* set fifosize from bufsize.  fifosize must be a
+                multiple of the number of bytes eaten for each DSP
+                tick.  We pessimistically assume MAXVECSIZE samples
+                per tick since that could change.  There could be a
+                problem here if the vector size increases while a
+                soundfile is being played...  */
+        x->x_fifosize = x->x_bufsize - (x->x_bufsize %
+            (sf->sf_bytesperframe * MAXVECSIZE));
+                /* arrange for the pool to be requested 16
+                times per buffer */
 #ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "readsf~: 13\n");
+        fprintf(stderr, "readsf~: fifosize %d\n", x->x_fifosize);
 #endif
+        x->x_sigcountdown = x->x_sigperiod = (x->x_fifosize /
+            (16 * sf->sf_bytesperframe * x->x_vecsize));
+            /* and start feeding the fifo */
+        return readsf_fill(x);
+    }
+    else if (x->x_requestcode == REQUEST_BUSY)
+        return readsf_fill(x);
+    else if (x->x_requestcode == REQUEST_CLOSE ||
+        x->x_requestcode == REQUEST_QUIT)
+    {
+        if (sf->sf_fd >= 0)
+        {
+            int fd = sf->sf_fd;
+            x->x_sf.sf_fd = -1;
+            sf->sf_fd = -1;
+            pthread_mutex_unlock(&x->x_mutex);
+            sys_close(fd);
+            pthread_mutex_lock(&x->x_mutex);
         }
+        if (x->x_requestcode == REQUEST_CLOSE ||
+            x->x_requestcode == REQUEST_QUIT)
+                x->x_requestcode = REQUEST_NOTHING;
+        sfread_cond_signal(&x->x_answercondition);
+        return sfpool_pending(x);
     }
-#ifdef DEBUG_SOUNDFILE_THREADS
-    fprintf(stderr, "readsf~: thread exit\n");
-#endif
-    pthread_mutex_unlock(&x->x_mutex);
-    return 0;
+    sfread_cond_signal(&x->x_answercondition);
+    return SFPOOL_IDLE;
 }
 
 /* ----- the object proper runs in the calling (parent) thread ----- */
@@ -1993,7 +2222,6 @@ static void *readsf_new(t_floatarg fnchannels, t_floatarg fbufsize)
     x->x_noutlets = nchannels;
     x->x_bangout = outlet_new(&x->x_obj, &s_bang);
     pthread_mutex_init(&x->x_mutex, 0);
-    pthread_cond_init(&x->x_requestcondition, 0);
     pthread_cond_init(&x->x_answercondition, 0);
     x->x_vecsize = MAXVECSIZE;
     x->x_state = STATE_IDLE;
@@ -2009,7 +2237,8 @@ static void *readsf_new(t_floatarg fnchannels, t_floatarg fbufsize)
 #ifdef PDINSTANCE
     x->x_pd_this = pd_this;
 #endif
-    pthread_create(&x->x_childthread, 0, readsf_child_main, x);
+    soundfile_clear(&x->x_childsf);
+    sfpool_addclient(x, readsf_step);
     return x;
 }
 
@@ -2038,7 +2267,7 @@ static t_int *readsf_perform(t_int *w)
 #ifdef DEBUG_SOUNDFILE_THREADS
             fprintf(stderr, "readsf~: wait...\n");
 #endif
-            sfread_cond_signal(&x->x_requestcondition);
+            sfpool_request(x, SFPOOL_URGENT);
             sfread_cond_wait(&x->x_answercondition, &x->x_mutex);
                 /* resync local variables -- bug fix thanks to Shahrokh */
             vecsize = x->x_vecsize;
@@ -2082,7 +2311,7 @@ static t_int *readsf_perform(t_int *w)
             x->x_fifotail = 0;
         if ((--x->x_sigcountdown) <= 0)
         {
-            sfread_cond_signal(&x->x_requestcondition);
+            sfpool_request(x, readsf_urgency(x));
             x->x_sigcountdown = x->x_sigperiod;
         }
         pthread_mutex_unlock(&x->x_mutex);
@@ -2111,7 +2340,7 @@ static void readsf_stop(t_readsf *x)
     pthread_mutex_lock(&x->x_mutex);
     x->x_state = STATE_IDLE;
     x->x_requestcode = REQUEST_CLOSE;
-    sfread_cond_signal(&x->x_requestcondition);
+    sfpool_request(x, SFPOOL_URGENT);
     pthread_mutex_unlock(&x->x_mutex);
 }
 
@@ -2180,7 +2409,7 @@ static void readsf_open(t_readsf *x, t_symbol *s, int argc, t_atom *argv)
     x->x_eof = 0;
     x->x_fileerror = 0;
     x->x_state = STATE_STARTUP;
-    sfread_cond_signal(&x->x_requestcondition);
+    sfpool_request(x, SFPOOL_URGENT);
     pthread_mutex_unlock(&x->x_mutex);
     return;
 usage:
@@ -2214,20 +2443,16 @@ static void readsf_print(t_readsf *x)
     /** request QUIT and wait for acknowledge */
 static void readsf_free(t_readsf *x)
 {
-    void *threadrtn;
     pthread_mutex_lock(&x->x_mutex);
     x->x_requestcode = REQUEST_QUIT;
-    sfread_cond_signal(&x->x_requestcondition);
     while (x->x_requestcode != REQUEST_NOTHING)
     {
-        sfread_cond_signal(&x->x_requestcondition);
+        sfpool_request(x, SFPOOL_URGENT);
         sfread_cond_wait(&x->x_answercondition, &x->x_mutex);
     }
     pthread_mutex_unlock(&x->x_mutex);
-    if (pthread_join(x->x_childthread, &threadrtn))
-        pd_error(x, "readsf_free: join failed");
+    sfpool_removeclient(x);
 
-    pthread_cond_destroy(&x->x_requestcondition);
     pthread_cond_destroy(&x->x_answercondition);
     pthread_mutex_destroy(&x->x_mutex);
     freebytes(x->x_buf, x->x_bufsize);
@@ -2255,234 +2480,181 @@ static t_class *writesf_class;
 
 typedef t_readsf t_writesf; /* just re-use the structure */
 
-/* ----- the child thread which performs file I/O ----- */
+/* ----- the child steps which perform file I/O ----- */
 
-static void *writesf_child_main(void *zz)
+    /** hit an error; close file if necessary, set EOF and signal once more */
+static void writesf_bail(t_writesf *x)
 {
-    t_writesf *x = zz;
-    t_soundfile sf = {0};
-    soundfile_clear(&sf);
-#ifdef PDINSTANCE
-    pd_this = x->x_pd_this;
-#endif
-#ifdef DEBUG_SOUNDFILE_THREADS
-    fprintf(stderr, "writesf~: 1\n");
-#endif
+    t_soundfile *sf = &x->x_childsf;
+    if (x->x_requestcode == REQUEST_BUSY)
+        x->x_requestcode = REQUEST_NOTHING;
+    if (sf->sf_fd >= 0)
+    {
+        int fd = sf->sf_fd;
+        sf->sf_fd = -1;
+        pthread_mutex_unlock(&x->x_mutex);
+        sys_close(fd);
+        pthread_mutex_lock(&x->x_mutex);
+        x->x_eof = 1;
+        x->x_sf.sf_fd = -1;
+    }
+    sfread_cond_signal(&x->x_answercondition);
+}
+
+    /** one write from the fifo, as big as the contiguous filled part allows */
+static int writesf_drain(t_writesf *x)
+{
+    t_soundfile *sf = &x->x_childsf;
+    int fifosize = x->x_fifosize, fifotail;
+    ssize_t byteswritten;
+    size_t writebytes;
+
+        /* if the head is < the tail, we can immediately write
+        from tail to end of fifo to disk; otherwise we hold off
+        writing until there are at least WRITESIZE bytes in the
+        buffer */
+    if (x->x_fifohead < x->x_fifotail ||
+        x->x_fifohead >= x->x_fifotail + WRITESIZE
+        || (x->x_requestcode == REQUEST_CLOSE &&
+            x->x_fifohead != x->x_fifotail))
+    {
+        writebytes = (x->x_fifohead < x->x_fifotail ?
+            fifosize : x->x_fifohead) - x->x_fifotail;
+        if (writebytes > SFPOOL_MAXREAD)
+            writebytes = SFPOOL_MAXREAD;
+    }
+    else
+    {
+        sfread_cond_signal(&x->x_answercondition);
+        return SFPOOL_IDLE;
+    }
+    fifotail = x->x_fifotail;
+    pthread_mutex_unlock(&x->x_mutex);
+    byteswritten = write(sf->sf_fd, x->x_buf + fifotail, writebytes);
     pthread_mutex_lock(&x->x_mutex);
-    while (1)
+    if (x->x_requestcode != REQUEST_BUSY &&
+        x->x_requestcode != REQUEST_CLOSE)
+            return sfpool_pending(x);
+    if (byteswritten < 0 || (size_t)byteswritten < writebytes)
     {
 #ifdef DEBUG_SOUNDFILE_THREADS
-        fprintf(stderr, "writesf~: 0\n");
+        fprintf(stderr, "writesf~: fileerror %d\n", errno);
 #endif
-        if (x->x_requestcode == REQUEST_NOTHING)
-        {
-#ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "writesf~: wait 2\n");
-#endif
-            sfread_cond_signal(&x->x_answercondition);
-            sfread_cond_wait(&x->x_requestcondition, &x->x_mutex);
+        x->x_fileerror = errno;
+        writesf_bail(x);
+        return sfpool_pending(x);
+    }
+    x->x_fifotail += byteswritten;
+    if (x->x_fifotail == fifosize)
+        x->x_fifotail = 0;
+    x->x_frameswritten += byteswritten / sf->sf_bytesperframe;
 #ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "writesf~: 3\n");
+    fprintf(stderr, "writesf~: after head %d tail %d written %ld\n",
+        x->x_fifohead, x->x_fifotail, x->x_frameswritten);
 #endif
-        }
-        else if (x->x_requestcode == REQUEST_OPEN)
-        {
-            ssize_t byteswritten;
-            size_t writebytes;
-
-                /* copy file stuff out of the data structure so we can
-                relinquish the mutex while we're in open_soundfile_via_path() */
-            const char *filename = x->x_filename;
-            t_canvas *canvas = x->x_canvas;
-            soundfile_copy(&sf, &x->x_sf);
+        /* signal parent in case it's waiting for data */
+    sfread_cond_signal(&x->x_answercondition);
+    return (x->x_requestcode == REQUEST_CLOSE ?
+        SFPOOL_URGENT : writesf_urgency(x));
+}
 
-                /* alter the request code so that an ensuing "open" will get
-                noticed. */
-#ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "writesf~: 4\n");
-#endif
-            x->x_requestcode = REQUEST_BUSY;
-            x->x_fileerror = 0;
+    /** the I/O pool step for writesf~, called with the object's mutex locked */
+static int writesf_step(t_writesf *x)
+{
+    t_soundfile *sf = &x->x_childsf;
+    if (x->x_requestcode == REQUEST_OPEN)
+    {
+            /* copy file stuff out of the data structure so we can
+            relinquish the mutex while we're in open_soundfile_via_path() */
+        const char *filename = x->x_filename;
+        t_canvas *canvas = x->x_canvas;
 
-                /* if there's already a file open, close it.  This
-                should never happen since writesf_open() calls stop if
-                needed and then waits until we're idle. */
-            if (sf.sf_fd >= 0)
-            {
-                size_t frameswritten = x->x_frameswritten;
-
-                pthread_mutex_unlock(&x->x_mutex);
-                soundfile_finishwrite(x, filename, &sf,
-                    SFMAXFRAMES, frameswritten);
-                sys_close(sf.sf_fd);
-                sf.sf_fd = -1;
-                pthread_mutex_lock(&x->x_mutex);
-                x->x_sf.sf_fd = -1;
 #ifdef DEBUG_SOUNDFILE_THREADS
-                fprintf(stderr, "writesf~: bug? ditched %ld\n", frameswritten);
+        fprintf(stderr, "writesf~: open\n");
 #endif
-                if (x->x_requestcode != REQUEST_BUSY)
-                    continue;
-            }
-                /* cache sf *after* closing as x->sf's type
-                    may have changed in writesf_open() */
-            soundfile_copy(&sf, &x->x_sf);
+            /* alter the request code so that an ensuing "open" will get
+            noticed. */
+        x->x_requestcode = REQUEST_BUSY;
+        x->x_fileerror = 0;
+
+            /* if there's already a file open, close it.  This
+            should never happen since writesf_open() calls stop if
+            needed and then waits until we're idle. */
+        if (sf->sf_fd >= 0)
+        {
+            size_t frameswritten = x->x_frameswritten;
 
-                /* open the soundfile with the mutex unlocked */
             pthread_mutex_unlock(&x->x_mutex);
-            create_soundfile(canvas, filename, &sf, 0);
+            soundfile_finishwrite(x, filename, sf,
+                SFMAXFRAMES, frameswritten);
+            sys_close(sf->sf_fd);
+            sf->sf_fd = -1;
             pthread_mutex_lock(&x->x_mutex);
-
+            x->x_sf.sf_fd = -1;
 #ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "writesf~: 5\n");
+            fprintf(stderr, "writesf~: bug? ditched %ld\n", frameswritten);
 #endif
-
-            if (sf.sf_fd < 0)
-            {
-                x->x_sf.sf_fd = -1;
-                x->x_eof = 1;
-                x->x_fileerror = errno;
-#ifdef DEBUG_SOUNDFILE_THREADS
-                fprintf(stderr, "writesf~: open failed %s\n", filename);
-#endif
-                goto bail;
-            }
-                /* check if another request has been made; if so, field it */
             if (x->x_requestcode != REQUEST_BUSY)
-                continue;
-#ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "writesf~: 6\n");
-#endif
-                /* copy back into the instance structure. */
-            soundfile_copy(&x->x_sf, &sf);
-            x->x_fifotail = 0;
-            x->x_frameswritten = 0;
-                /* in a loop, wait for the fifo to have data and write it
-                    to disk */
-            while (x->x_requestcode == REQUEST_BUSY ||
-                (x->x_requestcode == REQUEST_CLOSE &&
-                    x->x_fifohead != x->x_fifotail))
-            {
-                int fifosize = x->x_fifosize, fifotail;
-                char *buf = x->x_buf;
-#ifdef DEBUG_SOUNDFILE_THREADS
-                fprintf(stderr, "writesf~: 77\n");
-#endif
-                    /* if the head is < the tail, we can immediately write
-                    from tail to end of fifo to disk; otherwise we hold off
-                    writing until there are at least WRITESIZE bytes in the
-                    buffer */
-                if (x->x_fifohead < x->x_fifotail ||
-                    x->x_fifohead >= x->x_fifotail + WRITESIZE
-                    || (x->x_requestcode == REQUEST_CLOSE &&
-                        x->x_fifohead != x->x_fifotail))
-                {
-                    writebytes = (x->x_fifohead < x->x_fifotail ?
-                        fifosize : x->x_fifohead) - x->x_fifotail;
-                    if (writebytes > READSIZE)
-                        writebytes = READSIZE;
-                }
-                else
-                {
-#ifdef DEBUG_SOUNDFILE_THREADS
-                    fprintf(stderr, "writesf~: wait 7a...\n");
-#endif
-                    sfread_cond_signal(&x->x_answercondition);
-#ifdef DEBUG_SOUNDFILE_THREADS
-                    fprintf(stderr, "writesf~: signaled...\n");
-#endif
-                    sfread_cond_wait(&x->x_requestcondition,
-                        &x->x_mutex);
-#ifdef DEBUG_SOUNDFILE_THREADS
-                    fprintf(stderr, "writesf~: 7a ... done\n");
-#endif
-                    continue;
-                }
-#ifdef DEBUG_SOUNDFILE_THREADS
-                fprintf(stderr, "writesf~: 8\n");
-#endif
-                fifotail = x->x_fifotail;
-                soundfile_copy(&sf, &x->x_sf);
-                pthread_mutex_unlock(&x->x_mutex);
-                byteswritten = write(sf.sf_fd, buf + fifotail, writebytes);
-                pthread_mutex_lock(&x->x_mutex);
-                if (x->x_requestcode != REQUEST_BUSY &&
-                    x->x_requestcode != REQUEST_CLOSE)
-                        break;
-                if (byteswritten < 0 || (size_t)byteswritten < writebytes)
-                {
-#ifdef DEBUG_SOUNDFILE_THREADS
-                    fprintf(stderr, "writesf~: fileerror %d\n", errno);
-#endif
-                    x->x_fileerror = errno;
-                    goto bail;
-                }
-                else
-                {
-                    x->x_fifotail += byteswritten;
-                    if (x->x_fifotail == fifosize)
-                        x->x_fifotail = 0;
-                }
-                x->x_frameswritten += byteswritten / sf.sf_bytesperframe;
-#ifdef DEBUG_SOUNDFILE_THREADS
-                fprintf(stderr, "writesf~: after head %d tail %d written %ld\n",
-                    x->x_fifohead, x->x_fifotail, x->x_frameswritten);
-#endif
-                    /* signal parent in case it's waiting for data */
-                sfread_cond_signal(&x->x_answercondition);
-                continue;
-
-             bail:
-                 if (x->x_requestcode == REQUEST_BUSY)
-                     x->x_requestcode = REQUEST_NOTHING;
-                     /* hit an error; close file if necessary,
-                     set EOF and signal once more */
-                 if (sf.sf_fd >= 0)
-                 {
-                     pthread_mutex_unlock(&x->x_mutex);
-                     sys_close(sf.sf_fd);
-                     sf.sf_fd = -1;
-                     pthread_mutex_lock(&x->x_mutex);
-                     x->x_eof = 1;
-                     x->x_sf.sf_fd = -1;
-                 }
-                 sfread_cond_signal(&x->x_answercondition);
-            }
-        }
-        else if (x->x_requestcode == REQUEST_CLOSE ||
-            x->x_requestcode == REQUEST_QUIT)
-        {
-            int quit = (x->x_requestcode == REQUEST_QUIT);
-            if (sf.sf_fd >= 0)
-            {
-                const char *filename = x->x_filename;
-                size_t frameswritten = x->x_frameswritten;
-                soundfile_copy(&sf, &x->x_sf);
-                pthread_mutex_unlock(&x->x_mutex);
-                soundfile_finishwrite(x, filename, &sf,
-                    SFMAXFRAMES, frameswritten);
-                sys_close(sf.sf_fd);
-                sf.sf_fd = -1;
-                pthread_mutex_lock(&x->x_mutex);
-                x->x_sf.sf_fd = -1;
-            }
-            x->x_requestcode = REQUEST_NOTHING;
-            sfread_cond_signal(&x->x_answercondition);
-            if (quit)
-                break;
+                return sfpool_pending(x);
         }
-        else
+            /* cache sf *after* closing as x->sf's type
+                may have changed in writesf_open() */
+        soundfile_copy(sf, &x->x_sf);
+
+            /* open the soundfile with the mutex unlocked */
+        pthread_mutex_unlock(&x->x_mutex);
+        create_soundfile(canvas, filename, sf, 0);
+        pthread_mutex_lock(&x->x_mutex);
+
+        if (sf->sf_fd < 0)
         {
+            x->x_sf.sf_fd = -1;
+            x->x_eof = 1;
+            x->x_fileerror = errno;
 #ifdef DEBUG_SOUNDFILE_THREADS
-            fprintf(stderr, "writesf~: 13\n");
+            fprintf(stderr, "writesf~: open failed %s\n", filename);
 #endif
+            writesf_bail(x);
+            return sfpool_pending(x);
         }
+            /* check if another request has been made; if so, field it */
+        if (x->x_requestcode != REQUEST_BUSY)
+            return sfpool_pending(x);
+            /* copy back into the instance structure. */
+        soundfile_copy(&x->x_sf, sf);
+        x->x_fifotail = 0;
+        x->x_frameswritten = 0;
+        sfread_cond_signal(&x->x_answercondition);
+        return SFPOOL_IDLE;
     }
-#ifdef DEBUG_SOUNDFILE_THREADS
-    fprintf(stderr, "writesf~: thread exit\n");
-#endif
-    pthread_mutex_unlock(&x->x_mutex);
-    return 0;
+    else if (x->x_requestcode == REQUEST_BUSY ||
+        (x->x_requestcode == REQUEST_CLOSE &&
+            x->x_fifohead != x->x_fifotail && sf->sf_fd >= 0))
+    {
+            /* write the fifo data to disk */
+        return writesf_drain(x);
+    }
+    else if (x->x_requestcode == REQUEST_CLOSE ||
+        x->x_requestcode == REQUEST_QUIT)
+    {
+        if (sf->sf_fd >= 0)
+        {
+            const char *filename = x->x_filename;
+            size_t frameswritten = x->x_frameswritten;
+            pthread_mutex_unlock(&x->x_mutex);
+            soundfile_finishwrite(x, filename, sf,
+                SFMAXFRAMES, frameswritten);
+            sys_close(sf->sf_fd);
+            sf->sf_fd = -1;
+            pthread_mutex_lock(&x->x_mutex);
+            x->x_sf.sf_fd = -1;
+        }
+        x->x_requestcode = REQUEST_NOTHING;
+        sfread_cond_signal(&x->x_answercondition);
+        return SFPOOL_IDLE;
+    }
+    sfread_cond_signal(&x->x_answercondition);
+    return SFPOOL_IDLE;
 }
 
 /* ----- the object proper runs in the calling (parent) thread ----- */
@@ -2514,7 +2686,6 @@ static void *writesf_new(t_floatarg fnchannels, t_floatarg fbufsize)
 
     x->x_f = 0;
     pthread_mutex_init(&x->x_mutex, 0);
-    pthread_cond_init(&x->x_requestcondition, 0);
     pthread_cond_init(&x->x_answercondition, 0);
     x->x_vecsize = MAXVECSIZE;
     x->x_insamplerate = 0;
@@ -2531,7 +2702,8 @@ static void *writesf_new(t_floatarg fnchannels, t_floatarg fbufsize)
 #ifdef PDINSTANCE
     x->x_pd_this = pd_this;
 #endif
-    pthread_create(&x->x_childthread, 0, writesf_child_main, x);
+    soundfile_clear(&x->x_childsf);
+    sfpool_addclient(x, writesf_step);
     return x;
 }
 
@@ -2557,7 +2729,7 @@ static t_int *writesf_perform(t_int *w)
             fprintf(stderr, "(head %d, tail %d, room %d, want %ld)\n",
                 (int)x->x_fifohead, (int)x->x_fifotail,
                 (int)roominfifo, (long)wantbytes);
-            sfread_cond_signal(&x->x_requestcondition);
+            sfpool_request(x, SFPOOL_URGENT);
             sfread_cond_wait(&x->x_answercondition, &x->x_mutex);
             fprintf(stderr, "... done waiting.\n");
             roominfifo = x->x_fifotail - x->x_fifohead;
@@ -2570,7 +2742,7 @@ static t_int *writesf_perform(t_int *w)
                 object_sferror(x, "writesf~", x->x_filename,
                     x->x_fileerror, &x->x_sf);
             x->x_state = STATE_IDLE;
-            sfread_cond_signal(&x->x_requestcondition);
+            sfpool_request(x, SFPOOL_URGENT);
             pthread_mutex_unlock(&x->x_mutex);
             return w + 2;
         }
@@ -2586,7 +2758,7 @@ static t_int *writesf_perform(t_int *w)
 #ifdef DEBUG_SOUNDFILE_THREADS
             fprintf(stderr, "writesf~: signal 1\n");
 #endif
-            sfread_cond_signal(&x->x_requestcondition);
+            sfpool_request(x, writesf_urgency(x));
             x->x_sigcountdown = x->x_sigperiod;
         }
         pthread_mutex_unlock(&x->x_mutex);
@@ -2613,7 +2785,7 @@ static void writesf_stop(t_writesf *x)
 #ifdef DEBUG_SOUNDFILE_THREADS
     fprintf(stderr, "writesf~: signal 2\n");
 #endif
-    sfread_cond_signal(&x->x_requestcondition);
+    sfpool_request(x, SFPOOL_URGENT);
     pthread_mutex_unlock(&x->x_mutex);
 }
 
@@ -2638,7 +2810,7 @@ static void writesf_open(t_writesf *x, t_symbol *s, int argc, t_atom *argv)
         /* make sure that the child thread has finished writing */
     while (x->x_requestcode != REQUEST_NOTHING)
     {
-        sfread_cond_signal(&x->x_requestcondition);
+        sfpool_request(x, SFPOOL_URGENT);
         sfread_cond_wait(&x->x_answercondition, &x->x_mutex);
     }
     x->x_filename = wa.wa_filesym->s_name;
@@ -2668,7 +2840,7 @@ static void writesf_open(t_writesf *x, t_symbol *s, int argc, t_atom *argv)
             times per buffer */
     x->x_sigcountdown = x->x_sigperiod = (x->x_fifosize /
             (16 * (x->x_sf.sf_bytesperframe * x->x_vecsize)));
-    sfread_cond_signal(&x->x_requestcondition);
+    sfpool_request(x, SFPOOL_URGENT);
     pthread_mutex_unlock(&x->x_mutex);
 }
 
@@ -2699,29 +2871,25 @@ static void writesf_print(t_writesf *x)
     /** request QUIT and wait for acknowledge */
 static void writesf_free(t_writesf *x)
 {
-    void *threadrtn;
     pthread_mutex_lock(&x->x_mutex);
     x->x_requestcode = REQUEST_QUIT;
 #ifdef DEBUG_SOUNDFILE_THREADS
-    fprintf(stderr, "writesf~: stopping thread...\n");
+    fprintf(stderr, "writesf~: stopping...\n");
 #endif
-    sfread_cond_signal(&x->x_requestcondition);
     while (x->x_requestcode != REQUEST_NOTHING)
     {
 #ifdef DEBUG_SOUNDFILE_THREADS
         fprintf(stderr, "writesf~: signaling...\n");
 #endif
-        sfread_cond_signal(&x->x_requestcondition);
+        sfpool_request(x, SFPOOL_URGENT);
         sfread_cond_wait(&x->x_answercondition, &x->x_mutex);
     }
     pthread_mutex_unlock(&x->x_mutex);
-    if (pthread_join(x->x_childthread, &threadrtn))
-        pd_error(x, "writesf_free: join failed");
+    sfpool_removeclient(x);
 #ifdef DEBUG_SOUNDFILE_THREADS
     fprintf(stderr, "writesf~: ... done\n");
 #endif
 
-    pthread_cond_destroy(&x->x_requestcondition);
     pthread_cond_destroy(&x->x_answercondition);
     pthread_mutex_destroy(&x->x_mutex);
     freebytes(x->x_buf, x->x_bufsize);
@@ -13,7 +13,11 @@
 
 #include "m_pd.h"
 #include "m_imp.h"
+#include "d_parallel.h"
+#include "d_profile.h"
+#include "d_simd.h"
 #include <stdarg.h>
+#include <string.h>
 
 extern t_class *vinlet_class, *voutlet_class, *canvas_class, *text_class;
 
@@ -43,6 +47,22 @@ struct _instanceugen
     int u_phase;
     int u_loud;
     struct _dspcontext *u_context;
+        /* parallel DSP (see d_parallel.h) */
+    int u_paralleldepth;       /* nesting of parallel regions being sorted */
+    int u_nforked;             /* tasks forked since the last join */
+    t_signal *u_heldback;      /* signals released while tasks are forked */
+    t_sample **u_forkedvecs;   /* output buffers of those tasks */
+    int u_nforkedvecs;
+    struct _deferredsum *u_deferred;   /* sums of task outputs, see below */
+    int u_ndeferred;
+    t_dsptask **u_tasks;       /* all tasks of the current DSP chain */
+    int u_ntasks;
+    int u_regiononset;         /* onset of the open region or -1 */
+    struct _block **u_regionblocks;    /* block~s sorted inside it */
+    int u_nregionblocks;
+        /* DSP profiler (see d_profile.h) */
+    t_object *u_profileobj;    /* object whose "dsp" method is being called */
+    t_dspprofile *u_profilerec;    /* and its record, made on first use */
 };
 
 #define THIS (pd_this->pd_ugen)
@@ -53,6 +73,7 @@ void d_ugen_newpdinstance(void)
     THIS->u_dspchain = 0;
     THIS->u_dspchainsize = 0;
     THIS->u_signals = 0;
+    THIS->u_regiononset = -1;
 }
 
 void d_ugen_freepdinstance(void)
@@ -146,6 +167,8 @@ typedef struct _block
     int x_upsample;     /* upsampling-factor */
     int x_downsample;   /* downsampling-factor */
     int x_return;       /* stop right after this block (for one-shots) */
+    char x_parallel;    /* true if we may run in parallel with the rest */
+    t_dsptask *x_task;  /* chain we're in if we do, otherwise zero */
 } t_block;
 
 static void block_set(t_block *x, t_floatarg fvecsize, t_floatarg foverlap,
@@ -160,6 +183,8 @@ static void *block_new(t_floatarg fvecsize, t_floatarg foverlap,
     x->x_frequency = 1;
     x->x_switched = 0;
     x->x_switchon = 1;
+    x->x_parallel = 0;
+    x->x_task = 0;
     block_set(x, fvecsize, foverlap, fupsample);
     return (x);
 }
@@ -240,16 +265,39 @@ static void block_float(t_block *x, t_floatarg f)
         x->x_switchon = (f != 0);
 }
 
-static void block_bang(t_block *x)
+static void block_parallel(t_block *x, t_floatarg f)
 {
-    if (x->x_switched && !x->x_switchon && THIS->u_dspchain)
+    int parallel = (f != 0);
+    if (parallel != x->x_parallel)
     {
-        t_int *ip;
-        x->x_return = 1;
-        for (ip = THIS->u_dspchain + x->x_chainonset; ip; )
-            ip = (*(t_perfroutine)(*ip))(ip);
-        x->x_return = 0;
+        int dspstate = canvas_suspend_dsp();
+        x->x_parallel = parallel;
+        canvas_resume_dsp(dspstate);
     }
+}
+
+    /* run the chain of a switched-off subpatch once.  This is what a bang
+    to [switch~] does, but it can be called from a dsp task since it doesn't
+    go through the message system.  Returns 0 if there was nothing to run. */
+int dsp_switch_run(t_pd *x)
+{
+    t_block *b = (t_block *)x;
+    t_int *ip;
+    if (*x != block_class || !b->x_switched || b->x_switchon ||
+        !THIS->u_dspchain)
+            return (0);
+    ip = (b->x_task ? dsptask_getchain(b->x_task) : THIS->u_dspchain);
+    b->x_return = 1;
+    for (ip += b->x_chainonset; ip; )
+        ip = (*(t_perfroutine)(*ip))(ip);
+    b->x_return = 0;
+    return (1);
+}
+
+static void block_bang(t_block *x)
+{
+    if (dsp_switch_run(&x->x_obj.ob_pd))
+        ;
     else if (!x->x_switched)
         pd_error(x, "[block~]: bang has no effect");
     else if (x->x_switched)
@@ -317,6 +365,8 @@ void block_tilde_setup(void)
         A_DEFFLOAT, A_DEFFLOAT, A_DEFFLOAT, 0);
     class_addmethod(block_class, (t_method)block_set, gensym("set"),
         A_DEFFLOAT, A_DEFFLOAT, A_DEFFLOAT, 0);
+    class_addmethod(block_class, (t_method)block_parallel, gensym("parallel"),
+        A_FLOAT, 0);
     class_addmethod(block_class, (t_method)block_dsp, gensym("dsp"), A_CANT, 0);
     class_addfloat(block_class, block_float);
     class_addbang(block_class, block_bang);
@@ -329,11 +379,30 @@ static t_int dsp_done(t_int *w)
     return (0);
 }
 
+    /* if we're profiling, put a timer in front of the routine about to be
+    added to the chain. */
+static void dsp_addprofiler(void)
+{
+    int newsize = THIS->u_dspchainsize + 2;
+    if (!THIS->u_profilerec)
+        THIS->u_profilerec = dspprofile_new(THIS->u_profileobj);
+    THIS->u_dspchain = t_resizebytes(THIS->u_dspchain,
+        THIS->u_dspchainsize * sizeof (t_int), newsize * sizeof (t_int));
+    THIS->u_dspchain[THIS->u_dspchainsize-1] = (t_int)dspprofile_perform;
+    THIS->u_dspchain[THIS->u_dspchainsize] = (t_int)THIS->u_profilerec;
+    THIS->u_dspchain[newsize-1] = (t_int)dsp_done;
+    THIS->u_dspchainsize = newsize;
+}
+
 void dsp_add(t_perfroutine f, int n, ...)
 {
-    int newsize = THIS->u_dspchainsize + n+1, i;
+    int newsize, i;
     va_list ap;
 
+    if (THIS->u_profileobj)
+        dsp_addprofiler();
+    newsize = THIS->u_dspchainsize + n+1;
+
     THIS->u_dspchain = t_resizebytes(THIS->u_dspchain,
         THIS->u_dspchainsize * sizeof (t_int), newsize * sizeof (t_int));
     THIS->u_dspchain[THIS->u_dspchainsize-1] = (t_int)f;
@@ -356,7 +425,11 @@ void dsp_add(t_perfroutine f, int n, ...)
     /* at Guenter's suggestion, here's a vectorized version */
 void dsp_addv(t_perfroutine f, int n, t_int *vec)
 {
-    int newsize = THIS->u_dspchainsize + n+1, i;
+    int newsize, i;
+
+    if (THIS->u_profileobj)
+        dsp_addprofiler();
+    newsize = THIS->u_dspchainsize + n+1;
 
     THIS->u_dspchain = t_resizebytes(THIS->u_dspchain,
         THIS->u_dspchainsize * sizeof (t_int), newsize * sizeof (t_int));
@@ -407,6 +480,9 @@ static void signal_cleanup(void)
     for (i = 0; i <= MAXLOGSIG; i++)
         THIS->u_freelist[i] = 0;
     THIS->u_freeborrowed = 0;
+    THIS->u_heldback = 0;
+    THIS->u_paralleldepth = 0;
+    THIS->u_nforked = 0;
 }
 
     /* mark the signal "reusable." */
@@ -446,6 +522,13 @@ void signal_makereusable(t_signal *sig)
         sig->s_nextfree = THIS->u_freeborrowed;
         THIS->u_freeborrowed = sig;
     }
+    else if (THIS->u_paralleldepth || THIS->u_nforked)
+    {
+            /* a forked task may still be using the buffer, so we can't
+                hand it out again before the next join. */
+        sig->s_nextfree = THIS->u_heldback;
+        THIS->u_heldback = sig;
+    }
     else
     {
             /* if it's a real signal (not borrowed), put it on the free list
@@ -528,6 +611,211 @@ static int signal_compatible(t_signal *s1, t_signal *s2)
     return (s1->s_n == s2->s_n && s1->s_sr == s2->s_sr);
 }
 
+/* ------------------ parallel DSP regions ----------------------- */
+
+    /* sums of signals that come out of forked tasks, which have to wait
+    until after the next join */
+typedef struct _deferredsum
+{
+    t_sample *d_in1;
+    t_sample *d_in2;
+    t_sample *d_out;
+    int d_n;
+} t_deferredsum;
+
+static void signal_releaseheldback(void)
+{
+    t_signal *sig;
+    while ((sig = THIS->u_heldback))
+    {
+        int logn = ilog2(sig->s_vecsize);
+        THIS->u_heldback = sig->s_nextfree;
+        sig->s_nextfree = THIS->u_freelist[logn];
+        THIS->u_freelist[logn] = sig;
+    }
+}
+
+static void parallel_addforkedvec(t_sample *vec)
+{
+    THIS->u_forkedvecs = (t_sample **)t_resizebytes(THIS->u_forkedvecs,
+        THIS->u_nforkedvecs * sizeof(*THIS->u_forkedvecs),
+        (THIS->u_nforkedvecs + 1) * sizeof(*THIS->u_forkedvecs));
+    THIS->u_forkedvecs[THIS->u_nforkedvecs++] = vec;
+}
+
+    /* true if the signal might still be being computed by a forked task */
+static int signal_isforked(t_signal *sig)
+{
+    int i;
+    if (!THIS->u_nforked || THIS->u_paralleldepth || !sig->s_vec)
+        return (0);
+    for (i = 0; i < THIS->u_nforkedvecs; i++)
+        if (THIS->u_forkedvecs[i] == sig->s_vec)
+            return (1);
+    return (0);
+}
+
+static void signal_deferplus(t_signal *s1, t_signal *s2, t_signal *out)
+{
+    t_deferredsum *d;
+    THIS->u_deferred = (t_deferredsum *)t_resizebytes(THIS->u_deferred,
+        THIS->u_ndeferred * sizeof(*THIS->u_deferred),
+        (THIS->u_ndeferred + 1) * sizeof(*THIS->u_deferred));
+    d = THIS->u_deferred + THIS->u_ndeferred++;
+    d->d_in1 = s1->s_vec;
+    d->d_in2 = s2->s_vec;
+    d->d_out = out->s_vec;
+    d->d_n = s1->s_n;
+    parallel_addforkedvec(out->s_vec);
+}
+
+    /* true if a "dsp" method called now may fork tasks of its own from its
+    perform routine: there are workers, and the routine will run on the DSP
+    thread rather than inside another task. */
+int dsp_parallel_available(void)
+{
+    if (!dsp_getthreads() || THIS->u_paralleldepth)
+        return (0);
+#ifdef PDINSTANCE
+    if (pd_this != &pd_maininstance)
+        return (0);
+#endif
+    return (1);
+}
+
+    /* don't reuse signals freed from now on until dsp_parallel_unhold().
+    This also keeps any parallel regions sorted in between inline. */
+void dsp_parallel_hold(void)
+{
+    THIS->u_paralleldepth++;
+}
+
+void dsp_parallel_unhold(void)
+{
+    if (THIS->u_paralleldepth && !--THIS->u_paralleldepth &&
+        !THIS->u_nforked)
+            signal_releaseheldback();
+}
+
+    /* open a parallel region.  Returns the chain onset to pass to
+    dsp_parallel_end(), or -1 if the region stays inline. */
+int dsp_parallel_begin(void)
+{
+    if (THIS->u_paralleldepth)
+    {
+        THIS->u_paralleldepth++;
+        return (-1);
+    }
+    if (!dsp_getthreads())
+        return (-1);
+#ifdef PDINSTANCE
+        /* the worker pool serves only one DSP thread */
+    if (pd_this != &pd_maininstance)
+        return (-1);
+#endif
+    THIS->u_paralleldepth = 1;
+    THIS->u_regiononset = THIS->u_dspchainsize - 1;
+    return (THIS->u_regiononset);
+}
+
+    /* remember a block~ or switch~ whose prolog went into the open region;
+    if the region becomes a task its chain onset has to follow. */
+static void parallel_addblock(t_block *x)
+{
+    if (THIS->u_regiononset < 0)
+        return;
+    THIS->u_regionblocks = (t_block **)t_resizebytes(THIS->u_regionblocks,
+        THIS->u_nregionblocks * sizeof(*THIS->u_regionblocks),
+        (THIS->u_nregionblocks + 1) * sizeof(*THIS->u_regionblocks));
+    THIS->u_regionblocks[THIS->u_nregionblocks++] = x;
+}
+
+static void parallel_closeregion(t_dsptask *task, int onset)
+{
+    int i;
+    for (i = 0; i < THIS->u_nregionblocks; i++)
+    {
+        THIS->u_regionblocks[i]->x_task = task;
+        if (task)
+            THIS->u_regionblocks[i]->x_chainonset -= onset;
+    }
+    t_freebytes(THIS->u_regionblocks,
+        THIS->u_nregionblocks * sizeof(*THIS->u_regionblocks));
+    THIS->u_regionblocks = 0;
+    THIS->u_nregionblocks = 0;
+    THIS->u_regiononset = -1;
+}
+
+    /* close a parallel region: cut its code out of the main chain into a
+    new task and put a fork in its place.  "outsigs" are the signals the
+    region computes for the rest of the graph. */
+t_dsptask *dsp_parallel_end(int onset, t_signal **outsigs, int nout)
+{
+    t_int *chain;
+    t_dsptask *task;
+    int i, n;
+    if (onset < 0)
+    {
+        if (THIS->u_paralleldepth)
+            THIS->u_paralleldepth--;
+        return (0);
+    }
+    THIS->u_paralleldepth = 0;
+    if (!(n = THIS->u_dspchainsize - 1 - onset))
+    {
+        parallel_closeregion(0, onset);
+        if (!THIS->u_nforked)
+            signal_releaseheldback();
+        return (0);
+    }
+    chain = (t_int *)getbytes((n + 1) * sizeof(*chain));
+    memcpy(chain, THIS->u_dspchain + onset, n * sizeof(*chain));
+    chain[n] = (t_int)dsp_done;
+    THIS->u_dspchain = t_resizebytes(THIS->u_dspchain,
+        THIS->u_dspchainsize * sizeof (t_int), (onset + 1) * sizeof (t_int));
+    THIS->u_dspchain[onset] = (t_int)dsp_done;
+    THIS->u_dspchainsize = onset + 1;
+
+    task = dsptask_new(chain, n + 1);
+    THIS->u_tasks = (t_dsptask **)t_resizebytes(THIS->u_tasks,
+        THIS->u_ntasks * sizeof(*THIS->u_tasks),
+        (THIS->u_ntasks + 1) * sizeof(*THIS->u_tasks));
+    THIS->u_tasks[THIS->u_ntasks++] = task;
+        /* every block~ sorted inside the region, nested ones included,
+        now lives in the task's chain */
+    parallel_closeregion(task, onset);
+    dsp_add(dsptask_fork_perform, 1, task);
+    THIS->u_nforked++;
+    for (i = 0; i < nout; i++)
+        if (outsigs[i]->s_vec)
+            parallel_addforkedvec(outsigs[i]->s_vec);
+    if (THIS->u_loud)
+        post("parallel task %lx: %d chain entries", task, n);
+    return (task);
+}
+
+    /* wait for all forked tasks, then do the sums we had to put off. */
+void dsp_parallel_join(void)
+{
+    int i;
+    if (!THIS->u_nforked || THIS->u_paralleldepth)
+        return;
+    dsp_add(dsptask_join_perform, 0);
+    for (i = 0; i < THIS->u_ndeferred; i++)
+        dsp_add_plus(THIS->u_deferred[i].d_in1, THIS->u_deferred[i].d_in2,
+            THIS->u_deferred[i].d_out, THIS->u_deferred[i].d_n);
+    t_freebytes(THIS->u_deferred,
+        THIS->u_ndeferred * sizeof(*THIS->u_deferred));
+    t_freebytes(THIS->u_forkedvecs,
+        THIS->u_nforkedvecs * sizeof(*THIS->u_forkedvecs));
+    THIS->u_deferred = 0;
+    THIS->u_ndeferred = 0;
+    THIS->u_forkedvecs = 0;
+    THIS->u_nforkedvecs = 0;
+    THIS->u_nforked = 0;
+    signal_releaseheldback();
+}
+
 /* ------------------ ugen ("unit generator") sorting ----------------- */
 
 typedef struct _ugenbox
@@ -591,12 +879,26 @@ t_signal *signal_newfromcontext(int borrowed)
 
 void ugen_stop(void)
 {
+    int i;
     if (THIS->u_dspchain)
     {
         freebytes(THIS->u_dspchain,
             THIS->u_dspchainsize * sizeof (t_int));
         THIS->u_dspchain = 0;
     }
+    for (i = 0; i < THIS->u_ntasks; i++)
+        dsptask_free(THIS->u_tasks[i]);
+    t_freebytes(THIS->u_tasks, THIS->u_ntasks * sizeof(*THIS->u_tasks));
+    THIS->u_tasks = 0;
+    THIS->u_ntasks = 0;
+    t_freebytes(THIS->u_deferred,
+        THIS->u_ndeferred * sizeof(*THIS->u_deferred));
+    THIS->u_deferred = 0;
+    THIS->u_ndeferred = 0;
+    t_freebytes(THIS->u_forkedvecs,
+        THIS->u_nforkedvecs * sizeof(*THIS->u_forkedvecs));
+    THIS->u_forkedvecs = 0;
+    THIS->u_nforkedvecs = 0;
     signal_cleanup();
 
 }
@@ -604,6 +906,11 @@ void ugen_stop(void)
 void ugen_start(void)
 {
     ugen_stop();
+#ifdef PDINSTANCE
+    if (pd_this == &pd_maininstance)
+#endif
+    if (dsp_getprofile())
+        dspprofile_clear();
     THIS->u_sortno++;
     THIS->u_dspchain = (t_int *)getbytes(sizeof(*THIS->u_dspchain));
     THIS->u_dspchain[0] = (t_int)dsp_done;
@@ -822,11 +1129,29 @@ static void ugen_doit(t_dspcontext *dc, t_ugenbox *u)
         else
             *sig = uout->o_signal = signal_new(dc->dc_calcsize, dc->dc_srate);
         (*sig)->s_refcount = uout->o_nconnect;
+    }
+        /* if an input might still be computed by a forked task, wait for
+        it first */
+    for (i = 0; i < u->u_nin; i++)
+        if (signal_isforked(insig[i]))
+    {
+        dsp_parallel_join();
+        break;
     }
         /* now call the DSP scheduling routine for the ugen.  This
         routine must fill in "borrowed" signal outputs in case it's either
         a subcanvas or a signal inlet. */
+    if (dsp_getprofile()
+#ifdef PDINSTANCE
+        && pd_this == &pd_maininstance
+#endif
+        )
+    {
+        THIS->u_profileobj = u->u_obj;
+        THIS->u_profilerec = 0;
+    }
     mess1(&u->u_obj->ob_pd, gensym("dsp"), insig);
+    THIS->u_profileobj = 0;
 
         /* if any output signals aren't connected to anyone, free them
         now; otherwise they'll either get freed when the reference count
@@ -871,7 +1196,12 @@ static void ugen_doit(t_dspcontext *dc, t_ugenbox *u)
                     return;
                 }
                 s3 = signal_newlike(s1);
-                dsp_add_plus(s1->s_vec, s2->s_vec, s3->s_vec, s1->s_n);
+                    /* rather than waiting for a forked task here, put the
+                    sum off until the join, so that more tasks can be
+                    forked in the meantime */
+                if (signal_isforked(s1) || signal_isforked(s2))
+                    signal_deferplus(s1, s2, s3);
+                else dsp_add_plus(s1->s_vec, s2->s_vec, s3->s_vec, s1->s_n);
                 uin->i_signal = s3;
                 s3->s_refcount = 1;
                 if (!s1->s_refcount) signal_makereusable(s1);
@@ -920,6 +1250,12 @@ void ugen_done_graph(t_dspcontext *dc)
     int chainafterall;      /* and after signal outlet epilog */
     int reblock = 0, switched;
     int downsample = 1, upsample = 1;
+    int parallel, parallelonset = -1;
+        /* the object (such as a subpatch) whose "dsp" method sorts this
+        graph shouldn't be charged for block~ code or for what's inside */
+    t_object *profileobj = THIS->u_profileobj;
+    t_dspprofile *profilerec = THIS->u_profilerec;
+    THIS->u_profileobj = 0;
     /* debugging printout */
 
     if (THIS->u_loud)
@@ -1010,6 +1346,14 @@ void ugen_done_graph(t_dspcontext *dc)
     dc->dc_vecsize = vecsize;
     dc->dc_calcsize = calcsize;
 
+        /* if asked to, compute this subpatch, including its inlet and
+        outlet code, in a task of its own. */
+    parallel = (blk && blk->x_parallel && parent_context && dc->dc_iosigs);
+    if (blk)
+        blk->x_task = 0;
+    if (parallel)
+        parallelonset = dsp_parallel_begin();
+
         /* if we're reblocking or switched, we now have to create output
         signals to fill in for the "borrowed" ones we have now.  This
         is also possibly true even if we're not blocked/switched, in
@@ -1066,6 +1410,7 @@ void ugen_done_graph(t_dspcontext *dc)
     {
         dsp_add(block_prolog, 1, blk);
         blk->x_chainonset = THIS->u_dspchainsize - 1;
+        parallel_addblock(blk);
     }
         /* Initialize for sorting */
     for (u = dc->dc_ugenlist; u; u = u->u_next)
@@ -1144,6 +1489,9 @@ void ugen_done_graph(t_dspcontext *dc)
         blk->x_epiloglength = chainafterall - chainblockend;
         blk->x_reblock = reblock;
     }
+    if (parallel)
+        dsp_parallel_end(parallelonset,
+            dc->dc_iosigs + dc->dc_ninlets, dc->dc_noutlets);
 
     if (THIS->u_loud)
     {
@@ -1180,6 +1528,8 @@ void ugen_done_graph(t_dspcontext *dc)
         THIS->u_context = dc->dc_parentcontext;
     else bug("THIS->u_context");
     freebytes(dc, sizeof(*dc));
+    THIS->u_profileobj = profileobj;
+    THIS->u_profilerec = profilerec;
 
 }
 
@@ -1225,7 +1575,10 @@ t_int *plus_perf8(t_int *w)
 
 void dsp_add_plus(t_sample *in1, t_sample *in2, t_sample *out, int n)
 {
-    if (n&7)
+    t_perfroutine simd = dsp_simdroutine(SIMD_PLUS, n);
+    if (simd)
+        dsp_add(simd, 4, in1, in2, out, (t_int)n);
+    else if (n&7)
         dsp_add(plus_perform, 4, in1, in2, out, (t_int)n);
     else
         dsp_add(plus_perf8, 4, in1, in2, out, (t_int)n);
@@ -14,6 +14,7 @@ to be different but are now unified except for some fossilized names.) */
 #include "s_utf8.h"
 #include <string.h>
 #include "g_undo.h"
+#include "d_parallel.h"
 
 #include "g_ceammc_draw.h"
 #ifdef _WIN32
@@ -1372,6 +1373,8 @@ static void canvas_start_dsp(void)
 
     for (x = pd_getcanvaslist(); x; x = x->gl_next)
         canvas_dodsp(x, 1, 0);
+        /* wait for any parallel tasks still running at the end of the chain */
+    dsp_parallel_join();
 
     canvas_dspstate = THISGUI->i_dspstate = 1;
     if (gensym("pd-dsp-started")->s_thing)
@@ -2207,6 +2210,7 @@ t_pd *glob_evalfile(t_pd *ignore, t_symbol *name, t_symbol *dir)
 {
     t_pd *x = 0, *boundx;
     int dspstate;
+    double starttime = (sys_load_profile ? sys_getrealtime() : 0);
 
         /* even though binbuf_evalfile appears to take care of dspstate,
         we have to do it again here, because canvas_startdsp() assumes
@@ -2217,6 +2221,8 @@ t_pd *glob_evalfile(t_pd *ignore, t_symbol *name, t_symbol *dir)
         s__X.s_thing = 0;       /* don't save #X; we'll need to leave it bound
                                 for the caller to grab it. */
     binbuf_evalfile(name, dir);
+    if (sys_load_profile)
+        loadprofile_report(sys_getrealtime() - starttime);
     while ((x != s__X.s_thing) && s__X.s_thing)
     {
         x = s__X.s_thing;
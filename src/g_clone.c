@@ -1,6 +1,7 @@
 #include "m_pd.h"
 #include "g_canvas.h"
 #include "m_imp.h"
+#include "d_parallel.h"
 #include <string.h>
 
 /* ---------- clone - maintain copies of a patch ----------------- */
@@ -59,6 +60,7 @@ typedef struct _clone
     int x_phase;
     int x_startvoice;   /* number of first voice, 0 by default */
     int x_suppressvoice; /* suppress voice number as $1 arg */
+    int x_parallel;     /* compute copies on DSP worker threads */
 } t_clone;
 
 int clone_match(t_pd *z, t_symbol *name, t_symbol *dir)
@@ -333,7 +335,36 @@ static void clone_dsp(t_clone *x, t_signal **sp)
     for (i = 0; i < nout; i++)
         tempsigs[i] = signal_newfromcontext(0);
 
-    for (j = 0; j < x->x_n; j++)
+    if (x->x_parallel)
+    {
+            /* each copy gets its own task and keeps its output signals
+            to itself; we sum them all up once the tasks are joined. */
+        t_signal **copyout = (t_signal **)getbytes(
+            x->x_n * nout * sizeof(*copyout));
+        for (j = 0; j < x->x_n; j++)
+        {
+            int onset;
+            for (i = 0; i < nout; i++)
+                copyout[j * nout + i] = tempio[nin + i] =
+                    signal_newfromcontext(1);
+            onset = dsp_parallel_begin();
+            canvas_dodsp(x->x_vec[j].c_gl, 0, tempio);
+            dsp_parallel_end(onset, tempio + nin, nout);
+        }
+        dsp_parallel_join();
+        for (j = 0; j < x->x_n; j++)
+            for (i = 0; i < nout; i++)
+        {
+            t_signal *s = copyout[j * nout + i];
+            if (j == 0)
+                dsp_add_copy(s->s_vec, tempsigs[i]->s_vec, tempsigs[i]->s_n);
+            else dsp_add_plus(s->s_vec, tempsigs[i]->s_vec,
+                    tempsigs[i]->s_vec, tempsigs[i]->s_n);
+            signal_makereusable(s);
+        }
+        freebytes(copyout, x->x_n * nout * sizeof(*copyout));
+    }
+    else for (j = 0; j < x->x_n; j++)
     {
         for (i = 0; i < nout; i++)
             tempio[nin + i] = signal_newfromcontext(1);
@@ -366,6 +397,7 @@ static void *clone_new(t_symbol *s, int argc, t_atom *argv)
     x->x_outvec = 0;
     x->x_startvoice = 0;
     x->x_suppressvoice = 0;
+    x->x_parallel = 0;
     clone_voicetovis = -1;
     if (argc == 0)
     {
@@ -385,6 +417,8 @@ static void *clone_new(t_symbol *s, int argc, t_atom *argv)
         }
         else if (!strcmp(argv[0].a_w.w_symbol->s_name, "-x"))
             x->x_suppressvoice = 1, argc--, argv++;
+        else if (!strcmp(argv[0].a_w.w_symbol->s_name, "-p"))
+            x->x_parallel = 1, argc--, argv++;
         else goto usage;
     }
     if (argc >= 2 && (wantn = atom_getfloatarg(0, argc, argv)) >= 0
@@ -442,7 +476,7 @@ static void *clone_new(t_symbol *s, int argc, t_atom *argv)
         canvas_vis(x->x_vec[voicetovis].c_gl, 1);
     return (x);
 usage:
-    pd_error(0, "usage: clone [-s starting-number] <number> <name> [arguments]");
+    pd_error(0, "usage: clone [-s starting-number] [-x] [-p] <number> <name> [arguments]");
 fail:
     freebytes(x, sizeof(t_clone));
     canvas_resume_dsp(dspstate);
@@ -504,3 +538,15 @@ t_glist *clone_get_instance(t_gobj *x, int n)
     return  c->x_vec[n].c_gl;
 }
 
+    /* the same by copy index (0 to clone_get_n() - 1), whatever the
+    first voice number is; for d_profile.c */
+t_glist *clone_get_copy(t_gobj *x, int i)
+{
+    t_clone *c;
+
+    if (pd_class(&x->g_pd) != clone_class) return NULL;
+
+    c = (t_clone *)x;
+    return ((i >= 0 && i < c->x_n) ? c->x_vec[i].c_gl : NULL);
+}
+
@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include "m_pd.h"
 #include "m_imp.h"
+#include "s_stuff.h"
 
 #include "g_canvas.h"
 #include <stdio.h>
@@ -126,10 +127,16 @@ static void canvas_objtext(t_glist *gl, int xpix, int ypix, int width,
     t_text *x;
     int argc;
     t_atom *argv;
+    double starttime = (sys_load_profile ? sys_getrealtime() : 0);
     pd_this->pd_newest = 0;
     canvas_setcurrent((t_canvas *)gl);
     canvas_getargs(&argc, &argv);
     binbuf_eval(b, &pd_objectmaker, argc, argv);
+        /* abstractions are profiled in binbuf_evalabstraction() */
+    if (sys_load_profile && pd_this->pd_newest &&
+        pd_class(pd_this->pd_newest) != canvas_class)
+            loadprofile_add(pd_class(pd_this->pd_newest)->c_name,
+                LOADPROFILE_CLASS, sys_getrealtime() - starttime);
     if (binbuf_getnatom(b))
     {
         if (!pd_this->pd_newest)
@@ -9,6 +9,8 @@
 #include "g_canvas.h"
 #include <stdio.h>
 #include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
@@ -908,6 +910,8 @@ static t_binbuf *binbuf_convert(const t_binbuf *oldb, int maxtopd);
 
     /* write a binbuf to a text file.  If "crflag" is set we suppress
     semicolons. */
+static void binbuf_filecache_forget(const char *path);
+
 int binbuf_write(const t_binbuf *x, const char *filename, const char *dir, int crflag)
 {
     FILE *f = 0;
@@ -930,6 +934,7 @@ int binbuf_write(const t_binbuf *x, const char *filename, const char *dir, int c
         z = y;
     }
 
+    binbuf_filecache_forget(fbuf);
     if (!(f = sys_fopen(fbuf, "w")))
         goto fail;
     for (ap = z->b_vec, indx = z->b_n; indx--; ap++)
@@ -1463,17 +1468,221 @@ static t_binbuf *binbuf_convert(const t_binbuf *oldb, int maxtopd)
     return (newb);
 }
 
+/* ----------------- cache of parsed patch files ------------------ */
+
+    /* abstractions are usually instantiated many times: keep the parsed
+    contents of every loaded abstraction file and reuse them while the file's
+    modification time and size are unchanged.  Top-level patches are not
+    cached.  Files written by Pd are dropped from the cache explicitly, so
+    that saves within the same second are not missed. */
+
+#define FILECACHE_NBUCKETS 256
+
+typedef struct _filecache
+{
+    char *fc_path;
+    time_t fc_mtime;
+    long fc_size;
+    t_binbuf *fc_binbuf;
+    struct _filecache *fc_next;
+} t_filecache;
+
+static t_filecache **binbuf_filecache_bucket(const char *path)
+{
+    unsigned int hash = 5381;
+    const char *s;
+    if (!STUFF->st_filecache)
+        STUFF->st_filecache = (t_filecache **)getbytes(
+            FILECACHE_NBUCKETS * sizeof(t_filecache *));
+    for (s = path; *s; s++)
+        hash = hash * 33 + (unsigned char)*s;
+    return (STUFF->st_filecache + (hash % FILECACHE_NBUCKETS));
+}
+
+static void binbuf_filecache_delete(t_filecache *fc)
+{
+    binbuf_free(fc->fc_binbuf);
+    freebytes(fc->fc_path, strlen(fc->fc_path) + 1);
+    freebytes(fc, sizeof(*fc));
+}
+
+static void binbuf_filecache_forget(const char *path)
+{
+    t_filecache **fp, *fc;
+    if (!STUFF->st_filecache)
+        return;
+    for (fp = binbuf_filecache_bucket(path); (fc = *fp);
+        fp = &fc->fc_next)
+            if (!strcmp(fc->fc_path, path))
+    {
+        *fp = fc->fc_next;
+        binbuf_filecache_delete(fc);
+        return;
+    }
+}
+
+void binbuf_filecache_free(void)
+{
+    int i;
+    if (!STUFF->st_filecache)
+        return;
+    for (i = 0; i < FILECACHE_NBUCKETS; i++)
+    {
+        t_filecache *fc, *next;
+        for (fc = STUFF->st_filecache[i]; fc; fc = next)
+        {
+            next = fc->fc_next;
+            binbuf_filecache_delete(fc);
+        }
+    }
+    freebytes(STUFF->st_filecache, FILECACHE_NBUCKETS * sizeof(t_filecache *));
+    STUFF->st_filecache = 0;
+}
+
+    /* like binbuf_read() but parse the file only if it changed since
+    the last call */
+int binbuf_read_cached(t_binbuf *b, const char *filename,
+    const char *dirname)
+{
+    char namebuf[MAXPDSTRING];
+    struct stat statbuf;
+    t_filecache **bucket, *fc;
+    int fd, ok;
+
+    if (*dirname)
+        snprintf(namebuf, MAXPDSTRING-1, "%s/%s", dirname, filename);
+    else
+        snprintf(namebuf, MAXPDSTRING-1, "%s", filename);
+    namebuf[MAXPDSTRING-1] = 0;
+
+    if ((fd = sys_open(namebuf, 0)) < 0)
+        return (binbuf_read(b, filename, dirname, 0)); /* reports error */
+    ok = (fstat(fd, &statbuf) == 0);
+    close(fd);
+    if (!ok)
+        return (binbuf_read(b, filename, dirname, 0));
+
+    bucket = binbuf_filecache_bucket(namebuf);
+    for (fc = *bucket; fc; fc = fc->fc_next)
+        if (!strcmp(fc->fc_path, namebuf))
+            break;
+    if (fc && fc->fc_mtime == statbuf.st_mtime &&
+        fc->fc_size == (long)statbuf.st_size)
+    {
+        binbuf_clear(b);
+        binbuf_add(b, fc->fc_binbuf->b_n, fc->fc_binbuf->b_vec);
+        return (0);
+    }
+
+    if (binbuf_read(b, filename, dirname, 0))
+        return (1);
+    if (!fc)
+    {
+        fc = (t_filecache *)getbytes(sizeof(*fc));
+        fc->fc_path = (char *)getbytes(strlen(namebuf) + 1);
+        strcpy(fc->fc_path, namebuf);
+        fc->fc_binbuf = binbuf_new();
+        fc->fc_next = *bucket;
+        *bucket = fc;
+    }
+    binbuf_clear(fc->fc_binbuf);
+    binbuf_add(fc->fc_binbuf, b->b_n, b->b_vec);
+    fc->fc_mtime = statbuf.st_mtime;
+    fc->fc_size = (long)statbuf.st_size;
+    return (0);
+}
+
+/* ----------------------- load profiling ------------------------- */
+
+    /* with the -load-profile flag object creation times are collected
+    while a patch is loading and printed afterward.  Times are inclusive:
+    an abstraction's time contains the time of all objects inside it. */
+
+typedef struct _loadprofile
+{
+    t_symbol *lp_name;
+    int lp_kind;
+    int lp_count;
+    double lp_time;
+} t_loadprofile;
+
+static t_loadprofile *loadprofile_vec;
+static int loadprofile_n, loadprofile_alloc;
+
+void loadprofile_add(t_symbol *name, int kind, double elapsed)
+{
+    int i;
+    t_loadprofile *lp;
+    for (i = 0; i < loadprofile_n; i++)
+        if (loadprofile_vec[i].lp_name == name &&
+            loadprofile_vec[i].lp_kind == kind)
+    {
+        loadprofile_vec[i].lp_count++;
+        loadprofile_vec[i].lp_time += elapsed;
+        return;
+    }
+    if (loadprofile_n == loadprofile_alloc)
+    {
+        int newalloc = (loadprofile_alloc ? 2 * loadprofile_alloc : 64);
+        loadprofile_vec = (t_loadprofile *)resizebytes(loadprofile_vec,
+            loadprofile_alloc * sizeof(*loadprofile_vec),
+            newalloc * sizeof(*loadprofile_vec));
+        loadprofile_alloc = newalloc;
+    }
+    lp = &loadprofile_vec[loadprofile_n++];
+    lp->lp_name = name;
+    lp->lp_kind = kind;
+    lp->lp_count = 1;
+    lp->lp_time = elapsed;
+}
+
+static int loadprofile_cmp(const void *a, const void *b)
+{
+    double ta = ((const t_loadprofile *)a)->lp_time,
+        tb = ((const t_loadprofile *)b)->lp_time;
+    return ((ta < tb) - (ta > tb));
+}
+
+#define LOADPROFILE_MAXPRINT 30
+
+void loadprofile_report(double elapsed)
+{
+    int kind, i;
+    static const char *titles[] = {"classes", "files"};
+    qsort(loadprofile_vec, loadprofile_n, sizeof(*loadprofile_vec),
+        loadprofile_cmp);
+    post("load profile: %.1f ms total", elapsed * 1000);
+    for (kind = LOADPROFILE_CLASS; kind <= LOADPROFILE_ABSTRACTION; kind++)
+    {
+        int nprint = 0;
+        post("  %s:   count   total ms   mean ms", titles[kind]);
+        for (i = 0; i < loadprofile_n && nprint < LOADPROFILE_MAXPRINT; i++)
+        {
+            t_loadprofile *lp = &loadprofile_vec[i];
+            if (lp->lp_kind != kind)
+                continue;
+            post("    %-32s %6d %10.2f %9.3f", lp->lp_name->s_name,
+                lp->lp_count, lp->lp_time * 1000,
+                lp->lp_time * 1000 / lp->lp_count);
+            nprint++;
+        }
+    }
+    loadprofile_n = 0;
+}
+
 /* LATER make this evaluate the file on-the-fly. */
 /* LATER figure out how to log errors */
-void binbuf_evalfile(t_symbol *name, t_symbol *dir)
+static void binbuf_doevalfile(t_symbol *name, t_symbol *dir, int cached)
 {
     t_binbuf *b = binbuf_new();
     int import = !strcmp(name->s_name + strlen(name->s_name) - 4, ".pat") ||
         !strcmp(name->s_name + strlen(name->s_name) - 4, ".mxt");
     int dspstate = canvas_suspend_dsp();
+    double starttime = (sys_load_profile ? sys_getrealtime() : 0);
         /* set filename so that new canvases can pick them up */
     glob_setfilename(0, name, dir);
-    if (binbuf_read(b, name->s_name, dir->s_name, 0))
+    if ((cached ? binbuf_read_cached(b, name->s_name, dir->s_name) :
+        binbuf_read(b, name->s_name, dir->s_name, 0)))
         pd_error(0, "%s: read failed; %s", name->s_name, strerror(errno));
     else
     {
@@ -1496,9 +1705,23 @@ void binbuf_evalfile(t_symbol *name, t_symbol *dir)
     }
     glob_setfilename(0, &s_, &s_);
     binbuf_free(b);
+    if (sys_load_profile && cached)
+        loadprofile_add(name, LOADPROFILE_ABSTRACTION,
+            sys_getrealtime() - starttime);
     canvas_resume_dsp(dspstate);
 }
 
+void binbuf_evalfile(t_symbol *name, t_symbol *dir)
+{
+    binbuf_doevalfile(name, dir, 0);
+}
+
+    /* same for abstractions, using the parsed file cache */
+void binbuf_evalabstraction(t_symbol *name, t_symbol *dir)
+{
+    binbuf_doevalfile(name, dir, 1);
+}
+
     /* save a text object to a binbuf for a file or copy buf */
 void binbuf_savetext(const t_binbuf *bfrom, t_binbuf *bto)
 {
@@ -18,6 +18,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
 
 #ifdef _MSC_VER  /* This is only for Microsoft's compiler, not cygwin, e.g. */
 #define snprintf _snprintf
@@ -44,6 +45,10 @@ t_pdinstance pd_maininstance;
 
 static t_symbol *dogensym(const char *s, t_symbol *oldsym,
     t_pdinstance *pdinstance);
+static void symtab_new(t_pdinstance *x);
+#ifdef PDINSTANCE
+static void symtab_free(t_pdinstance *x);
+#endif
 void x_midi_newpdinstance( void);
 void x_midi_freepdinstance( void);
 void s_inter_newpdinstance( void);
@@ -63,23 +68,24 @@ void s_stuff_newpdinstance(void)
     STUFF->st_dacsr = DEFDACSAMPLERATE;
     STUFF->st_printhook = sys_printhook;
     STUFF->st_impdata = NULL;
+    STUFF->st_filecache = NULL;
+    schedstats_newpdinstance();
 }
 
 void s_stuff_freepdinstance(void)
 {
+    binbuf_filecache_free();
+    schedstats_freepdinstance();
     freebytes(STUFF, sizeof(*STUFF));
 }
 
 static t_pdinstance *pdinstance_init(t_pdinstance *x)
 {
-    int i;
     x->pd_systime = 0;
     x->pd_clock_setlist = 0;
     x->pd_canvaslist = 0;
     x->pd_templatelist = 0;
-    x->pd_symhash = getbytes(SYMTABHASHSIZE * sizeof(*x->pd_symhash));
-    for (i = 0; i < SYMTABHASHSIZE; i++)
-        x->pd_symhash[i] = 0;
+    symtab_new(x);
 #ifdef PDINSTANCE
     dogensym("pointer",   &x->pd_s_pointer,  x);
     dogensym("float",     &x->pd_s_float,    x);
@@ -197,7 +203,6 @@ EXTERN t_pdinstance *pdinstance_new(void)
 
 EXTERN void pdinstance_free(t_pdinstance *x)
 {
-    t_symbol *s;
     t_canvas *canvas;
     int i, instanceno;
     t_class *c;
@@ -225,30 +230,7 @@ EXTERN void pdinstance_free(t_pdinstance *x)
             pd_ninstances * sizeof(*c->c_methods),
             (pd_ninstances - 1) * sizeof(*c->c_methods));
     }
-    for (i =0; i < SYMTABHASHSIZE; i++)
-    {
-        while ((s = x->pd_symhash[i]))
-        {
-            x->pd_symhash[i] = s->s_next;
-            if(s != &x->pd_s_pointer &&
-               s != &x->pd_s_float &&
-               s != &x->pd_s_symbol &&
-               s != &x->pd_s_bang &&
-               s != &x->pd_s_list &&
-               s != &x->pd_s_anything &&
-               s != &x->pd_s_signal &&
-               s != &x->pd_s__N &&
-               s != &x->pd_s__X &&
-               s != &x->pd_s_x &&
-               s != &x->pd_s_y &&
-               s != &x->pd_s_)
-            {
-                freebytes((void *)s->s_name, strlen(s->s_name)+1);
-                freebytes(s, sizeof(*s));
-            }
-        }
-    }
-    freebytes(x->pd_symhash, SYMTABHASHSIZE * sizeof (*x->pd_symhash));
+    symtab_free(x);
     x_midi_freepdinstance();
     g_canvas_freepdinstance();
     d_ugen_freepdinstance();
@@ -838,52 +820,193 @@ t_propertiesfn class_getpropertiesfn(const t_class *c)
     return (c->c_propertiesfn);
 }
 
-// ceammc
-size_t pd_ceammc_gensym_hash_table_size()
+/* ---------------- the symbol table ------------------------ */
+
+/* The symbol table can be read and added to from any thread.  Lookups take
+no lock: symbols are published with release stores and never move to another
+address, and the chains are walked with acquire loads.  Insertions are
+serialized by a mutex, and a lookup that fails is repeated under it before
+a new symbol is made.
+
+When there are more symbols than buckets the table is doubled.  The symbols
+are relinked into the new table in place, so a lookup racing with a resize
+might wander off its chain and miss; it then simply takes the locked path.
+(It can't loop: a node is only ever relinked to one relinked before it.)  Old
+bucket arrays may still be in use by such lookups, so they are only freed
+with the instance. */
+
+static unsigned int symhash(const char *s)
 {
-    return SYMTABHASHSIZE;
+    unsigned int hash = 5381;
+    while (*s) /* djb2 hash algo */
+    {
+        hash = ((hash << 5) + hash) + *s;
+        s++;
+    }
+    return (hash);
 }
 
-t_symbol** pd_ceammc_gensym_hash_table()
+#define SYM_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define SYM_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+typedef struct _symtable
 {
-    return pd_this->pd_symhash;
+    struct _symtable *t_prev;   /* previous (smaller) table */
+    size_t t_mask;              /* number of buckets - 1 */
+    t_symbol *t_hash[1];        /* the buckets */
+} t_symtable;
+
+struct _instancesymtab
+{
+    t_symtable *st_table;       /* current table */
+    size_t st_count;            /* number of symbols */
+};
+
+static pthread_mutex_t symtab_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static t_symtable *symtable_new(size_t size, t_symtable *prev)
+{
+    t_symtable *t = (t_symtable *)getbytes(sizeof(t_symtable) +
+        (size - 1) * sizeof(t_symbol *));
+    t->t_prev = prev;
+    t->t_mask = size - 1;
+    return (t);
+}
+
+static void symtab_new(t_pdinstance *x)
+{
+    x->pd_symtab = (t_instancesymtab *)getbytes(sizeof(t_instancesymtab));
+    x->pd_symtab->st_table = symtable_new(SYMTABHASHSIZE, 0);
+    x->pd_symtab->st_count = 0;
+    x->pd_symhash = x->pd_symtab->st_table->t_hash;
+}
+
+#ifdef PDINSTANCE
+static void symtable_free(t_symtable *t)
+{
+    freebytes(t, sizeof(t_symtable) + t->t_mask * sizeof(t_symbol *));
+}
+
+static void symtab_free(t_pdinstance *x)
+{
+    t_symtable *t = x->pd_symtab->st_table, *prev;
+    t_symbol *s;
+    size_t i;
+    for (i = 0; i <= t->t_mask; i++)
+    {
+        while ((s = t->t_hash[i]))
+        {
+            t->t_hash[i] = s->s_next;
+            if(s != &x->pd_s_pointer &&
+               s != &x->pd_s_float &&
+               s != &x->pd_s_symbol &&
+               s != &x->pd_s_bang &&
+               s != &x->pd_s_list &&
+               s != &x->pd_s_anything &&
+               s != &x->pd_s_signal &&
+               s != &x->pd_s__N &&
+               s != &x->pd_s__X &&
+               s != &x->pd_s_x &&
+               s != &x->pd_s_y &&
+               s != &x->pd_s_)
+            {
+                freebytes((void *)s->s_name, strlen(s->s_name)+1);
+                freebytes(s, sizeof(*s));
+            }
+        }
+    }
+    for (; t; t = prev)
+    {
+        prev = t->t_prev;
+        symtable_free(t);
+    }
+    freebytes(x->pd_symtab, sizeof(t_instancesymtab));
+    x->pd_symtab = 0;
+    x->pd_symhash = 0;
+}
+#endif /* PDINSTANCE */
+
+static t_symbol *symtable_find(t_symtable *t, const char *s,
+    unsigned int hash)
+{
+    t_symbol *sym = SYM_LOAD(t->t_hash[hash & t->t_mask]);
+    for (; sym; sym = SYM_LOAD(sym->s_next))
+        if (!strcmp(sym->s_name, s))
+            return (sym);
+    return (0);
+}
+
+    /* double the table, called with the mutex held */
+static void symtab_grow(t_pdinstance *x)
+{
+    t_symtable *old = x->pd_symtab->st_table,
+        *t = symtable_new(2 * (old->t_mask + 1), old);
+    t_symbol *sym, *next;
+    size_t i, bucket;
+    for (i = 0; i <= old->t_mask; i++)
+        for (sym = old->t_hash[i]; sym; sym = next)
+    {
+        next = sym->s_next;
+        bucket = symhash(sym->s_name) & t->t_mask;
+        SYM_STORE(sym->s_next, t->t_hash[bucket]);
+        t->t_hash[bucket] = sym;
+    }
+    SYM_STORE(x->pd_symtab->st_table, t);
+    x->pd_symhash = t->t_hash;
 }
-// end ceammc
-/* ---------------- the symbol table ------------------------ */
 
 static t_symbol *dogensym(const char *s, t_symbol *oldsym,
     t_pdinstance *pdinstance)
 {
-    char *symname = 0;
+    t_instancesymtab *st = pdinstance->pd_symtab;
+    t_symtable *t;
     t_symbol **symhashloc, *sym2;
-    unsigned int hash = 5381;
-    int length = 0;
-    const char *s2 = s;
-    while (*s2) /* djb2 hash algo */
-    {
-        hash = ((hash << 5) + hash) + *s2;
-        length++;
-        s2++;
-    }
-    symhashloc = pdinstance->pd_symhash + (hash & (SYMTABHASHSIZE-1));
+    char *symname;
+    unsigned int hash = symhash(s);
+    size_t length;
+
+    if ((sym2 = symtable_find(SYM_LOAD(st->st_table), s, hash)))
+        return (sym2);
+
+    pthread_mutex_lock(&symtab_mutex);
+    t = st->st_table;
+    symhashloc = t->t_hash + (hash & t->t_mask);
     while ((sym2 = *symhashloc))
     {
         if (!strcmp(sym2->s_name, s))
-            return(sym2);
+        {
+            pthread_mutex_unlock(&symtab_mutex);
+            return (sym2);
+        }
         symhashloc = &sym2->s_next;
     }
     if (oldsym)
         sym2 = oldsym;
     else sym2 = (t_symbol *)t_getbytes(sizeof(*sym2));
+    length = strlen(s);
     symname = t_getbytes(length+1);
     sym2->s_next = 0;
     sym2->s_thing = 0;
     strcpy(symname, s);
     sym2->s_name = symname;
-    *symhashloc = sym2;
+    SYM_STORE(*symhashloc, sym2);
+    if (++st->st_count > t->t_mask + 1)
+        symtab_grow(pdinstance);
+    pthread_mutex_unlock(&symtab_mutex);
     return (sym2);
 }
 
+// ceammc
+    /* the array and its size come from one snapshot: the table can be
+    replaced by a bigger one at any time */
+t_symbol** pd_ceammc_gensym_hash_table(size_t* size)
+{
+    t_symtable *t = SYM_LOAD(pd_this->pd_symtab->st_table);
+    *size = t->t_mask + 1;
+    return t->t_hash;
+}
+// end ceammc
+
 t_symbol *gensym(const char *s)
 {
     return(dogensym(s, 0, pd_this));
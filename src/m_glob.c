@@ -41,6 +41,10 @@ void glob_forgetpreferences(t_pd *dummy);
 void glob_open(t_pd *ignore, t_symbol *name, t_symbol *dir, t_floatarg f);
 void glob_fastforward(t_pd *ignore, t_floatarg f);
 void glob_settracing(void *dummy, t_float f);
+void glob_dspthreads(void *dummy, t_floatarg f);
+void glob_dspprofile(void *dummy, t_symbol *s, int argc, t_atom *argv);
+void glob_dspsimd(void *dummy, t_symbol *s, int argc, t_atom *argv);
+void glob_fftbackend(void *dummy, t_symbol *s, int argc, t_atom *argv);
 
 static void glob_helpintro(t_pd *dummy)
 {
@@ -187,6 +191,14 @@ void glob_init(void)
          gensym("fast-forward"), A_FLOAT, 0);
     class_addmethod(glob_pdobject, (t_method)glob_settracing,
          gensym("set-tracing"), A_FLOAT, 0);
+    class_addmethod(glob_pdobject, (t_method)glob_dspthreads,
+         gensym("dsp-threads"), A_FLOAT, 0);
+    class_addmethod(glob_pdobject, (t_method)glob_dspprofile,
+         gensym("dsp-profile"), A_GIMME, 0);
+    class_addmethod(glob_pdobject, (t_method)glob_dspsimd,
+         gensym("dsp-simd"), A_GIMME, 0);
+    class_addmethod(glob_pdobject, (t_method)glob_fftbackend,
+         gensym("fft-backend"), A_GIMME, 0);
 #if defined(__linux__) || defined(__FreeBSD_kernel__)
     class_addmethod(glob_pdobject, (t_method)glob_watchdog,
         gensym("watchdog"), 0);
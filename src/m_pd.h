@@ -878,6 +878,9 @@ EXTERN_STRUCT _instanceugen;
 EXTERN_STRUCT _instancestuff;
 #define t_instancestuff struct _instancestuff
 
+EXTERN_STRUCT _instancesymtab;
+#define t_instancesymtab struct _instancesymtab
+
 #ifndef PDTHREADS
 #define PDTHREADS 1
 #endif
@@ -913,6 +916,7 @@ struct _pdinstance
 #if PDTHREADS
     int pd_islocked;
 #endif
+    t_instancesymtab *pd_symtab;    /* private stuff for m_class.c */
 };
 #define t_pdinstance struct _pdinstance
 EXTERN t_pdinstance pd_maininstance;
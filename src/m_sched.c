@@ -7,6 +7,7 @@
 #include "m_pd.h"
 #include "m_imp.h"
 #include "s_stuff.h"
+#include "m_schedstats.h"
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -186,6 +187,8 @@ static void sys_clearhist(void) {}
 
 void sys_log_error(int type)
 {
+    if (type != ERR_NOTHING)
+        schedstats_xrun();
     if (type != ERR_NOTHING && !sched_diored &&
         (sched_counter >= sched_dioredtime))
     {
@@ -236,11 +239,38 @@ void sched_set_using_audio(int flag)
     pdgui_vmess("pdtk_pd_audio", "r", flag ? "on" : "off");
 }
 
+#define MAXTICKHOOKS 16
+static t_tickhook sched_tickhooks[MAXTICKHOOKS];
+static int sched_ntickhooks;
+
+void sched_addtickhook(t_tickhook fn)
+{
+    int i;
+    for (i = 0; i < sched_ntickhooks; i++)
+        if (sched_tickhooks[i] == fn)
+            return;
+    if (sched_ntickhooks >= MAXTICKHOOKS)
+        bug("sched_addtickhook");
+    else sched_tickhooks[sched_ntickhooks++] = fn;
+}
+
+void sched_removetickhook(t_tickhook fn)
+{
+    int i;
+    for (i = 0; i < sched_ntickhooks; i++)
+        if (sched_tickhooks[i] == fn)
+    {
+        sched_tickhooks[i] = sched_tickhooks[--sched_ntickhooks];
+        return;
+    }
+}
+
     /* take the scheduler forward one DSP tick, also handling clock timeouts */
 void sched_tick(void)
 {
     double next_sys_time = pd_this->pd_systime + SYSTIMEPERTICK;
-    int countdown = 5000;
+    double starttime = sys_getrealtime();
+    int countdown = 5000, i;
     while (pd_this->pd_clock_setlist &&
         pd_this->pd_clock_setlist->c_settime < next_sys_time)
     {
@@ -260,6 +290,10 @@ void sched_tick(void)
     pd_this->pd_systime = next_sys_time;
     dsp_tick();
     sched_counter++;
+    for (i = 0; i < sched_ntickhooks; i++)
+        (*sched_tickhooks[i])();
+    schedstats_tick(1e6 * (sys_getrealtime() - starttime),
+        1e6 * STUFF->st_schedblocksize / STUFF->st_dacsr);
 }
 
 int sched_get_sleepgrain( void)
@@ -0,0 +1,160 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* scheduler timing statistics, see m_schedstats.h.  Everything here is
+written by the scheduler thread only, with atomic stores so that readers
+on other threads see whole values; a reader wanting a reset just raises a
+flag the scheduler looks at. */
+
+#include "m_pd.h"
+#include "s_stuff.h"
+#include "m_schedstats.h"
+
+#define SCHEDSTATS_RINGMASK (SCHEDSTATS_RINGSIZE - 1)
+
+#define STATS_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define STATS_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+struct _schedstatsdata
+{
+    unsigned long sd_ticks;
+    unsigned long sd_late;
+    unsigned long sd_xruns;
+    unsigned long long sd_sumnsec;  /* total tick time */
+    unsigned long long sd_maxnsec;  /* longest tick */
+    unsigned long long sd_period;   /* block period, nsec */
+    unsigned long sd_hist[SCHEDSTATS_NBINS];
+    double sd_starttime;
+    int sd_started;
+    int sd_resetrequest;
+    t_float sd_ring[SCHEDSTATS_RINGSIZE];
+    unsigned int sd_ringpos;
+};
+
+#define STATS (STUFF->st_schedstats)
+
+void schedstats_newpdinstance(void)
+{
+    STATS = (struct _schedstatsdata *)getbytes(sizeof(*STATS));
+}
+
+void schedstats_freepdinstance(void)
+{
+    freebytes(STATS, sizeof(*STATS));
+    STATS = 0;
+}
+
+static void schedstats_doreset(struct _schedstatsdata *sd)
+{
+    int i;
+    STATS_STORE(sd->sd_ticks, 0);
+    STATS_STORE(sd->sd_late, 0);
+    STATS_STORE(sd->sd_xruns, 0);
+    STATS_STORE(sd->sd_sumnsec, 0);
+    STATS_STORE(sd->sd_maxnsec, 0);
+    for (i = 0; i < SCHEDSTATS_NBINS; i++)
+        STATS_STORE(sd->sd_hist[i], 0);
+    sd->sd_starttime = sys_getrealtime();
+    STATS_STORE(sd->sd_started, 1);
+    STATS_STORE(sd->sd_resetrequest, 0);
+}
+
+    /* log a tick that took "usec" microseconds out of a period of "period" */
+void schedstats_tick(double usec, double period)
+{
+    unsigned long long nsec = (usec > 0 ? usec * 1000. : 0);
+    double load = (period > 0 ? usec / period : 0);
+    int bin = load / SCHEDSTATS_BINWIDTH;
+    unsigned int pos;
+    struct _schedstatsdata *sd = STATS;
+    if (STATS_LOAD(sd->sd_resetrequest) || !sd->sd_started)
+        schedstats_doreset(sd);
+    if (bin >= SCHEDSTATS_NBINS)
+        bin = SCHEDSTATS_NBINS - 1;
+    STATS_STORE(sd->sd_period, (unsigned long long)(period * 1000.));
+    STATS_STORE(sd->sd_hist[bin], sd->sd_hist[bin] + 1);
+    STATS_STORE(sd->sd_sumnsec, sd->sd_sumnsec + nsec);
+    if (nsec > sd->sd_maxnsec)
+        STATS_STORE(sd->sd_maxnsec, nsec);
+    if (load > 1)
+        STATS_STORE(sd->sd_late, sd->sd_late + 1);
+    STATS_STORE(sd->sd_ticks, sd->sd_ticks + 1);
+
+    pos = sd->sd_ringpos;
+    sd->sd_ring[pos & SCHEDSTATS_RINGMASK] = load;
+    STATS_STORE(sd->sd_ringpos, pos + 1);
+}
+
+void schedstats_xrun(void)
+{
+    struct _schedstatsdata *sd = STATS;
+    STATS_STORE(sd->sd_xruns, sd->sd_xruns + 1);
+}
+
+void sched_resetstats(void)
+{
+    STATS_STORE(STATS->sd_resetrequest, 1);
+}
+
+    /* upper edge of the histogram bin where the q-th fraction of ticks is */
+static double schedstats_percentile(const unsigned long *hist,
+    unsigned long count, double q, double period, double max)
+{
+    unsigned long sum = 0, target = (unsigned long)(q * count + 0.5);
+    int i;
+    if (!count)
+        return (0);
+    if (target < 1)
+        target = 1;
+    for (i = 0; i < SCHEDSTATS_NBINS - 1; i++)
+    {
+        if ((sum += hist[i]) >= target)
+        {
+            double edge = (i + 1) * SCHEDSTATS_BINWIDTH * period;
+            return (edge < max ? edge : max);
+        }
+    }
+    return (max);
+}
+
+void sched_getstats(t_schedstats *x)
+{
+    unsigned long count = 0;
+    double busy;
+    int i;
+    struct _schedstatsdata *sd = STATS;
+    x->ss_period = STATS_LOAD(sd->sd_period) * 0.001;
+    x->ss_ticks = STATS_LOAD(sd->sd_ticks);
+    x->ss_late = STATS_LOAD(sd->sd_late);
+    x->ss_xruns = STATS_LOAD(sd->sd_xruns);
+    x->ss_max = STATS_LOAD(sd->sd_maxnsec) * 0.001;
+    busy = STATS_LOAD(sd->sd_sumnsec) * 0.001;
+    x->ss_mean = (x->ss_ticks ? busy / x->ss_ticks : 0);
+    for (i = 0; i < SCHEDSTATS_NBINS; i++)
+        count += (x->ss_hist[i] = STATS_LOAD(sd->sd_hist[i]));
+    x->ss_p50 = schedstats_percentile(x->ss_hist, count, 0.5,
+        x->ss_period, x->ss_max);
+    x->ss_p90 = schedstats_percentile(x->ss_hist, count, 0.9,
+        x->ss_period, x->ss_max);
+    x->ss_p99 = schedstats_percentile(x->ss_hist, count, 0.99,
+        x->ss_period, x->ss_max);
+    x->ss_elapsed = (STATS_LOAD(sd->sd_started) ?
+        sys_getrealtime() - sd->sd_starttime : 0);
+    x->ss_idle = (x->ss_elapsed > 0 ? 1. - busy * 1e-6 / x->ss_elapsed : 0);
+    if (x->ss_idle < 0)
+        x->ss_idle = 0;
+}
+
+int sched_readticks(unsigned int *pos, t_float *dest, int n)
+{
+    struct _schedstatsdata *sd = STATS;
+    unsigned int end = STATS_LOAD(sd->sd_ringpos), i;
+    int count = 0;
+    if (end - *pos > SCHEDSTATS_RINGSIZE)
+        *pos = end - SCHEDSTATS_RINGSIZE;
+    for (i = *pos; i != end && count < n; i++)
+        dest[count++] = sd->sd_ring[i & SCHEDSTATS_RINGMASK];
+    *pos = i;
+    return (count);
+}
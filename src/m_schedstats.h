@@ -0,0 +1,61 @@
+/* Copyright (c) 1997-2022 Miller Puckette and others.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* scheduler timing statistics.
+
+The scheduler times every tick (clock timeouts plus the DSP chain) and
+compares it with the block period, i.e., the time the tick would have in a
+real time audio stream.  The tick times go into a histogram and a ring of the
+most recent ticks, and audio I/O errors (the ones that light up the "audio I/O
+error" indicator) are counted.  Only the thread running the scheduler writes
+any of this; readers, which may be on other threads, never block it.  Every
+Pd instance keeps its own statistics, read and reset through pd_this.  A reset
+is a request that the scheduler carries out on its next tick. */
+
+#pragma once
+
+#include "m_pd.h"
+
+#if defined(_LANGUAGE_C_PLUS_PLUS) || defined(__cplusplus)
+extern "C" {
+#endif
+
+    /* histogram bins are 5% of the block period wide; the last one counts
+    ticks that took twice the period or more */
+#define SCHEDSTATS_NBINS 41
+#define SCHEDSTATS_BINWIDTH 0.05
+    /* number of recent tick times kept */
+#define SCHEDSTATS_RINGSIZE 1024
+
+typedef struct _schedstats
+{
+    double ss_period;       /* block period, in microseconds */
+    double ss_elapsed;      /* real time since the last reset, in seconds */
+    unsigned long ss_ticks;     /* ticks since the last reset */
+    unsigned long ss_late;      /* ticks that took longer than the period */
+    unsigned long ss_xruns;     /* audio I/O errors */
+    double ss_max;          /* longest tick, in microseconds */
+    double ss_mean;         /* average tick */
+    double ss_p50;          /* median, from the histogram */
+    double ss_p90;          /* 90th percentile */
+    double ss_p99;          /* 99th percentile */
+    double ss_idle;         /* share of real time not spent in ticks */
+    unsigned long ss_hist[SCHEDSTATS_NBINS];
+} t_schedstats;
+
+EXTERN void sched_getstats(t_schedstats *x);
+EXTERN void sched_resetstats(void);
+    /* copy tick times (as fractions of the block period) added since "*pos"
+    into "dest", at most "n" of them, and advance "*pos".  If the reader has
+    fallen more than a ring behind, the oldest ones are skipped.  Start
+    with *pos = 0 to read whatever the ring has.  Returns the count. */
+EXTERN int sched_readticks(unsigned int *pos, t_float *dest, int n);
+
+    /* called by the scheduler */
+void schedstats_tick(double usec, double period);
+void schedstats_xrun(void);
+
+#if defined(_LANGUAGE_C_PLUS_PLUS) || defined(__cplusplus)
+}
+#endif
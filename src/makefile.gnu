@@ -120,11 +120,11 @@ SRC = g_canvas.c g_graph.c g_text.c g_rtext.c g_array.c g_template.c g_io.c \
     s_loader.c s_path.c s_entry.c s_audio.c s_midi.c s_net.c s_utf8.c \
     s_audio_paring.c \
     d_ugen.c d_ctl.c d_arithmetic.c d_osc.c d_filter.c d_dac.c d_misc.c \
-    d_math.c d_fft.c d_fft_fftsg.c d_array.c d_global.c \
+    d_math.c d_fft.c d_fft_fftsg.c d_fftplan.c d_array.c d_global.c \
     d_delay.c d_resample.c d_soundfile.c \
     x_arithmetic.c x_connective.c x_interface.c x_midi.c x_misc.c \
     x_time.c x_acoustics.c x_net.c x_text.c x_gui.c x_list.c x_array.c \
-    x_scalar.c  x_vexp.c x_vexp_if.c x_vexp_fun.c \
+    x_scalar.c  x_vexp.c x_vexp_if.c x_vexp_comp.c x_vexp_fun.c \
     $(SYSSRC)
 
 OBJ = $(SRC:.c=.o) 
@@ -462,7 +462,7 @@ static t_pd *do_create_abstraction(t_symbol*s, int argc, t_atom *argv)
             close(fd);
             canvas_setargs(argc, argv);
 
-            binbuf_evalfile(gensym(nameptr), gensym(dirbuf));
+            binbuf_evalabstraction(gensym(nameptr), gensym(dirbuf));
             if (s__X.s_thing && was != s__X.s_thing)
                 canvas_popabstraction((t_canvas *)(s__X.s_thing));
             else s__X.s_thing = was;
@@ -5,6 +5,7 @@
 #include "m_pd.h"
 #include "m_imp.h"
 #include "s_stuff.h"
+#include "d_parallel.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <limits.h>
@@ -56,10 +57,12 @@ int sys_oktoloadfiles(int done);
 int sys_debuglevel;
 int sys_verbose;
 int sys_noloadbang;
+int sys_load_profile;   /* print object creation times after loading a patch */
 static int sys_dontstartgui;
 int sys_hipriority = -1;    /* -1 = not specified; 0 = no; 1 = yes */
 int sys_guisetportnumber;   /* if started from the GUI, this is the port # */
 int sys_nosleep = 0;  /* skip all "sleep" calls and spin instead */
+static int sys_dspthreads;  /* worker threads for parallel DSP */
 int sys_defeatrt;       /* flag to cancel real-time */
 int sys_eventloop;
 t_symbol *sys_flags;    /* more command-line flags */
@@ -453,6 +456,9 @@ static int sys_run(void)
 {
     if (sys_hipriority)
         sys_setrealtime(sys_libdir->s_name); /* set desired process priority */
+        /* start DSP workers after that so they inherit the priority */
+    if (sys_dspthreads)
+        dsp_setthreads(sys_dspthreads);
     if (sys_externalschedlib)
         return (sys_run_scheduler(sys_externalschedlibname,
             sys_extraflagsstring));
@@ -566,6 +572,7 @@ static char *(usagemessage[]) = {
 "-d <n>           -- specify debug level for inspecting the GUI communication\n",
 "-loadbang        -- do not suppress all loadbangs (true by default)\n",
 "-noloadbang      -- suppress all loadbangs\n",
+"-load-profile    -- print time spent per abstraction and class on load\n",
 "-stderr          -- send printout to standard error instead of GUI\n",
 "-nostderr        -- send printout to GUI (true by default)\n",
 "-gui             -- start GUI (true by default)\n",
@@ -582,6 +589,7 @@ static char *(usagemessage[]) = {
 #endif
 "-sleep           -- sleep when idle, don't spin (true by default)\n",
 "-nosleep         -- spin, don't sleep (may lower latency on multi-CPUs)\n",
+"-dspthreads <n>  -- worker threads for parallel subpatches and clones\n",
 "-schedlib <file> -- plug in external scheduler (omit file extensions)\n",
 "-extraflags <s>  -- string argument to send schedlib\n",
 "-batch           -- run off-line as a batch process\n",
@@ -1264,6 +1272,11 @@ int sys_argparse(int argc, const char **argv)
             sys_verbose=0;
             argc--; argv++;
         }
+        else if (!strcmp(*argv, "-load-profile"))
+        {
+            sys_load_profile = 1;
+            argc--; argv++;
+        }
         else if (!strcmp(*argv, "-version"))
         {
             sys_version = 1;
@@ -1438,6 +1451,13 @@ int sys_argparse(int argc, const char **argv)
             sys_nosleep = 1;
             argc--; argv++;
         }
+        else if (!strcmp(*argv, "-dspthreads"))
+        {
+            if (argc < 2)
+                goto usage;
+            sys_dspthreads = atoi(argv[1]);
+            argc -= 2; argv += 2;
+        }
         else if (!strcmp(*argv, "-noprefs")) /* did this earlier */
             argc--, argv++;
         else if (!strcmp(*argv, "-prefsfile") && argc > 1) /* this too */
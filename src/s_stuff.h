@@ -35,10 +35,24 @@ void sys_savepreferences(const char *filename);
 extern int sys_defeatrt;
 extern t_symbol *sys_flags;
 
+/* m_binbuf.c */
+#define LOADPROFILE_CLASS 0
+#define LOADPROFILE_ABSTRACTION 1
+void loadprofile_add(t_symbol *name, int kind, double elapsed);
+void loadprofile_report(double elapsed);
+void binbuf_filecache_free(void);
+int binbuf_read_cached(t_binbuf *b, const char *filename, const char *dirname);
+void binbuf_evalabstraction(t_symbol *name, t_symbol *dir);
+
+/* m_schedstats.c */
+void schedstats_newpdinstance(void);
+void schedstats_freepdinstance(void);
+
 /* s_main.c */
 extern int sys_debuglevel;
 extern int sys_verbose;
 extern int sys_noloadbang;
+extern int sys_load_profile;
 EXTERN int sys_havegui(void);
 extern const char *sys_guicmd;
 extern int sys_eventloop;
@@ -313,6 +327,11 @@ EXTERN void sys_log_error(int type);
 void sched_set_using_audio(int flag);
 extern int sys_sleepgrain;      /* override value set in command line */
 EXTERN int sched_get_sleepgrain( void);     /* returns actual value */
+    /* functions called at the end of every scheduler tick, in the thread
+    running the scheduler, once clock timeouts and DSP are done */
+typedef void (*t_tickhook)(void);
+EXTERN void sched_addtickhook(t_tickhook fn);
+EXTERN void sched_removetickhook(t_tickhook fn);
 
 /* s_inter.c */
 
@@ -411,6 +430,8 @@ struct _instancestuff
     double st_time_per_dsp_tick;    /* obsolete - included for GEM?? */
     t_printhook st_printhook;   /* set this to override per-instance printing */
     void *st_impdata; /* optional implementation-specific data for libpd, etc */
+    struct _filecache **st_filecache; /* parsed patch files, see m_binbuf.c */
+    struct _schedstatsdata *st_schedstats; /* see m_schedstats.c */
 };
 
 #define STUFF (pd_this->pd_stuff)
@@ -3,8 +3,8 @@
 size_t pd_ceammc_gensym_hash_size()
 {
     size_t res = 0;
-    t_symbol** table = pd_ceammc_gensym_hash_table();
-    const size_t table_size = pd_ceammc_gensym_hash_table_size();
+    size_t table_size = 0;
+    t_symbol** table = pd_ceammc_gensym_hash_table(&table_size);
 
     for (size_t i = 0; i < table_size; i++) {
         t_symbol* sym = table[i];
@@ -28,8 +28,8 @@ size_t pd_ceammc_gensym_hash_max_chain()
 {
     size_t res = 0;
 
-    t_symbol** table = pd_ceammc_gensym_hash_table();
-    const size_t table_size = pd_ceammc_gensym_hash_table_size();
+    size_t table_size = 0;
+    t_symbol** table = pd_ceammc_gensym_hash_table(&table_size);
 
     for (size_t i = 0; i < table_size; i++) {
         t_symbol* sym = table[i];
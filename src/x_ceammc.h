@@ -21,8 +21,7 @@ extern "C" {
 
 #include "m_pd.h"
 
-EXTERN t_symbol** pd_ceammc_gensym_hash_table(void);
-EXTERN size_t pd_ceammc_gensym_hash_table_size(void);
+EXTERN t_symbol** pd_ceammc_gensym_hash_table(size_t* size);
 
 #if defined(__cplusplus)
 }
@@ -114,7 +114,6 @@ static int cal_sigidx(struct ex_ex *optr,       /* The output value */
 t_ex_func *find_func(char *s);
 void ex_dzdetect(struct expr *expr);
 
-#define MAX_ARGS        10
 extern t_ex_func ex_funcs[];
 
 struct ex_ex nullex = { 0 };
@@ -1527,23 +1526,36 @@ eval_sigidx(struct expr *expr, struct ex_ex *eptr, struct ex_ex *optr, int idx)
 {
         struct ex_ex arg = { 0 };
         struct ex_ex *reteptr;
-        int i = 0;
-        t_float fi = 0,         /* index in float */
-              rem_i = 0;        /* remains of the float */
 
         arg.ex_type = 0;
         arg.ex_int = 0;
         reteptr = ex_eval(expr, eptr + 1, &arg, idx);
-        if (arg.ex_type == ET_FLT) {
-                fi = arg.ex_flt;                /* float index */
-                i = (int) arg.ex_flt;           /* integer index */
-                rem_i =  arg.ex_flt - i;        /* remains of integer */
-        } else if (arg.ex_type == ET_INT) {
-                fi = arg.ex_int;                /* float index */
-                i = (int) arg.ex_int;           /* integer index */
+        ex_sigidx(expr, eptr, &arg, optr, idx);
+        return (reteptr);
+}
+
+/*
+ * ex_sigidx -- the value of an indexed signal for fexpr~ once the index
+ *              (arg) is evaluated, also used by the compiled expressions
+ */
+void
+ex_sigidx(struct expr *expr, struct ex_ex *eptr, struct ex_ex *arg,
+                                                struct ex_ex *optr, int idx)
+{
+        int i = 0;
+        t_float fi = 0,         /* index in float */
+              rem_i = 0;        /* remains of the float */
+
+        if (arg->ex_type == ET_FLT) {
+                fi = arg->ex_flt;               /* float index */
+                i = (int) arg->ex_flt;          /* integer index */
+                rem_i =  arg->ex_flt - i;       /* remains of integer */
+        } else if (arg->ex_type == ET_INT) {
+                fi = arg->ex_int;               /* float index */
+                i = (int) arg->ex_int;          /* integer index */
                 rem_i = 0;
         } else {
-                post("eval_sigidx: bad res type (%d)", arg.ex_type);
+                post("eval_sigidx: bad res type (%d)", arg->ex_type);
         }
         optr->ex_type = ET_FLT;
         /*
@@ -1595,7 +1607,7 @@ eval_sigidx(struct expr *expr, struct ex_ex *eptr, struct ex_ex *optr, int idx)
                         post("fexpr~: $y%d illegal: not that many exprs",
                                                                 eptr->ex_int);
                         optr->ex_flt = 0;
-                        return (reteptr);
+                        return;
                 }
                 if (cal_sigidx(optr, i, rem_i, idx, expr->exp_vsize,
                              expr->exp_tmpres[eptr->ex_int],
@@ -1613,7 +1625,6 @@ eval_sigidx(struct expr *expr, struct ex_ex *eptr, struct ex_ex *optr, int idx)
                 post("fexpr~:eval_sigidx: internal error - unknown vector (%d)",
                                                                 eptr->ex_type);
         }
-        return (reteptr);
 }
 
 /*
@@ -60,6 +60,7 @@ void pd_error(void *object, char *fmt, ...);
 
 #define MAX_VARS        100
 #define MINODES         10 /* was 200 */
+#define MAX_ARGS        10 /* max number of function arguments */
 
 /* terminal defines */
 
@@ -212,6 +213,7 @@ typedef struct expr {
         int exp_vsize;                  /* the size of the signal vector */
         int exp_nivec;                  /* # of vector inlets */
         t_float exp_f;          /* control value to be transformed to signal */
+        struct ex_prog *exp_prog[MAX_VARS]; /* compiled expressions or 0 */
 } t_expr;
 
 typedef struct ex_funcs {
@@ -242,6 +244,15 @@ extern void ex_Sum(t_expr *expr, long int argc, struct ex_ex *argv,
 extern void ex_avg(t_expr *expr, long int argc, struct ex_ex *argv,                                                                     struct ex_ex *optr);
 extern void ex_Avg(t_expr *expr, long int argc, struct ex_ex *argv,                                                                     struct ex_ex *optr);
 extern void ex_store(t_expr *expr, long int argc, struct ex_ex *argv,                                                                   struct ex_ex *optr);
+extern void ex_sigidx(struct expr *expr, struct ex_ex *eptr,
+                        struct ex_ex *arg, struct ex_ex *optr, int idx);
+
+/* the bytecode compiler in x_vexp_comp.c */
+extern struct ex_prog *ex_compile(t_expr *expr, struct ex_ex *eptr);
+extern int ex_prog_setsize(struct ex_prog *prog, int vsize);
+extern void ex_prog_free(struct ex_prog *prog);
+extern void ex_run(t_expr *expr, struct ex_prog *prog, struct ex_ex *optr,
+                                                                int idx);
 
 int value_getonly(t_symbol *s, t_float *f);
 
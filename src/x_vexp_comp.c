@@ -0,0 +1,801 @@
+/* Copyright (c) IRCAM.
+* For information on usage and redistribution, and for a DISCLAIMER OF ALL
+* WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/*
+ * x_vexp_comp.c -- compile the prefix expressions made by ex_parse() into
+ *                  a flat list of register instructions
+ *
+ * ex_eval() walks the prefix nodes recursively, dispatches on the type of
+ * every node and, for expr~, allocates and frees a vector for every
+ * intermediate result of every block.  Here this is done once when the
+ * object is created: constants and control inlets go to scalar registers
+ * (their int/float tag is kept at run time, as in ex_eval(), since the
+ * type of a result depends on it), signals go to vector registers which
+ * are processed a whole block at a time by the instructions.  Registers
+ * are allocated as a stack, so an expression needs no more of them than
+ * the depth of its tree.
+ *
+ * The results are the same as the ones of ex_eval(): the operators use the
+ * same expressions, and the functions are called with the same arguments.
+ * Only the nodes without side effects outside of the expression are
+ * compiled (numbers, inlets, operators, functions, if() and the fexpr~
+ * signals).  For tables, variables, symbols and '=' ex_compile() gives up
+ * and the expression is evaluated by ex_eval() as before.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "x_vexp.h"
+
+extern struct ex_ex * ex_if(t_expr *expr,  struct ex_ex *eptr,
+                                struct ex_ex *optr,struct ex_ex *argv, int idx);
+void ex_dzdetect(struct expr *expr);
+
+/* instructions, 's' is a scalar register, 'v' a vector register */
+#define EXI_LOAD        1       /* s[dst] = number */
+#define EXI_II          2       /* s[dst] = integer inlet */
+#define EXI_FI          3       /* s[dst] = float inlet */
+#define EXI_VI          4       /* v[dst] = signal inlet (not copied) */
+#define EXI_XI0         5       /* s[dst] = $x#[0] of fexpr~ */
+#define EXI_YOM1        6       /* s[dst] = $y#[-1] of fexpr~ */
+#define EXI_SIGIDX      7       /* s[dst] = $x#[s[a]] or $y#[s[a]] of fexpr~ */
+#define EXI_SS          8       /* s[dst] = s[a] op s[b] */
+#define EXI_SV          9       /* v[dst] = s[a] op v[b] */
+#define EXI_VS          10      /* v[dst] = v[a] op s[b] */
+#define EXI_VV          11      /* v[dst] = v[a] op v[b] */
+#define EXI_S           12      /* s[dst] = op s[a] */
+#define EXI_V           13      /* v[dst] = op v[a] */
+#define EXI_FUNC        14      /* dst = func(a, b, ...) */
+#define EXI_SEL         15      /* v[dst] = v[a] ? b : c */
+#define EXI_JZ          16      /* if (!s[a]) jump */
+#define EXI_JMP         17      /* jump */
+#define EXI_COPY        18      /* v[dst] = v[a] */
+
+typedef struct ex_insn {
+        int i_code;             /* EXI_... */
+        long i_op;              /* the operator of EXI_SS ... EXI_V */
+        struct ex_ex *i_node;   /* the node the instruction is made of */
+        int i_dst;              /* destination register */
+        int i_src[MAX_ARGS];    /* source registers */
+        int i_vmask;            /* bit n is set if i_src[n] is a vector */
+        int i_vdst;             /* the destination is a vector */
+        int i_jump;             /* where to jump to */
+} t_ex_insn;
+
+struct ex_prog {
+        t_ex_insn *p_insn;      /* the instructions */
+        int p_ninsn;
+        int p_maxinsn;
+        struct ex_ex *p_sreg;   /* scalar registers */
+        int p_nsreg;
+        t_float **p_vreg;       /* the current vector of the vector registers */
+        t_float **p_vbuf;       /* the vectors owned by the vector registers */
+        int p_nvreg;
+        t_float *p_vmem;        /* memory for p_vbuf */
+        int p_vsize;            /* the vector size */
+        int p_res;              /* the register with the result */
+        int p_resvec;           /* the result is a vector */
+};
+
+/*
+ * vector register 0 is the output vector of expr~, the result of the
+ * expression is written straight into it
+ */
+#define EX_OUTREG       0
+
+typedef struct ex_reg {
+        int r_idx;              /* register number */
+        int r_vec;              /* is it a vector register */
+} t_ex_reg;
+
+typedef struct ex_comp {
+        t_expr *c_expr;
+        struct ex_prog *c_prog;
+        int c_ssp;              /* scalar register stack pointer */
+        int c_vsp;              /* vector register stack pointer */
+        int c_lastwrite;        /* the instruction writing the last result */
+} t_ex_comp;
+
+static struct ex_ex *exc_node(t_ex_comp *c, struct ex_ex *eptr,
+                                                t_ex_reg *dst, int vecout);
+
+/*
+ * exc_emit -- add an instruction, return its index or -1 if out of memory
+ */
+static int
+exc_emit(t_ex_comp *c, int code)
+{
+        struct ex_prog *p = c->c_prog;
+        t_ex_insn *ip;
+
+        if (p->p_ninsn == p->p_maxinsn) {
+                int n = p->p_maxinsn ? 2 * p->p_maxinsn : 16;
+                t_ex_insn *insn = (t_ex_insn *)
+                        fts_realloc(p->p_insn, n * sizeof(t_ex_insn));
+                if (!insn)
+                        return (-1);
+                p->p_insn = insn;
+                p->p_maxinsn = n;
+        }
+        ip = &p->p_insn[p->p_ninsn];
+        memset(ip, 0, sizeof(*ip));
+        ip->i_code = code;
+        return (p->p_ninsn++);
+}
+
+/*
+ * exc_push -- allocate a register on top of the register stack
+ */
+static void
+exc_push(t_ex_comp *c, t_ex_reg *r, int vec)
+{
+        r->r_vec = vec;
+        if (vec) {
+                r->r_idx = c->c_vsp++;
+                if (c->c_vsp > c->c_prog->p_nvreg)
+                        c->c_prog->p_nvreg = c->c_vsp;
+        } else {
+                r->r_idx = c->c_ssp++;
+                if (c->c_ssp > c->c_prog->p_nsreg)
+                        c->c_prog->p_nsreg = c->c_ssp;
+        }
+}
+
+/*
+ * exc_pop -- release the register on top of the stack, the registers are
+ *            released in the reverse order of their allocation
+ */
+static void
+exc_pop(t_ex_comp *c, t_ex_reg *r)
+{
+        if (r->r_vec)
+                c->c_vsp--;
+        else
+                c->c_ssp--;
+}
+
+/*
+ * exc_terminal -- instruction for a number or an inlet
+ */
+static struct ex_ex *
+exc_terminal(t_ex_comp *c, struct ex_ex *eptr, t_ex_reg *dst, int code,
+                                                                int vec)
+{
+        int n;
+
+        if ((n = exc_emit(c, code)) < 0)
+                return (exNULL);
+        exc_push(c, dst, vec);
+        c->c_prog->p_insn[n].i_node = eptr;
+        c->c_prog->p_insn[n].i_dst = dst->r_idx;
+        c->c_prog->p_insn[n].i_vdst = vec;
+        /* an inlet vector is not copied, so it is not a write */
+        c->c_lastwrite = (code == EXI_VI) ? -1 : n;
+        return (eptr + 1);
+}
+
+/*
+ * exc_sigidx -- $x#[index] and $y#[index] of fexpr~
+ */
+static struct ex_ex *
+exc_sigidx(t_ex_comp *c, struct ex_ex *eptr, t_ex_reg *dst)
+{
+        struct ex_ex *node = eptr;
+        t_ex_reg idx;
+        int n;
+
+        if (!(eptr = exc_node(c, eptr + 1, &idx, 0)) || idx.r_vec)
+                return (exNULL);
+        exc_pop(c, &idx);
+        if ((n = exc_emit(c, EXI_SIGIDX)) < 0)
+                return (exNULL);
+        exc_push(c, dst, 0);
+        c->c_prog->p_insn[n].i_node = node;
+        c->c_prog->p_insn[n].i_src[0] = idx.r_idx;
+        c->c_prog->p_insn[n].i_dst = dst->r_idx;
+        c->c_lastwrite = n;
+        return (eptr);
+}
+
+/*
+ * exc_if -- if() evaluates only one of its arguments if the condition is
+ *           a scalar, so it is made of jumps;  if the condition is a vector
+ *           both arguments are evaluated and selected sample by sample
+ */
+static struct ex_ex *
+exc_if(t_ex_comp *c, struct ex_ex *eptr, t_ex_reg *dst)
+{
+        t_ex_reg cond, left, right;
+        t_ex_insn *ip;
+        int n, jz, jmp;
+
+        if (!(eptr = exc_node(c, eptr, &cond, 0)))
+                return (exNULL);
+        if (cond.r_vec) {
+                if (!(eptr = exc_node(c, eptr, &left, 0)) ||
+                        !(eptr = exc_node(c, eptr, &right, 0)))
+                                return (exNULL);
+                exc_pop(c, &right);
+                exc_pop(c, &left);
+                exc_pop(c, &cond);
+                if ((n = exc_emit(c, EXI_SEL)) < 0)
+                        return (exNULL);
+                exc_push(c, dst, 1);
+                ip = &c->c_prog->p_insn[n];
+                ip->i_src[0] = cond.r_idx;
+                ip->i_src[1] = left.r_idx;
+                ip->i_src[2] = right.r_idx;
+                ip->i_vmask = 1 | (left.r_vec << 1) | (right.r_vec << 2);
+                ip->i_dst = dst->r_idx;
+                ip->i_vdst = 1;
+                c->c_lastwrite = n;
+                return (eptr);
+        }
+        exc_pop(c, &cond);
+        if ((jz = exc_emit(c, EXI_JZ)) < 0)
+                return (exNULL);
+        c->c_prog->p_insn[jz].i_src[0] = cond.r_idx;
+        if (!(eptr = exc_node(c, eptr, &left, 0)))
+                return (exNULL);
+        exc_pop(c, &left);
+        if ((jmp = exc_emit(c, EXI_JMP)) < 0)
+                return (exNULL);
+        c->c_prog->p_insn[jz].i_jump = c->c_prog->p_ninsn;
+        if (!(eptr = exc_node(c, eptr, &right, 0)))
+                return (exNULL);
+        exc_pop(c, &right);
+        c->c_prog->p_insn[jmp].i_jump = c->c_prog->p_ninsn;
+        /*
+         * both branches leave their result in the same register,
+         * unless one of them is a signal and the other is not
+         */
+        if (left.r_vec != right.r_vec)
+                return (exNULL);
+        exc_push(c, dst, left.r_vec);
+        c->c_lastwrite = -1;
+        return (eptr);
+}
+
+/*
+ * exc_func -- a function call, the function is called at run time exactly
+ *             as eval_func() does, with scalars or vectors as arguments;
+ *             vecout is set if the result goes to the signal outlet, then
+ *             (as in ex_eval()) the function gets a vector to write to
+ */
+static struct ex_ex *
+exc_func(t_ex_comp *c, struct ex_ex *eptr, t_ex_reg *dst, int vecout)
+{
+        t_ex_func *f = (t_ex_func *)eptr->ex_ptr;
+        struct ex_ex *node = eptr++;
+        t_ex_reg args[MAX_ARGS];
+        t_ex_insn *ip;
+        int i, n, vmask = 0;
+
+        if (!f || !f->f_name || f->f_argc > MAX_ARGS)
+                return (exNULL);
+        if (f->f_func == (void (*)) ex_if)
+                return (exc_if(c, eptr, dst));
+        for (i = 0; i < f->f_argc; i++) {
+                if (!(eptr = exc_node(c, eptr, &args[i], 0)))
+                        return (exNULL);
+                vmask |= args[i].r_vec << i;
+        }
+        for (i = f->f_argc - 1; i >= 0; i--)
+                exc_pop(c, &args[i]);
+        if ((n = exc_emit(c, EXI_FUNC)) < 0)
+                return (exNULL);
+        exc_push(c, dst, vmask || vecout);
+        ip = &c->c_prog->p_insn[n];
+        ip->i_node = node;
+        for (i = 0; i < f->f_argc; i++)
+                ip->i_src[i] = args[i].r_idx;
+        ip->i_vmask = vmask;
+        ip->i_dst = dst->r_idx;
+        ip->i_vdst = dst->r_vec;
+        c->c_lastwrite = n;
+        return (eptr);
+}
+
+/*
+ * exc_op -- an unary or binary operator
+ */
+static struct ex_ex *
+exc_op(t_ex_comp *c, struct ex_ex *eptr, t_ex_reg *dst)
+{
+        long op = eptr->ex_op;
+        t_ex_reg left, right;
+        t_ex_insn *ip;
+        int n, code;
+
+        switch (op) {
+        case OP_NOT:
+        case OP_NEG:
+        case OP_UMINUS:
+        case OP_MUL:
+        case OP_ADD:
+        case OP_SUB:
+        case OP_LT:
+        case OP_LE:
+        case OP_GT:
+        case OP_GE:
+        case OP_EQ:
+        case OP_NE:
+        case OP_SL:
+        case OP_SR:
+        case OP_AND:
+        case OP_XOR:
+        case OP_OR:
+        case OP_LAND:
+        case OP_LOR:
+        case OP_MOD:
+        case OP_DIV:
+                break;
+        default:
+                /* '=' and the separators */
+                return (exNULL);
+        }
+        if (!eptr[1].ex_type || (!unary_op(op) && !eptr[2].ex_type))
+                return (exNULL);
+        if (!(eptr = exc_node(c, eptr + 1, &left, 0)))
+                return (exNULL);
+        if (unary_op(op)) {
+                exc_pop(c, &left);
+                if ((n = exc_emit(c, left.r_vec ? EXI_V : EXI_S)) < 0)
+                        return (exNULL);
+                exc_push(c, dst, left.r_vec);
+        } else {
+                if (!(eptr = exc_node(c, eptr, &right, 0)))
+                        return (exNULL);
+                exc_pop(c, &right);
+                exc_pop(c, &left);
+                if (left.r_vec)
+                        code = right.r_vec ? EXI_VV : EXI_VS;
+                else
+                        code = right.r_vec ? EXI_SV : EXI_SS;
+                if ((n = exc_emit(c, code)) < 0)
+                        return (exNULL);
+                exc_push(c, dst, left.r_vec || right.r_vec);
+                c->c_prog->p_insn[n].i_src[1] = right.r_idx;
+        }
+        ip = &c->c_prog->p_insn[n];
+        ip->i_op = op;
+        ip->i_src[0] = left.r_idx;
+        ip->i_dst = dst->r_idx;
+        ip->i_vdst = dst->r_vec;
+        c->c_lastwrite = n;
+        return (eptr);
+}
+
+/*
+ * exc_node -- compile the node at eptr and its arguments, leave the
+ *             result in the register dst;  return the next node or
+ *             exNULL if the node can not be compiled
+ */
+static struct ex_ex *
+exc_node(t_ex_comp *c, struct ex_ex *eptr, t_ex_reg *dst, int vecout)
+{
+        t_expr *expr = c->c_expr;
+
+        if (!eptr)
+                return (exNULL);
+        switch (eptr->ex_type) {
+        case ET_INT:
+        case ET_FLT:
+                return (exc_terminal(c, eptr, dst, EXI_LOAD, 0));
+        case ET_II:
+                if (eptr->ex_int == -1)
+                        return (exNULL);
+                return (exc_terminal(c, eptr, dst, EXI_II, 0));
+        case ET_FI:
+                if (eptr->ex_int == -1)
+                        return (exNULL);
+                return (exc_terminal(c, eptr, dst, EXI_FI, 0));
+        case ET_VI:
+                if (!IS_EXPR_TILDE(expr))
+                        return (exNULL);
+                return (exc_terminal(c, eptr, dst, EXI_VI, 1));
+        case ET_XI0:
+                if (!IS_FEXPR_TILDE(expr))
+                        return (exNULL);
+                return (exc_terminal(c, eptr, dst, EXI_XI0, 0));
+        case ET_YOM1:
+                if (!IS_FEXPR_TILDE(expr))
+                        return (exNULL);
+                return (exc_terminal(c, eptr, dst, EXI_YOM1, 0));
+        case ET_XI:
+        case ET_YO:
+                if (!IS_FEXPR_TILDE(expr))
+                        return (exNULL);
+                return (exc_sigidx(c, eptr, dst));
+        case ET_FUNC:
+                return (exc_func(c, eptr, dst, vecout));
+        case ET_OP:
+                return (exc_op(c, eptr, dst));
+        default:
+                /* tables, variables, symbols */
+                return (exNULL);
+        }
+}
+
+/*
+ * ex_compile -- compile the expression at eptr, return 0 if it has to be
+ *               evaluated by ex_eval()
+ */
+struct ex_prog *
+ex_compile(t_expr *expr, struct ex_ex *eptr)
+{
+        t_ex_comp c;
+        t_ex_reg res;
+        int n;
+
+        if (!eptr)
+                return (0);
+        c.c_expr = expr;
+        c.c_prog = (struct ex_prog *)fts_calloc(1, sizeof(struct ex_prog));
+        if (!c.c_prog)
+                return (0);
+        c.c_ssp = 0;
+        c.c_vsp = EX_OUTREG + 1;
+        c.c_prog->p_nvreg = c.c_vsp;
+        c.c_lastwrite = -1;
+
+        if (!exc_node(&c, eptr, &res, IS_EXPR_TILDE(expr)))
+                goto fail;
+        if (res.r_vec) {
+                /*
+                 * the last instruction writes the result straight to the
+                 * output, like ex_eval() does, otherwise the result is
+                 * copied
+                 */
+                if (c.c_lastwrite >= 0 && c.c_lastwrite == c.c_prog->p_ninsn - 1)
+                        c.c_prog->p_insn[c.c_lastwrite].i_dst = EX_OUTREG;
+                else {
+                        if ((n = exc_emit(&c, EXI_COPY)) < 0)
+                                goto fail;
+                        c.c_prog->p_insn[n].i_src[0] = res.r_idx;
+                        c.c_prog->p_insn[n].i_dst = EX_OUTREG;
+                        c.c_prog->p_insn[n].i_vdst = 1;
+                }
+                res.r_idx = EX_OUTREG;
+        }
+        c.c_prog->p_res = res.r_idx;
+        c.c_prog->p_resvec = res.r_vec;
+        c.c_prog->p_sreg = (struct ex_ex *)
+                fts_calloc(c.c_prog->p_nsreg + 1, sizeof(struct ex_ex));
+        c.c_prog->p_vreg = (t_float **)
+                fts_calloc(c.c_prog->p_nvreg, sizeof(t_float *));
+        c.c_prog->p_vbuf = (t_float **)
+                fts_calloc(c.c_prog->p_nvreg, sizeof(t_float *));
+        if (!c.c_prog->p_sreg || !c.c_prog->p_vreg || !c.c_prog->p_vbuf ||
+                !ex_prog_setsize(c.c_prog, expr->exp_vsize))
+                        goto fail;
+        return (c.c_prog);
+fail:
+        ex_prog_free(c.c_prog);
+        return (0);
+}
+
+/*
+ * ex_prog_setsize -- (re)allocate the vector registers for a new vector
+ *                    size, return 0 if out of memory
+ */
+int
+ex_prog_setsize(struct ex_prog *prog, int vsize)
+{
+        t_float *mem;
+        int i;
+
+        if (vsize == prog->p_vsize && (prog->p_vmem || prog->p_nvreg < 2))
+                return (1);
+        /* register 0 is the outlet, it has no vector of its own */
+        if (prog->p_nvreg > 1) {
+                mem = (t_float *)fts_realloc(prog->p_vmem,
+                        (prog->p_nvreg - 1) * vsize * sizeof(t_float));
+                if (!mem)
+                        return (0);
+                prog->p_vmem = mem;
+                for (i = 1; i < prog->p_nvreg; i++)
+                        prog->p_vbuf[i] = prog->p_vreg[i] =
+                                mem + (i - 1) * vsize;
+        }
+        prog->p_vsize = vsize;
+        return (1);
+}
+
+void
+ex_prog_free(struct ex_prog *prog)
+{
+        if (!prog)
+                return;
+        if (prog->p_insn)
+                fts_free(prog->p_insn);
+        if (prog->p_sreg)
+                fts_free(prog->p_sreg);
+        if (prog->p_vreg)
+                fts_free(prog->p_vreg);
+        if (prog->p_vbuf)
+                fts_free(prog->p_vbuf);
+        if (prog->p_vmem)
+                fts_free(prog->p_vmem);
+        fts_free(prog);
+}
+
+/*
+ * the operators, with the same divide by zero checks and integer
+ * conversions as in ex_eval()
+ */
+#define EXC_NUM(ARG1,OPR,ARG2)  (ARG1 OPR ARG2)
+#define EXC_INT(ARG1,OPR,ARG2)  (((int)ARG1) OPR ((int)ARG2))
+#define EXC_MOD(ARG1,OPR,ARG2)  ((((int)ARG2)?(((int)ARG1) OPR ((int)ARG2)) \
+                                                        : (ex_dzdetect(expr),0)))
+#define EXC_DIV(ARG1,OPR,ARG2)  (((ARG2)?(ARG1 OPR ARG2):(ex_dzdetect(expr),0)))
+
+#define EXC_BINARY(EVAL)                                                \
+        case OP_MUL: EVAL(EXC_NUM, *); break;                           \
+        case OP_ADD: EVAL(EXC_NUM, +); break;                           \
+        case OP_SUB: EVAL(EXC_NUM, -); break;                           \
+        case OP_LT: EVAL(EXC_NUM, <); break;                            \
+        case OP_LE: EVAL(EXC_NUM, <=); break;                           \
+        case OP_GT: EVAL(EXC_NUM, >); break;                            \
+        case OP_GE: EVAL(EXC_NUM, >=); break;                           \
+        case OP_EQ: EVAL(EXC_NUM, ==); break;                           \
+        case OP_NE: EVAL(EXC_NUM, !=); break;                           \
+        case OP_SL: EVAL(EXC_INT, <<); break;                           \
+        case OP_SR: EVAL(EXC_INT, >>); break;                           \
+        case OP_AND: EVAL(EXC_INT, &); break;                           \
+        case OP_XOR: EVAL(EXC_INT, ^); break;                           \
+        case OP_OR: EVAL(EXC_INT, |); break;                            \
+        case OP_LAND: EVAL(EXC_INT, &&); break;                         \
+        case OP_LOR: EVAL(EXC_INT, ||); break;                          \
+        case OP_MOD: EVAL(EXC_MOD, %); break;                           \
+        case OP_DIV: EVAL(EXC_DIV, /); break;
+
+#define EXC_UNARY(EVAL)                                                 \
+        case OP_NOT: EVAL(!, +); break;                                 \
+        case OP_NEG: EVAL(~, (long)); break;                            \
+        case OP_UMINUS: EVAL(-, +); break;
+
+/* the value of a scalar register as a float */
+#define EXC_SCALAR(r)   ((r)->ex_type == ET_INT ? (t_float)(r)->ex_int : \
+                                                                (r)->ex_flt)
+
+#define EVAL_SS(DZC, OPR)                                               \
+        if (a->ex_type == ET_INT) {                                     \
+                if (b->ex_type == ET_INT) {                             \
+                        lv = DZC(a->ex_int, OPR, b->ex_int);            \
+                        o->ex_type = ET_INT;                            \
+                        o->ex_int = lv;                                 \
+                } else {                                                \
+                        fv = DZC(((t_float)a->ex_int), OPR, b->ex_flt); \
+                        o->ex_type = ET_FLT;                            \
+                        o->ex_flt = fv;                                 \
+                }                                                       \
+        } else if (b->ex_type == ET_INT) {                              \
+                fv = DZC(a->ex_flt, OPR, b->ex_int);                    \
+                o->ex_type = ET_FLT;                                    \
+                o->ex_flt = fv;                                         \
+        } else {                                                        \
+                fv = DZC(a->ex_flt, OPR, b->ex_flt);                    \
+                o->ex_type = ET_FLT;                                    \
+                o->ex_flt = fv;                                         \
+        }
+
+#define EVAL_SV(DZC, OPR)                                               \
+        for (j = 0; j < n; j++)                                         \
+                op[j] = DZC(scalar, OPR, rp[j]);
+
+#define EVAL_VS(DZC, OPR)                                               \
+        for (j = 0; j < n; j++)                                         \
+                op[j] = DZC(lp[j], OPR, scalar);
+
+#define EVAL_VV(DZC, OPR)                                               \
+        for (j = 0; j < n; j++)                                         \
+                op[j] = DZC(lp[j], OPR, rp[j]);
+
+#define EVAL_S(OPR, TYPE)                                               \
+        if (a->ex_type == ET_INT) {                                     \
+                lv = OPR a->ex_int;                                     \
+                o->ex_type = ET_INT;                                    \
+                o->ex_int = lv;                                         \
+        } else {                                                        \
+                fv = OPR (TYPE a->ex_flt);                              \
+                o->ex_type = ET_FLT;                                    \
+                o->ex_flt = fv;                                         \
+        }
+
+#define EVAL_V(OPR, TYPE)                                               \
+        for (j = 0; j < n; j++)                                         \
+                op[j] = OPR (TYPE lp[j]);
+
+/*
+ * ex_run -- run a compiled expression, it is the counterpart of
+ *           ex_eval(expr, eptr, optr, idx): the result is written to the
+ *           vector of optr if it is an ET_VEC, otherwise it is set to the
+ *           scalar result
+ */
+void
+ex_run(t_expr *expr, struct ex_prog *prog, struct ex_ex *optr, int idx)
+{
+        t_ex_insn *ip = prog->p_insn, *end = prog->p_insn + prog->p_ninsn;
+        struct ex_ex *sreg = prog->p_sreg;
+        t_float **vreg = prog->p_vreg, **vbuf = prog->p_vbuf;
+        struct ex_ex *a, *b, *o, args[MAX_ARGS], res;
+        t_float *lp, *rp, *cp, *op;
+        t_float scalar, fv;
+        t_ex_func *f;
+        long lv;
+        int i, j, n = prog->p_vsize;
+
+        if (prog->p_resvec) {
+                if (optr->ex_type != ET_VEC) {
+                        post("expr: ex_run: no output vector");
+                        return;
+                }
+                vbuf[EX_OUTREG] = optr->ex_vec;
+        }
+        while (ip < end) {
+                switch (ip->i_code) {
+                case EXI_LOAD:
+                        sreg[ip->i_dst] = *ip->i_node;
+                        break;
+                case EXI_II:
+                        o = &sreg[ip->i_dst];
+                        o->ex_type = ET_INT;
+                        o->ex_int = expr->exp_var[ip->i_node->ex_int].ex_int;
+                        break;
+                case EXI_FI:
+                        o = &sreg[ip->i_dst];
+                        o->ex_type = ET_FLT;
+                        o->ex_flt = expr->exp_var[ip->i_node->ex_int].ex_flt;
+                        break;
+                case EXI_VI:
+                        vreg[ip->i_dst] =
+                                expr->exp_var[ip->i_node->ex_int].ex_vec;
+                        break;
+                case EXI_XI0:
+                        o = &sreg[ip->i_dst];
+                        o->ex_type = ET_FLT;
+                        o->ex_flt =
+                                expr->exp_var[ip->i_node->ex_int].ex_vec[idx];
+                        break;
+                case EXI_YOM1:
+                        o = &sreg[ip->i_dst];
+                        o->ex_type = ET_FLT;
+                        if (idx == 0)
+                                o->ex_flt = expr->exp_p_res[ip->i_node->ex_int]
+                                                        [expr->exp_vsize - 1];
+                        else
+                                o->ex_flt = expr->exp_tmpres[ip->i_node->ex_int]
+                                                                [idx - 1];
+                        break;
+                case EXI_SIGIDX:
+                        res = sreg[ip->i_src[0]];
+                        ex_sigidx(expr, ip->i_node, &res, &sreg[ip->i_dst],
+                                                                        idx);
+                        break;
+                case EXI_SS:
+                        a = &sreg[ip->i_src[0]];
+                        b = &sreg[ip->i_src[1]];
+                        o = &sreg[ip->i_dst];
+                        switch (ip->i_op) {
+                        EXC_BINARY(EVAL_SS)
+                        }
+                        break;
+                case EXI_SV:
+                        scalar = EXC_SCALAR(&sreg[ip->i_src[0]]);
+                        rp = vreg[ip->i_src[1]];
+                        op = vreg[ip->i_dst] = vbuf[ip->i_dst];
+                        switch (ip->i_op) {
+                        EXC_BINARY(EVAL_SV)
+                        }
+                        break;
+                case EXI_VS:
+                        lp = vreg[ip->i_src[0]];
+                        scalar = EXC_SCALAR(&sreg[ip->i_src[1]]);
+                        op = vreg[ip->i_dst] = vbuf[ip->i_dst];
+                        switch (ip->i_op) {
+                        EXC_BINARY(EVAL_VS)
+                        }
+                        break;
+                case EXI_VV:
+                        lp = vreg[ip->i_src[0]];
+                        rp = vreg[ip->i_src[1]];
+                        op = vreg[ip->i_dst] = vbuf[ip->i_dst];
+                        switch (ip->i_op) {
+                        EXC_BINARY(EVAL_VV)
+                        }
+                        break;
+                case EXI_S:
+                        a = &sreg[ip->i_src[0]];
+                        o = &sreg[ip->i_dst];
+                        switch (ip->i_op) {
+                        EXC_UNARY(EVAL_S)
+                        }
+                        break;
+                case EXI_V:
+                        lp = vreg[ip->i_src[0]];
+                        op = vreg[ip->i_dst] = vbuf[ip->i_dst];
+                        switch (ip->i_op) {
+                        EXC_UNARY(EVAL_V)
+                        }
+                        break;
+                case EXI_FUNC:
+                        f = (t_ex_func *)ip->i_node->ex_ptr;
+                        for (i = 0; i < f->f_argc; i++) {
+                                if (ip->i_vmask & (1 << i)) {
+                                        args[i].ex_type = ET_VI;
+                                        args[i].ex_vec = vreg[ip->i_src[i]];
+                                } else
+                                        args[i] = sreg[ip->i_src[i]];
+                        }
+                        if (ip->i_vdst) {
+                                res.ex_type = ET_VEC;
+                                res.ex_vec = vreg[ip->i_dst] = vbuf[ip->i_dst];
+                                (*f->f_func)(expr, f->f_argc, args, &res);
+                        } else {
+                                res.ex_type = 0;
+                                res.ex_int = 0;
+                                (*f->f_func)(expr, f->f_argc, args, &res);
+                                sreg[ip->i_dst] = res;
+                        }
+                        break;
+                case EXI_SEL:
+                        cp = vreg[ip->i_src[0]];
+                        op = vreg[ip->i_dst] = vbuf[ip->i_dst];
+                        switch (ip->i_vmask) {
+                        case 1:
+                                fv = EXC_SCALAR(&sreg[ip->i_src[1]]);
+                                scalar = EXC_SCALAR(&sreg[ip->i_src[2]]);
+                                for (j = 0; j < n; j++)
+                                        op[j] = cp[j] ? fv : scalar;
+                                break;
+                        case 3:
+                                lp = vreg[ip->i_src[1]];
+                                scalar = EXC_SCALAR(&sreg[ip->i_src[2]]);
+                                for (j = 0; j < n; j++)
+                                        op[j] = cp[j] ? lp[j] : scalar;
+                                break;
+                        case 5:
+                                fv = EXC_SCALAR(&sreg[ip->i_src[1]]);
+                                rp = vreg[ip->i_src[2]];
+                                for (j = 0; j < n; j++)
+                                        op[j] = cp[j] ? fv : rp[j];
+                                break;
+                        default:
+                                lp = vreg[ip->i_src[1]];
+                                rp = vreg[ip->i_src[2]];
+                                for (j = 0; j < n; j++)
+                                        op[j] = cp[j] ? lp[j] : rp[j];
+                        }
+                        break;
+                case EXI_JZ:
+                        a = &sreg[ip->i_src[0]];
+                        if (a->ex_type == ET_INT ? !a->ex_int : !a->ex_flt) {
+                                ip = prog->p_insn + ip->i_jump;
+                                continue;
+                        }
+                        break;
+                case EXI_JMP:
+                        ip = prog->p_insn + ip->i_jump;
+                        continue;
+                case EXI_COPY:
+                        op = vreg[ip->i_dst] = vbuf[ip->i_dst];
+                        if (op != vreg[ip->i_src[0]])
+                                memcpy(op, vreg[ip->i_src[0]],
+                                                        n * sizeof(t_float));
+                        break;
+                default:
+                        post("expr: ex_run: bad instruction %d", ip->i_code);
+                        return;
+                }
+                ip++;
+        }
+        if (!prog->p_resvec) {
+                a = &sreg[prog->p_res];
+                if (optr->ex_type == ET_VEC)
+                        ex_mkvector(optr->ex_vec, EXC_SCALAR(a), expr->exp_vsize);
+                else
+                        *optr = *a;
+        }
+}
@@ -43,6 +43,20 @@ void *expr_tilde_class;
 
 extern int expr_donew(struct expr *expr, int ac, t_atom *av);
 
+/*
+ * expr_eval -- evaluate the i'th expression, with the compiled code if the
+ *              expression could be compiled; return 0 on error
+ */
+static int
+expr_eval(t_expr *x, int i, struct ex_ex *optr, int idx)
+{
+        if (x->exp_prog[i]) {
+                ex_run(x, x->exp_prog[i], optr, idx);
+                return (1);
+        }
+        return (ex_eval(x, x->exp_stack[i], optr, idx) != 0);
+}
+
 /*#define EXPR_DEBUG*/
 
 static void expr_bang(t_expr *x);
@@ -147,9 +161,12 @@ expr_ff(t_expr *x)
 #endif
                 y = x->exp_proxy;
         }
-        for (i = 0 ; i < x->exp_nexpr; i++)
+        for (i = 0 ; i < x->exp_nexpr; i++) {
                 if (x->exp_stack[i])
                         fts_free(x->exp_stack[i]);
+                ex_prog_free(x->exp_prog[i]);
+                x->exp_prog[i] = 0;
+        }
 /*
  * SDY free all the allocated buffers here for expr~ and fexpr~
  * check to see if there are others
@@ -200,7 +217,7 @@ expr_bang(t_expr *x)
                 return;
 
         for (i = x->exp_nexpr - 1; i > -1 ; i--) {
-                if (!ex_eval(x, x->exp_stack[i], &x->exp_res[i], 0)) {
+                if (!expr_eval(x, i, &x->exp_res[i], 0)) {
                         /*fprintf(stderr,"expr_bang(error evaluation)\n"); */
                 /*  SDY now that we have multiple ones, on error we should
                  * continue
@@ -285,6 +302,7 @@ Nexpr_new(t_symbol *s, int ac, t_atom *av)
         x->exp_error = 0;
         for (i = 0; i < MAX_VARS; i++) {
                 x->exp_stack[i] = (struct ex_ex *)0;
+                x->exp_prog[i] = (struct ex_prog *)0;
                 x->exp_outlet[i] = (t_outlet *)0;
                 x->exp_res[i].ex_type = 0;
                 x->exp_res[i].ex_int = 0;
@@ -391,6 +409,13 @@ SDY the following coredumps why?
         for (i = 0; i < MAX_VARS; i++)
                 x->exp_p_var[i] = fts_calloc(x->exp_vsize, sizeof (t_float));
 
+        /*
+         * compile the expressions to bytecode, the ones that can not be
+         * compiled are evaluated by ex_eval()
+         */
+        for (i = 0; i < x->exp_nexpr; i++)
+                x->exp_prog[i] = ex_compile(x, x->exp_stack[i]);
+
         return (x);
 }
 
@@ -423,12 +448,12 @@ expr_perform(t_int *w)
                  * inputs
                  */
                 if ( x->exp_nexpr == 1)
-                        ex_eval(x, x->exp_stack[0], &x->exp_res[0], 0);
+                        expr_eval(x, 0, &x->exp_res[0], 0);
                 else {
                         res.ex_type = ET_VEC;
                         for (i = 0; i < x->exp_nexpr; i++) {
                                 res.ex_vec = x->exp_tmpres[i];
-                                ex_eval(x, x->exp_stack[i], &res, 0);
+                                expr_eval(x, i, &res, 0);
                         }
                         n = x->exp_vsize * sizeof(t_float);
                         for (i = 0; i < x->exp_nexpr; i++)
@@ -450,7 +475,7 @@ expr_perform(t_int *w)
         for (i = 0; i < x->exp_vsize; i++) for (j = 0; j < x->exp_nexpr; j++) {
                 res.ex_type = 0;
                 res.ex_int = 0;
-                ex_eval(x, x->exp_stack[j], &res, i);
+                expr_eval(x, j, &res, i);
                 switch (res.ex_type) {
                 case ET_INT:
                         x->exp_tmpres[j][i] = (t_float) res.ex_int;
@@ -487,6 +512,13 @@ expr_dsp(t_expr *x, t_signal **sp)
         x->exp_error = 0;               /* reset all errors */
         newsize = (x->exp_vsize !=  sp[0]->s_n);
         x->exp_vsize = sp[0]->s_n;      /* record the vector size */
+        for (i = 0; i < x->exp_nexpr; i++)
+                if (x->exp_prog[i] &&
+                        !ex_prog_setsize(x->exp_prog[i], x->exp_vsize)) {
+                        /* out of memory, fall back to ex_eval() */
+                        ex_prog_free(x->exp_prog[i]);
+                        x->exp_prog[i] = 0;
+                }
         for (i = 0; i < x->exp_nexpr; i++) {
                 x->exp_res[i].ex_type = ET_VEC;
                 x->exp_res[i].ex_vec =  sp[x->exp_nivec + i]->s_vec;
@@ -556,12 +588,17 @@ expr_dsp(t_expr *x, t_signal **sp)
 static void
 expr_verbose(t_expr *x)
 {
+        int i;
+
         if (x->exp_flags & EF_VERBOSE) {
                 x->exp_flags &= ~EF_VERBOSE;
                 post ("verbose off");
         } else {
                 x->exp_flags |= EF_VERBOSE;
                 post ("verbose on");
+                for (i = 0; i < x->exp_nexpr; i++)
+                        post("expression %d is %s", i + 1,
+                                x->exp_prog[i] ? "compiled" : "interpreted");
         }
 }
 
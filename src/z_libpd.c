@@ -656,6 +656,30 @@ int libpd_get_verbose(void) {
   return sys_verbose;
 }
 
+void libpd_get_stats(t_schedstats *stats) {
+  sched_getstats(stats);
+}
+
+void libpd_reset_stats(void) {
+  sched_resetstats();
+}
+
+int libpd_read_stats_ticks(unsigned int *pos, float *dest, int n) {
+#if PD_FLOATSIZE == 32
+  return sched_readticks(pos, dest, n);
+#else
+  t_float buf[64];
+  int count = 0, nread;
+  while (count < n && (nread = sched_readticks(pos, buf,
+      (n - count < 64 ? n - count : 64))) > 0) {
+    int i;
+    for (i = 0; i < nread; i++)
+      dest[count++] = buf[i];
+  }
+  return count;
+#endif
+}
+
 // dummy routines needed because we don't use s_file.c
 void glob_loadpreferences(t_pd *dummy, t_symbol *s) {}
 void glob_savepreferences(t_pd *dummy, t_symbol *s) {}
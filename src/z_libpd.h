@@ -18,6 +18,7 @@ extern "C"
 #endif
 
 #include "m_pd.h"
+#include "m_schedstats.h"
 
 /* initializing pd */
 
@@ -506,6 +507,22 @@ EXTERN void libpd_set_verbose(int verbose);
 /// get the verbose print state: 0 or 1
 EXTERN int libpd_get_verbose(void);
 
+/* timing statistics */
+
+/// get timing statistics of the libpd_process calls since the last reset:
+/// tick count, late ticks, max/mean/percentile tick time relative to the
+/// block period, tick time histogram and idle time (see m_schedstats.h)
+/// safe to call from any thread, does not block the audio thread
+EXTERN void libpd_get_stats(t_schedstats *stats);
+
+/// reset timing statistics, done on the next processed tick
+EXTERN void libpd_reset_stats(void);
+
+/// read tick times, as fractions of the block period, logged since *pos
+/// (start with *pos = 0) into dest, at most n of them, and advance *pos
+/// returns the number read
+EXTERN int libpd_read_stats_ticks(unsigned int *pos, float *dest, int n);
+
 #ifdef __cplusplus
 }
 #endif